@@ -9,7 +9,7 @@
 using Campaign = campaign::Campaign;
 using Updates = std::vector<Uptane::Target>;
 using Target = Uptane::Target;
-using StorageTargetHandle = std::ifstream;
+using StorageTargetHandle = std::istream;
 
 extern "C" {
 #else
@@ -8,8 +8,11 @@
 
 #include "libaktualizr/config.h"
 #include "libaktualizr/events.h"
+#include "libaktualizr/mapped_file.h"
 #include "libaktualizr/secondaryinterface.h"
 
+class EventDispatcher;
+class PollingScheduler;
 class SotaUptaneClient;
 class INvStorage;
 
@@ -63,6 +66,11 @@ class Aktualizr {
 
   /**
    * Asynchronously run aktualizr indefinitely until Shutdown is called.
+   *
+   * The wait between update cycles is uptane.polling_sec, adapted to the
+   * state of the device and the hints of the server; see the polling options
+   * of the uptane section of the configuration. Wakeup() starts the next
+   * cycle right away.
    * @return Empty std::future object
    *
    * @throw SQLException
@@ -82,6 +90,15 @@ class Aktualizr {
    */
   void Shutdown();
 
+  /**
+   * Start the next update cycle of `RunForever()` without waiting for the
+   * end of the polling interval, e.g. when the user asks for an update check.
+   * A call made while a cycle runs starts the next one right after it.
+   *
+   * @throw std::system_error (failure to lock a mutex)
+   */
+  void Wakeup();
+
   /**
    * Check for campaigns.
    * Campaigns are a concept outside of Uptane, and allow for user approval of
@@ -198,12 +215,26 @@ class Aktualizr {
    * Get target downloaded in Download call. Returned target is guaranteed to be verified and up-to-date
    * according to the Uptane metadata downloaded in CheckUpdates call.
    * @param target Target object matching the desired target in the storage.
-   * @return Handle to the stored binary. nullptr if none is found.
+   * @return Stream of the stored binary. Targets in the chunk store are read
+   * chunk by chunk rather than reassembled into a file.
+   *
+   * @throw SQLException
+   * @throw std::runtime_error (error getting targets from database or filesystem)
+   */
+  std::unique_ptr<std::istream> OpenStoredTarget(const Uptane::Target& target);
+
+  /**
+   * Map target downloaded in Download call into memory. Like OpenStoredTarget,
+   * but gives access to the whole binary without copying it. Large binaries
+   * are best processed with MappedFile::forEachSpan, which is the only way to
+   * read those that don't fit into the address space.
+   * @param target Target object matching the desired target in the storage.
+   * @return Read-only view of the stored binary.
    *
    * @throw SQLException
    * @throw std::runtime_error (error getting targets from database or filesystem)
    */
-  std::ifstream OpenStoredTarget(const Uptane::Target& target);
+  std::unique_ptr<MappedFile> MapStoredTarget(const Uptane::Target& target);
 
   /**
    * Install targets.
@@ -364,10 +395,14 @@ class Aktualizr {
     std::mutex m;
     std::condition_variable cv;
     bool flag = false;
+    bool wakeup = false;
   } exit_cond_;
 
+  std::unique_ptr<PollingScheduler> polling_scheduler_;
+
   std::shared_ptr<INvStorage> storage_;
   std::shared_ptr<event::Channel> sig_;
+  std::shared_ptr<EventDispatcher> dispatcher_;
   std::unique_ptr<api::CommandQueue> api_queue_;
 };
 
@@ -17,6 +17,7 @@
 
 struct LoggerConfig {
   int loglevel{2};
+  bool async{false};
   void updateFromPropertyTree(const boost::property_tree::ptree& pt);
   void writeToStream(std::ostream& out_stream) const;
 };
@@ -65,6 +66,13 @@ struct ProvisionConfig {
 
 struct UptaneConfig {
   uint64_t polling_sec{10U};
+  // Interval while an update is in progress
+  uint64_t polling_active_sec{10U};
+  // Upper bound for backoff and server hints
+  uint64_t polling_max_sec{3600U};
+  uint64_t polling_jitter_percent{10U};
+  // Resend an unchanged manifest only after this long; 0 means always send
+  uint64_t manifest_heartbeat_sec{0U};
   std::string director_server;
   std::string repo_server;
   CryptoSource key_source{CryptoSource::kFile};
@@ -72,6 +80,11 @@ struct UptaneConfig {
   bool force_install_completion{false};
   boost::filesystem::path secondary_config_file;
   uint64_t secondary_preinstall_wait_sec{600U};
+  // 0 means no limit
+  uint64_t memory_soft_limit_mb{0U};
+  // 0 means events are delivered synchronously
+  uint64_t event_queue_size{256U};
+  EventOverflow event_overflow{EventOverflow::kDropProgress};
 
   void updateFromPropertyTree(const boost::property_tree::ptree& pt);
   void writeToStream(std::ostream& out_stream) const;
@@ -97,6 +110,12 @@ struct PackageConfig {
   boost::filesystem::path images_path{"/var/sota/images"};
   boost::filesystem::path packages_file{"/usr/package.manifest"};
 
+  // Binary Target options
+  bool chunk_store{false};
+  // Hash binary Targets on every verification instead of trusting the ledger
+  // of verified Targets.
+  bool paranoid_verification{false};
+
   // Options for simulation
   bool fake_need_reboot{false};
   BootedType booted{BootedType::kBooted};
@@ -150,6 +169,20 @@ struct TelemetryConfig {
   void writeToStream(std::ostream& out_stream) const;
 };
 
+/**
+ * @brief The TracingConfig struct
+ * Record the time spent in the phases of the update pipeline, see
+ * utilities/tracing.h.
+ */
+struct TracingConfig {
+  bool enabled{false};
+  boost::filesystem::path prometheus_path;
+  boost::filesystem::path chrome_trace_path;
+  uint64_t max_events{100000};
+  void updateFromPropertyTree(const boost::property_tree::ptree& pt);
+  void writeToStream(std::ostream& out_stream) const;
+};
+
 enum class RollbackMode { kBootloaderNone = 0, kUbootGeneric, kUbootMasked };
 std::ostream& operator<<(std::ostream& os, RollbackMode mode);
 
@@ -229,6 +262,7 @@ class Config : public BaseConfig {
   StorageConfig storage;
   ImportConfig import;
   TelemetryConfig telemetry;
+  TracingConfig tracing;
   BootloaderConfig bootloader;
 
  private:
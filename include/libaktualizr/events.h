@@ -193,6 +193,24 @@ class CampaignPostponeComplete : public BaseEvent {
   CampaignPostponeComplete() { variant = TypeName; }
 };
 
+/**
+ * The resident memory of aktualizr has reached a watermark of the configured
+ * soft memory limit.
+ */
+class MemoryWatermark : public BaseEvent {
+ public:
+  static constexpr const char* TypeName{"MemoryWatermark"};
+
+  MemoryWatermark(unsigned int watermark_in, uint64_t resident_in, uint64_t soft_limit_in)
+      : watermark(watermark_in), resident(resident_in), soft_limit(soft_limit_in) {
+    variant = TypeName;
+  }
+
+  unsigned int watermark;  // percent of the soft limit
+  uint64_t resident;
+  uint64_t soft_limit;
+};
+
 using Channel = boost::signals2::signal<void(std::shared_ptr<event::BaseEvent>)>;
 
 }  // namespace event
@@ -0,0 +1,64 @@
+#ifndef MAPPED_FILE_H_
+#define MAPPED_FILE_H_
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+#include <boost/filesystem.hpp>
+
+/**
+ * Read-only, memory-mapped view of a file. The kernel is told that the file
+ * will be read sequentially, so it reads ahead aggressively and the content
+ * can be hashed or sent without copying it into a user space buffer first.
+ *
+ * The mapping stays valid after the file is removed. Files that don't fit
+ * into the address space, which can happen with multi-GB images on 32-bit
+ * devices, are mapped one span at a time by forEachSpan() instead.
+ *
+ * Content that isn't kept in a single file, such as a Target in the chunk
+ * store, can be given as a source of spans instead of a file.
+ */
+class MappedFile {
+ public:
+  using SpanCallback = std::function<void(const uint8_t* data, size_t size)>;
+  using SpanSource = std::function<void(const SpanCallback& cb)>;
+
+  static constexpr size_t kSpanSize = 4 * 1024 * 1024;
+
+  /** @throw std::runtime_error if the file can't be opened or mapped */
+  explicit MappedFile(const boost::filesystem::path& path);
+  /** `size` bytes that `source` passes on in spans of its own choosing. data() is nullptr. */
+  MappedFile(uint64_t size, SpanSource source) : size_(size), source_(std::move(source)) {}
+  ~MappedFile();
+  MappedFile(const MappedFile&) = delete;
+  MappedFile(MappedFile&&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  MappedFile& operator=(MappedFile&&) = delete;
+
+  /**
+   * Start of the file content, nullptr for an empty file, one that is too
+   * large to be mapped as a whole or a source of spans. Use forEachSpan() for
+   * those.
+   */
+  const uint8_t* data() const { return data_; }
+  uint64_t size() const { return size_; }
+
+  /**
+   * Pass the whole file to `cb` in spans of `span_size` bytes. The next span
+   * is read ahead while `cb` runs and processed spans are unmapped again, so
+   * that large files don't add to the resident memory. The spans of a
+   * source of spans are passed on as they are.
+   */
+  void forEachSpan(const SpanCallback& cb, size_t span_size = kSpanSize) const;
+
+ private:
+  void forEachWindow(const SpanCallback& cb, size_t span_size) const;
+
+  int fd_{-1};
+  uint8_t* data_{nullptr};
+  uint64_t size_{0};
+  SpanSource source_;
+};
+
+#endif  // MAPPED_FILE_H_
@@ -2,15 +2,22 @@
 #define PACKAGEMANAGERINTERFACE_H_
 
 #include <fstream>
+#include <istream>
+#include <memory>
 #include <mutex>
 #include <string>
 
 #include "libaktualizr/config.h"
+#include "libaktualizr/mapped_file.h"
 
 class Bootloader;
+class ChunkStore;
+class DeltaTarget;
 class HttpInterface;
 class KeyManager;
+class MultiPartHasher;
 class INvStorage;
+class TargetLedger;
 
 namespace api {
 class FlowControlToken;
@@ -40,13 +47,27 @@ enum class TargetStatus {
   kInvalid,
 };
 
+/**
+ * A Target file that has been found in the storage, see checkTargetFile().
+ */
+struct StoredTargetFile {
+  enum class Kind {
+    /* A plain file at `path`, possibly incomplete. */
+    kFile,
+    /* Chunks in the chunk store. `path` is empty: the content can only be
+     * read through openTargetFile() and mapTargetFile(). */
+    kChunks,
+  };
+
+  Kind kind{Kind::kFile};
+  uintmax_t size{0};
+  boost::filesystem::path path;
+};
+
 class PackageManagerInterface {
  public:
   PackageManagerInterface(PackageConfig pconfig, const BootloaderConfig& bconfig, std::shared_ptr<INvStorage> storage,
-                          std::shared_ptr<HttpInterface> http)
-      : config(std::move(pconfig)), storage_(std::move(storage)), http_(std::move(http)) {
-    (void)bconfig;
-  }
+                          std::shared_ptr<HttpInterface> http);
   virtual ~PackageManagerInterface() = default;
   PackageManagerInterface(const PackageManagerInterface&) = delete;
   PackageManagerInterface(PackageManagerInterface&&) = delete;
@@ -63,16 +84,34 @@ class PackageManagerInterface {
                            const FetcherProgressCb& progress_cb, const api::FlowControlToken* token);
   virtual TargetStatus verifyTarget(const Uptane::Target& target) const;
   virtual bool checkAvailableDiskSpace(uint64_t required_bytes) const;
-  virtual boost::optional<std::pair<uintmax_t, std::string>> checkTargetFile(const Uptane::Target& target) const;
+  virtual boost::optional<StoredTargetFile> checkTargetFile(const Uptane::Target& target) const;
   virtual std::ofstream createTargetFile(const Uptane::Target& target);
   virtual std::ofstream appendTargetFile(const Uptane::Target& target);
-  virtual std::ifstream openTargetFile(const Uptane::Target& target) const;
+  virtual std::unique_ptr<std::istream> openTargetFile(const Uptane::Target& target) const;
+  virtual std::unique_ptr<MappedFile> mapTargetFile(const Uptane::Target& target) const;
   virtual void removeTargetFile(const Uptane::Target& target);
   virtual std::vector<Uptane::Target> getTargetFiles();
+  virtual boost::optional<std::pair<uintmax_t, std::string>> checkDeltaFile(const DeltaTarget& delta) const;
+  virtual std::ifstream openDeltaFile(const DeltaTarget& delta) const;
 
  protected:
+  bool fetchDelta(const Uptane::Target& target, const FetcherProgressCb& progress_cb,
+                  const api::FlowControlToken* token);
+  bool downloadDelta(const Uptane::Target& target, const DeltaTarget& delta, const FetcherProgressCb& progress_cb,
+                     const api::FlowControlToken* token);
+  bool fetchChunks(const Uptane::Target& target, const std::string& url, const FetcherProgressCb& progress_cb,
+                   const api::FlowControlToken* token);
+  void chunkTargetFile(const Uptane::Target& target);
+  void hashTargetFile(const Uptane::Target& target, const StoredTargetFile& file, MultiPartHasher& hasher) const;
+  void recordVerified(const Uptane::Target& target) const;
+
   PackageConfig config;
   std::shared_ptr<INvStorage> storage_;
   std::shared_ptr<HttpInterface> http_;
+  // Only set if binary Targets are kept in a chunk store.
+  std::shared_ptr<ChunkStore> chunk_store_;
+  // Binary Targets that have been hashed and not changed since. Not set if
+  // paranoid_verification is on.
+  std::shared_ptr<TargetLedger> ledger_;
 };
 #endif  // PACKAGEMANAGERINTERFACE_H_
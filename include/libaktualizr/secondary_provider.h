@@ -7,6 +7,7 @@
 #include "libaktualizr/packagemanagerinterface.h"
 #include "libaktualizr/types.h"
 
+class DeltaTarget;
 class INvStorage;
 
 class SecondaryProviderBuilder;
@@ -19,7 +20,12 @@ class SecondaryProvider {
   bool getDirectorMetadata(Uptane::MetaBundle* meta_bundle) const;
   bool getImageRepoMetadata(Uptane::MetaBundle* meta_bundle, const Uptane::Target& target) const;
   std::string getTreehubCredentials() const;
-  std::ifstream getTargetFileHandle(const Uptane::Target& target) const;
+  std::unique_ptr<std::istream> getTargetFileHandle(const Uptane::Target& target) const;
+  std::unique_ptr<MappedFile> mapTargetFile(const Uptane::Target& target) const;
+  /* Returns a stream that is not open if the delta has not been downloaded. */
+  std::ifstream getDeltaFileHandle(const DeltaTarget& delta) const;
+  /* Whether `bytes` more can be held in memory within the configured soft memory limit. */
+  bool fitsInMemory(uint64_t bytes) const;
 
  private:
   SecondaryProvider(Config& config_in, std::shared_ptr<const INvStorage> storage_in,
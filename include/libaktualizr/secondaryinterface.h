@@ -2,6 +2,7 @@
 #define UPTANE_SECONDARYINTERFACE_H
 
 #include <string>
+#include <vector>
 
 #include "libaktualizr/secondary_provider.h"
 #include "libaktualizr/types.h"
@@ -22,11 +23,34 @@ class SecondaryInterface {
   virtual Uptane::Manifest getManifest() const = 0;
   virtual data::InstallationResult putMetadata(const Uptane::Target& target) = 0;
   virtual bool ping() const = 0;
+  /**
+   * Whether ping() may be called from another thread while other calls to
+   * this Secondary are in progress. Only then is the Secondary pinged in the
+   * background to keep track of its reachability.
+   */
+  virtual bool isPingThreadSafe() const { return false; }
 
   // return 0 during initialization and -1 for error.
   virtual int32_t getRootVersion(bool director) const = 0;
   virtual data::InstallationResult putRoot(const std::string& root, bool director) = 0;
 
+  /**
+   * Send a chain of consecutive Root metadata versions, oldest first, and stop
+   * at the first one that is rejected. Implementations that can transfer the
+   * whole chain at once should override this; the default sends each version
+   * with putRoot().
+   */
+  virtual data::InstallationResult putRootChain(const std::vector<std::string>& roots, bool director) {
+    data::InstallationResult result{data::ResultCode::Numeric::kOk, ""};
+    for (const auto& root : roots) {
+      result = putRoot(root, director);
+      if (!result.isSuccess()) {
+        break;
+      }
+    }
+    return result;
+  }
+
   /**
    * Send firmware to a device. This operation should be both idempotent and
    * not commit to installing the new version. Where practical, the
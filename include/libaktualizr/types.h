@@ -28,6 +28,17 @@ enum class VerificationType {
 };
 std::ostream &operator<<(std::ostream &os, VerificationType vtype);
 
+/** What to do with an event when the event queue is full. */
+enum class EventOverflow {
+  /* Wait for room in the queue. */
+  kBlock = 0,
+  /* Drop download progress reports, wait for room for anything else. */
+  kDropProgress,
+  /* Drop the event. */
+  kDropNewest,
+};
+std::ostream &operator<<(std::ostream &os, EventOverflow overflow);
+
 namespace utils {
 /**
  * @brief The BasedPath class
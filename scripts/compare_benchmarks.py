@@ -0,0 +1,50 @@
+#!/usr/bin/env python3
+
+import argparse
+import json
+import sys
+
+from pathlib import Path
+
+
+def load(path):
+    with path.open() as f:
+        results = json.load(f)
+    return {run['name']: run for run in results['benchmarks'] if not run.get('error_occurred', False)}
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Compare two aktualizr-benchmarks results and report regressions')
+    parser.add_argument('baseline', type=Path, help='results of the reference build')
+    parser.add_argument('current', type=Path, help='results of the build to check')
+    parser.add_argument('-t', '--threshold', type=float, default=0.1,
+                        help='relative increase of the real time that counts as a regression')
+    args = parser.parse_args()
+
+    baseline = load(args.baseline)
+    current = load(args.current)
+
+    regressions = 0
+    for name, run in current.items():
+        if name not in baseline:
+            print('{:<40} new'.format(name))
+            continue
+        before = baseline[name]['real_time']
+        after = run['real_time']
+        change = (after - before) / before if before > 0 else 0.0
+        regressed = change > args.threshold
+        if regressed:
+            regressions += 1
+        print('{:<40} {:>14.0f} ns {:>14.0f} ns {:>+8.1%}{}'.format(name, before, after, change,
+                                                                   '  REGRESSION' if regressed else ''))
+    for name in baseline.keys() - current.keys():
+        print('{:<40} missing'.format(name))
+
+    if regressions > 0:
+        print('Error: ' + str(regressions) + ' benchmarks regressed by more than {:.0%}'.format(args.threshold))
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -138,13 +138,17 @@ int main(int argc, char *argv[]) {
     aktualizr.Initialize();
 
     // handle unix signals
-    SigHandler::get().start([&aktualizr]() {
-      aktualizr.Abort();
-      aktualizr.Shutdown();
-    });
+    SigHandler::get().start(
+        [&aktualizr]() {
+          aktualizr.Abort();
+          aktualizr.Shutdown();
+        },
+        [&aktualizr]() { aktualizr.Wakeup(); });
     SigHandler::signal(SIGHUP);
     SigHandler::signal(SIGINT);
     SigHandler::signal(SIGTERM);
+    // Check for updates right away
+    SigHandler::wakeupSignal(SIGUSR1);
 
     if (commandline_map.count("hwinfo-file") != 0) {
       auto file = commandline_map["hwinfo-file"].as<boost::filesystem::path>();
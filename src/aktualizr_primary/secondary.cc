@@ -6,6 +6,8 @@
 #include <boost/filesystem.hpp>
 
 #include <algorithm>
+#include <chrono>
+#include <future>
 #include <unordered_map>
 
 #include "ipuptanesecondary.h"
@@ -168,13 +170,23 @@ class SecondaryWaiter {
 // cause re-registration.
 // 3. Same as 2 but cannot connect: abort.
 // 4. Secondary is stored but not configured: it must have been removed. Skip it. This will cause re-registration.
+//
+// The handshakes with all configured Secondaries run concurrently, so that
+// Secondaries that are slow to answer don't delay the others.
 static Secondaries createIPSecondaries(const IPSecondariesConfig& config, Aktualizr& aktualizr) {
   Secondaries result;
   SecondaryWaiter sec_waiter{aktualizr, config.secondaries_wait_port, config.secondaries_timeout_s, result};
   auto secondaries_info = aktualizr.GetSecondaries();
+  const std::chrono::milliseconds timeout = std::chrono::seconds(config.secondaries_connect_timeout_s);
+
+  struct Handshake {
+    const IPSecondaryConfig& cfg;
+    const SecondaryInfo* info;  // nullptr for new Secondaries
+    std::future<SecondaryInterface::Ptr> secondary;
+  };
+  std::vector<Handshake> handshakes;
 
   for (const auto& cfg : config.secondaries_cfg) {
-    SecondaryInterface::Ptr secondary;
     const SecondaryInfo* info = nullptr;
 
     // Try to match the configured Secondaries to stored Secondaries.
@@ -197,9 +209,26 @@ static Secondaries createIPSecondaries(const IPSecondariesConfig& config, Aktual
       d["verification_type"] = Uptane::VerificationTypeToString(cfg.verification_type);
       aktualizr.SetSecondaryData(info->serial, Utils::jsonToCanonicalStr(d));
       LOG_INFO << "Migrated a single IP Secondary to new storage format.";
-    } else if (f == secondaries_info.cend()) {
-      // Secondary was not found in storage; it must be new.
-      secondary = Uptane::IpUptaneSecondary::connectAndCreate(cfg.ip, cfg.port, cfg.verification_type);
+    } else if (f != secondaries_info.cend()) {
+      // The configured Secondary was found in storage.
+      info = &(*f);
+    }
+
+    auto secondary = std::async(std::launch::async, [&cfg, info, timeout]() {
+      if (info == nullptr) {
+        // Secondary was not found in storage; it must be new.
+        return Uptane::IpUptaneSecondary::connectAndCreate(cfg.ip, cfg.port, cfg.verification_type, timeout);
+      }
+      return Uptane::IpUptaneSecondary::connectAndCheck(cfg.ip, cfg.port, cfg.verification_type, info->serial,
+                                                        info->hw_id, info->pub_key, timeout);
+    });
+    handshakes.push_back(Handshake{cfg, info, std::move(secondary)});
+  }
+
+  for (auto& handshake : handshakes) {
+    const auto& cfg = handshake.cfg;
+    SecondaryInterface::Ptr secondary = handshake.secondary.get();
+    if (handshake.info == nullptr) {
       if (secondary == nullptr) {
         LOG_DEBUG << "Could not connect to IP Secondary at " << cfg.ip << ":" << cfg.port
                   << "; now trying to wait for it.";
@@ -214,18 +243,11 @@ static Secondaries createIPSecondaries(const IPSecondariesConfig& config, Aktual
         aktualizr.SetSecondaryData(secondary->getSerial(), Utils::jsonToCanonicalStr(d));
       }
       continue;
-    } else {
-      // The configured Secondary was found in storage.
-      info = &(*f);
     }
 
     if (secondary == nullptr) {
-      secondary = Uptane::IpUptaneSecondary::connectAndCheck(cfg.ip, cfg.port, cfg.verification_type, info->serial,
-                                                             info->hw_id, info->pub_key);
-      if (secondary == nullptr) {
-        throw std::runtime_error("Unable to connect to or verify IP Secondary at " + cfg.ip + ":" +
-                                 std::to_string(cfg.port));
-      }
+      throw std::runtime_error("Unable to connect to or verify IP Secondary at " + cfg.ip + ":" +
+                               std::to_string(cfg.port));
     }
 
     result.push_back(secondary);
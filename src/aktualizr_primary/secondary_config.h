@@ -36,18 +36,26 @@ class IPSecondariesConfig : public SecondaryConfig {
   static constexpr const char* const Type{"IP"};
   static constexpr const char* const PortField{"secondaries_wait_port"};
   static constexpr const char* const TimeoutField{"secondaries_wait_timeout"};
+  static constexpr const char* const ConnectTimeoutField{"secondaries_connect_timeout"};
   static constexpr const char* const SecondariesField{"secondaries"};
 
-  IPSecondariesConfig(const uint16_t wait_port, const int timeout_s)
-      : SecondaryConfig(Type), secondaries_wait_port{wait_port}, secondaries_timeout_s{timeout_s} {}
+  IPSecondariesConfig(const uint16_t wait_port, const int timeout_s, const int connect_timeout_s = 0)
+      : SecondaryConfig(Type),
+        secondaries_wait_port{wait_port},
+        secondaries_timeout_s{timeout_s},
+        secondaries_connect_timeout_s{connect_timeout_s} {}
 
   friend std::ostream& operator<<(std::ostream& os, const IPSecondariesConfig& cfg) {
-    os << "(wait_port: " << cfg.secondaries_wait_port << " timeout_s: " << cfg.secondaries_timeout_s << ")";
+    os << "(wait_port: " << cfg.secondaries_wait_port << " timeout_s: " << cfg.secondaries_timeout_s
+       << " connect_timeout_s: " << cfg.secondaries_connect_timeout_s << ")";
     return os;
   }
 
   const uint16_t secondaries_wait_port;
   const int secondaries_timeout_s;
+  // Deadline for connecting to each Secondary and for each message of the
+  // handshake. 0 leaves it to the system.
+  const int secondaries_connect_timeout_s;
   std::vector<IPSecondaryConfig> secondaries_cfg;
 };
 
@@ -256,6 +256,9 @@ void AktualizrSecondary::registerHandlers() {
   registerHandler(AKIpUptaneMes_PR_putRootReq,
                   std::bind(&AktualizrSecondary::putRootHdlr, this, std::placeholders::_1, std::placeholders::_2));
 
+  registerHandler(AKIpUptaneMes_PR_putRootChainReq, std::bind(&AktualizrSecondary::putRootChainHdlr, this,
+                                                              std::placeholders::_1, std::placeholders::_2));
+
   registerHandler(AKIpUptaneMes_PR_putMetaReq2,
                   std::bind(&AktualizrSecondary::putMetaHdlr, this, std::placeholders::_1, std::placeholders::_2));
 
@@ -341,19 +344,16 @@ AktualizrSecondary::ReturnCode AktualizrSecondary::getRootVerHdlr(Asn1Message& i
   return ReturnCode::kOk;
 }
 
-AktualizrSecondary::ReturnCode AktualizrSecondary::putRootHdlr(Asn1Message& in_msg, Asn1Message& out_msg) {
-  LOG_INFO << "Received a put Root request message; verifying contents...";
-  auto pr = in_msg.putRootReq();
+data::InstallationResult AktualizrSecondary::putRoot(const AKRepoType_t repotype, const std::string& json) {
   Uptane::RepositoryType repo_type{};
-  if (pr->repotype == AKRepoType_director) {
+  if (repotype == AKRepoType_director) {
     repo_type = Uptane::RepositoryType::Director();
-  } else if (pr->repotype == AKRepoType_image) {
+  } else if (repotype == AKRepoType_image) {
     repo_type = Uptane::RepositoryType::Image();
   } else {
     repo_type = Uptane::RepositoryType(-1);
   }
 
-  const std::string json = ToString(pr->json);
   LOG_DEBUG << "Received " << repo_type << " repo Root metadata:\n" << json;
   data::InstallationResult result(data::ResultCode::Numeric::kOk, "");
 
@@ -385,11 +385,18 @@ AktualizrSecondary::ReturnCode AktualizrSecondary::putRootHdlr(Asn1Message& in_m
                                         std::string("Failed to update Image repo Root metadata: ") + e.what());
     }
   } else {
-    LOG_WARNING << "Received Root version request with invalid repo type: " << pr->repotype;
+    LOG_WARNING << "Received Root version request with invalid repo type: " << repotype;
     result = data::InstallationResult(
         data::ResultCode::Numeric::kInternalError,
-        "Received Root version request with invalid repo type: " + std::to_string(pr->repotype));
+        "Received Root version request with invalid repo type: " + std::to_string(repotype));
   }
+  return result;
+}
+
+AktualizrSecondary::ReturnCode AktualizrSecondary::putRootHdlr(Asn1Message& in_msg, Asn1Message& out_msg) {
+  LOG_INFO << "Received a put Root request message; verifying contents...";
+  auto pr = in_msg.putRootReq();
+  const data::InstallationResult result = putRoot(pr->repotype, ToString(pr->json));
 
   auto m = out_msg.present(AKIpUptaneMes_PR_putRootResp).putRootResp();
   m->result = static_cast<AKInstallationResultCode_t>(result.result_code.num_code);
@@ -398,6 +405,29 @@ AktualizrSecondary::ReturnCode AktualizrSecondary::putRootHdlr(Asn1Message& in_m
   return ReturnCode::kOk;
 }
 
+AktualizrSecondary::ReturnCode AktualizrSecondary::putRootChainHdlr(Asn1Message& in_msg, Asn1Message& out_msg) {
+  auto pr = in_msg.putRootChainReq();
+  const int chain_length = pr->chain.list.count;
+  LOG_INFO << "Received a put Root chain request message with " << chain_length << " Root metadata versions";
+
+  data::InstallationResult result(data::ResultCode::Numeric::kOk, "");
+  int applied = 0;
+  for (; applied < chain_length; applied++) {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    result = putRoot(pr->repotype, ToString(*pr->chain.list.array[applied]));
+    if (!result.isSuccess()) {
+      break;
+    }
+  }
+
+  auto m = out_msg.present(AKIpUptaneMes_PR_putRootChainResp).putRootChainResp();
+  m->result = static_cast<AKInstallationResultCode_t>(result.result_code.num_code);
+  SetString(&m->description, result.description);
+  m->applied = applied;
+
+  return ReturnCode::kOk;
+}
+
 void AktualizrSecondary::copyMetadata(Uptane::MetaBundle& meta_bundle, const Uptane::RepositoryType repo,
                                       const Uptane::Role& role, std::string& json) {
   auto key = std::make_pair(repo, role);
@@ -51,6 +51,7 @@ class AktualizrSecondary : public MsgDispatcher {
   static void copyMetadata(Uptane::MetaBundle& meta_bundle, Uptane::RepositoryType repo, const Uptane::Role& role,
                            std::string& json);
   data::InstallationResult verifyMetadata(const Uptane::SecondaryMetadata& metadata);
+  data::InstallationResult putRoot(AKRepoType_t repotype, const std::string& json);
   data::InstallationResult findTargets();
   void uptaneInitialize();
   void registerHandlers();
@@ -61,6 +62,7 @@ class AktualizrSecondary : public MsgDispatcher {
   ReturnCode getManifestHdlr(Asn1Message& in_msg, Asn1Message& out_msg) const;
   ReturnCode getRootVerHdlr(Asn1Message& in_msg, Asn1Message& out_msg) const;
   ReturnCode putRootHdlr(Asn1Message& in_msg, Asn1Message& out_msg);
+  ReturnCode putRootChainHdlr(Asn1Message& in_msg, Asn1Message& out_msg);
   ReturnCode putMetaHdlr(Asn1Message& in_msg, Asn1Message& out_msg);
   ReturnCode installHdlr(Asn1Message& in_msg, Asn1Message& out_msg);
 
@@ -31,6 +31,7 @@ void AktualizrSecondaryUptaneConfig::updateFromPropertyTree(const boost::propert
   CopyFromConfig(key_source, "key_source", pt);
   CopyFromConfig(key_type, "key_type", pt);
   CopyFromConfig(force_install_completion, "force_install_completion", pt);
+  CopyFromConfig(memory_soft_limit_mb, "memory_soft_limit_mb", pt);
   CopyFromConfig(verification_type, "verification_type", pt);
 }
 
@@ -40,6 +41,7 @@ void AktualizrSecondaryUptaneConfig::writeToStream(std::ostream& out_stream) con
   writeOption(out_stream, key_source, "key_source");
   writeOption(out_stream, key_type, "key_type");
   writeOption(out_stream, force_install_completion, "force_install_completion");
+  writeOption(out_stream, memory_soft_limit_mb, "memory_soft_limit_mb");
   writeOption(out_stream, verification_type, "verification_type");
 }
 
@@ -75,6 +77,7 @@ KeyManagerConfig AktualizrSecondaryConfig::keymanagerConfig() const {
 
 void AktualizrSecondaryConfig::postUpdateValues() {
   logger_set_threshold(logger);
+  logger_set_async(logger.async);
   LOG_TRACE << "Final configuration that will be used: \n" << (*this);
 }
 
@@ -31,6 +31,8 @@ struct AktualizrSecondaryUptaneConfig {
   KeyType key_type{KeyType::kRSA2048};
   bool force_install_completion{false};
   VerificationType verification_type{VerificationType::kFull};
+  // 0 means no limit
+  uint64_t memory_soft_limit_mb{0U};
 
   void updateFromPropertyTree(const boost::property_tree::ptree& pt);
   void writeToStream(std::ostream& out_stream) const;
@@ -14,6 +14,8 @@ AktualizrSecondaryFile::AktualizrSecondaryFile(const AktualizrSecondaryConfig& c
     : AktualizrSecondary(config, std::move(storage)), update_agent_{std::move(update_agent)} {
   registerHandler(AKIpUptaneMes_PR_uploadDataReq, std::bind(&AktualizrSecondaryFile::uploadDataHdlr, this,
                                                             std::placeholders::_1, std::placeholders::_2));
+  registerHandler(AKIpUptaneMes_PR_uploadDeltaReq, std::bind(&AktualizrSecondaryFile::uploadDeltaHdlr, this,
+                                                             std::placeholders::_1, std::placeholders::_2));
   if (!update_agent_) {
     std::string current_target_name;
 
@@ -34,6 +36,13 @@ AktualizrSecondaryFile::AktualizrSecondaryFile(const AktualizrSecondaryConfig& c
 
 void AktualizrSecondaryFile::initialize() { initPendingTargetIfAny(); }
 
+data::InstallationResult AktualizrSecondaryFile::putMetadata(const Uptane::SecondaryMetadata& metadata) {
+  // New metadata starts a new update, so an upload left over from the previous
+  // one, including an announced delta, is of no use anymore.
+  update_agent_->discardUpload();
+  return AktualizrSecondary::putMetadata(metadata);
+}
+
 data::InstallationResult AktualizrSecondaryFile::receiveData(const uint8_t* data, size_t size) {
   if (!getPendingTarget().IsValid()) {
     LOG_ERROR << "Aborting image download; no valid target found.";
@@ -44,6 +53,16 @@ data::InstallationResult AktualizrSecondaryFile::receiveData(const uint8_t* data
   return update_agent_->receiveData(getPendingTarget(), data, size);
 }
 
+data::InstallationResult AktualizrSecondaryFile::receiveDelta(const std::string& from_hash) {
+  if (!getPendingTarget().IsValid()) {
+    LOG_ERROR << "Declining a delta; no valid target found.";
+    return data::InstallationResult(data::ResultCode::Numeric::kGeneralError,
+                                    "Declining a delta; no valid target found.");
+  }
+
+  return update_agent_->receiveDelta(getPendingTarget(), from_hash);
+}
+
 bool AktualizrSecondaryFile::isTargetSupported(const Uptane::Target& target) const {
   return update_agent_->isTargetSupported(target);
 }
@@ -83,3 +102,16 @@ MsgHandler::ReturnCode AktualizrSecondaryFile::uploadDataHdlr(Asn1Message& in_ms
 
   return ReturnCode::kOk;
 }
+
+MsgHandler::ReturnCode AktualizrSecondaryFile::uploadDeltaHdlr(Asn1Message& in_msg, Asn1Message& out_msg) {
+  auto result = receiveDelta(ToString(in_msg.uploadDeltaReq()->fromHash));
+  if (!result.isSuccess()) {
+    LOG_INFO << "Declined a delta, expecting the full image instead: " << result.description;
+  }
+
+  auto m = out_msg.present(AKIpUptaneMes_PR_uploadDeltaResp).uploadDeltaResp();
+  m->result = static_cast<AKInstallationResultCode_t>(result.result_code.num_code);
+  SetString(&m->description, result.description);
+
+  return ReturnCode::kOk;
+}
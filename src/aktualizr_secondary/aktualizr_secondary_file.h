@@ -16,7 +16,10 @@ class AktualizrSecondaryFile : public AktualizrSecondary {
                          std::shared_ptr<FileUpdateAgent> update_agent = nullptr);
 
   void initialize() override;
+  using AktualizrSecondary::putMetadata;
+  data::InstallationResult putMetadata(const Uptane::SecondaryMetadata& metadata) override;
   data::InstallationResult receiveData(const uint8_t* data, size_t size);
+  data::InstallationResult receiveDelta(const std::string& from_hash);
 
  protected:
   bool getInstalledImageInfo(Uptane::InstalledImageInfo& installed_image_info) const override;
@@ -26,6 +29,7 @@ class AktualizrSecondaryFile : public AktualizrSecondary {
   void completeInstall() override;
 
   ReturnCode uploadDataHdlr(Asn1Message& in_msg, Asn1Message& out_msg);
+  ReturnCode uploadDeltaHdlr(Asn1Message& in_msg, Asn1Message& out_msg);
 
  private:
   std::shared_ptr<FileUpdateAgent> update_agent_;
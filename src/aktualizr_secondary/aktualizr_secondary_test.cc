@@ -9,6 +9,7 @@
 #include "aktualizr_secondary_file.h"
 #include "crypto/keymanager.h"
 #include "libaktualizr/types.h"
+#include "package_manager/deltapatch.h"
 #include "storage/invstorage.h"
 #include "update_agent_file.h"
 #include "uptane_repo.h"
@@ -128,6 +129,39 @@ class UptaneRepoWrapper {
                                 custom);
   }
 
+  /* Add an image that differs slightly from an existing one as the only
+   * Target, along with an uncompressed bsdiff patch between the two. */
+  Uptane::SecondaryMetadata addDeltaImageFile(const std::string& targetname, const std::string& base_targetname,
+                                              const std::string& hardware_id, const std::string& serial) {
+    const std::string base = Utils::readFile(root_dir_ / base_targetname);
+    std::string image = base;
+    image[0] = static_cast<char>(image[0] + 1);
+    image += "-patched";
+    Utils::writeFile(root_dir_ / targetname, image);
+
+    std::string diff(base.size(), '\0');
+    for (size_t i = 0; i < base.size(); ++i) {
+      diff[i] = static_cast<char>(static_cast<uint8_t>(image[i]) - static_cast<uint8_t>(base[i]));
+    }
+    const std::string patch = std::string(DeltaPatch::kMagic) + offtout(image.size()) + offtout(base.size()) +
+                              offtout(image.size() - base.size()) + offtout(0) + diff + image.substr(base.size());
+    Utils::writeFile(root_dir_ / (targetname + ".delta"), patch);
+
+    Json::Value delta;
+    delta["from"]["sha256"] = Crypto::sha256digestHex(base);
+    delta["hashes"]["sha256"] = Crypto::sha256digestHex(patch);
+    delta["length"] = Json::UInt64(patch.size());
+    delta["uri"] = "https://example.com/" + targetname + ".delta";
+    Json::Value custom;
+    custom["delta"].append(delta);
+
+    uptane_repo_.addImage(root_dir_ / targetname, targetname, hardware_id, "", 0, Delegation(), custom);
+    uptane_repo_.emptyTargets();
+    uptane_repo_.addTarget(targetname, hardware_id, serial);
+    uptane_repo_.signTargets();
+    return Uptane::SecondaryMetadata(getCurrentMetadata());
+  }
+
   Uptane::MetaBundle getCurrentMetadata() const {
     Uptane::MetaBundle meta_bundle;
     std::string metadata;
@@ -156,6 +190,15 @@ class UptaneRepoWrapper {
   void refreshRoot(Uptane::RepositoryType repo) { uptane_repo_.refresh(repo, Uptane::Role::Root()); }
 
  private:
+  static std::string offtout(size_t x) {
+    std::string buf(8, '\0');
+    for (size_t i = 0; i < 8; ++i) {
+      buf[i] = static_cast<char>(x & 0xFF);
+      x >>= 8;
+    }
+    return buf;
+  }
+
   static void generateRandomFile(const boost::filesystem::path& filepath, size_t size) {
     std::ofstream file{filepath.string(), std::ofstream::binary};
 
@@ -458,6 +501,51 @@ TEST_F(SecondaryTest, InvalidImageData) {
   EXPECT_FALSE(secondary_->install().isSuccess());
 }
 
+/* A delta against the installed image is reconstructed into the new image. */
+TEST_F(SecondaryTest, DeltaUpdate) {
+  ASSERT_TRUE(secondary_->putMetadata(uptane_repo_.getCurrentMetadata()).isSuccess());
+  ASSERT_EQ(sendImageFile(), data::ResultCode::Numeric::kOk);
+  ASSERT_TRUE(secondary_->install().isSuccess());
+  const Hash installed_hash =
+      Hash::generate(Hash::Type::kSha256, Utils::readFile(uptane_repo_.getTargetImagePath(default_target_)));
+
+  const std::string delta_target{"delta-target"};
+  auto metadata = uptane_repo_.addDeltaImageFile(delta_target, default_target_, secondary_->hwID().ToString(),
+                                                 secondary_->serial().ToString());
+  ASSERT_TRUE(secondary_->putMetadata(metadata).isSuccess());
+
+  // Only deltas against the installed image are accepted.
+  EXPECT_FALSE(secondary_->receiveDelta(std::string(64, 'A')).isSuccess());
+  ASSERT_TRUE(secondary_->receiveDelta(installed_hash.HashString()).isSuccess());
+  ASSERT_EQ(sendImageFile(delta_target + ".delta"), data::ResultCode::Numeric::kOk);
+  ASSERT_TRUE(secondary_->install().isSuccess());
+
+  verifyTargetAndManifest();
+}
+
+/* A delta upload that is abandoned doesn't get in the way of the full image. */
+TEST_F(SecondaryTest, AbandonedDeltaUpdate) {
+  ASSERT_TRUE(secondary_->putMetadata(uptane_repo_.getCurrentMetadata()).isSuccess());
+  ASSERT_EQ(sendImageFile(), data::ResultCode::Numeric::kOk);
+  ASSERT_TRUE(secondary_->install().isSuccess());
+  const Hash installed_hash =
+      Hash::generate(Hash::Type::kSha256, Utils::readFile(uptane_repo_.getTargetImagePath(default_target_)));
+
+  const std::string delta_target{"delta-target"};
+  auto metadata = uptane_repo_.addDeltaImageFile(delta_target, default_target_, secondary_->hwID().ToString(),
+                                                 secondary_->serial().ToString());
+  ASSERT_TRUE(secondary_->putMetadata(metadata).isSuccess());
+  ASSERT_TRUE(secondary_->receiveDelta(installed_hash.HashString()).isSuccess());
+  const uint8_t part[16]{};
+  ASSERT_TRUE(secondary_->receiveData(part, sizeof(part)).isSuccess());
+
+  ASSERT_TRUE(secondary_->putMetadata(metadata).isSuccess());
+  ASSERT_EQ(sendImageFile(delta_target), data::ResultCode::Numeric::kOk);
+  ASSERT_TRUE(secondary_->install().isSuccess());
+
+  verifyTargetAndManifest();
+}
+
 class SecondaryTestTuf
     : public SecondaryTest,
       public ::testing::WithParamInterface<std::pair<std::vector<std::string>, boost::optional<std::string>>> {
@@ -50,6 +50,7 @@ class SecondaryMock : public MsgDispatcher {
   const PublicKey& publicKey() const { return pub_key_; }
   const Uptane::Manifest& manifest() const { return manifest_; }
   const Uptane::MetaBundle& metadata() const { return meta_bundle_; }
+  const std::vector<std::string>& rootChain() const { return root_chain_; }
   HandlerVersion handlerVersion() const { return handler_version_; }
   void setHandlerVersion(HandlerVersion handler_version_in) { handler_version_ = handler_version_in; }
   void registerHandlers() {
@@ -109,6 +110,8 @@ class SecondaryMock : public MsgDispatcher {
                     std::bind(&SecondaryMock::rootVerHdlr, this, std::placeholders::_1, std::placeholders::_2));
     registerHandler(AKIpUptaneMes_PR_putRootReq,
                     std::bind(&SecondaryMock::putRootHdlr, this, std::placeholders::_1, std::placeholders::_2));
+    registerHandler(AKIpUptaneMes_PR_putRootChainReq,
+                    std::bind(&SecondaryMock::putRootChainHdlr, this, std::placeholders::_1, std::placeholders::_2));
   }
 
   // Procotol v2 handlers that fail in predictable ways.
@@ -381,6 +384,21 @@ class SecondaryMock : public MsgDispatcher {
     return ReturnCode::kOk;
   }
 
+  MsgHandler::ReturnCode putRootChainHdlr(Asn1Message& in_msg, Asn1Message& out_msg) {
+    auto pr = in_msg.putRootChainReq();
+    root_chain_.clear();
+    for (int i = 0; i < pr->chain.list.count; i++) {
+      root_chain_.push_back(ToString(*pr->chain.list.array[i]));  // NOLINT
+    }
+
+    auto m = out_msg.present(AKIpUptaneMes_PR_putRootChainResp).putRootChainResp();
+    m->result = static_cast<AKInstallationResultCode_t>(data::ResultCode::Numeric::kOk);
+    SetString(&m->description, "");
+    m->applied = pr->chain.list.count;
+
+    return ReturnCode::kOk;
+  }
+
   MsgHandler::ReturnCode putRootFailureHdlr(Asn1Message& in_msg, Asn1Message& out_msg) {
     (void)in_msg;
 
@@ -427,6 +445,7 @@ class SecondaryMock : public MsgDispatcher {
   const Uptane::Manifest manifest_;
 
   Uptane::MetaBundle meta_bundle_;
+  std::vector<std::string> root_chain_;
 
   TemporaryDirectory image_dir_;
   boost::filesystem::path image_filepath_;
@@ -689,6 +708,16 @@ class SecondaryRpcCommon : public ::testing::Test {
       EXPECT_TRUE(iresult.isSuccess());
       verifyMetadata(secondary_.metadata());
     }
+
+    const std::vector<std::string> image_roots{image_root_v2_, "image-root-v3"};
+    iresult = ip_secondary_->putRootChain(image_roots, false);
+    if (handler_version == HandlerVersion::kV1 || handler_version == HandlerVersion::kV2Failure) {
+      EXPECT_EQ(iresult.result_code, data::ResultCode::Numeric::kVerificationFailed);
+      EXPECT_EQ(iresult.description, secondary_.verification_failure);
+    } else {
+      EXPECT_TRUE(iresult.isSuccess());
+      EXPECT_EQ(secondary_.rootChain(), image_roots);
+    }
   }
 
   SecondaryMock secondary_;
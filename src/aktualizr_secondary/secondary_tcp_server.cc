@@ -10,11 +10,12 @@
 #include "utilities/dequeue_buffer.h"
 
 SecondaryTcpServer::SecondaryTcpServer(MsgHandler &msg_handler, const std::string &primary_ip, in_port_t primary_port,
-                                       in_port_t port, bool reboot_after_install)
+                                       in_port_t port, bool reboot_after_install, uint64_t memory_soft_limit)
     : msg_handler_(msg_handler),
       listen_socket_(port),
       keep_running_(true),
       reboot_after_install_(reboot_after_install),
+      memory_monitor_(memory_soft_limit),
       is_running_(false) {
   if (primary_ip.empty()) {
     return;
@@ -101,6 +102,10 @@ bool SecondaryTcpServer::HandleOneConnection(int socket) {
   // moment. This shouldn't be a problem until we have messages that aren't
   // strictly request/response
   DequeueBuffer buffer;
+  // A single message may take up a quarter of the soft memory limit at most.
+  // Images are uploaded in small parts, so only a broken or hostile Primary
+  // hits this.
+  const uint64_t max_message_size = memory_monitor_.enabled() ? memory_monitor_.softLimit() / 4 : 0;
   bool keep_running_server = true;
   bool keep_running_current_session = true;
 
@@ -110,6 +115,7 @@ bool SecondaryTcpServer::HandleOneConnection(int socket) {
     asn_dec_rval_t res{};
     asn_codec_ctx_s context{};
     ssize_t received;
+    uint64_t message_size = buffer.Size();
 
     do {
       received = recv(socket, buffer.Tail(), buffer.TailSpace(), 0);
@@ -117,10 +123,11 @@ bool SecondaryTcpServer::HandleOneConnection(int socket) {
         LOG_ERROR << "Failed to read data from a server socket: " << strerror(errno);
         break;
       }
+      message_size += static_cast<uint64_t>(received);
       buffer.HaveEnqueued(static_cast<size_t>(received));
       res = ber_decode(&context, &asn_DEF_AKIpUptaneMes, reinterpret_cast<void **>(&m), buffer.Head(), buffer.Size());
       buffer.Consume(res.consumed);
-    } while (res.code == RC_WMORE && received > 0);
+    } while (res.code == RC_WMORE && received > 0 && (max_message_size == 0 || message_size <= max_message_size));
     // Note that ber_decode allocates *m even on failure, so this must always be done
     Asn1Message::Ptr request_msg = Asn1Message::FromRaw(&m);
 
@@ -134,6 +141,11 @@ bool SecondaryTcpServer::HandleOneConnection(int socket) {
       break;
     }
 
+    if (res.code == RC_WMORE) {
+      LOG_ERROR << "Message received from Primary exceeds the soft memory limit, closing the connection";
+      break;
+    }
+
     if (res.code != RC_OK) {
       LOG_ERROR << "Failed to decode a message received from Primary";
       break;
@@ -164,6 +176,14 @@ bool SecondaryTcpServer::HandleOneConnection(int socket) {
       }
     }  // switch
 
+    if (memory_monitor_.enabled()) {
+      auto watermark = memory_monitor_.check();
+      if (watermark) {
+        LOG_WARNING << "Resident memory has reached " << *watermark << "% of the soft limit of "
+                    << memory_monitor_.softLimit() << " bytes";
+      }
+    }
+
   }  // Go back round and read another message
 
   return keep_running_server;
@@ -5,6 +5,7 @@
 #include <condition_variable>
 #include <mutex>
 
+#include "utilities/memory_monitor.h"
 #include "utilities/utils.h"
 
 class MsgHandler;
@@ -22,7 +23,7 @@ class SecondaryTcpServer {
   };
 
   SecondaryTcpServer(MsgHandler& msg_handler, const std::string& primary_ip, in_port_t primary_port, in_port_t port = 0,
-                     bool reboot_after_install = false);
+                     bool reboot_after_install = false, uint64_t memory_soft_limit = 0);
   ~SecondaryTcpServer() = default;
   SecondaryTcpServer(const SecondaryTcpServer&) = delete;
   SecondaryTcpServer(SecondaryTcpServer&&) = delete;
@@ -48,6 +49,7 @@ class SecondaryTcpServer {
   std::atomic<bool> keep_running_;
   bool reboot_after_install_;
   ExitReason exit_reason_{ExitReason::kNotApplicable};
+  MemoryMonitor memory_monitor_;
 
   bool is_running_;
   std::mutex running_condition_mutex_;
@@ -1,7 +1,10 @@
 #include "update_agent_file.h"
 
+#include <boost/algorithm/string/case_conv.hpp>
 #include <boost/filesystem.hpp>
 
+#include <algorithm>
+#include <array>
 #include <fstream>
 #include "crypto/crypto.h"
 #include "logging/logging.h"
@@ -13,11 +16,19 @@ bool FileUpdateAgent::isTargetSupported(const Uptane::Target& target) const { re
 
 bool FileUpdateAgent::getInstalledImageInfo(Uptane::InstalledImageInfo& installed_image_info) const {
   if (boost::filesystem::exists(target_filepath_)) {
-    auto file_content = Utils::readFile(target_filepath_);
+    // Hash the image in parts rather than reading it into memory as a whole.
+    std::ifstream file(target_filepath_.string(), std::ios::binary);
+    MultiPartSHA256Hasher hasher;
+    std::array<uint8_t, 64 * 1024> buf{};
+    do {
+      file.read(reinterpret_cast<char*>(buf.data()), buf.size());
+      hasher.update(buf.data(), static_cast<uint64_t>(file.gcount()));
+    } while (file.gcount() != 0);
 
     installed_image_info.name = current_target_name_;
-    installed_image_info.len = file_content.size();
-    installed_image_info.hash = Uptane::ManifestIssuer::generateVersionHashStr(file_content);
+    installed_image_info.len = boost::filesystem::file_size(target_filepath_);
+    // think of unifying a hash case, see ManifestIssuer::generateVersionHashStr()
+    installed_image_info.hash = boost::algorithm::to_lower_copy(hasher.getHexDigest());
   } else {
     // mimic the Primary's fake package manager behavior
     auto unknown_target = Uptane::Target::Unknown();
@@ -36,6 +47,13 @@ data::InstallationResult FileUpdateAgent::install(const Uptane::Target& target)
                                     "The target image has not been received");
   }
 
+  if (!!pending_delta_) {
+    auto delta_result = applyDelta(target);
+    if (!delta_result.isSuccess()) {
+      return delta_result;
+    }
+  }
+
   auto received_target_image_size = boost::filesystem::file_size(new_target_filepath_);
   if (received_target_image_size != target.length()) {
     LOG_ERROR << "Received image size does not match the size specified in Target metadata: "
@@ -81,6 +99,88 @@ data::InstallationResult FileUpdateAgent::applyPendingInstall(const Uptane::Targ
                                   "Applying pending updates is not supported by the file update agent");
 }
 
+/* Prepare to receive a delta against the installed image instead of the full
+ * image. Only deltas listed in the Target metadata are accepted. */
+data::InstallationResult FileUpdateAgent::receiveDelta(const Uptane::Target& target, const std::string& from_hash) {
+  // Whatever was received before is superseded by the upload that follows.
+  discardUpload();
+
+  const auto deltas = DeltaTarget::fromTarget(target);
+  auto delta = std::find_if(deltas.cbegin(), deltas.cend(),
+                            [&from_hash](const DeltaTarget& d) { return d.from().HashString() == from_hash; });
+  if (delta == deltas.cend()) {
+    return data::InstallationResult(data::ResultCode::Numeric::kGeneralError,
+                                    "No delta from " + from_hash + " is listed for the target " + target.filename());
+  }
+  if (!boost::filesystem::exists(target_filepath_)) {
+    return data::InstallationResult(data::ResultCode::Numeric::kGeneralError,
+                                    "No image is installed to apply a delta to");
+  }
+
+  auto hasher = MultiPartHasher::create(delta->from().type());
+  std::ifstream installed(target_filepath_.c_str(), std::ios::binary);
+  std::array<uint8_t, 4096> buf{};
+  do {
+    installed.read(reinterpret_cast<char*>(buf.data()), buf.size());
+    hasher->update(buf.data(), static_cast<uint64_t>(installed.gcount()));
+  } while (installed.gcount() != 0);
+  if (hasher->getHash() != delta->from()) {
+    return data::InstallationResult(data::ResultCode::Numeric::kGeneralError,
+                                    "The installed image does not match the base of the delta");
+  }
+
+  LOG_INFO << "Ready to receive a delta of " << delta->length() << " bytes for the target " << target.filename();
+  pending_delta_ = *delta;
+  delta_announced_ = true;
+  return data::InstallationResult(data::ResultCode::Numeric::kOk, "");
+}
+
+void FileUpdateAgent::discardUpload() {
+  pending_delta_ = boost::none;
+  delta_announced_ = false;
+  new_target_hasher_.reset();
+  boost::filesystem::remove(new_target_filepath_);
+}
+
+/* Replace the received delta with the image it reconstructs from the
+ * installed one, so that the usual checks of the new image follow. */
+data::InstallationResult FileUpdateAgent::applyDelta(const Uptane::Target& target) {
+  const DeltaTarget delta = *pending_delta_;
+  pending_delta_ = boost::none;
+
+  auto received_delta_size = boost::filesystem::file_size(new_target_filepath_);
+  if (received_delta_size != delta.length() || new_target_hasher_ == nullptr ||
+      !delta.MatchHash(new_target_hasher_->getHash())) {
+    LOG_ERROR << "The received delta does not match the delta specified in Target metadata";
+    boost::filesystem::remove(new_target_filepath_);
+    return data::InstallationResult(data::ResultCode::Numeric::kDownloadFailed,
+                                    "The received delta does not match the delta specified in Target metadata");
+  }
+
+  boost::filesystem::rename(new_target_filepath_, delta_filepath_);
+  try {
+    std::ofstream new_target_file(new_target_filepath_.c_str(), std::ios::binary | std::ios::trunc);
+    new_target_hasher_ = MultiPartHasher::create(getTargetHash(target).type());
+    DeltaPatch::apply(target_filepath_, delta_filepath_, [this, &new_target_file](const uint8_t* data, size_t size) {
+      new_target_file.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+      new_target_hasher_->update(data, size);
+    });
+    new_target_file.close();
+    if (new_target_file.fail()) {
+      throw std::runtime_error("Failed to write the new target image");
+    }
+  } catch (const std::exception& e) {
+    LOG_ERROR << "Failed to apply the delta: " << e.what();
+    boost::filesystem::remove(new_target_filepath_);
+    boost::filesystem::remove(delta_filepath_);
+    return data::InstallationResult(data::ResultCode::Numeric::kInstallFailed,
+                                    std::string("Failed to apply the delta: ") + e.what());
+  }
+  boost::filesystem::remove(delta_filepath_);
+  LOG_INFO << "Reconstructed the target image from a delta of " << delta.length() << " bytes";
+  return data::InstallationResult(data::ResultCode::Numeric::kOk, "");
+}
+
 data::InstallationResult FileUpdateAgent::receiveData(const Uptane::Target& target, const uint8_t* data, size_t size) {
   std::ofstream target_file(new_target_filepath_.c_str(),
                             std::ofstream::out | std::ofstream::binary | std::ofstream::app);
@@ -99,18 +199,29 @@ data::InstallationResult FileUpdateAgent::receiveData(const Uptane::Target& targ
                                     "Failed to obtain a size of the new target image that is being uploaded");
   }
 
-  if (static_cast<uint64_t>(current_new_image_size) >= target.length()) {
+  if (current_new_image_size == 0) {
+    // A delta that was announced for an earlier upload doesn't apply to this one.
+    if (!delta_announced_) {
+      pending_delta_ = boost::none;
+    }
+    delta_announced_ = false;
+  }
+
+  // A delta announced beforehand replaces the full image.
+  const uint64_t expected_size = !!pending_delta_ ? pending_delta_->length() : target.length();
+  if (static_cast<uint64_t>(current_new_image_size) >= expected_size) {
     LOG_ERROR << "The size of the received image data exceeds the expected Target image size: "
-              << current_new_image_size << " != " << target.length();
+              << current_new_image_size << " != " << expected_size;
     target_file.close();
     return data::InstallationResult(data::ResultCode::Numeric::kDownloadFailed,
                                     "The size of the received image data exceeds the expected Target image size: " +
                                         std::to_string(current_new_image_size) +
-                                        " != " + std::to_string(target.length()));
+                                        " != " + std::to_string(expected_size));
   }
 
   if (current_new_image_size == 0) {
-    new_target_hasher_ = MultiPartHasher::create(getTargetHash(target).type());
+    new_target_hasher_ = MultiPartHasher::create(!!pending_delta_ ? pending_delta_->hashes()[0].type()
+                                                                  : getTargetHash(target).type());
   }
 
   target_file.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
@@ -128,10 +239,12 @@ data::InstallationResult FileUpdateAgent::receiveData(const Uptane::Target& targ
   target_file.close();
 
   auto total_size = current_new_image_size + written_data_size;
-  LOG_DEBUG << "Received and stored data of a new target image."
-               " Received in this request (bytes): "
-            << size << "; total received so far: " << total_size << "; expected total: " << target.length();
-  if (static_cast<uint64_t>(total_size) == target.length()) {
+  // Once per chunk, so keep it from flooding the log of big images.
+  LOG_RATE_LIMITED(debug, std::chrono::seconds(1)) << "Received and stored data of a new target image."
+                                                      " Received in this request (bytes): "
+                                                   << size << "; total received so far: " << total_size
+                                                   << "; expected total: " << expected_size;
+  if (static_cast<uint64_t>(total_size) == expected_size) {
     LOG_INFO << "Successfully received and stored new target image of " << total_size << " bytes.";
   }
 
@@ -1,6 +1,9 @@
 #ifndef AKTUALIZR_SECONDARY_UPDATE_AGENT_FILE_H
 #define AKTUALIZR_SECONDARY_UPDATE_AGENT_FILE_H
 
+#include <boost/optional.hpp>
+
+#include "package_manager/deltapatch.h"
 #include "update_agent.h"
 
 class FileUpdateAgent : public UpdateAgent {
@@ -8,24 +11,35 @@ class FileUpdateAgent : public UpdateAgent {
   FileUpdateAgent(boost::filesystem::path target_filepath, std::string target_name)
       : target_filepath_{std::move(target_filepath)},
         new_target_filepath_{target_filepath_.string() + ".newtarget"},
+        delta_filepath_{target_filepath_.string() + ".delta"},
         current_target_name_{std::move(target_name)} {}
 
   bool isTargetSupported(const Uptane::Target& target) const override;
   bool getInstalledImageInfo(Uptane::InstalledImageInfo& installed_image_info) const override;
 
   virtual data::InstallationResult receiveData(const Uptane::Target& target, const uint8_t* data, size_t size);
+  virtual data::InstallationResult receiveDelta(const Uptane::Target& target, const std::string& from_hash);
   data::InstallationResult install(const Uptane::Target& target) override;
+  // Drop whatever has been received for the previous pending Target.
+  void discardUpload();
 
   void completeInstall() override;
   data::InstallationResult applyPendingInstall(const Uptane::Target& target) override;
 
  private:
   static Hash getTargetHash(const Uptane::Target& target);
+  data::InstallationResult applyDelta(const Uptane::Target& target);
 
   const boost::filesystem::path target_filepath_;
   const boost::filesystem::path new_target_filepath_;
+  const boost::filesystem::path delta_filepath_;
   std::string current_target_name_;
   std::shared_ptr<MultiPartHasher> new_target_hasher_;
+  // Set while the data being received is a delta rather than the full image.
+  boost::optional<DeltaTarget> pending_delta_;
+  // Set from receiveDelta() until the delta upload starts. An upload that
+  // starts without it is a full image.
+  bool delta_announced_{false};
 };
 
 #endif  // AKTUALIZR_SECONDARY_UPDATE_AGENT_FILE_H
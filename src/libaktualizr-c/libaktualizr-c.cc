@@ -203,8 +203,7 @@ StorageTargetHandle *Aktualizr_open_stored_target(Aktualizr *a, const Target *t)
   }
 
   try {
-    auto *stream = new auto(a->OpenStoredTarget(*t));
-    return stream;
+    return a->OpenStoredTarget(*t).release();
   } catch (const std::exception &e) {
     std::cerr << "Aktualizr_open_stored_target exception: " << e.what() << std::endl;
     return nullptr;
@@ -224,7 +223,6 @@ size_t Aktualizr_read_stored_target(StorageTargetHandle *handle, uint8_t *buf, s
 
 int Aktualizr_close_stored_target(StorageTargetHandle *handle) {
   if (handle != nullptr) {
-    handle->close();
     delete handle;
     return 0;
   } else {
@@ -3,9 +3,13 @@
 #include <sys/socket.h>
 #include <sys/types.h>
 
+#include <cstdlib>
+#include <limits>
+
 #include "asn1_message.h"
 #include "logging/logging.h"
 #include "utilities/dequeue_buffer.h"
+#include "utilities/tracing.h"
 #include "utilities/utils.h"
 
 #ifndef MSG_NOSIGNAL
@@ -52,7 +56,30 @@ void SetString(OCTET_STRING_t* dest, const std::string& str) {
   OCTET_STRING_fromBuf(dest, str.c_str(), static_cast<int>(str.size()));
 }
 
+bool SetStringFromStream(OCTET_STRING_t* dest, std::istream& stream, uint64_t size) {
+  if (size > static_cast<uint64_t>(std::numeric_limits<int>::max())) {
+    return false;
+  }
+  OCTET_STRING_fromBuf(dest, nullptr, 0);
+  // Allocated the same way as by OCTET_STRING_fromBuf(), so that the encoder can free it.
+  // NOLINTNEXTLINE(cppcoreguidelines-no-malloc, hicpp-no-malloc)
+  auto* buf = static_cast<uint8_t*>(malloc(size + 1));
+  if (buf == nullptr) {
+    return false;
+  }
+  stream.read(reinterpret_cast<char*>(buf), static_cast<std::streamsize>(size));
+  if (static_cast<uint64_t>(stream.gcount()) != size) {
+    free(buf);  // NOLINT(cppcoreguidelines-no-malloc, hicpp-no-malloc)
+    return false;
+  }
+  buf[size] = 0;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  dest->buf = buf;
+  dest->size = static_cast<int>(size);
+  return true;
+}
+
 Asn1Message::Ptr Asn1Rpc(const Asn1Message::Ptr& tx, int con_fd) {
+  TraceSpan span("secondary", tx->toStr());
   der_encode(&asn_DEF_AKIpUptaneMes, &tx->msg_, Asn1SocketWriteCallback, &con_fd);
 
   // Bounce TCP_NODELAY to flush the TCP send buffer
@@ -85,6 +112,10 @@ Asn1Message::Ptr Asn1Rpc(const Asn1Message::Ptr& tx, int con_fd) {
     LOG_DEBUG << "Asn1Rpc decoding failed";
     msg->present(AKIpUptaneMes_PR_NOTHING);
   }
+  if (span) {
+    span.arg("response", msg->toStr());
+  }
+  Tracer::count("secondary_requests_total", 1);
 
   return msg;
 }
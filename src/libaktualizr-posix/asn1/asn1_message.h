@@ -1,5 +1,7 @@
 #ifndef ASN1_MESSAGE_H_
 #define ASN1_MESSAGE_H_
+#include <istream>
+
 #include <boost/intrusive_ptr.hpp>
 
 #include "AKIpUptaneMes.h"
@@ -99,6 +101,11 @@ class Asn1Message {
   ASN1_MESSAGE_DEFINE_ACCESSOR(AKPutRootReqMes_t, putRootReq);
   ASN1_MESSAGE_DEFINE_ACCESSOR(AKPutRootRespMes_t, putRootResp);
 
+  ASN1_MESSAGE_DEFINE_ACCESSOR(AKPutRootChainReqMes_t, putRootChainReq);
+  ASN1_MESSAGE_DEFINE_ACCESSOR(AKPutRootChainRespMes_t, putRootChainResp);
+  ASN1_MESSAGE_DEFINE_ACCESSOR(AKUploadDeltaReqMes_t, uploadDeltaReq);
+  ASN1_MESSAGE_DEFINE_ACCESSOR(AKUploadDeltaRespMes_t, uploadDeltaResp);
+
 #define ASN1_MESSAGE_DEFINE_STR_NAME(MessageID) \
   case MessageID:                               \
     return #MessageID;
@@ -132,6 +139,11 @@ class Asn1Message {
         ASN1_MESSAGE_DEFINE_STR_NAME(AKIpUptaneMes_PR_rootVerResp);
         ASN1_MESSAGE_DEFINE_STR_NAME(AKIpUptaneMes_PR_putRootReq);
         ASN1_MESSAGE_DEFINE_STR_NAME(AKIpUptaneMes_PR_putRootResp);
+
+        ASN1_MESSAGE_DEFINE_STR_NAME(AKIpUptaneMes_PR_putRootChainReq);
+        ASN1_MESSAGE_DEFINE_STR_NAME(AKIpUptaneMes_PR_putRootChainResp);
+        ASN1_MESSAGE_DEFINE_STR_NAME(AKIpUptaneMes_PR_uploadDeltaReq);
+        ASN1_MESSAGE_DEFINE_STR_NAME(AKIpUptaneMes_PR_uploadDeltaResp);
     }
     return "Unknown";
   };
@@ -175,6 +187,11 @@ int Asn1SocketWriteCallback(const void* buffer, size_t size, void* priv);
 std::string ToString(const OCTET_STRING_t& octet_str);
 
 void SetString(OCTET_STRING_t* dest, const std::string& str);
+/**
+ * Fill `dest` with `size` bytes read from `stream`, without an intermediate
+ * copy. Returns false if the stream ends early.
+ */
+bool SetStringFromStream(OCTET_STRING_t* dest, std::istream& stream, uint64_t size);
 
 /**
  * Open a TCP connection to client; send a message and wait for a
@@ -3,14 +3,17 @@
 #include <arpa/inet.h>
 #include <netinet/tcp.h>
 
-#include <array>
+#include <cerrno>
+#include <cstring>
 #include <fstream>
 #include <memory>
+#include <vector>
 
 #include "asn1/asn1_message.h"
 #include "der_encoder.h"
 #include "libaktualizr/secondary_provider.h"
 #include "logging/logging.h"
+#include "package_manager/deltapatch.h"
 #include "uptane/tuf.h"
 #include "utilities/flow_control.h"
 #include "utilities/utils.h"
@@ -18,10 +21,14 @@
 namespace Uptane {
 
 SecondaryInterface::Ptr IpUptaneSecondary::connectAndCreate(const std::string& address, unsigned short port,
-                                                            VerificationType verification_type) {
+                                                            VerificationType verification_type,
+                                                            std::chrono::milliseconds timeout) {
   LOG_INFO << "Connecting to and getting info about IP Secondary: " << address << ":" << port << "...";
 
   ConnectionSocket con_sock{address, port};
+  if (timeout.count() > 0) {
+    con_sock.setTimeout(timeout);
+  }
 
   if (con_sock.connect() == 0) {
     LOG_INFO << "Connected to IP Secondary: "
@@ -63,12 +70,13 @@ SecondaryInterface::Ptr IpUptaneSecondary::create(const std::string& address, un
 
 SecondaryInterface::Ptr IpUptaneSecondary::connectAndCheck(const std::string& address, unsigned short port,
                                                            VerificationType verification_type, EcuSerial serial,
-                                                           HardwareIdentifier hw_id, PublicKey pub_key) {
+                                                           HardwareIdentifier hw_id, PublicKey pub_key,
+                                                           std::chrono::milliseconds timeout) {
   // try to connect:
   // - if it succeeds compare with what we expect
   // - otherwise, keep using what we know
   try {
-    auto sec = IpUptaneSecondary::connectAndCreate(address, port, verification_type);
+    auto sec = IpUptaneSecondary::connectAndCreate(address, port, verification_type, timeout);
     if (sec != nullptr) {
       auto s = sec->getSerial();
       if (s != serial && serial != EcuSerial::Unknown()) {
@@ -325,6 +333,55 @@ data::InstallationResult IpUptaneSecondary::putRoot(const std::string& root, boo
   return data::InstallationResult(static_cast<data::ResultCode::Numeric>(r->result), ToString(r->description));
 }
 
+/* Send all the Root metadata versions in a single request. Secondaries that
+ * predate this message close the connection without responding, in which case
+ * fall back to sending the versions one by one and do not try again. */
+data::InstallationResult IpUptaneSecondary::putRootChain(const std::vector<std::string>& roots, bool director) {
+  if (roots.empty()) {
+    return data::InstallationResult(data::ResultCode::Numeric::kOk, "");
+  }
+  if (director && verification_type_ == VerificationType::kTuf) {
+    return putRoot(roots.front(), director);
+  }
+  if (root_chain_unsupported_ || roots.size() == 1) {
+    return SecondaryInterface::putRootChain(roots, director);
+  }
+
+  Asn1Message::Ptr req(Asn1Message::Empty());
+  req->present(AKIpUptaneMes_PR_putRootChainReq);
+  auto m = req->putRootChainReq();
+
+  if (director) {
+    m->repotype = AKRepoType_director;
+  } else {
+    m->repotype = AKRepoType_image;
+  }
+  for (const auto& root : roots) {
+    auto* root_json = Asn1Allocation<OCTET_STRING_t>();
+    SetString(root_json, root);
+    ASN_SEQUENCE_ADD(&m->chain, root_json);
+  }
+
+  auto resp = Asn1Rpc(req, getAddr());
+  if (resp->present() != AKIpUptaneMes_PR_putRootChainResp) {
+    if (!ping()) {
+      LOG_ERROR << "Secondary " << getSerial() << " failed to respond to a request to receive Root metadata.";
+      return data::InstallationResult(
+          data::ResultCode::Numeric::kInternalError,
+          "Secondary " + getSerial().ToString() + " failed to respond to a request to receive Root metadata.");
+    }
+    LOG_DEBUG << "Secondary " << getSerial()
+              << " does not support receiving a Root metadata chain; sending versions separately.";
+    root_chain_unsupported_ = true;
+    return SecondaryInterface::putRootChain(roots, director);
+  }
+
+  auto r = resp->putRootChainResp();
+  LOG_DEBUG << "Secondary " << getSerial() << " accepted " << r->applied << " of " << roots.size()
+            << " Root metadata versions";
+  return data::InstallationResult(static_cast<data::ResultCode::Numeric>(r->result), ToString(r->description));
+}
+
 Manifest IpUptaneSecondary::getManifest() const {
   getSecondaryVersion();
 
@@ -352,9 +409,15 @@ bool IpUptaneSecondary::ping() const {
   Asn1Message::Ptr req(Asn1Message::Empty());
   req->present(AKIpUptaneMes_PR_getInfoReq);
 
-  auto m = req->getInfoReq();
-
-  auto resp = Asn1Rpc(req, getAddr());
+  // Secondaries are pinged over and over while they are switched off, the
+  // change in their reachability is what is worth logging.
+  ConnectionSocket connection(getAddr().first, getAddr().second);
+  if (connection.connect() < 0) {
+    LOG_DEBUG << "Failed to connect to the Secondary ( " << getAddr().first << ":" << getAddr().second
+              << "): " << std::strerror(errno);
+    return false;
+  }
+  auto resp = Asn1Rpc(req, *connection);
 
   return resp->present() == AKIpUptaneMes_PR_getInfoResp;
 }
@@ -379,24 +442,30 @@ data::InstallationResult IpUptaneSecondary::sendFirmware(const Uptane::Target& t
 }
 
 data::InstallationResult IpUptaneSecondary::sendFirmware_v1(const Uptane::Target& target) {
-  std::string data_to_send;
+  Asn1Message::Ptr req(Asn1Message::Empty());
+  req->present(AKIpUptaneMes_PR_sendFirmwareReq);
+  auto m = req->sendFirmwareReq();
 
   if (target.IsOstree()) {
     // empty firmware means OSTree Secondaries: pack credentials instead
-    data_to_send = secondary_provider_->getTreehubCredentials();
+    SetString(&m->firmware, secondary_provider_->getTreehubCredentials());
   } else {
-    std::stringstream sstr;
+    // Version 1 of the protocol sends the whole image in a single message, so
+    // it has to fit into memory.
+    if (!secondary_provider_->fitsInMemory(target.length())) {
+      LOG_ERROR << "Image " << target.filename() << " of " << target.length()
+                << " bytes exceeds the soft memory limit, can't send it to Secondary " << getSerial();
+      return data::InstallationResult(data::ResultCode::Numeric::kDownloadFailed,
+                                      "Image exceeds the soft memory limit for Secondary " + getSerial().ToString());
+    }
     auto str = secondary_provider_->getTargetFileHandle(target);
-    sstr << str.rdbuf();
-    data_to_send = sstr.str();
+    if (!SetStringFromStream(&m->firmware, *str, target.length())) {
+      return data::InstallationResult(data::ResultCode::Numeric::kDownloadFailed,
+                                      "Could not read image " + target.filename());
+    }
   }
 
-  LOG_INFO << "Sending firmware to the Secondary, size: " << data_to_send.size();
-  Asn1Message::Ptr req(Asn1Message::Empty());
-  req->present(AKIpUptaneMes_PR_sendFirmwareReq);
-
-  auto m = req->sendFirmwareReq();
-  SetString(&m->firmware, data_to_send);
+  LOG_INFO << "Sending firmware to the Secondary, size: " << m->firmware.size;
   auto resp = Asn1Rpc(req, getAddr());
 
   if (resp->present() != AKIpUptaneMes_PR_sendFirmwareResp) {
@@ -497,35 +566,102 @@ data::InstallationResult IpUptaneSecondary::downloadOstreeRev(const Uptane::Targ
 }
 
 data::InstallationResult IpUptaneSecondary::uploadFirmware(const Uptane::Target& target) {
+  for (const auto& delta : DeltaTarget::fromTarget(target)) {
+    if (delta_unsupported_) {
+      break;
+    }
+    auto delta_reader = secondary_provider_->getDeltaFileHandle(delta);
+    if (!delta_reader.is_open()) {
+      continue;
+    }
+    auto delta_result = requestDeltaUpload(delta);
+    if (delta_result.isSuccess()) {
+      LOG_INFO << "Uploading a delta of " << delta.length() << " bytes for the target image (" << target.filename()
+               << ") to the Secondary (" << getSerial() << ")";
+      return uploadFirmwareStream(delta_reader, delta.length());
+    }
+    LOG_DEBUG << "Secondary " << getSerial() << " declined a delta for " << target.filename() << ": "
+              << delta_result.description;
+  }
+
   LOG_INFO << "Uploading the target image (" << target.filename() << ") "
            << "to the Secondary (" << getSerial() << ")";
 
-  auto upload_result = data::InstallationResult(data::ResultCode::Numeric::kDownloadFailed, "");
+  std::unique_ptr<MappedFile> image;
+  try {
+    image = secondary_provider_->mapTargetFile(target);
+  } catch (const std::exception& e) {
+    LOG_ERROR << "Can't read the target image " << target.filename() << ": " << e.what();
+    return data::InstallationResult(data::ResultCode::Numeric::kDownloadFailed, e.what());
+  }
+  if (image->size() != target.length()) {
+    return data::InstallationResult(data::ResultCode::Numeric::kDownloadFailed, "Incomplete target image");
+  }
+  return uploadFirmwareMapped(*image);
+}
 
-  auto image_reader = secondary_provider_->getTargetFileHandle(target);
+/* Send the image straight from the page cache. */
+data::InstallationResult IpUptaneSecondary::uploadFirmwareMapped(const MappedFile& image) {
+  auto upload_data_result = data::InstallationResult(data::ResultCode::Numeric::kOk, "");
+  image.forEachSpan([this, &upload_data_result](const uint8_t* span, size_t size) {
+    for (size_t offset = 0; offset < size && upload_data_result.isSuccess(); offset += kUploadPartSize) {
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+      upload_data_result = uploadFirmwareData(span + offset, std::min(kUploadPartSize, size - offset));
+    }
+  });
+  return upload_data_result;
+}
+
+data::InstallationResult IpUptaneSecondary::uploadFirmwareStream(std::ifstream& reader, uint64_t size) {
+  auto upload_result = data::InstallationResult(data::ResultCode::Numeric::kDownloadFailed, "");
 
-  uint64_t image_size = target.length();
-  const size_t size = 1024;
   size_t total_send_data = 0;
-  std::array<uint8_t, size> buf{};
+  std::vector<uint8_t> buf(kUploadPartSize);
   auto upload_data_result = data::InstallationResult(data::ResultCode::Numeric::kOk, "");
 
-  while (total_send_data < image_size && upload_data_result.isSuccess()) {
-    image_reader.read(reinterpret_cast<char*>(buf.data()), buf.size());
-    upload_data_result = uploadFirmwareData(buf.data(), static_cast<size_t>(image_reader.gcount()));
-    total_send_data += static_cast<size_t>(image_reader.gcount());
+  while (total_send_data < size && upload_data_result.isSuccess()) {
+    reader.read(reinterpret_cast<char*>(buf.data()), static_cast<std::streamsize>(buf.size()));
+    upload_data_result = uploadFirmwareData(buf.data(), static_cast<size_t>(reader.gcount()));
+    total_send_data += static_cast<size_t>(reader.gcount());
   }
-  if (upload_data_result.isSuccess() && total_send_data == image_size) {
+  if (upload_data_result.isSuccess() && total_send_data == size) {
     upload_result = data::InstallationResult(data::ResultCode::Numeric::kOk, "");
   } else if (!upload_data_result.isSuccess()) {
     upload_result = upload_data_result;
   } else {
     upload_result = data::InstallationResult(data::ResultCode::Numeric::kDownloadFailed, "Incomplete upload");
   }
-  image_reader.close();
+  reader.close();
   return upload_result;
 }
 
+/* Ask the Secondary to accept a delta against its installed image instead of
+ * the full image. Secondaries that predate this message close the connection
+ * without responding and are not asked again. */
+data::InstallationResult IpUptaneSecondary::requestDeltaUpload(const DeltaTarget& delta) {
+  Asn1Message::Ptr req(Asn1Message::Empty());
+  req->present(AKIpUptaneMes_PR_uploadDeltaReq);
+
+  auto m = req->uploadDeltaReq();
+  SetString(&m->fromHash, delta.from().HashString());
+  auto resp = Asn1Rpc(req, getAddr());
+
+  if (resp->present() != AKIpUptaneMes_PR_uploadDeltaResp) {
+    if (!ping()) {
+      LOG_ERROR << "Secondary " << getSerial() << " failed to respond to a request to receive a delta.";
+      return data::InstallationResult(
+          data::ResultCode::Numeric::kDownloadFailed,
+          "Secondary " + getSerial().ToString() + " failed to respond to a request to receive a delta.");
+    }
+    delta_unsupported_ = true;
+    return data::InstallationResult(data::ResultCode::Numeric::kGeneralError,
+                                    "Secondary " + getSerial().ToString() + " does not support delta updates.");
+  }
+
+  auto r = resp->uploadDeltaResp();
+  return data::InstallationResult(static_cast<data::ResultCode::Numeric>(r->result), ToString(r->description));
+}
+
 data::InstallationResult IpUptaneSecondary::uploadFirmwareData(const uint8_t* data, size_t size) {
   Asn1Message::Ptr req(Asn1Message::Empty());
   req->present(AKIpUptaneMes_PR_uploadDataReq);
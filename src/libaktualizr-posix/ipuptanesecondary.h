@@ -1,9 +1,13 @@
 #ifndef UPTANE_IPUPTANESECONDARY_H_
 #define UPTANE_IPUPTANESECONDARY_H_
 
+#include <chrono>
+
+#include "libaktualizr/mapped_file.h"
 #include "libaktualizr/secondaryinterface.h"
 #include "libaktualizr/types.h"
 
+class DeltaTarget;
 struct AKMetaCollection;
 using AKMetaCollection_t = struct AKMetaCollection;
 
@@ -11,14 +15,17 @@ namespace Uptane {
 
 class IpUptaneSecondary : public SecondaryInterface {
  public:
+  /** A non-zero `timeout` bounds the connection and each message exchanged on it. */
   static SecondaryInterface::Ptr connectAndCreate(const std::string& address, unsigned short port,
-                                                  VerificationType verification_type);
+                                                  VerificationType verification_type,
+                                                  std::chrono::milliseconds timeout = std::chrono::milliseconds{0});
   static SecondaryInterface::Ptr create(const std::string& address, unsigned short port,
                                         VerificationType verification_type, int con_fd);
 
   static SecondaryInterface::Ptr connectAndCheck(const std::string& address, unsigned short port,
                                                  VerificationType verification_type, EcuSerial serial,
-                                                 HardwareIdentifier hw_id, PublicKey pub_key);
+                                                 HardwareIdentifier hw_id, PublicKey pub_key,
+                                                 std::chrono::milliseconds timeout = std::chrono::milliseconds{0});
 
   explicit IpUptaneSecondary(const std::string& address, unsigned short port, VerificationType verification_type,
                              EcuSerial serial, HardwareIdentifier hw_id, PublicKey pub_key);
@@ -34,8 +41,11 @@ class IpUptaneSecondary : public SecondaryInterface {
   data::InstallationResult putMetadata(const Target& target) override;
   int32_t getRootVersion(bool director) const override;
   data::InstallationResult putRoot(const std::string& root, bool director) override;
+  data::InstallationResult putRootChain(const std::vector<std::string>& roots, bool director) override;
   Manifest getManifest() const override;
   bool ping() const override;
+  // Every ping uses a connection of its own.
+  bool isPingThreadSafe() const override { return true; }
   data::InstallationResult sendFirmware(const Uptane::Target& target,
                                         const api::FlowControlToken* flow_control) override;
   data::InstallationResult install(const Uptane::Target& target, const api::FlowControlToken* flow_control) override;
@@ -54,7 +64,14 @@ class IpUptaneSecondary : public SecondaryInterface {
   data::InstallationResult invokeInstallOnSecondary(const Uptane::Target& target);
   data::InstallationResult downloadOstreeRev(const Uptane::Target& target);
   data::InstallationResult uploadFirmware(const Uptane::Target& target);
+  data::InstallationResult uploadFirmwareStream(std::ifstream& reader, uint64_t size);
+  data::InstallationResult uploadFirmwareMapped(const MappedFile& image);
   data::InstallationResult uploadFirmwareData(const uint8_t* data, size_t size);
+  data::InstallationResult requestDeltaUpload(const DeltaTarget& delta);
+
+  // Size of the uploadDataReq messages, large enough to keep the round trips
+  // from dominating the upload.
+  static constexpr size_t kUploadPartSize = 64 * 1024;
 
   std::shared_ptr<SecondaryProvider> secondary_provider_;
   const std::pair<std::string, uint16_t> addr_;
@@ -63,6 +80,8 @@ class IpUptaneSecondary : public SecondaryInterface {
   const HardwareIdentifier hw_id_;
   const PublicKey pub_key_;
   mutable uint32_t protocol_version{0};
+  bool root_chain_unsupported_{false};
+  bool delta_unsupported_{false};
 };
 
 }  // namespace Uptane
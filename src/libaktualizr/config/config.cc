@@ -87,6 +87,10 @@ void ProvisionConfig::writeToStream(std::ostream& out_stream) const {
 
 void UptaneConfig::updateFromPropertyTree(const boost::property_tree::ptree& pt) {
   CopyFromConfig(polling_sec, "polling_sec", pt);
+  CopyFromConfig(polling_active_sec, "polling_active_sec", pt);
+  CopyFromConfig(polling_max_sec, "polling_max_sec", pt);
+  CopyFromConfig(polling_jitter_percent, "polling_jitter_percent", pt);
+  CopyFromConfig(manifest_heartbeat_sec, "manifest_heartbeat_sec", pt);
   CopyFromConfig(director_server, "director_server", pt);
   CopyFromConfig(repo_server, "repo_server", pt);
   CopyFromConfig(key_source, "key_source", pt);
@@ -94,10 +98,17 @@ void UptaneConfig::updateFromPropertyTree(const boost::property_tree::ptree& pt)
   CopyFromConfig(force_install_completion, "force_install_completion", pt);
   CopyFromConfig(secondary_config_file, "secondary_config_file", pt);
   CopyFromConfig(secondary_preinstall_wait_sec, "secondary_preinstall_wait_sec", pt);
+  CopyFromConfig(memory_soft_limit_mb, "memory_soft_limit_mb", pt);
+  CopyFromConfig(event_queue_size, "event_queue_size", pt);
+  CopyFromConfig(event_overflow, "event_overflow", pt);
 }
 
 void UptaneConfig::writeToStream(std::ostream& out_stream) const {
   writeOption(out_stream, polling_sec, "polling_sec");
+  writeOption(out_stream, polling_active_sec, "polling_active_sec");
+  writeOption(out_stream, polling_max_sec, "polling_max_sec");
+  writeOption(out_stream, polling_jitter_percent, "polling_jitter_percent");
+  writeOption(out_stream, manifest_heartbeat_sec, "manifest_heartbeat_sec");
   writeOption(out_stream, director_server, "director_server");
   writeOption(out_stream, repo_server, "repo_server");
   writeOption(out_stream, key_source, "key_source");
@@ -105,6 +116,9 @@ void UptaneConfig::writeToStream(std::ostream& out_stream) const {
   writeOption(out_stream, force_install_completion, "force_install_completion");
   writeOption(out_stream, secondary_config_file, "secondary_config_file");
   writeOption(out_stream, secondary_preinstall_wait_sec, "secondary_preinstall_wait_sec");
+  writeOption(out_stream, memory_soft_limit_mb, "memory_soft_limit_mb");
+  writeOption(out_stream, event_queue_size, "event_queue_size");
+  writeOption(out_stream, event_overflow, "event_overflow");
 }
 
 /**
@@ -156,6 +170,7 @@ KeyManagerConfig Config::keymanagerConfig() const {
 
 void Config::postUpdateValues() {
   logger_set_threshold(logger);
+  logger_set_async(logger.async);
 
   if (provision.mode == ProvisionMode::kDefault) {
     provision.mode = provision.provision_path.empty() ? ProvisionMode::kDeviceCred : ProvisionMode::kSharedCred;
@@ -217,8 +232,11 @@ void Config::updateFromTomlString(const std::string& contents) {
 
 void Config::updateFromPropertyTree(const boost::property_tree::ptree& pt) {
   // Keep this order the same as in config.h and Config::writeToStream().
-  if (!loglevel_from_cmdline) {
-    CopySubtreeFromConfig(logger, "logger", pt);
+  const int cmdline_loglevel = logger.loglevel;
+  CopySubtreeFromConfig(logger, "logger", pt);
+  if (loglevel_from_cmdline) {
+    logger.loglevel = cmdline_loglevel;
+  } else {
     // If not already set from the commandline, set the loglevel now so that it
     // affects the rest of the config processing.
     logger_set_threshold(logger);
@@ -231,6 +249,7 @@ void Config::updateFromPropertyTree(const boost::property_tree::ptree& pt) {
   CopySubtreeFromConfig(storage, "storage", pt);
   CopySubtreeFromConfig(import, "import", pt);
   CopySubtreeFromConfig(telemetry, "telemetry", pt);
+  CopySubtreeFromConfig(tracing, "tracing", pt);
   CopySubtreeFromConfig(bootloader, "bootloader", pt);
 }
 
@@ -271,5 +290,6 @@ void Config::writeToStream(std::ostream& sink) const {
   WriteSectionToStream(storage, "storage", sink);
   WriteSectionToStream(import, "import", sink);
   WriteSectionToStream(telemetry, "telemetry", sink);
+  WriteSectionToStream(tracing, "tracing", sink);
   WriteSectionToStream(bootloader, "bootloader", sink);
 }
@@ -1,8 +1,13 @@
 #include "httpclient.h"
 
+#include <algorithm>
 #include <cassert>
+#include <regex>
 #include <sstream>
 
+#include <boost/algorithm/string.hpp>
+
+#include "utilities/tracing.h"
 #include "utilities/utils.h"
 
 struct WriteStringArg {
@@ -34,6 +39,61 @@ static size_t writeString(void* contents, size_t size, size_t nmemb, void* userp
   return size * nmemb;
 }
 
+/**
+ * \par Description:
+ *    A header handler for the curl library. It picks up the polling hints of
+ *    the server: the Retry-After and the max-age of the Cache-Control headers.
+ *    https://curl.haxx.se/libcurl/c/CURLOPT_HEADERFUNCTION.html
+ */
+static size_t readPollingHints(char* buffer, size_t size, size_t nitems, void* userp) {
+  const size_t length = size * nitems;
+  auto* response = static_cast<HttpResponse*>(userp);
+  const std::string line(buffer, length);
+  if (boost::algorithm::istarts_with(line, "HTTP/")) {
+    // A new response, e.g. after a redirect.
+    response->retry_after_sec = -1;
+    response->max_age_sec = -1;
+    return length;
+  }
+  const auto colon = line.find(':');
+  if (colon == std::string::npos) {
+    return length;
+  }
+  const std::string name = boost::algorithm::to_lower_copy(line.substr(0, colon));
+  const std::string value = boost::algorithm::trim_copy(line.substr(colon + 1));
+  if (name == "retry-after") {
+    response->retry_after_sec = HttpResponse::parseRetryAfter(value, time(nullptr));
+  } else if (name == "cache-control") {
+    response->max_age_sec = HttpResponse::parseMaxAge(value);
+  }
+  return length;
+}
+
+int64_t HttpResponse::parseRetryAfter(const std::string& value, time_t now) {
+  if (!value.empty() && std::all_of(value.begin(), value.end(), ::isdigit)) {
+    try {
+      return std::stoll(value);
+    } catch (const std::out_of_range&) {
+      return -1;
+    }
+  }
+  // An HTTP date
+  const time_t date = curl_getdate(value.c_str(), nullptr);
+  if (date < 0) {
+    return -1;
+  }
+  return std::max<int64_t>(0, date - now);
+}
+
+int64_t HttpResponse::parseMaxAge(const std::string& value) {
+  static const std::regex max_age(R"((?:^|[\s,])max-age\s*=\s*"?(\d{1,10}))", std::regex::icase);
+  std::smatch match;
+  if (!std::regex_search(value, match, max_age)) {
+    return -1;
+  }
+  return std::stoll(match[1]);
+}
+
 static int ProgressHandler(void* clientp, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow) {
   (void)dltotal;
   (void)dlnow;
@@ -215,6 +275,40 @@ HttpResponse HttpClient::put(const std::string& url, const Json::Value& data) {
   return put(url, "application/json", data_str);
 }
 
+/* Record the transfer of a finished request: sizes, TLS handshake and time to first byte. */
+static void traceTransfer(CURL* curl_handler, TraceSpan& span) {
+  if (!span) {
+    return;
+  }
+  curl_off_t downloaded = 0;
+  curl_off_t uploaded = 0;
+  curl_off_t tls_done = 0;
+  curl_off_t first_byte = 0;
+  long http_code = 0;  // NOLINT(google-runtime-int)
+  char* url = nullptr;
+  curl_easy_getinfo(curl_handler, CURLINFO_SIZE_DOWNLOAD_T, &downloaded);
+  curl_easy_getinfo(curl_handler, CURLINFO_SIZE_UPLOAD_T, &uploaded);
+  // Both in microseconds since the start of the request, the first is 0 without TLS.
+  curl_easy_getinfo(curl_handler, CURLINFO_APPCONNECT_TIME_T, &tls_done);
+  curl_easy_getinfo(curl_handler, CURLINFO_STARTTRANSFER_TIME_T, &first_byte);
+  curl_easy_getinfo(curl_handler, CURLINFO_RESPONSE_CODE, &http_code);
+  curl_easy_getinfo(curl_handler, CURLINFO_EFFECTIVE_URL, &url);
+
+  if (url != nullptr) {
+    span.arg("url", url);
+  }
+  span.arg("http_code", static_cast<int64_t>(http_code));
+  span.arg("bytes_downloaded", static_cast<int64_t>(downloaded));
+  span.arg("bytes_uploaded", static_cast<int64_t>(uploaded));
+  span.arg("tls_us", static_cast<int64_t>(tls_done));
+  span.arg("ttfb_us", static_cast<int64_t>(first_byte));
+  Tracer::count("http_requests_total", 1);
+  Tracer::count("http_downloaded_bytes_total", static_cast<uint64_t>(downloaded));
+  Tracer::count("http_uploaded_bytes_total", static_cast<uint64_t>(uploaded));
+  Tracer::count("http_tls_microseconds_total", static_cast<uint64_t>(tls_done));
+  Tracer::count("http_ttfb_microseconds_total", static_cast<uint64_t>(first_byte));
+}
+
 // NOLINTNEXTLINE(misc-no-recursion)
 HttpResponse HttpClient::perform(CURL* curl_handler, int retry_times, int64_t size_limit) {
   if (size_limit >= 0) {
@@ -228,10 +322,23 @@ HttpResponse HttpClient::perform(CURL* curl_handler, int retry_times, int64_t si
   WriteStringArg response_arg;
   response_arg.limit = size_limit;
   curlEasySetoptWrapper(curl_handler, CURLOPT_WRITEDATA, static_cast<void*>(&response_arg));
-  CURLcode result = curl_easy_perform(curl_handler);
+  HttpResponse hints;
+  curlEasySetoptWrapper(curl_handler, CURLOPT_HEADERFUNCTION, readPollingHints);
+  curlEasySetoptWrapper(curl_handler, CURLOPT_HEADERDATA, static_cast<void*>(&hints));
+  CURLcode result;
+  {
+    TraceSpan span("http", "request");
+    result = curl_easy_perform(curl_handler);
+    traceTransfer(curl_handler, span);
+  }
+  curlEasySetoptWrapper(curl_handler, CURLOPT_HEADERFUNCTION, nullptr);
+  curlEasySetoptWrapper(curl_handler, CURLOPT_HEADERDATA, nullptr);
   long http_code;  // NOLINT(google-runtime-int)
   curl_easy_getinfo(curl_handler, CURLINFO_RESPONSE_CODE, &http_code);
-  HttpResponse response(response_arg.out, http_code, result, (result != CURLE_OK) ? curl_easy_strerror(result) : "");
+  HttpResponse response(std::move(response_arg.out), http_code, result,
+                        (result != CURLE_OK) ? curl_easy_strerror(result) : "");
+  response.retry_after_sec = hints.retry_after_sec;
+  response.max_age_sec = hints.max_age_sec;
   if (response.curl_code != CURLE_OK || response.http_status_code >= 500) {
     std::ostringstream error_message;
     error_message << "curl error " << response.curl_code << " (http code " << response.http_status_code
@@ -283,7 +390,12 @@ std::future<HttpResponse> HttpClient::downloadAsync(const std::string& url, curl
   auto resp_future = resp_promise.get_future();
   std::thread(
       [curlp](std::promise<HttpResponse> promise) {
-        CURLcode result = curl_easy_perform(curlp.get());
+        CURLcode result;
+        {
+          TraceSpan span("http", "download");
+          result = curl_easy_perform(curlp.get());
+          traceTransfer(curlp.get(), span);
+        }
         long http_code;  // NOLINT(google-runtime-int)
         curl_easy_getinfo(curlp.get(), CURLINFO_RESPONSE_CODE, &http_code);
         HttpResponse response("", http_code, result, (result != CURLE_OK) ? curl_easy_strerror(result) : "");
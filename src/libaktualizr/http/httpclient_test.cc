@@ -141,6 +141,30 @@ TEST(Headers, update_header) {
   EXPECT_EQ(response["status"].asString(), "good");
 }
 
+/* The polling hints of the server are picked up from the response headers. */
+TEST(Headers, polling_hints) {
+  HttpClient http;
+  HttpResponse response = http.get(server + "/polling_hints", HttpInterface::kNoLimit, nullptr);
+  EXPECT_EQ(response.http_status_code, 429);
+  EXPECT_EQ(response.retry_after_sec, 30);
+  EXPECT_EQ(response.max_age_sec, 120);
+
+  response = http.get(server + "/path/1", HttpInterface::kNoLimit, nullptr);
+  EXPECT_EQ(response.retry_after_sec, -1);
+  EXPECT_EQ(response.max_age_sec, -1);
+}
+
+TEST(Headers, parse_polling_hints) {
+  EXPECT_EQ(HttpResponse::parseRetryAfter("120", 0), 120);
+  EXPECT_EQ(HttpResponse::parseRetryAfter("Thu, 01 Jan 1970 00:01:40 GMT", 40), 60);
+  EXPECT_EQ(HttpResponse::parseRetryAfter("Thu, 01 Jan 1970 00:01:40 GMT", 1000), 0);
+  EXPECT_EQ(HttpResponse::parseRetryAfter("soon", 0), -1);
+  EXPECT_EQ(HttpResponse::parseMaxAge("max-age=60"), 60);
+  EXPECT_EQ(HttpResponse::parseMaxAge("public, MAX-AGE = 3600, must-revalidate"), 3600);
+  EXPECT_EQ(HttpResponse::parseMaxAge("s-maxage=60"), -1);
+  EXPECT_EQ(HttpResponse::parseMaxAge("no-cache"), -1);
+}
+
 // TODO(OTA-4546): add tests for HttpClient::download
 
 #ifndef __NO_MAIN__
@@ -27,6 +27,9 @@ struct HttpResponse {
   long http_status_code{0};  // NOLINT(google-runtime-int)
   CURLcode curl_code{CURLE_OK};
   std::string error_message;
+  // Polling hints of the server, negative if it did not send them.
+  int64_t retry_after_sec{-1};
+  int64_t max_age_sec{-1};
   bool isOk() const { return (curl_code == CURLE_OK && http_status_code >= 200 && http_status_code < 400); }
   bool wasInterrupted() const { return curl_code == CURLE_ABORTED_BY_CALLBACK; };
   std::string getStatusStr() const {
@@ -34,6 +37,12 @@ struct HttpResponse {
   }
 
   Json::Value getJson() const { return Utils::parseJSON(body); }
+
+  /** Seconds to wait from a Retry-After header, which is either a number of
+   * seconds or an HTTP date. Negative if invalid. */
+  static int64_t parseRetryAfter(const std::string &value, time_t now);
+  /** The max-age of a Cache-Control header, negative if there is none. */
+  static int64_t parseMaxAge(const std::string &value);
 };
 
 class HttpInterface {
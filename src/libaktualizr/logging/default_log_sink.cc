@@ -1,8 +1,44 @@
+#include <cstdlib>
 #include <iomanip>
 #include <iostream>
+#include <mutex>
 
+#include <boost/core/null_deleter.hpp>
+#include <boost/log/core/core.hpp>
+#include <boost/log/expressions.hpp>
+#include <boost/log/sinks/async_frontend.hpp>
+#include <boost/log/sinks/bounded_fifo_queue.hpp>
+#include <boost/log/sinks/drop_on_overflow.hpp>
+#include <boost/log/sinks/sync_frontend.hpp>
+#include <boost/log/sinks/text_ostream_backend.hpp>
 #include <boost/log/trivial.hpp>
-#include <boost/log/utility/setup/console.hpp>
+#include <boost/make_shared.hpp>
+
+namespace sinks = boost::log::sinks;
+
+using SyncSink = sinks::synchronous_sink<sinks::text_ostream_backend>;
+// Bounded, so that a burst of debug messages cannot exhaust the memory of the
+// device. When the writer falls behind, new messages are dropped instead of
+// blocking the thread that logs them.
+using AsyncSink = sinks::asynchronous_sink<sinks::text_ostream_backend,
+                                           sinks::bounded_fifo_queue<8192, sinks::drop_on_overflow>>;
+
+namespace {
+
+struct SinkState {
+  std::mutex mutex;
+  bool use_colors{false};
+  boost::shared_ptr<sinks::text_ostream_backend> backend;
+  boost::shared_ptr<SyncSink> sync_sink;
+  boost::shared_ptr<AsyncSink> async_sink;
+};
+
+SinkState& sinkState() {
+  static SinkState state;
+  return state;
+}
+
+}  // namespace
 
 static void color_fmt(boost::log::record_view const& rec, boost::log::formatting_ostream& strm) {
   auto severity = rec[boost::log::trivial::severity];
@@ -29,14 +65,74 @@ static void color_fmt(boost::log::record_view const& rec, boost::log::formatting
   }
 }
 
+template <class Sink>
+static void set_format(Sink& sink, bool use_colors) {
+  if (use_colors) {
+    sink.set_formatter(&color_fmt);
+  } else {
+    sink.set_formatter(boost::log::expressions::stream << boost::log::expressions::smessage);
+  }
+}
+
+static void stop_async_sink(SinkState& state) {
+  if (state.async_sink) {
+    boost::log::core::get()->remove_sink(state.async_sink);
+    state.async_sink->stop();
+    state.async_sink->flush();
+    state.async_sink.reset();
+  }
+}
+
+static void stop_async_sink_at_exit() {
+  SinkState& state = sinkState();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  stop_async_sink(state);
+}
+
 void logger_init_sink(bool use_colors = false) {
   auto* stream = &std::cerr;
   if (getenv("LOG_STDERR") == nullptr) {
     stream = &std::cout;
   }
-  auto sink = boost::log::add_console_log(*stream, boost::log::keywords::format = "%Message%",
-                                          boost::log::keywords::auto_flush = true);
-  if (use_colors) {
-    sink->set_formatter(&color_fmt);
+  SinkState& state = sinkState();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  stop_async_sink(state);
+  if (state.sync_sink) {
+    boost::log::core::get()->remove_sink(state.sync_sink);
+  }
+  state.use_colors = use_colors;
+  state.backend = boost::make_shared<sinks::text_ostream_backend>();
+  state.backend->add_stream(boost::shared_ptr<std::ostream>(stream, boost::null_deleter()));
+  state.backend->auto_flush(true);
+  state.sync_sink = boost::make_shared<SyncSink>(state.backend);
+  set_format(*state.sync_sink, use_colors);
+  boost::log::core::get()->add_sink(state.sync_sink);
+}
+
+void logger_set_async_sink(bool async) {
+  static std::once_flag registered;
+  SinkState& state = sinkState();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  if (!state.backend || async == static_cast<bool>(state.async_sink)) {
+    return;
+  }
+  if (async) {
+    // The queued messages must be written before the process exits.
+    std::call_once(registered, [] { std::atexit(&stop_async_sink_at_exit); });
+    state.async_sink = boost::make_shared<AsyncSink>(state.backend);
+    set_format(*state.async_sink, state.use_colors);
+    boost::log::core::get()->remove_sink(state.sync_sink);
+    boost::log::core::get()->add_sink(state.async_sink);
+  } else {
+    stop_async_sink(state);
+    boost::log::core::get()->add_sink(state.sync_sink);
+  }
+}
+
+void logger_flush_sink() {
+  SinkState& state = sinkState();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  if (state.async_sink) {
+    state.async_sink->flush();
   }
 }
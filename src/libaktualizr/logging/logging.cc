@@ -7,9 +7,11 @@
 
 using boost::log::trivial::severity_level;
 
-static severity_level gLoggingThreshold;  // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+std::atomic<int> gLoggingThreshold{0};  // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
 
 extern void logger_init_sink(bool use_colors = false);
+extern void logger_set_async_sink(bool async);
+extern void logger_flush_sink();
 
 int64_t get_curlopt_verbose() { return gLoggingThreshold <= boost::log::trivial::trace ? 1L : 0L; }
 
@@ -18,12 +20,12 @@ void logger_init(bool use_colors) {
 
   logger_init_sink(use_colors);
 
-  boost::log::core::get()->set_filter(boost::log::trivial::severity >= gLoggingThreshold);
+  boost::log::core::get()->set_filter(boost::log::trivial::severity >= boost::log::trivial::info);
 }
 
 void logger_set_threshold(const severity_level threshold) {
   gLoggingThreshold = threshold;
-  boost::log::core::get()->set_filter(boost::log::trivial::severity >= gLoggingThreshold);
+  boost::log::core::get()->set_filter(boost::log::trivial::severity >= threshold);
 }
 
 void logger_set_threshold(const LoggerConfig& lconfig) {
@@ -39,8 +41,12 @@ void logger_set_threshold(const LoggerConfig& lconfig) {
   logger_set_threshold(static_cast<boost::log::trivial::severity_level>(loglevel));
 }
 
+void logger_set_async(bool async) { logger_set_async_sink(async); }
+
+void logger_flush() { logger_flush_sink(); }
+
 void logger_set_enable(bool enabled) { boost::log::core::get()->set_logging_enabled(enabled); }
 
-int loggerGetSeverity() { return static_cast<int>(gLoggingThreshold); }
+int loggerGetSeverity() { return gLoggingThreshold; }
 
 // vim: set tabstop=2 shiftwidth=2 expandtab:
@@ -2,28 +2,93 @@
 #define SOTA_CLIENT_TOOLS_LOGGING_H_
 
 #include <boost/log/trivial.hpp>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <string>
 
 struct LoggerConfig;
 
+/** Messages below this level are removed at compile time. 0-5 (trace, debug,
+ * info, warning, error, fatal), set with the AKTUALIZR_LOG_MIN_LEVEL CMake
+ * option. */
+#ifndef AKTUALIZR_LOG_MIN_LEVEL
+#define AKTUALIZR_LOG_MIN_LEVEL 0
+#endif
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+extern std::atomic<int> gLoggingThreshold;
+
+/** Whether a message of this severity would be logged. A constant severity
+ * below AKTUALIZR_LOG_MIN_LEVEL folds to false, otherwise this is a single
+ * relaxed load, much cheaper than the filter of the logging core. */
+inline bool logger_should_log(boost::log::trivial::severity_level severity) {
+  return static_cast<int>(severity) >= AKTUALIZR_LOG_MIN_LEVEL &&
+         static_cast<int>(severity) >= gLoggingThreshold.load(std::memory_order_relaxed);
+}
+
+// The arguments of a message that is not logged are never evaluated.
+#define AKTUALIZR_LOG(lvl)                            \
+  if (!logger_should_log(boost::log::trivial::lvl)) { \
+  } else                                              \
+    BOOST_LOG_TRIVIAL(lvl)
+
 /** Log an unrecoverable error */
-#define LOG_FATAL BOOST_LOG_TRIVIAL(fatal)
+#define LOG_FATAL AKTUALIZR_LOG(fatal)
 
 /** Log that something has definitely gone wrong */
-#define LOG_ERROR BOOST_LOG_TRIVIAL(error)
+#define LOG_ERROR AKTUALIZR_LOG(error)
 
 /** Warn about behaviour that is probably bad, but hasn't yet caused the system
  * to operate out of spec. */
-#define LOG_WARNING BOOST_LOG_TRIVIAL(warning)
+#define LOG_WARNING AKTUALIZR_LOG(warning)
 
 /** Report a user-visible message about operation */
-#define LOG_INFO BOOST_LOG_TRIVIAL(info)
+#define LOG_INFO AKTUALIZR_LOG(info)
 
 /** Report a message for developer debugging */
-#define LOG_DEBUG BOOST_LOG_TRIVIAL(debug)
+#define LOG_DEBUG AKTUALIZR_LOG(debug)
 
 /** Report very-verbose debugging information */
-#define LOG_TRACE BOOST_LOG_TRIVIAL(trace)
+#define LOG_TRACE AKTUALIZR_LOG(trace)
+
+/**
+ * Lets at most one message per interval through. Each call site of
+ * LOG_RATE_LIMITED has its own limiter.
+ */
+class LogRateLimiter {
+ public:
+  explicit LogRateLimiter(std::chrono::milliseconds interval) : interval_(interval.count()) {}
+  bool allow() {
+    const int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            std::chrono::steady_clock::now().time_since_epoch())
+                            .count();
+    int64_t next = next_.load(std::memory_order_relaxed);
+    if (now < next || !next_.compare_exchange_strong(next, now + interval_, std::memory_order_relaxed)) {
+      suppressed_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    return true;
+  }
+  /** Mentions the messages suppressed since the previous one that was let through. */
+  std::string suppressedNote() {
+    const uint64_t suppressed = suppressed_.exchange(0, std::memory_order_relaxed);
+    return suppressed == 0 ? std::string() : "(" + std::to_string(suppressed) + " similar messages suppressed) ";
+  }
+
+ private:
+  const int64_t interval_;
+  std::atomic<int64_t> next_{0};
+  std::atomic<uint64_t> suppressed_{0};
+};
+
+// Use like:
+// LOG_RATE_LIMITED(debug, std::chrono::seconds(1)) << "Received " << size << " bytes";
+#define LOG_RATE_LIMITED(lvl, interval)                                             \
+  if (static LogRateLimiter log_rate_limiter_(interval);                            \
+      !logger_should_log(boost::log::trivial::lvl) || !log_rate_limiter_.allow()) { \
+  } else                                                                            \
+    BOOST_LOG_TRIVIAL(lvl) << log_rate_limiter_.suppressedNote()
 
 // Use like:
 // curl_easy_setopt(curl_handle, CURLOPT_VERBOSE, get_curlopt_verbose());
@@ -35,6 +100,13 @@ void logger_set_threshold(boost::log::trivial::severity_level threshold);
 
 void logger_set_threshold(const LoggerConfig& lconfig);
 
+/** Format and write the messages in a background thread instead of the
+ * calling one. Messages that do not fit in the queue are dropped. */
+void logger_set_async(bool async);
+
+/** Wait until the queued messages are written. */
+void logger_flush();
+
 void logger_set_enable(bool enabled);
 
 int loggerGetSeverity();
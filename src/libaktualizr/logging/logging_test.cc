@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "logging/logging.h"
+
+// Captures what the console sink writes to stdout.
+class LogCapture {
+ public:
+  LogCapture() : old_(std::cout.rdbuf(buffer_.rdbuf())) {}
+  ~LogCapture() { std::cout.rdbuf(old_); }
+  LogCapture(const LogCapture&) = delete;
+  LogCapture& operator=(const LogCapture&) = delete;
+  std::string str() {
+    logger_flush();
+    return buffer_.str();
+  }
+
+ private:
+  std::stringstream buffer_;
+  std::streambuf* old_;
+};
+
+static std::string expensive(int& calls) {
+  ++calls;
+  return "expensive";
+}
+
+/* The arguments of messages below the threshold are not evaluated. */
+TEST(Logging, LazyArguments) {
+  LogCapture capture;
+  logger_set_threshold(boost::log::trivial::info);
+  int calls = 0;
+  LOG_DEBUG << expensive(calls);
+  EXPECT_EQ(calls, 0);
+  LOG_INFO << expensive(calls);
+  EXPECT_EQ(calls, 1);
+  EXPECT_EQ(capture.str(), "expensive\n");
+}
+
+static void logChunk(int i) { LOG_RATE_LIMITED(debug, std::chrono::milliseconds(100)) << "chunk " << i; }
+
+/* A rate limited call site lets one message per interval through and reports
+ * how many were suppressed. */
+TEST(Logging, RateLimited) {
+  LogCapture capture;
+  logger_set_threshold(boost::log::trivial::debug);
+  for (int i = 0; i < 3; ++i) {
+    logChunk(i);
+  }
+  LOG_RATE_LIMITED(debug, std::chrono::milliseconds(100)) << "other call site";
+  std::this_thread::sleep_for(std::chrono::milliseconds(150));
+  logChunk(3);
+  logChunk(4);
+  EXPECT_EQ(capture.str(), "chunk 0\nother call site\n(2 similar messages suppressed) chunk 3\n");
+}
+
+/* The suppressed messages are counted on the next one let through. */
+TEST(Logging, RateLimiterSuppressedNote) {
+  LogRateLimiter limiter(std::chrono::milliseconds(0));
+  EXPECT_TRUE(limiter.allow());
+  EXPECT_EQ(limiter.suppressedNote(), "");
+  LogRateLimiter slow(std::chrono::hours(1));
+  EXPECT_TRUE(slow.allow());
+  EXPECT_FALSE(slow.allow());
+  EXPECT_FALSE(slow.allow());
+  EXPECT_EQ(slow.suppressedNote(), "(2 similar messages suppressed) ");
+  EXPECT_EQ(slow.suppressedNote(), "");
+}
+
+/* Messages written in the background come out complete and in order. */
+TEST(Logging, Async) {
+  LogCapture capture;
+  logger_set_threshold(boost::log::trivial::info);
+  logger_set_async(true);
+  std::string expected;
+  for (int i = 0; i < 100; ++i) {
+    LOG_INFO << "message " << i;
+    expected += "message " + std::to_string(i) + "\n";
+  }
+  EXPECT_EQ(capture.str(), expected);
+  logger_set_async(false);
+  LOG_INFO << "synchronous";
+  EXPECT_EQ(capture.str(), expected + "synchronous\n");
+}
+
+#ifndef __NO_MAIN__
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  logger_init();
+  return RUN_ALL_TESTS();
+}
+#endif
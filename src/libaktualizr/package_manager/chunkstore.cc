@@ -0,0 +1,342 @@
+#include "package_manager/chunkstore.h"
+
+#include <array>
+#include <fstream>
+
+#include <boost/algorithm/string/case_conv.hpp>
+
+#include "crypto/crypto.h"
+#include "logging/logging.h"
+#include "utilities/utils.h"
+
+namespace {
+
+constexpr size_t kReadSize = 64 * 1024;
+
+// Random values for the gear hash. They are part of the chunking scheme: a
+// different table gives different chunk boundaries.
+const std::array<uint64_t, 256> &gearTable() {
+  static const std::array<uint64_t, 256> table = [] {
+    std::array<uint64_t, 256> t{};
+    uint64_t state = 0x6a09e667f3bcc908ULL;
+    for (auto &v : t) {
+      // splitmix64
+      state += 0x9e3779b97f4a7c15ULL;
+      uint64_t z = state;
+      z = (z ^ (z >> 30U)) * 0xbf58476d1ce4e5b9ULL;
+      z = (z ^ (z >> 27U)) * 0x94d049bb133111ebULL;
+      v = z ^ (z >> 31U);
+    }
+    return t;
+  }();
+  return table;
+}
+
+// Mask with the `bits` highest bits set. The high bits of the gear hash depend
+// on the last 64 bytes, the low bits only on the last few.
+uint64_t highMask(unsigned int bits) { return bits == 0 ? 0 : ~uint64_t{0} << (64U - bits); }
+
+unsigned int log2(size_t v) {
+  unsigned int bits = 0;
+  while (v > 1) {
+    v >>= 1U;
+    ++bits;
+  }
+  return bits;
+}
+
+std::string sha256Hex(const uint8_t *data, size_t size) {
+  MultiPartSHA256Hasher hasher;
+  hasher.update(data, size);
+  return hasher.getHexDigest();
+}
+
+// The hashes end up in file paths, so anything but a sha256 digest in the
+// expected case is rejected. Target metadata has lower case digests, indexes
+// the upper case ones they are stored under.
+bool isDigest(const std::string &hash, const char *digits) {
+  return hash.size() == 64 && hash.find_first_not_of(digits) == std::string::npos;
+}
+
+ChunkList parseChunks(const Json::Value &json, const char *digits) {
+  ChunkList chunks;
+  if (!json.isArray()) {
+    return chunks;
+  }
+  for (const auto &c : json) {
+    if (!c["sha256"].isString() || !isDigest(c["sha256"].asString(), digits) || !c["length"].isUInt64() ||
+        c["length"].asUInt64() == 0) {
+      return ChunkList();
+    }
+    chunks.emplace_back(boost::algorithm::to_upper_copy(c["sha256"].asString()), c["length"].asUInt64());
+  }
+  return chunks;
+}
+
+constexpr const char *kLowerDigits = "0123456789abcdef";
+constexpr const char *kUpperDigits = "0123456789ABCDEF";
+
+}  // namespace
+
+ContentChunker::ContentChunker(size_t min_size, size_t avg_size, size_t max_size)
+    : min_size_(min_size), avg_size_(avg_size), max_size_(max_size) {
+  if (min_size_ == 0 || min_size_ > avg_size_ || avg_size_ > max_size_) {
+    throw std::invalid_argument("Invalid chunk sizes");
+  }
+  // Normalized chunking: cutting is harder below the average size and easier
+  // above it, which narrows the distribution of chunk sizes.
+  const unsigned int bits = log2(avg_size_);
+  mask_small_ = highMask(bits + 1);
+  mask_large_ = highMask(bits > 0 ? bits - 1 : 0);
+}
+
+void ContentChunker::update(const uint8_t *data, size_t size, const Writer &out) {
+  const auto &gear = gearTable();
+  size_t start = 0;
+  for (size_t i = 0; i < size; ++i) {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    hash_ = (hash_ << 1U) + gear[data[i]];
+    const size_t len = buffer_.size() + (i + 1 - start);
+    if (len < min_size_) {
+      continue;
+    }
+    const uint64_t mask = len < avg_size_ ? mask_small_ : mask_large_;
+    if ((hash_ & mask) == 0 || len >= max_size_) {
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+      buffer_.insert(buffer_.end(), data + start, data + i + 1);
+      out(buffer_.data(), buffer_.size());
+      buffer_.clear();
+      hash_ = 0;
+      start = i + 1;
+    }
+  }
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  buffer_.insert(buffer_.end(), data + start, data + size);
+}
+
+void ContentChunker::finish(const Writer &out) {
+  if (!buffer_.empty()) {
+    out(buffer_.data(), buffer_.size());
+    buffer_.clear();
+  }
+  hash_ = 0;
+}
+
+ChunkStore::ChunkStore(boost::filesystem::path root, size_t min_size, size_t avg_size, size_t max_size)
+    : root_(std::move(root)), min_size_(min_size), avg_size_(avg_size), max_size_(max_size) {
+  boost::filesystem::create_directories(root_ / "objects");
+  boost::filesystem::create_directories(root_ / "index");
+}
+
+ChunkList ChunkStore::fromTarget(const Uptane::Target &target) {
+  const Json::Value custom = target.custom_data();
+  if (!custom.isObject() || !custom.isMember("chunks")) {
+    return ChunkList();
+  }
+  ChunkList chunks = parseChunks(custom["chunks"], kLowerDigits);
+  if (chunks.empty() || length(chunks) != target.length()) {
+    LOG_WARNING << "Ignoring malformed chunk list for target " << target.filename();
+    return ChunkList();
+  }
+  return chunks;
+}
+
+Json::Value ChunkStore::toJson(const ChunkList &chunks) {
+  Json::Value json(Json::arrayValue);
+  for (const auto &c : chunks) {
+    Json::Value chunk;
+    chunk["sha256"] = c.hash;
+    chunk["length"] = Json::UInt64(c.length);
+    json.append(chunk);
+  }
+  return json;
+}
+
+uint64_t ChunkStore::length(const ChunkList &chunks) {
+  uint64_t total = 0;
+  for (const auto &c : chunks) {
+    total += c.length;
+  }
+  return total;
+}
+
+ChunkList ChunkStore::addFile(const std::string &name, const boost::filesystem::path &file) {
+  std::ifstream stream(file.string(), std::ios::binary);
+  if (!stream.good()) {
+    throw std::runtime_error("Can't open file " + file.string());
+  }
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  ChunkList chunks;
+  auto store = [this, &chunks](const uint8_t *data, size_t size) {
+    chunks.emplace_back(sha256Hex(data, size), size);
+    if (!boost::filesystem::exists(chunkPath(chunks.back().hash))) {
+      storeChunk(chunks.back(), data, size);
+    }
+  };
+  ContentChunker chunker(min_size_, avg_size_, max_size_);
+  std::vector<uint8_t> buf(kReadSize);
+  do {
+    stream.read(reinterpret_cast<char *>(buf.data()), static_cast<std::streamsize>(buf.size()));
+    chunker.update(buf.data(), static_cast<size_t>(stream.gcount()), store);
+  } while (stream.gcount() != 0);
+  if (stream.bad()) {
+    throw std::runtime_error("Error reading file " + file.string());
+  }
+  chunker.finish(store);
+
+  const std::string index = Utils::jsonToCanonicalStr(toJson(chunks));
+  Utils::writeFile(indexPath(name), index.c_str(), index.size());
+  return chunks;
+}
+
+void ChunkStore::addChunk(const ImageChunk &chunk, const uint8_t *data, size_t size) {
+  if (size != chunk.length || sha256Hex(data, size) != chunk.hash) {
+    throw std::runtime_error("Chunk " + chunk.hash + " does not match its content");
+  }
+  std::lock_guard<std::mutex> guard(mutex_);
+  storeChunk(chunk, data, size);
+  pinned_.insert(chunk.hash);
+}
+
+bool ChunkStore::hasChunk(const ImageChunk &chunk) const {
+  boost::system::error_code ec;
+  const uintmax_t size = boost::filesystem::file_size(chunkPath(chunk.hash), ec);
+  return !ec && size == chunk.length;
+}
+
+void ChunkStore::writeIndex(const std::string &name, const ChunkList &chunks) {
+  const std::string index = Utils::jsonToCanonicalStr(toJson(chunks));
+  std::lock_guard<std::mutex> guard(mutex_);
+  Utils::writeFile(indexPath(name), index.c_str(), index.size());
+  for (const auto &c : chunks) {
+    pinned_.erase(c.hash);
+  }
+}
+
+boost::optional<ChunkList> ChunkStore::readIndex(const std::string &name) const {
+  const boost::filesystem::path path = indexPath(name);
+  if (!boost::filesystem::exists(path)) {
+    return boost::none;
+  }
+  ChunkList chunks = parseChunks(Utils::parseJSONFile(path), kUpperDigits);
+  if (chunks.empty()) {
+    LOG_WARNING << "Chunk index " << path << " is corrupted";
+    return boost::none;
+  }
+  return chunks;
+}
+
+void ChunkStore::removeIndex(const std::string &name) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  boost::filesystem::remove(indexPath(name));
+}
+
+size_t ChunkStore::removeDamaged(const ChunkList &chunks) {
+  size_t removed = 0;
+  for (const auto &c : chunks) {
+    const boost::filesystem::path path = chunkPath(c.hash);
+    if (!boost::filesystem::exists(path)) {
+      continue;
+    }
+    MultiPartSHA256Hasher hasher;
+    try {
+      read({c}, [&hasher](const uint8_t *data, size_t size) { hasher.update(data, size); });
+      if (hasher.getHexDigest() == c.hash && boost::filesystem::file_size(path) == c.length) {
+        continue;
+      }
+    } catch (const std::runtime_error &e) {
+      LOG_DEBUG << e.what();
+    }
+    LOG_WARNING << "Removing damaged chunk " << c.hash;
+    std::lock_guard<std::mutex> guard(mutex_);
+    boost::filesystem::remove(path);
+    ++removed;
+  }
+  return removed;
+}
+
+void ChunkStore::read(const ChunkList &chunks, const Writer &out) const {
+  std::vector<uint8_t> buf(kReadSize);
+  for (const auto &c : chunks) {
+    const boost::filesystem::path path = chunkPath(c.hash);
+    std::ifstream stream(path.string(), std::ios::binary);
+    if (!stream.good()) {
+      throw std::runtime_error("Chunk " + c.hash + " is missing");
+    }
+    uint64_t remaining = c.length;
+    while (remaining > 0) {
+      const auto len = static_cast<std::streamsize>(std::min<uint64_t>(remaining, buf.size()));
+      stream.read(reinterpret_cast<char *>(buf.data()), len);
+      if (stream.gcount() != len) {
+        throw std::runtime_error("Chunk " + c.hash + " is truncated");
+      }
+      out(buf.data(), static_cast<size_t>(len));
+      remaining -= static_cast<uint64_t>(len);
+    }
+  }
+}
+
+ChunkStreamBuf::int_type ChunkStreamBuf::underflow() {
+  while (gptr() == egptr()) {
+    if (next_ == chunks_.size()) {
+      return traits_type::eof();
+    }
+    setg(nullptr, nullptr, nullptr);
+    buf_.clear();
+    store_->read({chunks_[next_]}, [this](const uint8_t *data, size_t size) {
+      const auto *begin = reinterpret_cast<const char *>(data);
+      buf_.insert(buf_.end(), begin, begin + size);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    });
+    ++next_;
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    setg(buf_.data(), buf_.data(), buf_.data() + buf_.size());
+  }
+  return traits_type::to_int_type(*gptr());
+}
+
+uint64_t ChunkStore::collectGarbage() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  std::set<std::string> referenced = pinned_;
+  for (const auto &entry : boost::filesystem::directory_iterator(root_ / "index")) {
+    // Leftovers of interrupted writes, see Utils::writeFile().
+    if (entry.path().extension() == ".new") {
+      boost::filesystem::remove(entry.path());
+      continue;
+    }
+    const ChunkList chunks = parseChunks(Utils::parseJSONFile(entry.path()), kUpperDigits);
+    if (chunks.empty()) {
+      // Better to leak some chunks than to lose data because of a bad index.
+      LOG_WARNING << "Chunk index " << entry.path() << " is corrupted, skipping garbage collection";
+      return 0;
+    }
+    for (const auto &c : chunks) {
+      referenced.insert(c.hash);
+    }
+  }
+
+  std::vector<boost::filesystem::path> garbage;
+  for (const auto &entry : boost::filesystem::recursive_directory_iterator(root_ / "objects")) {
+    if (boost::filesystem::is_regular_file(entry.path()) &&
+        referenced.count(entry.path().filename().string()) == 0) {
+      garbage.push_back(entry.path());
+    }
+  }
+  uint64_t freed = 0;
+  for (const auto &path : garbage) {
+    freed += boost::filesystem::file_size(path);
+    boost::filesystem::remove(path);
+  }
+  LOG_DEBUG << "Chunk store garbage collection freed " << freed << " bytes";
+  return freed;
+}
+
+boost::filesystem::path ChunkStore::chunkPath(const std::string &hash) const {
+  return root_ / "objects" / hash.substr(0, 2) / hash;
+}
+
+void ChunkStore::storeChunk(const ImageChunk &chunk, const uint8_t *data, size_t size) {
+  const boost::filesystem::path path = chunkPath(chunk.hash);
+  boost::filesystem::create_directories(path.parent_path());
+  Utils::writeFile(path, reinterpret_cast<const char *>(data), size);
+}
@@ -0,0 +1,153 @@
+#ifndef PACKAGE_MANAGER_CHUNKSTORE_H_
+#define PACKAGE_MANAGER_CHUNKSTORE_H_
+
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/optional.hpp>
+
+#include "libaktualizr/types.h"
+
+/** A piece of a Target image, identified by the sha256 of its content. */
+struct ImageChunk {
+  ImageChunk(std::string hash_in, uint64_t length_in) : hash(std::move(hash_in)), length(length_in) {}
+  std::string hash;  // upper case hexadecimal sha256
+  uint64_t length;
+
+  bool operator==(const ImageChunk &other) const { return hash == other.hash && length == other.length; }
+};
+
+using ChunkList = std::vector<ImageChunk>;
+
+/**
+ * Splits a byte stream into content-defined chunks with a gear rolling hash,
+ * as in FastCDC. A boundary only depends on the bytes right before it, so an
+ * insertion or a deletion only changes the chunks around it and successive
+ * builds of an image share most of their chunks.
+ */
+class ContentChunker {
+ public:
+  using Writer = std::function<void(const uint8_t *data, size_t size)>;
+
+  ContentChunker(size_t min_size, size_t avg_size, size_t max_size);
+
+  /** Pass data through the chunker. `out` is called for every completed chunk. */
+  void update(const uint8_t *data, size_t size, const Writer &out);
+  /** Flush the last chunk, if any. */
+  void finish(const Writer &out);
+
+ private:
+  size_t min_size_;
+  size_t avg_size_;
+  size_t max_size_;
+  uint64_t mask_small_;
+  uint64_t mask_large_;
+  uint64_t hash_{0};
+  std::vector<uint8_t> buffer_;
+};
+
+/**
+ * Content-addressed storage for binary Targets. Every chunk is stored once in
+ * `<root>/objects`, no matter how many Targets contain it. Each stored Target
+ * has an index in `<root>/index` which lists its chunks in order; chunks that
+ * no index refers to any more are removed by collectGarbage().
+ *
+ * The chunk boundaries of a Target can also be offered in its custom metadata,
+ * in the same format as the indices:
+ *
+ *   "chunks": [{"sha256": "...", "length": 1234}, ...]
+ *
+ * so that only the chunks which are not stored yet have to be downloaded.
+ */
+class ChunkStore {
+ public:
+  using Writer = std::function<void(const uint8_t *data, size_t size)>;
+
+  static constexpr size_t kMinChunkSize = 16 * 1024;
+  static constexpr size_t kAvgChunkSize = 64 * 1024;
+  static constexpr size_t kMaxChunkSize = 256 * 1024;
+
+  explicit ChunkStore(boost::filesystem::path root, size_t min_size = kMinChunkSize,
+                      size_t avg_size = kAvgChunkSize, size_t max_size = kMaxChunkSize);
+
+  /** The chunks listed in the custom metadata of the Target, or nothing if they are missing or malformed. */
+  static ChunkList fromTarget(const Uptane::Target &target);
+  static Json::Value toJson(const ChunkList &chunks);
+  static uint64_t length(const ChunkList &chunks);
+
+  /** Split a file into chunks, store the new ones and write the index `name`. */
+  ChunkList addFile(const std::string &name, const boost::filesystem::path &file);
+  /**
+   * Store a single chunk. Throws std::runtime_error if the data does not match
+   * the chunk. The chunk is protected from garbage collection until an index
+   * that refers to it is written.
+   */
+  void addChunk(const ImageChunk &chunk, const uint8_t *data, size_t size);
+  bool hasChunk(const ImageChunk &chunk) const;
+
+  void writeIndex(const std::string &name, const ChunkList &chunks);
+  boost::optional<ChunkList> readIndex(const std::string &name) const;
+  boost::filesystem::path indexPath(const std::string &name) const { return root_ / "index" / name; }
+  void removeIndex(const std::string &name);
+
+  /** Remove the chunks whose content does not match their hash. Returns the number of chunks removed. */
+  size_t removeDamaged(const ChunkList &chunks);
+
+  /** Pass the content of the chunks to `out` in order. */
+  void read(const ChunkList &chunks, const Writer &out) const;
+
+  /** Remove all chunks that no index refers to. Returns the number of bytes freed. */
+  uint64_t collectGarbage();
+
+ private:
+  boost::filesystem::path chunkPath(const std::string &hash) const;
+  void storeChunk(const ImageChunk &chunk, const uint8_t *data, size_t size);
+
+  boost::filesystem::path root_;
+  size_t min_size_;
+  size_t avg_size_;
+  size_t max_size_;
+  // Chunks that are stored but not referenced by an index yet.
+  std::set<std::string> pinned_;
+  mutable std::mutex mutex_;
+};
+
+/**
+ * Reads a Target from the chunk store one chunk at a time, so that only the
+ * chunk that is being read is held in memory. A missing or damaged chunk makes
+ * the stream fail.
+ */
+class ChunkStreamBuf : public std::streambuf {
+ public:
+  ChunkStreamBuf(std::shared_ptr<const ChunkStore> store, ChunkList chunks)
+      : store_(std::move(store)), chunks_(std::move(chunks)) {}
+
+ protected:
+  int_type underflow() override;
+
+ private:
+  std::shared_ptr<const ChunkStore> store_;
+  ChunkList chunks_;
+  size_t next_{0};
+  std::vector<char> buf_;
+};
+
+class ChunkStream : public std::istream {
+ public:
+  ChunkStream(std::shared_ptr<const ChunkStore> store, ChunkList chunks)
+      : std::istream(nullptr), buf_(std::move(store), std::move(chunks)) {
+    rdbuf(&buf_);
+  }
+
+ private:
+  ChunkStreamBuf buf_;
+};
+
+#endif  // PACKAGE_MANAGER_CHUNKSTORE_H_
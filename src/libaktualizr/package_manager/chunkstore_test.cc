@@ -0,0 +1,219 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "libaktualizr/types.h"
+#include "package_manager/chunkstore.h"
+#include "utilities/utils.h"
+
+static constexpr size_t kMin = 1024;
+static constexpr size_t kAvg = 4096;
+static constexpr size_t kMax = 16384;
+
+static std::string randomData(size_t size, unsigned int seed) {
+  std::mt19937 gen(seed);
+  std::uniform_int_distribution<int> dist(0, 255);
+  std::string data(size, '\0');
+  for (auto& c : data) {
+    c = static_cast<char>(dist(gen));
+  }
+  return data;
+}
+
+static std::vector<std::string> split(const std::string& data, size_t feed_size) {
+  std::vector<std::string> chunks;
+  ContentChunker chunker(kMin, kAvg, kMax);
+  auto out = [&chunks](const uint8_t* d, size_t size) { chunks.emplace_back(reinterpret_cast<const char*>(d), size); };
+  for (size_t pos = 0; pos < data.size(); pos += feed_size) {
+    const std::string part = data.substr(pos, feed_size);
+    chunker.update(reinterpret_cast<const uint8_t*>(part.data()), part.size(), out);
+  }
+  chunker.finish(out);
+  return chunks;
+}
+
+static std::string readAll(const ChunkStore& store, const ChunkList& chunks) {
+  std::string out;
+  store.read(chunks,
+             [&out](const uint8_t* data, size_t size) { out.append(reinterpret_cast<const char*>(data), size); });
+  return out;
+}
+
+static size_t countObjects(const boost::filesystem::path& root) {
+  size_t n = 0;
+  for (const auto& entry : boost::filesystem::recursive_directory_iterator(root / "objects")) {
+    if (boost::filesystem::is_regular_file(entry.path())) {
+      ++n;
+    }
+  }
+  return n;
+}
+
+/* Chunk boundaries do not depend on how the data is fed and chunk sizes stay
+ * within the limits. */
+TEST(ContentChunker, Boundaries) {
+  const std::string data = randomData(300000, 1);
+  const auto chunks = split(data, 65536);
+  EXPECT_EQ(split(data, 1000), chunks);
+  EXPECT_GT(chunks.size(), 30);
+
+  std::string joined;
+  for (size_t i = 0; i < chunks.size(); ++i) {
+    joined += chunks[i];
+    EXPECT_LE(chunks[i].size(), kMax);
+    if (i + 1 < chunks.size()) {
+      EXPECT_GE(chunks[i].size(), kMin);
+    }
+  }
+  EXPECT_EQ(joined, data);
+}
+
+/* An insertion only changes the chunks around it. */
+TEST(ContentChunker, Insertion) {
+  const std::string data = randomData(300000, 2);
+  std::string modified = data;
+  modified.insert(150000, "some inserted bytes");
+
+  const auto before = split(data, 65536);
+  const auto after = split(modified, 65536);
+  const std::set<std::string> known(before.begin(), before.end());
+  size_t changed = 0;
+  for (const auto& c : after) {
+    changed += known.count(c) == 0 ? 1 : 0;
+  }
+  EXPECT_LE(changed, 3);
+}
+
+/* Identical content is stored once and Targets are reassembled from their index. */
+TEST(ChunkStore, Deduplication) {
+  TemporaryDirectory temp_dir;
+  ChunkStore store(temp_dir / "chunks", kMin, kAvg, kMax);
+  const std::string data = randomData(200000, 3);
+  std::string modified = data;
+  modified.replace(100000, 10, "0123456789");
+  Utils::writeFile(temp_dir / "a", data);
+  Utils::writeFile(temp_dir / "b", modified);
+
+  const ChunkList a = store.addFile("A", temp_dir / "a");
+  const size_t objects = countObjects(temp_dir / "chunks");
+  EXPECT_EQ(objects, a.size());
+  EXPECT_EQ(ChunkStore::length(a), data.size());
+
+  const ChunkList b = store.addFile("B", temp_dir / "b");
+  EXPECT_LE(countObjects(temp_dir / "chunks"), objects + 2);
+
+  EXPECT_EQ(*store.readIndex("A"), a);
+  EXPECT_EQ(readAll(store, *store.readIndex("B")), modified);
+  EXPECT_FALSE(store.readIndex("C"));
+}
+
+/* Only chunks that no index refers to are garbage collected. */
+TEST(ChunkStore, GarbageCollection) {
+  TemporaryDirectory temp_dir;
+  ChunkStore store(temp_dir / "chunks", kMin, kAvg, kMax);
+  const std::string data = randomData(100000, 4);
+  Utils::writeFile(temp_dir / "a", data);
+  Utils::writeFile(temp_dir / "b", data + randomData(50000, 5));
+  const ChunkList a = store.addFile("A", temp_dir / "a");
+  store.addFile("B", temp_dir / "b");
+
+  store.removeIndex("B");
+  EXPECT_GT(store.collectGarbage(), 0);
+  EXPECT_EQ(readAll(store, a), data);
+
+  // A chunk that was stored, but isn't referenced yet, survives.
+  const std::string extra = "pinned chunk";
+  const ImageChunk pinned(Hash::generate(Hash::Type::kSha256, extra).HashString(), extra.size());
+  store.addChunk(pinned, reinterpret_cast<const uint8_t*>(extra.data()), extra.size());
+  store.removeIndex("A");
+  EXPECT_EQ(store.collectGarbage(), data.size());
+  EXPECT_TRUE(store.hasChunk(pinned));
+
+  store.writeIndex("C", {pinned});
+  store.removeIndex("C");
+  EXPECT_EQ(store.collectGarbage(), extra.size());
+  EXPECT_EQ(countObjects(temp_dir / "chunks"), 0);
+}
+
+/* Chunks are checked against their hash when added and can be repaired. */
+TEST(ChunkStore, Damaged) {
+  TemporaryDirectory temp_dir;
+  ChunkStore store(temp_dir / "chunks", kMin, kAvg, kMax);
+  const std::string content = "chunk content";
+  const ImageChunk chunk(Hash::generate(Hash::Type::kSha256, content).HashString(), content.size());
+  const std::string bad = "chunk CONTENT";
+  EXPECT_THROW(store.addChunk(chunk, reinterpret_cast<const uint8_t*>(bad.data()), bad.size()), std::runtime_error);
+  EXPECT_FALSE(store.hasChunk(chunk));
+
+  store.addChunk(chunk, reinterpret_cast<const uint8_t*>(content.data()), content.size());
+  store.writeIndex("A", {chunk});
+  EXPECT_EQ(store.removeDamaged({chunk}), 0);
+  const auto path = temp_dir / "chunks/objects" / chunk.hash.substr(0, 2) / chunk.hash;
+  ASSERT_TRUE(boost::filesystem::exists(path));
+  Utils::writeFile(path, bad);
+  EXPECT_EQ(store.removeDamaged({chunk}), 1);
+  EXPECT_FALSE(store.hasChunk(chunk));
+  EXPECT_THROW(readAll(store, {chunk}), std::runtime_error);
+}
+
+/* Chunk lists are read from the custom Target metadata. */
+TEST(ChunkStore, FromTarget) {
+  const std::string hash_a(64, 'a');
+  const std::string hash_b(64, 'b');
+  Json::Value target_json;
+  target_json["hashes"]["sha256"] = "D9CD8155764C3543F10FAD8A480D743137466F8D55213C8EAEFCD12F06D43A80";
+  target_json["length"] = 3;
+  Json::Value chunk;
+  chunk["sha256"] = hash_a;
+  chunk["length"] = 1;
+  target_json["custom"]["chunks"].append(chunk);
+  chunk["sha256"] = hash_b;
+  chunk["length"] = 2;
+  target_json["custom"]["chunks"].append(chunk);
+
+  const ChunkList chunks = ChunkStore::fromTarget(Uptane::Target("aa.bin", target_json));
+  ASSERT_EQ(chunks.size(), 2);
+  EXPECT_EQ(chunks[0], ImageChunk(std::string(64, 'A'), 1));
+  EXPECT_EQ(chunks[1], ImageChunk(std::string(64, 'B'), 2));
+  EXPECT_EQ(ChunkStore::toJson(chunks)[1]["sha256"], std::string(64, 'B'));
+
+  // The chunks have to add up to the Target.
+  target_json["length"] = 4;
+  EXPECT_TRUE(ChunkStore::fromTarget(Uptane::Target("aa.bin", target_json)).empty());
+  target_json["length"] = 3;
+  target_json["custom"]["chunks"][0]["length"] = "1";
+  EXPECT_TRUE(ChunkStore::fromTarget(Uptane::Target("aa.bin", target_json)).empty());
+  EXPECT_TRUE(ChunkStore::fromTarget(Uptane::Target("aa.bin", Json::Value())).empty());
+}
+
+/* Hashes that aren't lower case sha256 digests fail the whole chunk list. */
+TEST(ChunkStore, MalformedHashes) {
+  Json::Value target_json;
+  target_json["hashes"]["sha256"] = "D9CD8155764C3543F10FAD8A480D743137466F8D55213C8EAEFCD12F06D43A80";
+  target_json["length"] = 3;
+  Json::Value chunk;
+  chunk["sha256"] = std::string(64, 'a');
+  chunk["length"] = 1;
+  target_json["custom"]["chunks"].append(chunk);
+  chunk["length"] = 2;
+  target_json["custom"]["chunks"].append(chunk);
+  ASSERT_EQ(ChunkStore::fromTarget(Uptane::Target("aa.bin", target_json)).size(), 2);
+
+  for (const std::string hash : {std::string("aa"), std::string(64, 'A'), std::string(65, 'a'),
+                                 "../../" + std::string(58, 'a'), std::string(63, 'a') + "g"}) {
+    target_json["custom"]["chunks"][1]["sha256"] = hash;
+    EXPECT_TRUE(ChunkStore::fromTarget(Uptane::Target("aa.bin", target_json)).empty()) << hash;
+  }
+}
+
+#ifndef __NO_MAIN__
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+#endif
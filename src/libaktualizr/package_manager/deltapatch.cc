@@ -0,0 +1,194 @@
+#include "package_manager/deltapatch.h"
+
+#include <archive.h>
+#include <archive_entry.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+
+#include "logging/logging.h"
+#include "utilities/utils.h"
+
+std::vector<DeltaTarget> DeltaTarget::fromTarget(const Uptane::Target &target) {
+  std::vector<DeltaTarget> deltas;
+  const Json::Value custom = target.custom_data();
+  if (!custom.isObject() || !custom["delta"].isArray()) {
+    return deltas;
+  }
+
+  for (const auto &d : custom["delta"]) {
+    if (!d["from"].isObject() || !d["hashes"].isObject() || !d["length"].isUInt64() || !d["uri"].isString()) {
+      LOG_WARNING << "Ignoring malformed delta for target " << target.filename();
+      continue;
+    }
+    std::vector<Hash> from;
+    std::vector<Hash> hashes;
+    for (auto i = d["from"].begin(); i != d["from"].end(); ++i) {
+      Hash h(i.key().asString(), (*i).asString());
+      if (h.HaveAlgorithm()) {
+        from.push_back(h);
+      }
+    }
+    for (auto i = d["hashes"].begin(); i != d["hashes"].end(); ++i) {
+      Hash h(i.key().asString(), (*i).asString());
+      if (h.HaveAlgorithm()) {
+        hashes.push_back(h);
+      }
+    }
+    if (from.empty() || hashes.empty()) {
+      LOG_WARNING << "Ignoring delta without supported hashes for target " << target.filename();
+      continue;
+    }
+    // sort hashes so that higher priority hash algorithm goes first
+    std::sort(from.begin(), from.end(), [](const Hash &l, const Hash &r) { return l.type() < r.type(); });
+    std::sort(hashes.begin(), hashes.end(), [](const Hash &l, const Hash &r) { return l.type() < r.type(); });
+    deltas.emplace_back(from[0], hashes, d["length"].asUInt64(), d["uri"].asString());
+  }
+  return deltas;
+}
+
+bool DeltaTarget::MatchHash(const Hash &hash) const {
+  return (std::find(hashes_.begin(), hashes_.end(), hash) != hashes_.end());
+}
+
+namespace {
+
+constexpr size_t kChunkSize = 64 * 1024;
+
+// bsdiff stores integers as sign-magnitude little endian.
+int64_t offtin(const uint8_t *buf) {
+  int64_t y = buf[7] & 0x7F;
+  for (int i = 6; i >= 0; --i) {
+    y = y * 256 + buf[i];  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  }
+  if ((buf[7] & 0x80) != 0) {
+    y = -y;
+  }
+  return y;
+}
+
+class PatchReader {
+ public:
+  explicit PatchReader(const boost::filesystem::path &path) : a_(archive_read_new(), archive_read_free) {
+    if (a_ == nullptr) {
+      throw std::runtime_error("archive error: could not initialize archive object");
+    }
+    archive_read_support_filter_all(a_.get());
+    archive_read_support_format_raw(a_.get());
+    if (archive_read_open_filename(a_.get(), path.c_str(), kChunkSize) != ARCHIVE_OK) {
+      throw std::runtime_error("Can't open delta " + path.string() + ": " + archive_error_string(a_.get()));
+    }
+    struct archive_entry *entry;
+    if (archive_read_next_header(a_.get(), &entry) != ARCHIVE_OK) {
+      throw std::runtime_error("Can't read delta " + path.string() + ": " + archive_error_string(a_.get()));
+    }
+  }
+
+  void read(uint8_t *buf, size_t len) {
+    while (len > 0) {
+      const ssize_t r = archive_read_data(a_.get(), buf, len);
+      if (r < 0) {
+        throw std::runtime_error(std::string("Error reading delta: ") + archive_error_string(a_.get()));
+      }
+      if (r == 0) {
+        throw std::runtime_error("Delta is truncated");
+      }
+      buf += r;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+      len -= static_cast<size_t>(r);
+    }
+  }
+
+ private:
+  StructGuardInt<struct archive> a_;
+};
+
+class BaseReader {
+ public:
+  explicit BaseReader(const boost::filesystem::path &path)
+      : stream_(path.string(), std::ios::binary), size_(static_cast<int64_t>(boost::filesystem::file_size(path))) {
+    if (!stream_.good()) {
+      throw std::runtime_error("Can't open file " + path.string());
+    }
+  }
+
+  // Bytes outside of the base image read as zero, as in bspatch.
+  void read(int64_t pos, uint8_t *buf, size_t len) {
+    std::memset(buf, 0, len);
+    const int64_t begin = std::max<int64_t>(pos, 0);
+    const int64_t end = std::min<int64_t>(pos + static_cast<int64_t>(len), size_);
+    if (begin >= end) {
+      return;
+    }
+    stream_.seekg(begin);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    stream_.read(reinterpret_cast<char *>(buf + (begin - pos)), end - begin);
+    if (!stream_.good()) {
+      throw std::runtime_error("Error reading the base image of a delta");
+    }
+  }
+
+ private:
+  std::ifstream stream_;
+  int64_t size_;
+};
+
+}  // namespace
+
+uint64_t DeltaPatch::apply(const boost::filesystem::path &base, const boost::filesystem::path &patch,
+                           const Writer &out) {
+  PatchReader patch_reader(patch);
+  BaseReader base_reader(base);
+
+  std::array<uint8_t, 24> header{};
+  patch_reader.read(header.data(), header.size());
+  if (std::memcmp(header.data(), kMagic, std::strlen(kMagic)) != 0) {
+    throw std::runtime_error("Delta is not a bsdiff patch");
+  }
+  const int64_t new_size = offtin(&header[16]);
+  if (new_size < 0) {
+    throw std::runtime_error("Delta is corrupted");
+  }
+
+  std::vector<uint8_t> diff(kChunkSize);
+  std::vector<uint8_t> old(kChunkSize);
+  int64_t old_pos = 0;
+  int64_t new_pos = 0;
+  while (new_pos < new_size) {
+    std::array<uint8_t, 24> ctrl_buf{};
+    patch_reader.read(ctrl_buf.data(), ctrl_buf.size());
+    const int64_t add_len = offtin(&ctrl_buf[0]);
+    const int64_t copy_len = offtin(&ctrl_buf[8]);
+    const int64_t seek_len = offtin(&ctrl_buf[16]);
+    if (add_len < 0 || copy_len < 0 || add_len > new_size - new_pos || copy_len > new_size - new_pos - add_len) {
+      throw std::runtime_error("Delta is corrupted");
+    }
+
+    // Add the diff bytes to the base image.
+    for (int64_t done = 0; done < add_len;) {
+      const auto len = static_cast<size_t>(std::min<int64_t>(add_len - done, kChunkSize));
+      patch_reader.read(diff.data(), len);
+      base_reader.read(old_pos + done, old.data(), len);
+      for (size_t i = 0; i < len; ++i) {
+        diff[i] = static_cast<uint8_t>(diff[i] + old[i]);
+      }
+      out(diff.data(), len);
+      done += static_cast<int64_t>(len);
+    }
+    new_pos += add_len;
+    old_pos += add_len;
+
+    // Copy the extra bytes as they are.
+    for (int64_t done = 0; done < copy_len;) {
+      const auto len = static_cast<size_t>(std::min<int64_t>(copy_len - done, kChunkSize));
+      patch_reader.read(diff.data(), len);
+      out(diff.data(), len);
+      done += static_cast<int64_t>(len);
+    }
+    new_pos += copy_len;
+    old_pos += seek_len;
+  }
+
+  return static_cast<uint64_t>(new_size);
+}
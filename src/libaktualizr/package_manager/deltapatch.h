@@ -0,0 +1,64 @@
+#ifndef PACKAGE_MANAGER_DELTAPATCH_H_
+#define PACKAGE_MANAGER_DELTAPATCH_H_
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "libaktualizr/types.h"
+
+/**
+ * A binary delta that turns the image with hash `from` into a Target image.
+ * Deltas are offered in the custom metadata of a Target:
+ *
+ *   "delta": [{"from": {"sha256": "..."}, "hashes": {"sha256": "..."}, "length": 1234, "uri": "https://..."}]
+ *
+ * `hashes` and `length` describe the delta file itself.
+ */
+class DeltaTarget {
+ public:
+  DeltaTarget(Hash from, std::vector<Hash> hashes, uint64_t length, std::string uri)
+      : from_(std::move(from)), hashes_(std::move(hashes)), length_(length), uri_(std::move(uri)) {}
+
+  /** All well-formed deltas offered for the Target. */
+  static std::vector<DeltaTarget> fromTarget(const Uptane::Target &target);
+
+  const Hash &from() const { return from_; }
+  const std::vector<Hash> &hashes() const { return hashes_; }
+  uint64_t length() const { return length_; }
+  std::string uri() const { return uri_; }
+  bool MatchHash(const Hash &hash) const;
+  /** Name of the delta file in a directory of images. */
+  std::string filename() const { return hashes_[0].HashString() + ".delta"; }
+
+ private:
+  Hash from_;
+  std::vector<Hash> hashes_;
+  uint64_t length_;
+  std::string uri_;
+};
+
+/**
+ * Applies bsdiff patches in the ENDSLEY/BSDIFF43 format. The patch may be
+ * compressed with any filter libarchive can read (zstd, xz, bzip2, gzip) or be
+ * stored uncompressed. Both the patch and the base image are streamed, so the
+ * memory use does not depend on the image size.
+ */
+class DeltaPatch {
+ public:
+  using Writer = std::function<void(const uint8_t *data, size_t size)>;
+
+  /**
+   * Reconstruct the new image from `base` and `patch` and pass it to `out` in
+   * order. Returns the size of the new image. Throws std::runtime_error if the
+   * patch is malformed or a file can not be read.
+   */
+  static uint64_t apply(const boost::filesystem::path &base, const boost::filesystem::path &patch, const Writer &out);
+
+  static constexpr const char *kMagic = "ENDSLEY/BSDIFF43";
+};
+
+#endif  // PACKAGE_MANAGER_DELTAPATCH_H_
@@ -0,0 +1,184 @@
+#include <gtest/gtest.h>
+
+#include <archive.h>
+#include <archive_entry.h>
+
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "libaktualizr/types.h"
+#include "package_manager/deltapatch.h"
+#include "utilities/utils.h"
+
+struct PatchBlock {
+  std::string diff;
+  std::string extra;
+  int64_t seek;
+};
+
+static std::string offtout(int64_t x) {
+  uint64_t y = x < 0 ? static_cast<uint64_t>(-x) : static_cast<uint64_t>(x);
+  std::string buf(8, '\0');
+  for (size_t i = 0; i < 8; ++i) {
+    buf[i] = static_cast<char>(y & 0xFF);
+    y >>= 8;
+  }
+  if (x < 0) {
+    buf[7] = static_cast<char>(buf[7] | 0x80);
+  }
+  return buf;
+}
+
+static std::string makePatch(int64_t new_size, const std::vector<PatchBlock>& blocks) {
+  std::string patch = std::string(DeltaPatch::kMagic) + offtout(new_size);
+  for (const auto& b : blocks) {
+    patch += offtout(static_cast<int64_t>(b.diff.size())) + offtout(static_cast<int64_t>(b.extra.size())) +
+             offtout(b.seek);
+    patch += b.diff + b.extra;
+  }
+  return patch;
+}
+
+// Patch that turns `base` into `image` with a single diff block and the rest as extra bytes.
+static std::string makeSimplePatch(const std::string& base, const std::string& image) {
+  const size_t common = std::min(base.size(), image.size());
+  std::string diff(common, '\0');
+  for (size_t i = 0; i < common; ++i) {
+    diff[i] = static_cast<char>(static_cast<uint8_t>(image[i]) - static_cast<uint8_t>(base[i]));
+  }
+  return makePatch(static_cast<int64_t>(image.size()), {{diff, image.substr(common), 0}});
+}
+
+static std::string applyPatch(const boost::filesystem::path& base, const boost::filesystem::path& patch) {
+  std::string out;
+  const uint64_t new_size = DeltaPatch::apply(
+      base, patch, [&out](const uint8_t* data, size_t size) { out.append(reinterpret_cast<const char*>(data), size); });
+  EXPECT_EQ(new_size, out.size());
+  return out;
+}
+
+/* Apply an uncompressed patch with diff and extra blocks. */
+TEST(DeltaPatch, Apply) {
+  TemporaryDirectory temp_dir;
+  const std::string base = "The quick brown fox jumps over the lazy dog";
+  const std::string image = "The quick brown cat jumps over the lazy dog, twice";
+  Utils::writeFile(temp_dir / "base", base);
+  Utils::writeFile(temp_dir / "patch", makeSimplePatch(base, image));
+
+  EXPECT_EQ(applyPatch(temp_dir / "base", temp_dir / "patch"), image);
+}
+
+/* Control blocks can seek back and forth in the base image. */
+TEST(DeltaPatch, Seek) {
+  TemporaryDirectory temp_dir;
+  Utils::writeFile(temp_dir / "base", std::string("0123456789"));
+  // Copy "56789" from offset 5, then "01234" from offset 0.
+  const std::string patch =
+      makePatch(10, {{"", "", 5}, {std::string(5, '\0'), "", -10}, {std::string(5, '\0'), "", 0}});
+  Utils::writeFile(temp_dir / "patch", patch);
+
+  EXPECT_EQ(applyPatch(temp_dir / "base", temp_dir / "patch"), "5678901234");
+}
+
+/* Images larger than the internal buffers are streamed in chunks. */
+TEST(DeltaPatch, LargeImage) {
+  TemporaryDirectory temp_dir;
+  std::string base = Utils::randomUuid();
+  while (base.size() < 300000) {
+    base += Utils::randomUuid();
+  }
+  std::string image = base;
+  image[1000] = 'x';
+  image[150000] = 'y';
+  image += "appended";
+  Utils::writeFile(temp_dir / "base", base);
+  Utils::writeFile(temp_dir / "patch", makeSimplePatch(base, image));
+
+  EXPECT_EQ(applyPatch(temp_dir / "base", temp_dir / "patch"), image);
+}
+
+/* Compressed patches are decompressed while they are applied. */
+TEST(DeltaPatch, Compressed) {
+  TemporaryDirectory temp_dir;
+  const std::string base = "firmware version 1";
+  const std::string image = "firmware version 2 with fixes";
+  Utils::writeFile(temp_dir / "base", base);
+  const std::string patch = makeSimplePatch(base, image);
+
+  const std::string patch_path = (temp_dir / "patch.gz").string();
+  StructGuardInt<struct archive> a(archive_write_new(), archive_write_free);
+  ASSERT_EQ(archive_write_add_filter_gzip(a.get()), ARCHIVE_OK);
+  ASSERT_EQ(archive_write_set_format_raw(a.get()), ARCHIVE_OK);
+  ASSERT_EQ(archive_write_open_filename(a.get(), patch_path.c_str()), ARCHIVE_OK);
+  StructGuard<struct archive_entry> entry(archive_entry_new(), archive_entry_free);
+  archive_entry_set_filetype(entry.get(), AE_IFREG);
+  archive_entry_set_pathname(entry.get(), "patch");
+  ASSERT_EQ(archive_write_header(a.get(), entry.get()), ARCHIVE_OK);
+  ASSERT_EQ(archive_write_data(a.get(), patch.data(), patch.size()), static_cast<ssize_t>(patch.size()));
+  ASSERT_EQ(archive_write_close(a.get()), ARCHIVE_OK);
+
+  EXPECT_EQ(applyPatch(temp_dir / "base", patch_path), image);
+}
+
+/* Malformed patches are rejected. */
+TEST(DeltaPatch, Malformed) {
+  TemporaryDirectory temp_dir;
+  const std::string base = "base image";
+  const std::string patch = makeSimplePatch(base, "new image!");
+  Utils::writeFile(temp_dir / "base", base);
+  auto discard = [](const uint8_t* data, size_t size) {
+    (void)data;
+    (void)size;
+  };
+
+  Utils::writeFile(temp_dir / "bad_magic", "BSDIFF40" + patch.substr(8));
+  EXPECT_THROW(DeltaPatch::apply(temp_dir / "base", temp_dir / "bad_magic", discard), std::runtime_error);
+
+  Utils::writeFile(temp_dir / "truncated", patch.substr(0, patch.size() - 3));
+  EXPECT_THROW(DeltaPatch::apply(temp_dir / "base", temp_dir / "truncated", discard), std::runtime_error);
+
+  // The control block claims more data than the new image holds.
+  Utils::writeFile(temp_dir / "overflow", makePatch(2, {{"abc", "", 0}}));
+  EXPECT_THROW(DeltaPatch::apply(temp_dir / "base", temp_dir / "overflow", discard), std::runtime_error);
+}
+
+/* Deltas are read from the custom Target metadata and malformed ones are skipped. */
+TEST(DeltaTarget, FromTarget) {
+  Json::Value target_json;
+  target_json["hashes"]["sha256"] = "D9CD8155764C3543F10FAD8A480D743137466F8D55213C8EAEFCD12F06D43A80";
+  target_json["length"] = 2;
+  Json::Value delta;
+  delta["from"]["sha256"] = "aa";
+  delta["hashes"]["sha512"] = "cc";
+  delta["hashes"]["sha256"] = "bb";
+  delta["length"] = 1;
+  delta["uri"] = "https://example.com/delta";
+  target_json["custom"]["delta"].append(delta);
+  Json::Value no_uri = delta;
+  no_uri.removeMember("uri");
+  target_json["custom"]["delta"].append(no_uri);
+  Json::Value bad_hash = delta;
+  bad_hash["hashes"] = Json::objectValue;
+  bad_hash["hashes"]["md5"] = "dd";
+  target_json["custom"]["delta"].append(bad_hash);
+
+  const auto deltas = DeltaTarget::fromTarget(Uptane::Target("aa.bin", target_json));
+  ASSERT_EQ(deltas.size(), 1);
+  EXPECT_EQ(deltas[0].from(), Hash(Hash::Type::kSha256, "aa"));
+  EXPECT_EQ(deltas[0].hashes()[0], Hash(Hash::Type::kSha256, "bb"));
+  EXPECT_TRUE(deltas[0].MatchHash(Hash(Hash::Type::kSha512, "cc")));
+  EXPECT_EQ(deltas[0].length(), 1);
+  EXPECT_EQ(deltas[0].uri(), "https://example.com/delta");
+  EXPECT_EQ(deltas[0].filename(), "BB.delta");
+
+  EXPECT_TRUE(DeltaTarget::fromTarget(Uptane::Target("aa.bin", Json::Value())).empty());
+}
+
+#ifndef __NO_MAIN__
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+#endif
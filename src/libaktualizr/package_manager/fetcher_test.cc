@@ -4,9 +4,11 @@
 #include <chrono>
 #include <future>
 #include <iostream>
+#include <sstream>
 #include <string>
 #include <thread>
 
+#include <boost/algorithm/string/case_conv.hpp>
 #include <boost/process.hpp>
 
 #include "crypto/keymanager.h"
@@ -15,6 +17,7 @@
 #include "libaktualizr/config.h"
 #include "libaktualizr/packagemanagerfactory.h"
 #include "logging/logging.h"
+#include "package_manager/chunkstore.h"
 #include "package_manager/packagemanagerfake.h"
 #include "storage/sqlstorage.h"
 #include "test_utils.h"
@@ -356,6 +359,109 @@ TEST(Fetcher, DownloadOstreeFail) {
   EXPECT_EQ(http->counter, 1);
 }
 
+class HttpChunks : public HttpFake {
+ public:
+  HttpChunks(const boost::filesystem::path& test_dir_in, std::string content_in)
+      : HttpFake(test_dir_in), content(std::move(content_in)) {}
+  HttpResponse download(const std::string& url, curl_write_callback write_cb, curl_xferinfo_callback progress_cb,
+                        void* userp, curl_off_t from) override {
+    (void)url;
+    for (auto pos = static_cast<size_t>(from); pos < content.size(); pos += 4096) {
+      const size_t len = std::min<size_t>(4096, content.size() - pos);
+      served += len;
+      if (write_cb(const_cast<char*>(&content[pos]), 1, len, userp) != len) {
+        return HttpResponse("", 206, CURLE_WRITE_ERROR, "Failed writing received data to disk/application");
+      }
+      progress_cb(userp, 0, 0, 0, 0);
+    }
+    return HttpResponse("", 200, CURLE_OK, "");
+  }
+
+  std::string content;
+  size_t served = 0;
+};
+
+static Uptane::Target chunkedTarget(const std::string& name, const std::string& content) {
+  ChunkList chunks;
+  ContentChunker chunker(ChunkStore::kMinChunkSize, ChunkStore::kAvgChunkSize, ChunkStore::kMaxChunkSize);
+  auto out = [&chunks](const uint8_t* data, size_t size) {
+    const std::string chunk(reinterpret_cast<const char*>(data), size);
+    chunks.emplace_back(Hash::generate(Hash::Type::kSha256, chunk).HashString(), size);
+  };
+  chunker.update(reinterpret_cast<const uint8_t*>(content.data()), content.size(), out);
+  chunker.finish(out);
+
+  Json::Value target_json;
+  target_json["hashes"]["sha256"] = Hash::generate(Hash::Type::kSha256, content).HashString();
+  target_json["length"] = Json::UInt64(content.size());
+  for (const auto& c : chunks) {
+    // Target metadata has lower case hashes.
+    Json::Value chunk;
+    chunk["sha256"] = boost::algorithm::to_lower_copy(c.hash);
+    chunk["length"] = Json::UInt64(c.length);
+    target_json["custom"]["chunks"].append(chunk);
+  }
+  return Uptane::Target(name, target_json);
+}
+
+/* Download only the chunks of a Target that are not in the chunk store yet.
+ * Read a Target from the chunk store without reassembling it.
+ * Keep the chunks that are still in use when a Target is removed. */
+TEST(Fetcher, DownloadChunks) {
+  TemporaryDirectory temp_dir;
+  config.storage.path = temp_dir.Path();
+  config.pacman.images_path = temp_dir.Path() / "images";
+  config.pacman.chunk_store = true;
+  config.uptane.repo_server = server;
+
+  std::string v1;
+  while (v1.size() < 1000000) {
+    v1 += Utils::randomUuid();
+  }
+  std::string v2 = v1;
+  v2.replace(500000, 8, "modified");
+  const Uptane::Target t1 = chunkedTarget("v1.bin", v1);
+  const Uptane::Target t2 = chunkedTarget("v2.bin", v2);
+
+  std::shared_ptr<INvStorage> storage(new SQLStorage(config.storage, false));
+  auto http = std::make_shared<HttpChunks>(temp_dir.Path(), v1);
+  auto pacman = std::make_shared<PackageManagerFake>(config.pacman, config.bootloader, storage, http);
+  KeyManager keys(storage, config.keymanagerConfig());
+  Uptane::Fetcher fetcher(config, http);
+
+  // Nothing to reuse yet, so the whole Target is downloaded.
+  EXPECT_TRUE(pacman->fetchTarget(t1, fetcher, keys, progress_cb, nullptr));
+  EXPECT_EQ(http->served, v1.size());
+  EXPECT_FALSE(boost::filesystem::exists(config.pacman.images_path / t1.hashes()[0].HashString()));
+
+  http->content = v2;
+  http->served = 0;
+  EXPECT_TRUE(pacman->fetchTarget(t2, fetcher, keys, progress_cb, nullptr));
+  EXPECT_LT(http->served, v2.size() / 10);
+  EXPECT_EQ(pacman->verifyTarget(t2), TargetStatus::kGood);
+  {
+    auto in = pacman->openTargetFile(t2);
+    std::stringstream ss;
+    ss << in->rdbuf();
+    EXPECT_EQ(ss.str(), v2);
+  }
+  {
+    auto mapped = pacman->mapTargetFile(t2);
+    std::string content;
+    mapped->forEachSpan(
+        [&content](const uint8_t* data, size_t size) { content.append(reinterpret_cast<const char*>(data), size); });
+    EXPECT_EQ(mapped->size(), v2.size());
+    EXPECT_EQ(content, v2);
+  }
+  // Neither of them reassembled the Target into the images directory.
+  EXPECT_FALSE(boost::filesystem::exists(config.pacman.images_path / t2.hashes()[0].HashString()));
+
+  pacman->removeTargetFile(t1);
+  EXPECT_EQ(pacman->verifyTarget(t1), TargetStatus::kNotFound);
+  EXPECT_EQ(pacman->verifyTarget(t2), TargetStatus::kGood);
+  config.pacman.chunk_store = false;
+}
+
 #ifndef __NO_MAIN__
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
@@ -39,7 +39,7 @@ TEST(PackageManagerFake, Binary) {
   {
     auto in = pacman.openTargetFile(target);
     std::stringstream ss;
-    ss << in.rdbuf();
+    ss << in->rdbuf();
     ASSERT_EQ(ss.str(), "a");
   }
   {
@@ -49,7 +49,7 @@ TEST(PackageManagerFake, Binary) {
   {
     auto in = pacman.openTargetFile(target);
     std::stringstream ss;
-    ss << in.rdbuf();
+    ss << in->rdbuf();
     ASSERT_EQ(ss.str(), "aa");
   }
   // Test overwriting
@@ -60,7 +60,7 @@ TEST(PackageManagerFake, Binary) {
   {
     auto in = pacman.openTargetFile(target);
     std::stringstream ss;
-    ss << in.rdbuf();
+    ss << in->rdbuf();
     ASSERT_EQ(ss.str(), "a");
   }
 
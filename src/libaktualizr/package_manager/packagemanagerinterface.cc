@@ -8,6 +8,9 @@
 #include "crypto/keymanager.h"
 #include "http/httpclient.h"
 #include "logging/logging.h"
+#include "package_manager/chunkstore.h"
+#include "package_manager/deltapatch.h"
+#include "package_manager/targetledger.h"
 #include "storage/invstorage.h"
 #include "uptane/exceptions.h"
 #include "uptane/fetcher.h"
@@ -89,13 +92,127 @@ static int ProgressHandler(void* clientp, curl_off_t dltotal, curl_off_t dlnow,
   return 0;
 }
 
-static void restoreHasherState(MultiPartHasher& hasher, std::ifstream data) {
-  static constexpr size_t buf_len = 1024;
-  std::array<uint8_t, buf_len> buf{};
-  do {
-    data.read(reinterpret_cast<char*>(buf.data()), buf.size());
-    hasher.update(buf.data(), static_cast<uint64_t>(data.gcount()));
-  } while (data.gcount() != 0);
+struct ChunkDownloadStruct {
+ public:
+  ChunkDownloadStruct(ChunkStore& store_in, Uptane::Target target_in, uint64_t available_in,
+                      FetcherProgressCb progress_cb_in, const api::FlowControlToken* token_in)
+      : store{store_in},
+        target{std::move(target_in)},
+        available_length{available_in},
+        token{token_in},
+        progress_cb{std::move(progress_cb_in)} {}
+  ChunkStore& store;
+  Uptane::Target target;
+  // the consecutive chunks that the current request is for
+  ChunkList run;
+  size_t received{0};
+  std::vector<uint8_t> buffer;
+  uint64_t available_length;
+  std::string error;
+  unsigned int last_progress{0};
+  const api::FlowControlToken* token;
+  FetcherProgressCb progress_cb;
+};
+
+static size_t ChunkDownloadHandler(char* contents, size_t size, size_t nmemb, void* userp) {
+  assert(userp);
+  auto* ds = static_cast<ChunkDownloadStruct*>(userp);
+  const size_t downloaded = size * nmemb;
+  size_t used = 0;
+  while (used < downloaded && ds->received < ds->run.size()) {
+    const ImageChunk& chunk = ds->run[ds->received];
+    const auto len = static_cast<size_t>(std::min<uint64_t>(chunk.length - ds->buffer.size(), downloaded - used));
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    ds->buffer.insert(ds->buffer.end(), contents + used, contents + used + len);
+    used += len;
+    if (ds->buffer.size() < chunk.length) {
+      break;
+    }
+    try {
+      ds->store.addChunk(chunk, ds->buffer.data(), ds->buffer.size());
+    } catch (const std::exception& e) {
+      ds->error = e.what();
+      return downloaded + 1;  // curl will abort if return unexpected size;
+    }
+    ds->available_length += chunk.length;
+    ds->buffer.clear();
+    ++ds->received;
+  }
+  if (ds->received == ds->run.size()) {
+    // The rest of the response is either stored already or fetched by another request.
+    return downloaded + 1;
+  }
+  return downloaded;
+}
+
+static int ChunkProgressHandler(void* clientp, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal,
+                                curl_off_t ulnow) {
+  (void)dltotal;
+  (void)dlnow;
+  (void)ultotal;
+  (void)ulnow;
+  auto* ds = static_cast<ChunkDownloadStruct*>(clientp);
+
+  auto progress = static_cast<unsigned int>((ds->available_length * 100) / ds->target.length());
+  if (ds->progress_cb && progress > ds->last_progress) {
+    ds->last_progress = progress;
+    ds->progress_cb(ds->target, "Downloading", progress);
+  }
+  if (ds->token != nullptr && ds->token->hasAborted()) {
+    return 1;
+  }
+  return 0;
+}
+
+/* The chunks of a Target that is kept in the chunk store. A plain file in
+ * images_path, such as an incomplete download, takes precedence. */
+static boost::optional<ChunkList> storedChunks(const ChunkStore* store, const boost::filesystem::path& images_path,
+                                               const std::string& filename) {
+  if (store == nullptr || filename.empty() || boost::filesystem::exists(images_path / filename)) {
+    return boost::none;
+  }
+  return store->readIndex(filename);
+}
+
+static void assembleChunks(const ChunkStore& store, const ChunkList& chunks, const boost::filesystem::path& path) {
+  std::ofstream out(path.string(), std::ios::binary | std::ios::trunc);
+  if (!out.good()) {
+    throw std::runtime_error("Can't write to file " + path.string());
+  }
+  try {
+    store.read(chunks, [&out](const uint8_t* data, size_t size) {
+      out.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+    });
+    out.close();
+    if (out.fail()) {
+      throw std::runtime_error("Can't write to file " + path.string());
+    }
+  } catch (...) {
+    out.close();
+    boost::filesystem::remove(path);
+    throw;
+  }
+}
+
+static void restoreHasherState(MultiPartHasher& hasher, const MappedFile& data) {
+  data.forEachSpan([&hasher](const uint8_t* span, size_t size) { hasher.update(span, size); });
+}
+
+PackageManagerInterface::PackageManagerInterface(PackageConfig pconfig, const BootloaderConfig& bconfig,
+                                                 std::shared_ptr<INvStorage> storage,
+                                                 std::shared_ptr<HttpInterface> http)
+    : config(std::move(pconfig)), storage_(std::move(storage)), http_(std::move(http)) {
+  (void)bconfig;
+  if (config.chunk_store) {
+    chunk_store_ = std::make_shared<ChunkStore>(config.images_path / "chunks");
+  }
+  if (!config.paranoid_verification && storage_ != nullptr) {
+    try {
+      ledger_ = std::make_shared<TargetLedger>(config.images_path, storage_);
+    } catch (const std::exception& e) {
+      LOG_WARNING << "Verified Targets will be hashed again: " << e.what();
+    }
+  }
 }
 
 bool PackageManagerInterface::fetchTarget(const Uptane::Target& target, Uptane::Fetcher& fetcher,
@@ -118,11 +235,39 @@ bool PackageManagerInterface::fetchTarget(const Uptane::Target& target, Uptane::
       ds->fhandle = createTargetFile(target);
       return true;
     }
+    if (exists == TargetStatus::kHashMismatch && chunk_store_) {
+      const std::string filename = storage_->getTargetFilename(target.filename());
+      auto chunks = storedChunks(chunk_store_.get(), config.images_path, filename);
+      if (chunks) {
+        chunk_store_->removeDamaged(*chunks);
+      }
+    }
+
+    std::string target_url = target.uri();
+    if (target_url.empty()) {
+      target_url = fetcher.getRepoServer() + "/targets/" + Utils::urlEncode(target.filename());
+    }
+
+    if (exists != TargetStatus::kIncomplete) {
+      if (fetchDelta(target, progress_cb, token)) {
+        chunkTargetFile(target);
+        recordVerified(target);
+        return true;
+      }
+      if (fetchChunks(target, target_url, progress_cb, token)) {
+        return true;
+      }
+    }
+    // Only a plain file can be appended to. An incomplete Target in the chunk
+    // store is downloaded again.
+    boost::optional<StoredTargetFile> target_check;
     if (exists == TargetStatus::kIncomplete) {
+      target_check = checkTargetFile(target);
+    }
+    if (target_check && target_check->kind == StoredTargetFile::Kind::kFile) {
       LOG_INFO << "Continuing incomplete download of file " << target.filename();
-      auto target_check = checkTargetFile(target);
-      ds->downloaded_length = target_check->first;
-      ::restoreHasherState(ds->hasher(), openTargetFile(target));
+      ds->downloaded_length = target_check->size;
+      hashTargetFile(target, *target_check, ds->hasher());
       ds->fhandle = appendTargetFile(target);
     } else {
       // If the target was found, but is oversized or the hash doesn't match,
@@ -136,11 +281,6 @@ bool PackageManagerInterface::fetchTarget(const Uptane::Target& target, Uptane::
       throw std::runtime_error("Insufficient disk space available to download target");
     }
 
-    std::string target_url = target.uri();
-    if (target_url.empty()) {
-      target_url = fetcher.getRepoServer() + "/targets/" + Utils::urlEncode(target.filename());
-    }
-
     HttpResponse response;
     for (;;) {
       response = http_->download(target_url, DownloadHandler, ProgressHandler, ds.get(),
@@ -178,6 +318,8 @@ bool PackageManagerInterface::fetchTarget(const Uptane::Target& target, Uptane::
       throw Uptane::TargetHashMismatch(target.filename());
     }
     ds->fhandle.close();
+    chunkTargetFile(target);
+    recordVerified(target);
     result = true;
   } catch (const std::exception& e) {
     LOG_WARNING << "Error while downloading a target: " << e.what();
@@ -185,31 +327,346 @@ bool PackageManagerInterface::fetchTarget(const Uptane::Target& target, Uptane::
   return result;
 }
 
+/* Reconstruct the Target from a delta against an image that is still present
+ * in images_path. Returns false without leaving a partial Target behind if no
+ * usable delta is offered or anything goes wrong, so that the caller can fall
+ * back to downloading the full image. The delta is kept next to the images for
+ * Secondaries that have the same base image installed. */
+bool PackageManagerInterface::fetchDelta(const Uptane::Target& target, const FetcherProgressCb& progress_cb,
+                                         const api::FlowControlToken* token) {
+  for (const auto& delta : DeltaTarget::fromTarget(target)) {
+    if (target.MatchHash(delta.from())) {
+      continue;
+    }
+    boost::filesystem::path base = config.images_path / delta.from().HashString();
+    auto base_chunks = storedChunks(chunk_store_.get(), config.images_path, delta.from().HashString());
+    if (!base_chunks && !boost::filesystem::exists(base)) {
+      continue;
+    }
+
+    bool created = false;
+    boost::filesystem::path assembled_base;
+    try {
+      if (!downloadDelta(target, delta, progress_cb, token)) {
+        continue;
+      }
+      if (!checkAvailableDiskSpace(target.length())) {
+        throw std::runtime_error("Insufficient disk space available to apply delta");
+      }
+      if (base_chunks) {
+        // bsdiff seeks around in the base image, so it has to be a plain file.
+        if (!checkAvailableDiskSpace(ChunkStore::length(*base_chunks))) {
+          throw std::runtime_error("Insufficient disk space available to assemble the base image of a delta");
+        }
+        assembled_base = config.images_path / (delta.from().HashString() + ".base");
+        assembleChunks(*chunk_store_, *base_chunks, assembled_base);
+        base = assembled_base;
+      }
+
+      std::ofstream fhandle = createTargetFile(target);
+      created = true;
+      auto hasher = MultiPartHasher::create(target.hashes()[0].type());
+      uint64_t written = 0;
+      DeltaPatch::apply(base, config.images_path / delta.filename(), [&](const uint8_t* data, size_t size) {
+        written += size;
+        if (written > target.length()) {
+          throw Uptane::OversizedTarget(target.filename());
+        }
+        fhandle.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+        hasher->update(data, size);
+      });
+      if (!assembled_base.empty()) {
+        boost::filesystem::remove(assembled_base);
+      }
+      fhandle.close();
+      if (fhandle.fail()) {
+        throw std::runtime_error("Can't write to file for target " + target.filename());
+      }
+      if (written != target.length() || !target.MatchHash(hasher->getHash())) {
+        throw Uptane::TargetHashMismatch(target.filename());
+      }
+      LOG_INFO << "Reconstructed " << target.filename() << " from a delta of " << delta.length() << " bytes";
+      return true;
+    } catch (const std::exception& e) {
+      LOG_WARNING << "Could not update " << target.filename() << " from a delta: " << e.what();
+      if (!assembled_base.empty()) {
+        boost::filesystem::remove(assembled_base);
+      }
+      if (created) {
+        removeTargetFile(target);
+      }
+      if (token != nullptr && token->hasAborted()) {
+        throw;
+      }
+    }
+  }
+  return false;
+}
+
+bool PackageManagerInterface::downloadDelta(const Uptane::Target& target, const DeltaTarget& delta,
+                                            const FetcherProgressCb& progress_cb,
+                                            const api::FlowControlToken* token) {
+  // Report the progress against the Target that the delta is for.
+  FetcherProgressCb delta_progress_cb;
+  if (progress_cb) {
+    delta_progress_cb = [&progress_cb, &target](const Uptane::Target& delta_target, const std::string& description,
+                                                unsigned int progress) {
+      (void)delta_target;
+      progress_cb(target, description, progress);
+    };
+  }
+  const Uptane::Target delta_target(target.filename(), Uptane::EcuMap{}, delta.hashes(), delta.length());
+  const std::string delta_path = (config.images_path / delta.filename()).string();
+  auto ds = std_::make_unique<DownloadMetaStruct>(delta_target, delta_progress_cb, token);
+
+  std::ios::openmode mode = std::ios::binary | std::ios::trunc;
+  auto existing = checkDeltaFile(delta);
+  if (existing && existing->first == delta.length()) {
+    ::restoreHasherState(ds->hasher(), MappedFile(existing->second));
+    if (delta.MatchHash(Hash(ds->hash_type, ds->hasher().getHexDigest()))) {
+      LOG_INFO << "Delta for " << target.filename() << " has already been downloaded";
+      return true;
+    }
+    // Start over if the complete file doesn't match.
+    ds = std_::make_unique<DownloadMetaStruct>(delta_target, delta_progress_cb, token);
+  }
+  if (existing && existing->first < delta.length()) {
+    LOG_INFO << "Continuing incomplete download of delta for " << target.filename();
+    ds->downloaded_length = existing->first;
+    ::restoreHasherState(ds->hasher(), MappedFile(existing->second));
+    mode = std::ios::binary | std::ios::app;
+  } else {
+    LOG_DEBUG << "Initiating download of delta for " << target.filename() << " from " << delta.uri();
+  }
+  if (!checkAvailableDiskSpace(delta.length() - ds->downloaded_length)) {
+    return false;
+  }
+  boost::filesystem::create_directories(config.images_path);
+  ds->fhandle.open(delta_path, mode);
+  if (!ds->fhandle.good()) {
+    throw std::runtime_error("Can't write to file " + delta_path);
+  }
+
+  HttpResponse response;
+  for (;;) {
+    response = http_->download(delta.uri(), DownloadHandler, ProgressHandler, ds.get(),
+                               static_cast<curl_off_t>(ds->downloaded_length));
+
+    if (response.curl_code == CURLE_RANGE_ERROR) {
+      ds = std_::make_unique<DownloadMetaStruct>(delta_target, delta_progress_cb, token);
+      ds->fhandle.open(delta_path, std::ios::binary | std::ios::trunc);
+      continue;
+    }
+
+    if (!response.wasInterrupted()) {
+      break;
+    }
+    ds->fhandle.close();
+    // sleep if paused or abort the download
+    if (!token->canContinue()) {
+      throw Uptane::Exception("image", "Download of a target was aborted");
+    }
+    ds->fhandle.open(delta_path, std::ios::binary | std::ios::app);
+  }
+  ds->fhandle.close();
+
+  if (!response.isOk()) {
+    LOG_WARNING << "Could not download delta for " << target.filename() << ", error: " << response.error_message;
+    boost::filesystem::remove(delta_path);
+    return false;
+  }
+  if (!delta.MatchHash(Hash(ds->hash_type, ds->hasher().getHexDigest()))) {
+    LOG_WARNING << "Hash of the delta for " << target.filename() << " does not match the metadata";
+    boost::filesystem::remove(delta_path);
+    return false;
+  }
+  return true;
+}
+
+/* Assemble the Target from the chunks that are already stored and download
+ * only the missing ones, as listed in the Target metadata. Every run of
+ * consecutive missing chunks is fetched with a request that starts at its
+ * offset in the Target and is cut off as soon as the run is complete. Returns
+ * false if there is nothing to reuse or anything goes wrong, so that the caller
+ * can fall back to downloading the full image. */
+bool PackageManagerInterface::fetchChunks(const Uptane::Target& target, const std::string& url,
+                                          const FetcherProgressCb& progress_cb, const api::FlowControlToken* token) {
+  if (!chunk_store_) {
+    return false;
+  }
+  const ChunkList chunks = ChunkStore::fromTarget(target);
+  if (chunks.empty()) {
+    return false;
+  }
+  uint64_t missing_length = 0;
+  for (const auto& c : chunks) {
+    if (!chunk_store_->hasChunk(c)) {
+      missing_length += c.length;
+    }
+  }
+  if (missing_length == target.length() || !checkAvailableDiskSpace(missing_length)) {
+    return false;
+  }
+  LOG_INFO << "Reusing " << target.length() - missing_length << " of " << target.length() << " bytes of "
+           << target.filename() << " from the chunk store";
+
+  try {
+    ChunkDownloadStruct ds(*chunk_store_, target, target.length() - missing_length, progress_cb, token);
+    uint64_t offset = 0;
+    for (size_t i = 0; i < chunks.size();) {
+      if (chunk_store_->hasChunk(chunks[i])) {
+        offset += chunks[i].length;
+        ++i;
+        continue;
+      }
+      size_t end = i;
+      while (end < chunks.size() && !chunk_store_->hasChunk(chunks[end])) {
+        ++end;
+      }
+      ds.run.assign(chunks.begin() + static_cast<std::ptrdiff_t>(i), chunks.begin() + static_cast<std::ptrdiff_t>(end));
+      ds.received = 0;
+      for (;;) {
+        ds.buffer.clear();
+        uint64_t from = offset;
+        for (size_t k = 0; k < ds.received; ++k) {
+          from += ds.run[k].length;
+        }
+        const HttpResponse response =
+            http_->download(url, ChunkDownloadHandler, ChunkProgressHandler, &ds, static_cast<curl_off_t>(from));
+        if (ds.received == ds.run.size()) {
+          break;
+        }
+        if (!ds.error.empty()) {
+          throw std::runtime_error(ds.error);
+        }
+        if (!response.wasInterrupted()) {
+          throw std::runtime_error("Could not download chunks, error: " + response.getStatusStr());
+        }
+        // sleep if paused or abort the download
+        if (token == nullptr || !token->canContinue()) {
+          throw Uptane::Exception("image", "Download of a target was aborted");
+        }
+      }
+      offset += ChunkStore::length(ds.run);
+      i = end;
+    }
+
+    auto hasher = MultiPartHasher::create(target.hashes()[0].type());
+    chunk_store_->read(chunks, [&hasher](const uint8_t* data, size_t size) { hasher->update(data, size); });
+    if (!target.MatchHash(hasher->getHash())) {
+      chunk_store_->removeDamaged(chunks);
+      throw Uptane::TargetHashMismatch(target.filename());
+    }
+
+    const std::string filename = target.hashes()[0].HashString();
+    // Drop any broken plain file that would shadow the chunks.
+    boost::filesystem::remove(config.images_path / filename);
+    chunk_store_->writeIndex(filename, chunks);
+    storage_->storeTargetFilename(target.filename(), filename);
+    return true;
+  } catch (const std::exception& e) {
+    LOG_WARNING << "Could not assemble " << target.filename() << " from chunks: " << e.what();
+    if (token != nullptr && token->hasAborted()) {
+      throw;
+    }
+  }
+  return false;
+}
+
+/* Move a downloaded and verified Target into the chunk store. If that fails,
+ * the Target is simply kept as a plain file. */
+void PackageManagerInterface::chunkTargetFile(const Uptane::Target& target) {
+  if (!chunk_store_ || target.length() == 0) {
+    return;
+  }
+  const std::string filename = target.hashes()[0].HashString();
+  const boost::filesystem::path path = config.images_path / filename;
+  try {
+    const ChunkList chunks = chunk_store_->addFile(filename, path);
+    boost::filesystem::remove(path);
+    LOG_DEBUG << "Stored " << target.filename() << " as " << chunks.size() << " chunks";
+  } catch (const std::exception& e) {
+    LOG_WARNING << "Could not add " << target.filename() << " to the chunk store: " << e.what();
+  }
+}
+
+/* Remember that the Target file has just been hashed, so that verifyTarget()
+ * doesn't have to hash it again while it stays unchanged. Targets in the chunk
+ * store are left out, they are made of many files. */
+void PackageManagerInterface::recordVerified(const Uptane::Target& target) const {
+  if (!ledger_) {
+    return;
+  }
+  const boost::filesystem::path path = config.images_path / storage_->getTargetFilename(target.filename());
+  try {
+    if (boost::filesystem::is_regular_file(path)) {
+      ledger_->record(target.hashes()[0], path);
+    }
+  } catch (const std::exception& e) {
+    LOG_WARNING << "Could not record the verification of " << target.filename() << ": " << e.what();
+  }
+}
+
 TargetStatus PackageManagerInterface::verifyTarget(const Uptane::Target& target) const {
   auto target_exists = checkTargetFile(target);
   if (!target_exists) {
     LOG_DEBUG << "File " << target.filename() << " with expected hash not found in the database.";
     return TargetStatus::kNotFound;
-  } else if (target_exists->first < target.length()) {
+  } else if (target_exists->size < target.length()) {
     LOG_DEBUG << "File " << target.filename() << " was found in the database, but is incomplete.";
     return TargetStatus::kIncomplete;
-  } else if (target_exists->first > target.length()) {
+  } else if (target_exists->size > target.length()) {
     LOG_DEBUG << "File " << target.filename() << " was found in the database, but is oversized.";
     return TargetStatus::kOversized;
   }
 
-  // Even if the file exists and the length matches, recheck the hash.
+  // Even if the file exists and the length matches, recheck the hash, unless
+  // it has been checked before and the file hasn't changed since.
+  const bool plain_file = target_exists->kind == StoredTargetFile::Kind::kFile;
+  if (plain_file && ledger_ && ledger_->isVerified(target.hashes()[0], target_exists->path)) {
+    LOG_DEBUG << "File " << target.filename() << " is unchanged since it was last verified.";
+    return TargetStatus::kGood;
+  }
   DownloadMetaStruct ds(target, nullptr, nullptr);
-  ds.downloaded_length = target_exists->first;
-  ::restoreHasherState(ds.hasher(), openTargetFile(target));
+  ds.downloaded_length = target_exists->size;
+  try {
+    hashTargetFile(target, *target_exists, ds.hasher());
+  } catch (const std::exception& e) {
+    if (plain_file) {
+      throw;
+    }
+    LOG_ERROR << "Target " << target << " is damaged in the chunk store: " << e.what();
+    return TargetStatus::kHashMismatch;
+  }
   if (!target.MatchHash(Hash(ds.hash_type, ds.hasher().getHexDigest()))) {
     LOG_ERROR << "Target exists with expected length, but hash does not match metadata! " << target;
+    if (ledger_ && plain_file) {
+      ledger_->remove(target_exists->path);
+    }
     return TargetStatus::kHashMismatch;
   }
 
+  if (plain_file) {
+    recordVerified(target);
+  }
   return TargetStatus::kGood;
 }
 
+/* Pass the content of a stored Target to `hasher`. Targets in the chunk store
+ * are read chunk by chunk. */
+void PackageManagerInterface::hashTargetFile(const Uptane::Target& target, const StoredTargetFile& file,
+                                             MultiPartHasher& hasher) const {
+  if (file.kind == StoredTargetFile::Kind::kChunks) {
+    const auto chunks = chunk_store_->readIndex(storage_->getTargetFilename(target.filename()));
+    if (!chunks) {
+      throw std::runtime_error("Chunk index of target " + target.filename() + " is missing");
+    }
+    chunk_store_->read(*chunks, [&hasher](const uint8_t* data, size_t size) { hasher.update(data, size); });
+  } else {
+    ::restoreHasherState(hasher, MappedFile(file.path));
+  }
+}
+
 bool PackageManagerInterface::checkAvailableDiskSpace(const uint64_t required_bytes) const {
   struct statvfs stvfsbuf {};
   const int stat_res = statvfs(config.images_path.c_str(), &stvfsbuf);
@@ -229,30 +686,58 @@ bool PackageManagerInterface::checkAvailableDiskSpace(const uint64_t required_by
   }
 }
 
-boost::optional<std::pair<uintmax_t, std::string>> PackageManagerInterface::checkTargetFile(
-    const Uptane::Target& target) const {
+boost::optional<StoredTargetFile> PackageManagerInterface::checkTargetFile(const Uptane::Target& target) const {
   std::string filename = storage_->getTargetFilename(target.filename());
   if (!filename.empty()) {
     auto path = config.images_path / filename;
     if (boost::filesystem::exists(path)) {
-      return {{boost::filesystem::file_size(path), path.string()}};
+      return StoredTargetFile{StoredTargetFile::Kind::kFile, boost::filesystem::file_size(path), path};
+    }
+    auto chunks = storedChunks(chunk_store_.get(), config.images_path, filename);
+    if (chunks) {
+      return StoredTargetFile{StoredTargetFile::Kind::kChunks, ChunkStore::length(*chunks), {}};
     }
   }
   return boost::none;
 }
 
-std::ifstream PackageManagerInterface::openTargetFile(const Uptane::Target& target) const {
+std::unique_ptr<std::istream> PackageManagerInterface::openTargetFile(const Uptane::Target& target) const {
   auto file = checkTargetFile(target);
   if (!file) {
     throw std::runtime_error("File doesn't exist for target " + target.filename());
   }
-  std::ifstream stream(file->second, std::ios::binary);
-  if (!stream.good()) {
-    throw std::runtime_error("Can't open file " + file->second);
+  if (file->kind == StoredTargetFile::Kind::kChunks) {
+    auto chunks = chunk_store_->readIndex(storage_->getTargetFilename(target.filename()));
+    if (!chunks) {
+      throw std::runtime_error("Chunk index of target " + target.filename() + " is missing");
+    }
+    return std_::make_unique<ChunkStream>(chunk_store_, std::move(*chunks));
+  }
+  std::unique_ptr<std::istream> stream = std_::make_unique<std::ifstream>(file->path.string(), std::ios::binary);
+  if (!stream->good()) {
+    throw std::runtime_error("Can't open file " + file->path.string());
   }
   return stream;
 }
 
+std::unique_ptr<MappedFile> PackageManagerInterface::mapTargetFile(const Uptane::Target& target) const {
+  auto file = checkTargetFile(target);
+  if (!file) {
+    throw std::runtime_error("File doesn't exist for target " + target.filename());
+  }
+  if (file->kind == StoredTargetFile::Kind::kChunks) {
+    auto chunks = chunk_store_->readIndex(storage_->getTargetFilename(target.filename()));
+    if (!chunks) {
+      throw std::runtime_error("Chunk index of target " + target.filename() + " is missing");
+    }
+    // The chunks are read one after the other instead of being mapped.
+    std::shared_ptr<const ChunkStore> store = chunk_store_;
+    return std_::make_unique<MappedFile>(
+        file->size, [store, list = std::move(*chunks)](const MappedFile::SpanCallback& cb) { store->read(list, cb); });
+  }
+  return std_::make_unique<MappedFile>(file->path);
+}
+
 std::ofstream PackageManagerInterface::createTargetFile(const Uptane::Target& target) {
   std::string filename = target.hashes()[0].HashString();
   std::string filepath = (config.images_path / filename).string();
@@ -270,9 +755,12 @@ std::ofstream PackageManagerInterface::appendTargetFile(const Uptane::Target& ta
   if (!file) {
     throw std::runtime_error("File doesn't exist for target " + target.filename());
   }
-  std::ofstream stream(file->second, std::ios::binary | std::ios::app);
+  if (file->kind == StoredTargetFile::Kind::kChunks) {
+    throw std::runtime_error("Target " + target.filename() + " is stored in chunks and can't be appended to");
+  }
+  std::ofstream stream(file->path.string(), std::ios::binary | std::ios::app);
   if (!stream.good()) {
-    throw std::runtime_error("Can't open file " + file->second);
+    throw std::runtime_error("Can't open file " + file->path.string());
   }
   return stream;
 }
@@ -282,8 +770,44 @@ void PackageManagerInterface::removeTargetFile(const Uptane::Target& target) {
   if (!file) {
     throw std::runtime_error("File doesn't exist for target " + target.filename());
   }
-  boost::filesystem::remove(file->second);
+  const std::string filename = storage_->getTargetFilename(target.filename());
+  boost::filesystem::remove(config.images_path / filename);
+  if (ledger_) {
+    ledger_->remove(config.images_path / filename);
+  }
   storage_->deleteTargetInfo(target.filename());
+  for (const auto& delta : DeltaTarget::fromTarget(target)) {
+    boost::filesystem::remove(config.images_path / delta.filename());
+  }
+  if (chunk_store_) {
+    chunk_store_->removeIndex(filename);
+    try {
+      chunk_store_->collectGarbage();
+    } catch (const std::exception& e) {
+      LOG_WARNING << "Chunk store garbage collection failed: " << e.what();
+    }
+  }
+}
+
+boost::optional<std::pair<uintmax_t, std::string>> PackageManagerInterface::checkDeltaFile(
+    const DeltaTarget& delta) const {
+  auto path = config.images_path / delta.filename();
+  if (boost::filesystem::exists(path)) {
+    return {{boost::filesystem::file_size(path), path.string()}};
+  }
+  return boost::none;
+}
+
+std::ifstream PackageManagerInterface::openDeltaFile(const DeltaTarget& delta) const {
+  auto file = checkDeltaFile(delta);
+  if (!file) {
+    throw std::runtime_error("Delta file " + delta.filename() + " doesn't exist");
+  }
+  std::ifstream stream(file->second, std::ios::binary);
+  if (!stream.good()) {
+    throw std::runtime_error("Can't open file " + file->second);
+  }
+  return stream;
 }
 
 std::vector<Uptane::Target> PackageManagerInterface::getTargetFiles() {
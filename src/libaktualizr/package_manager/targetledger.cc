@@ -0,0 +1,166 @@
+#include "package_manager/targetledger.h"
+
+#include <sys/stat.h>
+
+#include <sstream>
+
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/rand.h>
+
+#include "logging/logging.h"
+#include "utilities/utils.h"
+
+namespace {
+
+constexpr size_t kKeySize = 32;
+
+std::string toHex(const unsigned char *data, size_t size) {
+  static const char digits[] = "0123456789abcdef";
+  std::string hex;
+  hex.reserve(2 * size);
+  for (size_t i = 0; i < size; ++i) {
+    hex.push_back(digits[data[i] >> 4U]);
+    hex.push_back(digits[data[i] & 0xfU]);
+  }
+  return hex;
+}
+
+int64_t nanoseconds(const struct timespec &ts) {
+  return static_cast<int64_t>(ts.tv_sec) * 1000000000 + static_cast<int64_t>(ts.tv_nsec);
+}
+
+}  // namespace
+
+TargetLedger::TargetLedger(boost::filesystem::path dir, std::shared_ptr<INvStorage> storage)
+    : path_(dir / ".verified"), storage_(std::move(storage)) {
+  // The key is only created once something is recorded.
+  if (storage_->loadTargetLedgerKey(&key_)) {
+    if (key_.size() != kKeySize) {
+      throw std::runtime_error("The key of the verified Target ledger is damaged");
+    }
+    load();
+  }
+}
+
+void TargetLedger::loadKey() {
+  std::string key(kKeySize, '\0');
+  if (RAND_bytes(reinterpret_cast<unsigned char *>(&key[0]), static_cast<int>(key.size())) != 1) {
+    throw std::runtime_error("Could not create the key of the verified Target ledger");
+  }
+  // Another process may have stored its key first, which is kept.
+  storage_->storeTargetLedgerKey(key);
+  if (!storage_->loadTargetLedgerKey(&key_) || key_.size() != kKeySize) {
+    key_.clear();
+    throw std::runtime_error("Could not store the key of the verified Target ledger");
+  }
+  if (key_ == key) {
+    // Entries made under an older key can't be trusted anyway.
+    entries_.clear();
+    boost::filesystem::remove(path_);
+  } else {
+    load();
+  }
+}
+
+void TargetLedger::load() {
+  if (!boost::filesystem::exists(path_)) {
+    return;
+  }
+  std::istringstream in(Utils::readFile(path_));
+  std::string line;
+  size_t rejected = 0;
+  while (std::getline(in, line)) {
+    const auto pos = line.rfind(' ');
+    if (pos == std::string::npos || line.substr(pos + 1) != mac(line.substr(0, pos))) {
+      ++rejected;
+      continue;
+    }
+    std::istringstream fields(line.substr(0, pos));
+    std::string name;
+    Entry entry;
+    if (!(fields >> name >> entry.hash >> entry.device >> entry.inode >> entry.size >> entry.mtime_ns >>
+          entry.ctime_ns)) {
+      ++rejected;
+      continue;
+    }
+    entries_[name] = entry;
+  }
+  if (rejected != 0) {
+    LOG_WARNING << "Ignoring " << rejected << " invalid entries of the verified Target ledger " << path_;
+  }
+}
+
+void TargetLedger::save() const {
+  std::string content;
+  for (const auto &e : entries_) {
+    const std::string line = serialize(e.first, e.second);
+    content += line + " " + mac(line) + "\n";
+  }
+  Utils::writeFile(path_, content);
+}
+
+std::string TargetLedger::serialize(const std::string &name, const Entry &entry) {
+  std::ostringstream out;
+  out << name << ' ' << entry.hash << ' ' << entry.device << ' ' << entry.inode << ' ' << entry.size << ' '
+      << entry.mtime_ns << ' ' << entry.ctime_ns;
+  return out.str();
+}
+
+std::string TargetLedger::mac(const std::string &line) const {
+  unsigned char md[EVP_MAX_MD_SIZE];
+  unsigned int md_len = 0;
+  HMAC(EVP_sha256(), key_.data(), static_cast<int>(key_.size()), reinterpret_cast<const unsigned char *>(line.data()),
+       line.size(), md, &md_len);
+  return toHex(md, md_len);
+}
+
+boost::optional<TargetLedger::Entry> TargetLedger::describe(const Hash &hash, const boost::filesystem::path &file) {
+  struct stat st {};
+  if (stat(file.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+    return boost::none;
+  }
+  Entry entry;
+  entry.hash = hash.TypeString() + ":" + hash.HashString();
+  entry.device = static_cast<uint64_t>(st.st_dev);
+  entry.inode = static_cast<uint64_t>(st.st_ino);
+  entry.size = static_cast<uint64_t>(st.st_size);
+  entry.mtime_ns = nanoseconds(st.st_mtim);
+  entry.ctime_ns = nanoseconds(st.st_ctim);
+  return entry;
+}
+
+void TargetLedger::record(const Hash &hash, const boost::filesystem::path &file) {
+  auto entry = describe(hash, file);
+  if (!entry) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (key_.empty()) {
+    loadKey();
+  }
+  entries_[file.filename().string()] = *entry;
+  save();
+}
+
+bool TargetLedger::isVerified(const Hash &hash, const boost::filesystem::path &file) const {
+  auto entry = describe(hash, file);
+  if (!entry) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = entries_.find(file.filename().string());
+  return it != entries_.end() && it->second == *entry;
+}
+
+void TargetLedger::remove(const boost::filesystem::path &file) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (entries_.erase(file.filename().string()) != 0) {
+    save();
+  }
+}
+
+size_t TargetLedger::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
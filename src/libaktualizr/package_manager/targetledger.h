@@ -0,0 +1,74 @@
+#ifndef PACKAGE_MANAGER_TARGETLEDGER_H_
+#define PACKAGE_MANAGER_TARGETLEDGER_H_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <boost/filesystem.hpp>
+#include <boost/optional.hpp>
+
+#include "libaktualizr/types.h"
+#include "storage/invstorage.h"
+
+/**
+ * Remembers which Target files have been hashed and found to match their
+ * metadata, so that a multi-gigabyte image doesn't have to be hashed again
+ * every time it is verified between its download and its installation.
+ *
+ * An entry only vouches for the file it was made for as long as the file is
+ * unchanged: it records the device, inode, size, modification time and status
+ * change time of the file. The status change time can't be set from user
+ * space, so any write to the file or replacement of it invalidates the entry.
+ * Every entry carries an HMAC under a key that is created on first use, so
+ * edited or forged entries are ignored. The key is kept in the storage rather
+ * than next to the ledger, so that write access to the images directory is
+ * not enough to forge entries.
+ *
+ * The ledger lives in `<dir>/.verified`.
+ */
+class TargetLedger {
+ public:
+  TargetLedger(boost::filesystem::path dir, std::shared_ptr<INvStorage> storage);
+
+  /** Record that `file` has been found to match `hash`. */
+  void record(const Hash &hash, const boost::filesystem::path &file);
+  /** Whether `file` has been found to match `hash` and is unchanged since. */
+  bool isVerified(const Hash &hash, const boost::filesystem::path &file) const;
+  /** Forget about `file`. */
+  void remove(const boost::filesystem::path &file);
+
+  size_t size() const;
+
+ private:
+  struct Entry {
+    std::string hash;  // "<type>:<hash>", as in the Target metadata
+    uint64_t device{0};
+    uint64_t inode{0};
+    uint64_t size{0};
+    int64_t mtime_ns{0};
+    int64_t ctime_ns{0};
+
+    bool operator==(const Entry &other) const {
+      return hash == other.hash && device == other.device && inode == other.inode && size == other.size &&
+             mtime_ns == other.mtime_ns && ctime_ns == other.ctime_ns;
+    }
+  };
+
+  static boost::optional<Entry> describe(const Hash &hash, const boost::filesystem::path &file);
+  static std::string serialize(const std::string &name, const Entry &entry);
+  std::string mac(const std::string &line) const;
+  void loadKey();
+  void load();
+  void save() const;
+
+  boost::filesystem::path path_;
+  std::shared_ptr<INvStorage> storage_;
+  std::string key_;
+  std::map<std::string, Entry> entries_;  // by file name
+  mutable std::mutex mutex_;
+};
+
+#endif  // PACKAGE_MANAGER_TARGETLEDGER_H_
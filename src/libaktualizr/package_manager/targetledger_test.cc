@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <boost/filesystem.hpp>
+
+#include "libaktualizr/types.h"
+#include "package_manager/targetledger.h"
+#include "storage/invstorage.h"
+#include "utilities/utils.h"
+
+static const Hash kHash(Hash::Type::kSha256, "2561bd2a3e8b46b19ed8bf6a38b43ac2f8ad3d49ec8a1a76347d9a0e8e0ab2ac");
+static const Hash kOtherHash(Hash::Type::kSha256, "c9f4be2ded4dabd6fe5f40b65a6ebcaf7c3c5e3ad1fb0d58f8e4d1e2d7d0a5ef");
+
+static std::shared_ptr<INvStorage> newStorage(const TemporaryDirectory& dir) {
+  StorageConfig config;
+  config.path = dir.Path();
+  return INvStorage::newStorage(config);
+}
+
+/* A recorded file is verified until it changes. */
+TEST(TargetLedger, RecordAndCheck) {
+  TemporaryDirectory temp_dir;
+  const boost::filesystem::path file = temp_dir / "image";
+  Utils::writeFile(file, std::string("image content"));
+  auto storage = newStorage(temp_dir);
+
+  TargetLedger ledger(temp_dir.Path(), storage);
+  EXPECT_FALSE(ledger.isVerified(kHash, file));
+  ledger.record(kHash, file);
+  EXPECT_TRUE(ledger.isVerified(kHash, file));
+  EXPECT_FALSE(ledger.isVerified(kOtherHash, file));
+  EXPECT_EQ(ledger.size(), 1);
+
+  ledger.remove(file);
+  EXPECT_FALSE(ledger.isVerified(kHash, file));
+  EXPECT_EQ(ledger.size(), 0);
+}
+
+/* Writing to the file, even with the same size and content, invalidates the entry. */
+TEST(TargetLedger, ModifiedFile) {
+  TemporaryDirectory temp_dir;
+  const boost::filesystem::path file = temp_dir / "image";
+  Utils::writeFile(file, std::string("image content"));
+  auto storage = newStorage(temp_dir);
+
+  TargetLedger ledger(temp_dir.Path(), storage);
+  ledger.record(kHash, file);
+  {
+    std::ofstream out(file.string(), std::ios::binary | std::ios::in | std::ios::out);
+    out << "I";
+  }
+  EXPECT_FALSE(ledger.isVerified(kHash, file));
+
+  // Replaced by another file.
+  ledger.record(kHash, file);
+  Utils::writeFile(file, std::string("image content"));
+  EXPECT_FALSE(ledger.isVerified(kHash, file));
+
+  boost::filesystem::remove(file);
+  EXPECT_FALSE(ledger.isVerified(kHash, file));
+}
+
+/* The ledger is kept across restarts. */
+TEST(TargetLedger, Persistence) {
+  TemporaryDirectory temp_dir;
+  const boost::filesystem::path file = temp_dir / "image";
+  Utils::writeFile(file, std::string("image content"));
+  auto storage = newStorage(temp_dir);
+  {
+    TargetLedger ledger(temp_dir.Path(), storage);
+    ledger.record(kHash, file);
+  }
+  TargetLedger ledger(temp_dir.Path(), storage);
+  EXPECT_EQ(ledger.size(), 1);
+  EXPECT_TRUE(ledger.isVerified(kHash, file));
+}
+
+/* Entries that have been edited, or made under another key, are ignored. */
+TEST(TargetLedger, Tampering) {
+  TemporaryDirectory temp_dir;
+  const boost::filesystem::path file = temp_dir / "image";
+  Utils::writeFile(file, std::string("image content"));
+  auto storage = newStorage(temp_dir);
+  {
+    TargetLedger ledger(temp_dir.Path(), storage);
+    ledger.record(kHash, file);
+  }
+  const std::string content = Utils::readFile(temp_dir / ".verified");
+  ASSERT_NE(content.find(kHash.HashString()), std::string::npos);
+
+  std::string edited(content);
+  edited.replace(edited.find(kHash.HashString()), kHash.HashString().size(), kOtherHash.HashString());
+  Utils::writeFile(temp_dir / ".verified", edited);
+  {
+    TargetLedger ledger(temp_dir.Path(), storage);
+    EXPECT_EQ(ledger.size(), 0);
+    EXPECT_FALSE(ledger.isVerified(kOtherHash, file));
+  }
+
+  Utils::writeFile(temp_dir / ".verified", content);
+  TemporaryDirectory other_storage_dir;
+  auto other_storage = newStorage(other_storage_dir);
+  {
+    TargetLedger ledger(temp_dir.Path(), other_storage);
+    EXPECT_EQ(ledger.size(), 0);
+    // A new key is created and the old entries dropped.
+    ledger.record(kOtherHash, file);
+  }
+  TargetLedger ledger(temp_dir.Path(), other_storage);
+  EXPECT_TRUE(ledger.isVerified(kOtherHash, file));
+  EXPECT_FALSE(ledger.isVerified(kHash, file));
+}
+
+/* The key is kept in the storage, not next to the ledger. */
+TEST(TargetLedger, KeyInStorage) {
+  TemporaryDirectory temp_dir;
+  const boost::filesystem::path file = temp_dir / "image";
+  Utils::writeFile(file, std::string("image content"));
+  auto storage = newStorage(temp_dir);
+
+  TargetLedger ledger(temp_dir.Path(), storage);
+  EXPECT_FALSE(storage->loadTargetLedgerKey(nullptr));
+  ledger.record(kHash, file);
+  std::string key;
+  EXPECT_TRUE(storage->loadTargetLedgerKey(&key));
+  EXPECT_EQ(key.size(), 32);
+  EXPECT_FALSE(boost::filesystem::exists(temp_dir / ".verified.key"));
+}
+
+#ifndef __NO_MAIN__
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+#endif
@@ -5,9 +5,12 @@
 
 #include "libaktualizr/aktualizr.h"
 #include "libaktualizr/events.h"
+#include "primary/event_dispatcher.h"
+#include "primary/polling_scheduler.h"
 #include "primary/sotauptaneclient.h"
 #include "utilities/apiqueue.h"
 #include "utilities/timer.h"
+#include "utilities/tracing.h"
 
 using std::shared_ptr;
 
@@ -20,14 +23,35 @@ Aktualizr::Aktualizr(Config config, std::shared_ptr<INvStorage> storage_in,
   if (sodium_init() == -1) {  // Note that sodium_init doesn't require a matching 'sodium_deinit'
     throw std::runtime_error("Unable to initialize libsodium");
   }
+  Tracer::configure(config_.tracing);
 
   storage_ = std::move(storage_in);
   storage_->importData(config_.import);
 
-  uptane_client_ = std::make_shared<SotaUptaneClient>(config_, storage_, http_in, sig_, api_queue_->FlowControlToken());
+  // The client sends its events to the dispatcher, which passes them on to the
+  // handlers registered with SetSignalHandler().
+  std::shared_ptr<event::Channel> client_sig = sig_;
+  if (config_.uptane.event_queue_size > 0) {
+    dispatcher_ =
+        std::make_shared<EventDispatcher>(sig_, config_.uptane.event_queue_size, config_.uptane.event_overflow);
+    client_sig = std::make_shared<event::Channel>();
+    client_sig->connect([dispatcher = dispatcher_](shared_ptr<event::BaseEvent> event) {
+      dispatcher->post(std::move(event));
+    });
+  }
+
+  uptane_client_ =
+      std::make_shared<SotaUptaneClient>(config_, storage_, http_in, client_sig, api_queue_->FlowControlToken());
+  polling_scheduler_ = std_::make_unique<PollingScheduler>(config_.uptane);
 }
 
-Aktualizr::~Aktualizr() { api_queue_.reset(nullptr); }
+Aktualizr::~Aktualizr() {
+  api_queue_.reset(nullptr);
+  if (dispatcher_) {
+    dispatcher_->stop();
+  }
+  Tracer::flush();
+}
 
 void Aktualizr::Initialize() {
   uptane_client_->initialize();
@@ -40,15 +64,21 @@ bool Aktualizr::UptaneCycle() {
     if (update_result.status == result::UpdateStatus::kError) {
       // If the metadata verification failed, inform the backend immediately.
       SendManifest().get();
+      polling_scheduler_->report(PollingScheduler::Outcome::kFailed);
+    } else {
+      polling_scheduler_->report(PollingScheduler::Outcome::kIdle);
     }
     return true;
   }
 
+  // Until the update is installed, check back sooner than usual.
+  polling_scheduler_->report(PollingScheduler::Outcome::kActive);
   result::Download download_result = Download(update_result.updates).get();
   if (download_result.status != result::DownloadStatus::kSuccess || download_result.updates.empty()) {
     if (download_result.status != result::DownloadStatus::kNothingToDownload) {
       // If the download failed, inform the backend immediately.
       SendManifest().get();
+      polling_scheduler_->report(PollingScheduler::Outcome::kFailed);
     }
     return true;
   }
@@ -66,6 +96,7 @@ bool Aktualizr::UptaneCycle() {
     // If updates were applied and no any reboot/finalization is required then send/put manifest
     // as soon as possible, don't wait for config_.uptane.polling_sec
     SendManifest().get();
+    polling_scheduler_->report(PollingScheduler::Outcome::kIdle);
   }
 
   return true;
@@ -73,7 +104,6 @@ bool Aktualizr::UptaneCycle() {
 
 std::future<void> Aktualizr::RunForever() {
   std::future<void> future = std::async(std::launch::async, [this]() {
-    std::unique_lock<std::mutex> l(exit_cond_.m);
     bool have_sent_device_data = false;
     while (true) {
       try {
@@ -83,17 +113,28 @@ std::future<void> Aktualizr::RunForever() {
           have_sent_device_data = true;
         }
 
-        if (!UptaneCycle()) {
+        const bool keep_running = UptaneCycle();
+        Tracer::flush();
+        if (!keep_running) {
           break;
         }
       } catch (SotaUptaneClient::ProvisioningFailed &e) {
         LOG_DEBUG << "Not provisioned yet:" << e.what();
+        polling_scheduler_->report(PollingScheduler::Outcome::kFailed);
       }
 
-      if (exit_cond_.cv.wait_for(l, std::chrono::seconds(config_.uptane.polling_sec),
-                                 [this] { return exit_cond_.flag; })) {
+      const auto delay = polling_scheduler_->next(uptane_client_->takeServerHints());
+      // Only held while waiting, so that Shutdown() and Wakeup() don't block
+      // until the cycle is over.
+      std::unique_lock<std::mutex> l(exit_cond_.m);
+      if (exit_cond_.cv.wait_for(l, delay, [this] { return exit_cond_.flag || exit_cond_.wakeup; }) &&
+          exit_cond_.flag) {
         break;
       }
+      if (exit_cond_.wakeup) {
+        LOG_INFO << "Woken up, checking for updates";
+        exit_cond_.wakeup = false;
+      }
     }
     uptane_client_->completeInstall();
   });
@@ -108,6 +149,14 @@ void Aktualizr::Shutdown() {
   exit_cond_.cv.notify_all();
 }
 
+void Aktualizr::Wakeup() {
+  {
+    std::lock_guard<std::mutex> g(exit_cond_.m);
+    exit_cond_.wakeup = true;
+  }
+  exit_cond_.cv.notify_all();
+}
+
 void Aktualizr::AddSecondary(const std::shared_ptr<SecondaryInterface> &secondary) {
   uptane_client_->addSecondary(secondary);
 }
@@ -228,6 +277,10 @@ std::vector<Uptane::Target> Aktualizr::GetStoredTargets() { return uptane_client
 
 void Aktualizr::DeleteStoredTarget(const Uptane::Target &target) { uptane_client_->deleteStoredTarget(target); }
 
-std::ifstream Aktualizr::OpenStoredTarget(const Uptane::Target &target) {
+std::unique_ptr<std::istream> Aktualizr::OpenStoredTarget(const Uptane::Target &target) {
   return uptane_client_->openStoredTarget(target);
 }
+
+std::unique_ptr<MappedFile> Aktualizr::MapStoredTarget(const Uptane::Target &target) {
+  return uptane_client_->mapStoredTarget(target);
+}
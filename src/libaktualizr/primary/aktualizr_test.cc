@@ -1336,6 +1336,45 @@ TEST(Aktualizr, CheckNoUpdates) {
   verifyNothingInstalled(aktualizr.uptane_client()->AssembleManifest());
 }
 
+/*
+ * RunForever -> Wakeup -> the next update check starts without waiting for
+ * the end of the polling interval.
+ */
+TEST(Aktualizr, Wakeup) {
+  TemporaryDirectory temp_dir;
+  auto http = std::make_shared<HttpFake>(temp_dir.Path(), "noupdates", fake_meta_dir);
+  Config conf = UptaneTestCommon::makeTestConfig(temp_dir, http->tls_server);
+  conf.uptane.polling_sec = 3600;
+
+  auto storage = INvStorage::newStorage(conf.storage);
+  UptaneTestCommon::TestAktualizr aktualizr(conf, storage, http);
+
+  std::mutex m;
+  std::condition_variable cv;
+  size_t update_checks = 0;
+  boost::signals2::connection conn =
+      aktualizr.SetSignalHandler([&](const std::shared_ptr<event::BaseEvent>& event) {
+        if (event->variant == "UpdateCheckComplete") {
+          std::lock_guard<std::mutex> lock(m);
+          ++update_checks;
+          cv.notify_all();
+        }
+      });
+  auto wait_for_checks = [&](size_t n) {
+    std::unique_lock<std::mutex> lock(m);
+    return cv.wait_for(lock, std::chrono::seconds(20), [&] { return update_checks >= n; });
+  };
+
+  aktualizr.Initialize();
+  auto run = aktualizr.RunForever();
+  ASSERT_TRUE(wait_for_checks(1));
+  aktualizr.Wakeup();
+  EXPECT_TRUE(wait_for_checks(2));
+
+  aktualizr.Shutdown();
+  EXPECT_EQ(run.wait_for(std::chrono::seconds(20)), std::future_status::ready);
+}
+
 /*
  * Initialize -> Download -> nothing to download.
  *
@@ -1876,6 +1915,7 @@ TEST(Aktualizr, InstallWithUpdates) {
       << "Primary firmware is not present in storage after the download";
   EXPECT_NO_THROW(aktualizr.OpenStoredTarget(secondary_target))
       << "Secondary firmware is not present in storage after the download";
+  EXPECT_EQ(aktualizr.MapStoredTarget(primary_target)->size(), primary_target.length());
 
   // After updates have been downloaded, try to install them.
   aktualizr.Install(update_result.updates);
@@ -0,0 +1,219 @@
+#include "primary/event_dispatcher.h"
+
+#include <set>
+#include <string>
+#include <unordered_map>
+
+#include "logging/logging.h"
+
+EventDispatcher::EventDispatcher(std::shared_ptr<event::Channel> subscribers, size_t capacity, EventOverflow overflow)
+    : subscribers_(std::move(subscribers)), overflow_(overflow) {
+  // The ring works on power of two sizes.
+  size_t size = 2;
+  while (size < capacity) {
+    size <<= 1U;
+  }
+  mask_ = size - 1;
+  cells_.reset(new Cell[size]);  // NOLINT(modernize-avoid-c-arrays)
+  for (size_t i = 0; i < size; ++i) {
+    cells_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+  thread_ = std::thread([this] { run(); });
+}
+
+EventDispatcher::~EventDispatcher() { stop(); }
+
+bool EventDispatcher::isBarrier(const event::BaseEvent& event) {
+  static const std::set<std::string> barriers{
+      event::SendDeviceDataComplete::TypeName,  event::PutManifestComplete::TypeName,
+      event::UpdateCheckComplete::TypeName,     event::AllDownloadsComplete::TypeName,
+      event::AllInstallsComplete::TypeName,     event::CampaignCheckComplete::TypeName,
+      event::CampaignAcceptComplete::TypeName,  event::CampaignDeclineComplete::TypeName,
+      event::CampaignPostponeComplete::TypeName};
+  return barriers.count(event.variant) != 0;
+}
+
+// Bounded queue from Dmitry Vyukov: every cell carries a sequence number that
+// tells producers and the consumer whose turn it is, so neither has to lock.
+bool EventDispatcher::tryPush(std::shared_ptr<event::BaseEvent>& event) {
+  size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+  Cell* cell;
+  for (;;) {
+    cell = &cells_[pos & mask_];
+    const size_t seq = cell->sequence.load(std::memory_order_acquire);
+    const auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+    if (diff == 0) {
+      if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      return false;  // full
+    } else {
+      pos = enqueue_pos_.load(std::memory_order_relaxed);
+    }
+  }
+  cell->event = std::move(event);
+  cell->sequence.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+bool EventDispatcher::tryPop(std::shared_ptr<event::BaseEvent>& event) {
+  Cell& cell = cells_[dequeue_pos_ & mask_];
+  if (cell.sequence.load(std::memory_order_acquire) != dequeue_pos_ + 1) {
+    return false;
+  }
+  event = std::move(cell.event);
+  cell.sequence.store(dequeue_pos_ + mask_ + 1, std::memory_order_release);
+  ++dequeue_pos_;
+  return true;
+}
+
+void EventDispatcher::post(std::shared_ptr<event::BaseEvent> event) {
+  if (!event) {
+    return;
+  }
+  // Either stop() sees this post in progress and waits for it, or this post
+  // sees that the dispatcher has stopped.
+  ++posting_;
+  if (stopped_.load()) {
+    --posting_;
+    (*subscribers_)(event);
+    return;
+  }
+  const bool barrier = isBarrier(*event);
+  const bool progress = event->isTypeOf<event::DownloadProgressReport>();
+
+  if (!tryPush(event)) {
+    if (overflow_ == EventOverflow::kDropNewest || (overflow_ == EventOverflow::kDropProgress && progress)) {
+      --posting_;
+      LOG_TRACE << "Event queue is full, dropping " << event->variant << " event";
+      ++dropped_;
+      return;
+    }
+    // The delivery thread is busy with the events in the ring, it makes room
+    // after every batch.
+    std::unique_lock<std::mutex> lock(m_);
+    space_cv_.wait(lock, [this, &event] { return tryPush(event); });
+  }
+  --posting_;
+  // Wake up the delivery thread. The fence pairs with the one in run(): either
+  // this thread sees that the delivery thread sleeps, or the delivery thread
+  // sees the new event before it goes to sleep.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (sleeping_.load(std::memory_order_relaxed)) {
+    std::lock_guard<std::mutex> lock(m_);
+    work_cv_.notify_one();
+  }
+  if (barrier) {
+    flush();
+  }
+}
+
+void EventDispatcher::flush() {
+  if (std::this_thread::get_id() == thread_.get_id()) {
+    // Called from an event handler, the events can't be delivered meanwhile.
+    return;
+  }
+  const size_t target = enqueue_pos_.load();
+  std::unique_lock<std::mutex> lock(m_);
+  // stop() delivers whatever is left in the ring, so this returns even if
+  // the delivery thread is gone.
+  delivered_cv_.wait(lock, [this, target] { return delivered_pos_.load() >= target; });
+}
+
+void EventDispatcher::stop() {
+  if (!thread_.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(m_);
+    stopping_ = true;
+    work_cv_.notify_one();
+  }
+  thread_.join();
+  stopped_.store(true);
+  // Events posted between the end of run() and the line above are still in
+  // the ring, as are those of posts that are still in progress.
+  drain();
+}
+
+void EventDispatcher::deliver(std::vector<std::shared_ptr<event::BaseEvent>>& batch) {
+  // Only the latest progress report of each Target is of interest.
+  std::unordered_map<std::string, size_t> latest_progress;
+  for (size_t i = 0; i < batch.size(); ++i) {
+    if (batch[i]->isTypeOf<event::DownloadProgressReport>()) {
+      latest_progress[std::static_pointer_cast<event::DownloadProgressReport>(batch[i])->target.filename()] = i;
+    }
+  }
+
+  for (size_t i = 0; i < batch.size(); ++i) {
+    if (batch[i]->isTypeOf<event::DownloadProgressReport>() &&
+        latest_progress[std::static_pointer_cast<event::DownloadProgressReport>(batch[i])->target.filename()] != i) {
+      ++dropped_;
+      continue;
+    }
+    try {
+      (*subscribers_)(batch[i]);
+    } catch (const std::exception& e) {
+      LOG_ERROR << "Handler of " << batch[i]->variant << " event failed: " << e.what();
+    }
+  }
+}
+
+bool EventDispatcher::deliverQueued(std::vector<std::shared_ptr<event::BaseEvent>>& batch) {
+  std::shared_ptr<event::BaseEvent> event;
+  while (tryPop(event)) {
+    batch.push_back(std::move(event));
+  }
+  if (batch.empty()) {
+    return false;
+  }
+  {
+    std::lock_guard<std::mutex> lock(m_);
+    space_cv_.notify_all();
+  }
+  deliver(batch);
+  batch.clear();
+  std::lock_guard<std::mutex> lock(m_);
+  delivered_pos_.store(dequeue_pos_);
+  delivered_cv_.notify_all();
+  return true;
+}
+
+void EventDispatcher::drain() {
+  std::vector<std::shared_ptr<event::BaseEvent>> batch;
+  for (;;) {
+    if (deliverQueued(batch)) {
+      continue;
+    }
+    if (posting_.load() == 0 && enqueue_pos_.load() == dequeue_pos_) {
+      break;
+    }
+    std::this_thread::yield();
+  }
+}
+
+void EventDispatcher::run() {
+  std::vector<std::shared_ptr<event::BaseEvent>> batch;
+  for (;;) {
+    if (deliverQueued(batch)) {
+      continue;
+    }
+    if (enqueue_pos_.load() != dequeue_pos_) {
+      // A producer has claimed the next cell, but not filled it yet.
+      std::this_thread::yield();
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(m_);
+    if (stopping_) {
+      break;
+    }
+    sleeping_.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (enqueue_pos_.load(std::memory_order_relaxed) == dequeue_pos_) {
+      work_cv_.wait(lock);
+    }
+    sleeping_.store(false, std::memory_order_relaxed);
+  }
+}
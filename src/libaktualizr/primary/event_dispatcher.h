@@ -0,0 +1,84 @@
+#ifndef EVENT_DISPATCHER_H_
+#define EVENT_DISPATCHER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "libaktualizr/events.h"
+#include "libaktualizr/types.h"
+
+/**
+ * Delivers events to the subscribers of a channel on a thread of its own, so
+ * that slow subscribers don't hold up downloads and installations.
+ *
+ * Events are passed through a bounded, lock-free multi-producer ring. Before
+ * they are delivered, download progress reports that have been superseded by
+ * a later report for the same Target are dropped. What happens when the ring
+ * is full is decided by the EventOverflow policy.
+ *
+ * Events that complete an API call (UpdateCheckComplete, AllInstallsComplete,
+ * ...) wait until they have been delivered, so by the time the call returns,
+ * its events have been seen by the subscribers, just as with synchronous
+ * delivery.
+ */
+class EventDispatcher {
+ public:
+  EventDispatcher(std::shared_ptr<event::Channel> subscribers, size_t capacity,
+                  EventOverflow overflow = EventOverflow::kDropProgress);
+  ~EventDispatcher();
+  EventDispatcher(const EventDispatcher&) = delete;
+  EventDispatcher(EventDispatcher&&) = delete;
+  EventDispatcher& operator=(const EventDispatcher&) = delete;
+  EventDispatcher& operator=(EventDispatcher&&) = delete;
+
+  /** Queue an event for delivery. Safe to call from any thread. */
+  void post(std::shared_ptr<event::BaseEvent> event);
+  /** Wait until all events posted so far have been delivered or dropped. */
+  void flush();
+  /** Deliver the remaining events and stop the delivery thread. Events posted afterwards are delivered right away. */
+  void stop();
+
+  size_t capacity() const { return mask_ + 1; }
+  /** Number of events dropped because the ring was full or because they were superseded. */
+  uint64_t dropped() const { return dropped_.load(); }
+
+ private:
+  struct Cell {
+    std::atomic<size_t> sequence{0};
+    std::shared_ptr<event::BaseEvent> event;
+  };
+
+  static bool isBarrier(const event::BaseEvent& event);
+  bool tryPush(std::shared_ptr<event::BaseEvent>& event);
+  bool tryPop(std::shared_ptr<event::BaseEvent>& event);
+  void deliver(std::vector<std::shared_ptr<event::BaseEvent>>& batch);
+  bool deliverQueued(std::vector<std::shared_ptr<event::BaseEvent>>& batch);
+  void drain();
+  void run();
+
+  std::shared_ptr<event::Channel> subscribers_;
+  EventOverflow overflow_;
+  size_t mask_;
+  std::unique_ptr<Cell[]> cells_;  // NOLINT(modernize-avoid-c-arrays)
+  std::atomic<size_t> enqueue_pos_{0};
+  size_t dequeue_pos_{0};  // only touched by the delivery thread, and by stop() once it is gone
+
+  std::atomic<size_t> delivered_pos_{0};
+  std::atomic<uint64_t> dropped_{0};
+  std::atomic<bool> sleeping_{false};
+  std::atomic<bool> stopped_{false};
+  std::atomic<size_t> posting_{0};  // posts that may still push into the ring
+  bool stopping_{false};  // guarded by m_
+  std::mutex m_;
+  std::condition_variable work_cv_;
+  std::condition_variable space_cv_;
+  std::condition_variable delivered_cv_;
+  std::thread thread_;
+};
+
+#endif  // EVENT_DISPATCHER_H_
@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "primary/event_dispatcher.h"
+
+static std::shared_ptr<event::BaseEvent> progress(const std::string& filename, unsigned int percent) {
+  return std::make_shared<event::DownloadProgressReport>(Uptane::Target(filename, Json::Value()), "", percent);
+}
+
+/* Events are delivered in order on the delivery thread and completion events wait for their delivery. */
+TEST(EventDispatcher, Order) {
+  auto channel = std::make_shared<event::Channel>();
+  std::vector<std::string> received;
+  std::thread::id handler_thread;
+  channel->connect([&](const std::shared_ptr<event::BaseEvent>& event) {
+    handler_thread = std::this_thread::get_id();
+    received.push_back(event->variant);
+  });
+
+  EventDispatcher dispatcher(channel, 16);
+  dispatcher.post(std::make_shared<event::InstallStarted>(Uptane::EcuSerial("serial")));
+  dispatcher.post(std::make_shared<event::PutManifestComplete>(true));
+  ASSERT_EQ(received.size(), 2);
+  EXPECT_EQ(received[0], "InstallStarted");
+  EXPECT_EQ(received[1], "PutManifestComplete");
+  EXPECT_NE(handler_thread, std::this_thread::get_id());
+}
+
+/* Superseded progress reports are dropped while a slow handler is busy. */
+TEST(EventDispatcher, CoalesceProgress) {
+  auto channel = std::make_shared<event::Channel>();
+  std::promise<void> entered;
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  std::vector<std::string> received;
+  channel->connect([&](const std::shared_ptr<event::BaseEvent>& event) {
+    if (event->isTypeOf<event::InstallStarted>()) {
+      entered.set_value();
+      released.wait();
+    }
+    if (event->isTypeOf<event::DownloadProgressReport>()) {
+      auto report = std::static_pointer_cast<event::DownloadProgressReport>(event);
+      received.push_back(report->target.filename() + ":" + std::to_string(report->progress));
+    } else {
+      received.push_back(event->variant);
+    }
+  });
+
+  EventDispatcher dispatcher(channel, 64);
+  dispatcher.post(std::make_shared<event::InstallStarted>(Uptane::EcuSerial("serial")));
+  entered.get_future().wait();
+  for (unsigned int i = 1; i <= 10; ++i) {
+    dispatcher.post(progress("a", i * 10));
+    dispatcher.post(progress("b", i * 5));
+  }
+  release.set_value();
+  dispatcher.flush();
+
+  const std::vector<std::string> expected{"InstallStarted", "a:100", "b:50"};
+  EXPECT_EQ(received, expected);
+  EXPECT_EQ(dispatcher.dropped(), 18);
+}
+
+/* Overflow policies decide what happens to events that don't fit into the ring. */
+TEST(EventDispatcher, Overflow) {
+  for (const auto overflow : {EventOverflow::kBlock, EventOverflow::kDropProgress, EventOverflow::kDropNewest}) {
+    auto channel = std::make_shared<event::Channel>();
+    std::promise<void> entered;
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<size_t> installs{0};
+    channel->connect([&](const std::shared_ptr<event::BaseEvent>& event) {
+      if (installs == 0) {
+        entered.set_value();
+      }
+      released.wait();
+      if (event->isTypeOf<event::InstallStarted>()) {
+        ++installs;
+      }
+    });
+
+    EventDispatcher dispatcher(channel, 4, overflow);
+    // The first event blocks the handler, the next ones fill the ring.
+    dispatcher.post(std::make_shared<event::InstallStarted>(Uptane::EcuSerial("serial")));
+    entered.get_future().wait();
+    for (size_t i = 0; i < dispatcher.capacity(); ++i) {
+      dispatcher.post(std::make_shared<event::InstallStarted>(Uptane::EcuSerial("serial")));
+    }
+    auto extra = std::async(std::launch::async, [&dispatcher] {
+      dispatcher.post(progress("a", 10));
+      dispatcher.post(std::make_shared<event::InstallStarted>(Uptane::EcuSerial("serial")));
+    });
+    const bool blocked = extra.wait_for(std::chrono::milliseconds(100)) == std::future_status::timeout;
+    release.set_value();
+    extra.get();
+    dispatcher.flush();
+
+    const size_t posted = dispatcher.capacity() + 2;
+    switch (overflow) {
+      case EventOverflow::kBlock:
+        EXPECT_TRUE(blocked);
+        EXPECT_EQ(installs, posted);
+        EXPECT_EQ(dispatcher.dropped(), 0);
+        break;
+      case EventOverflow::kDropProgress:
+        EXPECT_TRUE(blocked);
+        EXPECT_EQ(installs, posted);
+        EXPECT_EQ(dispatcher.dropped(), 1);
+        break;
+      case EventOverflow::kDropNewest:
+      default:
+        EXPECT_FALSE(blocked);
+        EXPECT_EQ(installs, posted - 1);
+        EXPECT_EQ(dispatcher.dropped(), 2);
+        break;
+    }
+  }
+}
+
+/* Events are delivered synchronously once the dispatcher is stopped. */
+TEST(EventDispatcher, Stop) {
+  auto channel = std::make_shared<event::Channel>();
+  size_t received = 0;
+  channel->connect([&received](const std::shared_ptr<event::BaseEvent>& event) {
+    (void)event;
+    ++received;
+  });
+
+  EventDispatcher dispatcher(channel, 16);
+  dispatcher.post(std::make_shared<event::InstallStarted>(Uptane::EcuSerial("serial")));
+  dispatcher.stop();
+  EXPECT_EQ(received, 1);
+  dispatcher.post(std::make_shared<event::InstallStarted>(Uptane::EcuSerial("serial")));
+  EXPECT_EQ(received, 2);
+}
+
+/* No event is lost when the dispatcher is stopped while events are posted. */
+TEST(EventDispatcher, StopWhilePosting) {
+  auto channel = std::make_shared<event::Channel>();
+  std::atomic<size_t> received{0};
+  channel->connect([&received](const std::shared_ptr<event::BaseEvent>& event) {
+    (void)event;
+    ++received;
+  });
+
+  EventDispatcher dispatcher(channel, 16, EventOverflow::kBlock);
+  const size_t per_thread = 1000;
+  std::vector<std::thread> posters;
+  for (int i = 0; i < 4; ++i) {
+    posters.emplace_back([&dispatcher] {
+      for (size_t j = 0; j < per_thread; ++j) {
+        dispatcher.post(std::make_shared<event::InstallStarted>(Uptane::EcuSerial("serial")));
+      }
+    });
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  dispatcher.stop();
+  for (auto& t : posters) {
+    t.join();
+  }
+  EXPECT_EQ(received.load(), 4 * per_thread);
+  EXPECT_EQ(dispatcher.dropped(), 0);
+}
+
+#ifndef __NO_MAIN__
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+#endif
@@ -0,0 +1,60 @@
+#include "polling_scheduler.h"
+
+#include <algorithm>
+
+#include "logging/logging.h"
+
+using std::chrono::milliseconds;
+using std::chrono::seconds;
+
+PollingScheduler::PollingScheduler(const UptaneConfig& config, uint32_t seed)
+    : interval_(seconds(config.polling_sec)),
+      active_interval_(seconds(std::min(config.polling_sec, config.polling_active_sec))),
+      max_interval_(seconds(std::max(config.polling_sec, config.polling_max_sec))),
+      jitter_(static_cast<double>(std::min<uint64_t>(config.polling_jitter_percent, 100)) / 100.),
+      random_(seed) {}
+
+milliseconds PollingScheduler::jitter(milliseconds delay, double from, double to) {
+  std::uniform_real_distribution<double> factor(from, to);
+  return milliseconds(static_cast<int64_t>(static_cast<double>(delay.count()) * (1. + factor(random_))));
+}
+
+milliseconds PollingScheduler::next(const Uptane::ServerHints& hints) {
+  const int64_t max_sec = std::chrono::duration_cast<seconds>(max_interval_).count();
+  milliseconds delay = interval_;
+  switch (outcome_) {
+    case Outcome::kIdle:
+      failures_ = 0;
+      // The server has told us that the timestamp metadata won't change
+      // before then, so there is no point in asking earlier.
+      if (hints.max_age_sec > 0) {
+        delay = std::max<milliseconds>(delay, seconds(std::min(hints.max_age_sec, max_sec)));
+      }
+      break;
+    case Outcome::kActive:
+      failures_ = 0;
+      delay = active_interval_;
+      break;
+    case Outcome::kFailed:
+      ++failures_;
+      // Exponential backoff, from polling_sec after the first failure.
+      for (unsigned i = 1; i < failures_ && delay < max_interval_; ++i) {
+        delay *= 2;
+      }
+      break;
+    default:
+      break;
+  }
+  delay = std::min(jitter(std::min(delay, max_interval_), -jitter_, jitter_), max_interval_);
+
+  if (hints.retry_after_sec >= 0) {
+    // Only ever add to what the server asked for, so that the whole fleet
+    // doesn't come back at the same moment.
+    const milliseconds retry_after = seconds(std::min(hints.retry_after_sec, max_sec));
+    if (retry_after > delay) {
+      delay = jitter(retry_after, 0., jitter_);
+    }
+  }
+  LOG_DEBUG << "Next update check in " << delay.count() << " ms";
+  return delay;
+}
@@ -0,0 +1,56 @@
+#ifndef POLLING_SCHEDULER_H_
+#define POLLING_SCHEDULER_H_
+
+#include <chrono>
+#include <cstdint>
+#include <random>
+
+#include "libaktualizr/config.h"
+#include "uptane/fetcher.h"
+
+/**
+ * Decides how long RunForever waits before the next update cycle.
+ *
+ * The interval is uptane.polling_sec, shortened to uptane.polling_active_sec
+ * while an update is in progress and doubled after each consecutive failure.
+ * The server can ask for a longer wait with Retry-After on a metadata request
+ * (target downloads don't pass it on), or announce with the max-age of the
+ * timestamp metadata that nothing changes before then. Every wait is
+ * randomized by uptane.polling_jitter_percent, so that devices which start
+ * together do not keep polling together. No wait is longer than
+ * uptane.polling_max_sec (or polling_sec, if that is longer).
+ */
+class PollingScheduler {
+ public:
+  enum class Outcome {
+    // Up to date
+    kIdle,
+    // An update is being downloaded or installed
+    kActive,
+    // The server could not be reached, the metadata could not be verified or
+    // the download of an update failed
+    kFailed,
+  };
+
+  explicit PollingScheduler(const UptaneConfig& config, uint32_t seed = std::random_device{}());
+
+  /** Record the outcome of an update cycle. */
+  void report(Outcome outcome) { outcome_ = outcome; }
+  /** Delay before the next cycle, given the outcome of the last one and the hints of the server. */
+  std::chrono::milliseconds next(const Uptane::ServerHints& hints);
+
+  unsigned consecutiveFailures() const { return failures_; }
+
+ private:
+  std::chrono::milliseconds jitter(std::chrono::milliseconds delay, double from, double to);
+
+  const std::chrono::milliseconds interval_;
+  const std::chrono::milliseconds active_interval_;
+  const std::chrono::milliseconds max_interval_;
+  const double jitter_;
+  Outcome outcome_{Outcome::kIdle};
+  unsigned failures_{0};
+  std::mt19937 random_;
+};
+
+#endif  // POLLING_SCHEDULER_H_
@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+
+#include "libaktualizr/config.h"
+#include "primary/polling_scheduler.h"
+
+using std::chrono::milliseconds;
+using std::chrono::seconds;
+using Outcome = PollingScheduler::Outcome;
+
+static UptaneConfig pollingConfig(uint64_t jitter_percent = 0) {
+  UptaneConfig config;
+  config.polling_sec = 300;
+  config.polling_active_sec = 30;
+  config.polling_max_sec = 3600;
+  config.polling_jitter_percent = jitter_percent;
+  return config;
+}
+
+/* Without hints and jitter, the interval is polling_sec, or polling_active_sec
+ * while an update is in progress. */
+TEST(PollingScheduler, Intervals) {
+  PollingScheduler scheduler(pollingConfig());
+  EXPECT_EQ(scheduler.next({}), seconds(300));
+  scheduler.report(Outcome::kActive);
+  EXPECT_EQ(scheduler.next({}), seconds(30));
+  scheduler.report(Outcome::kIdle);
+  EXPECT_EQ(scheduler.next({}), seconds(300));
+}
+
+/* The interval doubles with each consecutive failure, up to polling_max_sec,
+ * and is back to normal after a success. */
+TEST(PollingScheduler, Backoff) {
+  PollingScheduler scheduler(pollingConfig());
+  scheduler.report(Outcome::kFailed);
+  EXPECT_EQ(scheduler.next({}), seconds(300));
+  EXPECT_EQ(scheduler.next({}), seconds(600));
+  EXPECT_EQ(scheduler.next({}), seconds(1200));
+  EXPECT_EQ(scheduler.next({}), seconds(2400));
+  EXPECT_EQ(scheduler.next({}), seconds(3600));
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(scheduler.next({}), seconds(3600));
+  }
+  EXPECT_EQ(scheduler.consecutiveFailures(), 105);
+  scheduler.report(Outcome::kIdle);
+  EXPECT_EQ(scheduler.next({}), seconds(300));
+  EXPECT_EQ(scheduler.consecutiveFailures(), 0);
+}
+
+/* The server can ask for longer waits, but not longer than polling_max_sec. */
+TEST(PollingScheduler, ServerHints) {
+  PollingScheduler scheduler(pollingConfig());
+  Uptane::ServerHints hints;
+  hints.max_age_sec = 900;
+  EXPECT_EQ(scheduler.next(hints), seconds(900));
+  hints.max_age_sec = 60;
+  EXPECT_EQ(scheduler.next(hints), seconds(300));
+  hints.max_age_sec = 86400;
+  EXPECT_EQ(scheduler.next(hints), seconds(3600));
+
+  // The freshness of the metadata doesn't matter during an update.
+  scheduler.report(Outcome::kActive);
+  hints.max_age_sec = 900;
+  EXPECT_EQ(scheduler.next(hints), seconds(30));
+
+  scheduler.report(Outcome::kFailed);
+  hints = Uptane::ServerHints();
+  hints.retry_after_sec = 1000;
+  EXPECT_EQ(scheduler.next(hints), seconds(1000));
+  hints.retry_after_sec = 10;
+  EXPECT_EQ(scheduler.next(hints), seconds(600));
+  hints.retry_after_sec = 1000000000000;
+  EXPECT_EQ(scheduler.next(hints), seconds(3600));
+}
+
+/* The jitter spreads the polls of devices that started together. */
+TEST(PollingScheduler, Jitter) {
+  PollingScheduler scheduler(pollingConfig(10), 42);
+  milliseconds min = milliseconds::max();
+  milliseconds max = milliseconds::min();
+  for (int i = 0; i < 1000; ++i) {
+    const milliseconds delay = scheduler.next({});
+    min = std::min(min, delay);
+    max = std::max(max, delay);
+  }
+  EXPECT_GE(min, seconds(270));
+  EXPECT_LE(max, seconds(330));
+  EXPECT_LT(min, seconds(280));
+  EXPECT_GT(max, seconds(320));
+
+  // Never earlier than the server asked for.
+  scheduler.report(Outcome::kFailed);
+  Uptane::ServerHints hints;
+  hints.retry_after_sec = 1000;
+  for (int i = 0; i < 100; ++i) {
+    const milliseconds delay = scheduler.next(hints);
+    EXPECT_GE(delay, seconds(1000));
+    EXPECT_LE(delay, seconds(3600));
+  }
+}
+
+#ifndef __NO_MAIN__
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+#endif
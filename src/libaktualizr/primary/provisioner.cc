@@ -362,10 +362,12 @@ void Provisioner::initEcuRegister() {
   }
 
   // Only store the changes if we successfully registered the ECUs.
-  storage_->storeEcuSerials(new_ecu_serials_);
-  for (const auto& info : sec_info_) {
-    storage_->saveSecondaryInfo(info.serial, info.type, info.pub_key);
-  }
+  storage_->batch([this](INvStorage& txn) {
+    txn.storeEcuSerials(new_ecu_serials_);
+    for (const auto& info : sec_info_) {
+      txn.saveSecondaryInfo(info.serial, info.type, info.pub_key);
+    }
+  });
   // Create a DeviceId if it hasn't been done already. This is necessary
   // because storeDeviceId() resets the is_registered flag and storeEcuRegistered()
   // requires there to be a DeviceID in the device_info table already.
@@ -0,0 +1,43 @@
+#include "primary/root_chain.h"
+
+#include "logging/logging.h"
+#include "storage/invstorage.h"
+#include "uptane/exceptions.h"
+#include "uptane/fetcher.h"
+
+RootChain::RootChain(Uptane::RepositoryType repo, const INvStorage &storage, const Uptane::IMetadataFetcher &fetcher,
+                     const api::FlowControlToken *flow_control)
+    : repo_(repo), storage_(storage), fetcher_(fetcher), flow_control_(flow_control) {
+  std::string latest_root;
+  if (!storage_.loadLatestRoot(&latest_root, repo_)) {
+    LOG_ERROR << "Error reading " << repo_ << " repo Root metadata";
+    return;
+  }
+  latest_version_ = Uptane::extractVersionUntrusted(latest_root);
+  roots_.emplace(latest_version_, std::move(latest_root));
+}
+
+std::vector<std::string> RootChain::range(const int first, const int last) {
+  std::vector<std::string> chain;
+  if (first > last) {
+    return chain;
+  }
+  chain.reserve(static_cast<size_t>(last - first + 1));
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  for (int version = first; version <= last; version++) {
+    auto it = roots_.find(version);
+    if (it == roots_.end()) {
+      std::string root;
+      if (!storage_.loadRoot(&root, repo_, Uptane::Version(version))) {
+        LOG_WARNING << "Couldn't find " << repo_ << " repo Root metadata version " << version
+                    << " in the storage, trying remote repo";
+        fetcher_.fetchRole(&root, Uptane::kMaxRootSize, repo_, Uptane::Role::Root(), Uptane::Version(version),
+                           flow_control_);
+      }
+      it = roots_.emplace(version, std::move(root)).first;
+    }
+    chain.push_back(it->second);
+  }
+  return chain;
+}
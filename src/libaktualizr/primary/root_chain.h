@@ -0,0 +1,50 @@
+#ifndef ROOT_CHAIN_H_
+#define ROOT_CHAIN_H_
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "uptane/tuf.h"
+#include "utilities/flow_control.h"
+
+class INvStorage;
+namespace Uptane {
+class IMetadataFetcher;
+}
+
+/**
+ * The Root metadata history of one repository, shared by the Root rotations
+ * of all the Secondaries in one installation. Every version is read from
+ * storage (or, failing that, fetched from the server) at most once, however
+ * many Secondaries need it. It is safe to use from several threads.
+ */
+class RootChain {
+ public:
+  RootChain(Uptane::RepositoryType repo, const INvStorage &storage, const Uptane::IMetadataFetcher &fetcher,
+            const api::FlowControlToken *flow_control);
+
+  Uptane::RepositoryType repo() const { return repo_; }
+  /** Version of the latest Root metadata in storage, or -1 if it could not be read. */
+  int latestVersion() const { return latest_version_; }
+
+  /**
+   * Get the Root metadata versions from `first` to `last` inclusive, oldest
+   * first.
+   * @throws Uptane::Exception if any version is neither stored nor fetchable.
+   */
+  std::vector<std::string> range(int first, int last);
+
+ private:
+  const Uptane::RepositoryType repo_;
+  const INvStorage &storage_;
+  const Uptane::IMetadataFetcher &fetcher_;
+  const api::FlowControlToken *flow_control_;
+  int latest_version_{-1};
+
+  std::mutex mutex_;
+  std::map<int, std::string> roots_;
+};
+
+#endif  // ROOT_CHAIN_H_
@@ -0,0 +1,158 @@
+#include "primary/secondary_monitor.h"
+
+#include <algorithm>
+
+#include "logging/logging.h"
+#include "utilities/utils.h"
+
+SecondaryMonitor::SecondaryMonitor(std::chrono::milliseconds retry_interval,
+                                   std::chrono::milliseconds refresh_interval,
+                                   std::chrono::milliseconds max_retry_interval)
+    : retry_interval_(retry_interval),
+      refresh_interval_(refresh_interval),
+      max_retry_interval_(std::max(max_retry_interval, retry_interval)) {}
+
+SecondaryMonitor::~SecondaryMonitor() { stop(); }
+
+void SecondaryMonitor::add(const SecondaryInterface::Ptr& secondary) {
+  const Uptane::EcuSerial serial = secondary->getSerial();
+  std::lock_guard<std::mutex> lock(m_);
+  if (stopping_ || secondaries_.count(serial) != 0) {
+    return;
+  }
+  auto monitored = std_::make_unique<Monitored>(secondary);
+  Monitored* raw = monitored.get();
+  raw->thread = std::thread([this, raw] { run(raw); });
+  secondaries_.emplace(serial, std::move(monitored));
+}
+
+bool SecondaryMonitor::isReachable(const Uptane::EcuSerial& serial) const {
+  std::lock_guard<std::mutex> lock(m_);
+  auto it = secondaries_.find(serial);
+  return it != secondaries_.end() && it->second->reachable;
+}
+
+std::vector<Uptane::EcuSerial> SecondaryMonitor::waitReachable(const std::vector<Uptane::EcuSerial>& serials,
+                                                               std::chrono::steady_clock::time_point deadline) {
+  std::unique_lock<std::mutex> lock(m_);
+  std::vector<Uptane::EcuSerial> unknown;
+  // Secondary => the ping that has to answer.
+  std::map<Monitored*, uint64_t> pending;
+  std::vector<Monitored*> waiting;
+  const auto now = std::chrono::steady_clock::now();
+  for (const auto& serial : serials) {
+    auto it = secondaries_.find(serial);
+    if (it == secondaries_.end()) {
+      unknown.push_back(serial);
+      continue;
+    }
+    Monitored* monitored = it->second.get();
+    if (monitored->reachable && now - monitored->answered < retry_interval_) {
+      continue;
+    }
+    // The ping that is running, if any, may have started too long ago.
+    pending[monitored] = monitored->started + 1;
+    monitored->wake = true;
+    ++monitored->waiters;
+    waiting.push_back(monitored);
+  }
+  wake_cv_.notify_all();
+
+  auto settle = [this, &pending]() {
+    for (auto it = pending.begin(); it != pending.end();) {
+      Monitored* monitored = it->first;
+      if (monitored->completed < it->second) {
+        ++it;
+      } else if (monitored->reachable) {
+        it = pending.erase(it);
+      } else {
+        // Wait for the next regular ping.
+        it->second = monitored->started + 1;
+        ++it;
+      }
+    }
+    return pending.empty() || stopping_;
+  };
+  result_cv_.wait_until(lock, deadline, settle);
+
+  std::vector<Uptane::EcuSerial> unreachable(unknown);
+  if (stopping_) {
+    // The Secondaries are being taken away by stop().
+    return serials;
+  }
+  for (const auto& p : pending) {
+    unreachable.push_back(p.first->secondary->getSerial());
+  }
+  for (Monitored* monitored : waiting) {
+    --monitored->waiters;
+  }
+  return unreachable;
+}
+
+void SecondaryMonitor::stop() {
+  std::map<Uptane::EcuSerial, std::unique_ptr<Monitored>> secondaries;
+  {
+    std::lock_guard<std::mutex> lock(m_);
+    stopping_ = true;
+    wake_cv_.notify_all();
+    result_cv_.notify_all();
+    secondaries.swap(secondaries_);
+  }
+  for (auto& s : secondaries) {
+    s.second->thread.join();
+  }
+}
+
+std::chrono::milliseconds SecondaryMonitor::nextInterval(const Monitored& monitored) const {
+  if (monitored.reachable) {
+    return refresh_interval_;
+  }
+  if (monitored.waiters > 0) {
+    return retry_interval_;
+  }
+  // Don't keep pinging a Secondary that is switched off, every failed ping
+  // costs a connection attempt.
+  auto interval = retry_interval_;
+  for (unsigned int i = 1; i < monitored.failures && interval < max_retry_interval_; ++i) {
+    interval *= 2;
+  }
+  return std::min(interval, max_retry_interval_);
+}
+
+void SecondaryMonitor::run(Monitored* monitored) {
+  std::unique_lock<std::mutex> lock(m_);
+  for (;;) {
+    auto woken = [this, monitored] { return stopping_ || monitored->wake; };
+    if (monitored->background || monitored->waiters > 0) {
+      wake_cv_.wait_for(lock, nextInterval(*monitored), woken);
+    } else {
+      wake_cv_.wait(lock, woken);
+    }
+    if (stopping_) {
+      return;
+    }
+    monitored->wake = false;
+    const uint64_t number = ++monitored->started;
+    lock.unlock();
+
+    bool reachable = false;
+    try {
+      reachable = monitored->secondary->ping();
+    } catch (const std::exception& e) {
+      LOG_DEBUG << "Failed to ping Secondary with serial " << monitored->secondary->getSerial() << ": " << e.what();
+    }
+
+    lock.lock();
+    if (reachable != monitored->reachable) {
+      LOG_INFO << "Secondary with serial " << monitored->secondary->getSerial() << " is "
+               << (reachable ? "reachable" : "not reachable");
+    }
+    monitored->reachable = reachable;
+    monitored->failures = reachable ? 0 : monitored->failures + 1;
+    monitored->completed = number;
+    if (reachable) {
+      monitored->answered = std::chrono::steady_clock::now();
+    }
+    result_cv_.notify_all();
+  }
+}
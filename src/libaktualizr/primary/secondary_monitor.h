@@ -0,0 +1,85 @@
+#ifndef SECONDARY_MONITOR_H_
+#define SECONDARY_MONITOR_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "libaktualizr/secondaryinterface.h"
+#include "libaktualizr/types.h"
+
+/**
+ * Keeps track of which Secondaries answer a ping, so that an installation can
+ * start as soon as all the Secondaries it targets are reachable.
+ *
+ * Every Secondary is pinged by a thread of its own, so that Secondaries that
+ * are still booting or slow to answer don't hold up the others. While
+ * waitReachable() waits for them, unreachable Secondaries are pinged every
+ * `retry_interval`. Otherwise reachable ones are pinged every
+ * `refresh_interval`, and unreachable ones with an interval that doubles
+ * after every failed ping, up to `max_retry_interval`.
+ *
+ * Outside of waitReachable(), ping() is called concurrently with the other
+ * calls to the Secondary, so only Secondaries whose
+ * SecondaryInterface::isPingThreadSafe() is true are pinged then.
+ */
+class SecondaryMonitor {
+ public:
+  explicit SecondaryMonitor(std::chrono::milliseconds retry_interval = std::chrono::seconds(1),
+                            std::chrono::milliseconds refresh_interval = std::chrono::seconds(10),
+                            std::chrono::milliseconds max_retry_interval = std::chrono::minutes(5));
+  ~SecondaryMonitor();
+  SecondaryMonitor(const SecondaryMonitor&) = delete;
+  SecondaryMonitor(SecondaryMonitor&&) = delete;
+  SecondaryMonitor& operator=(const SecondaryMonitor&) = delete;
+  SecondaryMonitor& operator=(SecondaryMonitor&&) = delete;
+
+  /** Start monitoring a Secondary. */
+  void add(const SecondaryInterface::Ptr& secondary);
+  /** Whether the Secondary answered its last ping. */
+  bool isReachable(const Uptane::EcuSerial& serial) const;
+  /**
+   * Wait until all the given Secondaries have answered a ping, or until the
+   * deadline. A Secondary that answered within the last `retry_interval`
+   * counts right away, the others are pinged at once. Returns the Secondaries
+   * that are still unreachable.
+   */
+  std::vector<Uptane::EcuSerial> waitReachable(const std::vector<Uptane::EcuSerial>& serials,
+                                               std::chrono::steady_clock::time_point deadline);
+  /** Stop all the threads. Called by the destructor as well. */
+  void stop();
+
+ private:
+  struct Monitored {
+    explicit Monitored(SecondaryInterface::Ptr secondary_in)
+        : secondary(std::move(secondary_in)), background(secondary->isPingThreadSafe()), wake(background) {}
+    SecondaryInterface::Ptr secondary;
+    const bool background;  // whether it may be pinged while nobody waits for it
+    bool reachable{false};
+    bool wake;
+    unsigned int waiters{0};   // calls of waitReachable() that wait for it
+    unsigned int failures{0};  // failed pings in a row
+    uint64_t started{0};    // number of pings started
+    uint64_t completed{0};  // number of the last ping completed
+    std::chrono::steady_clock::time_point answered;
+    std::thread thread;
+  };
+
+  void run(Monitored* monitored);
+  std::chrono::milliseconds nextInterval(const Monitored& monitored) const;
+
+  const std::chrono::milliseconds retry_interval_;
+  const std::chrono::milliseconds refresh_interval_;
+  const std::chrono::milliseconds max_retry_interval_;
+  std::map<Uptane::EcuSerial, std::unique_ptr<Monitored>> secondaries_;  // guarded by m_
+  bool stopping_{false};                                                 // guarded by m_
+  mutable std::mutex m_;
+  std::condition_variable wake_cv_;
+  std::condition_variable result_cv_;
+};
+
+#endif  // SECONDARY_MONITOR_H_
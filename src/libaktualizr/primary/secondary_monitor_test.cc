@@ -0,0 +1,173 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "libaktualizr/secondaryinterface.h"
+#include "primary/secondary_monitor.h"
+
+using std::chrono::milliseconds;
+
+class PingSecondary : public SecondaryInterface {
+ public:
+  PingSecondary(const std::string& serial, bool up, milliseconds delay = milliseconds(0), bool thread_safe = true)
+      : serial_(serial), up_(up), delay_(delay), thread_safe_(thread_safe) {}
+
+  void init(std::shared_ptr<SecondaryProvider> secondary_provider_in) override { (void)secondary_provider_in; }
+  std::string Type() const override { return "ping"; }
+  Uptane::EcuSerial getSerial() const override { return serial_; }
+  Uptane::HardwareIdentifier getHwId() const override { return Uptane::HardwareIdentifier("ping-hw"); }
+  PublicKey getPublicKey() const override { return PublicKey("", KeyType::kUnknown); }
+  Uptane::Manifest getManifest() const override { return Json::Value(); }
+  data::InstallationResult putMetadata(const Uptane::Target& target) override {
+    (void)target;
+    return data::InstallationResult(data::ResultCode::Numeric::kOk, "");
+  }
+  bool ping() const override {
+    ++pings;
+    std::this_thread::sleep_for(delay_);
+    return up_.load();
+  }
+  bool isPingThreadSafe() const override { return thread_safe_; }
+  int32_t getRootVersion(bool director) const override {
+    (void)director;
+    return 1;
+  }
+  data::InstallationResult putRoot(const std::string& root, bool director) override {
+    (void)root;
+    (void)director;
+    return data::InstallationResult(data::ResultCode::Numeric::kOk, "");
+  }
+  data::InstallationResult sendFirmware(const Uptane::Target& target,
+                                        const api::FlowControlToken* flow_control) override {
+    (void)target;
+    (void)flow_control;
+    return data::InstallationResult(data::ResultCode::Numeric::kOk, "");
+  }
+  data::InstallationResult install(const Uptane::Target& target, const api::FlowControlToken* flow_control) override {
+    (void)target;
+    (void)flow_control;
+    return data::InstallationResult(data::ResultCode::Numeric::kOk, "");
+  }
+
+  void setUp(bool up) { up_ = up; }
+  mutable std::atomic<int> pings{0};
+
+ private:
+  Uptane::EcuSerial serial_;
+  std::atomic<bool> up_;
+  milliseconds delay_;
+  bool thread_safe_;
+};
+
+static std::chrono::steady_clock::time_point in(milliseconds duration) {
+  return std::chrono::steady_clock::now() + duration;
+}
+
+/* Reachable Secondaries are found right away, unreachable ones time out. */
+TEST(SecondaryMonitor, Reachability) {
+  SecondaryMonitor monitor(milliseconds(20), milliseconds(1000));
+  auto up = std::make_shared<PingSecondary>("up", true);
+  auto down = std::make_shared<PingSecondary>("down", false);
+  monitor.add(up);
+  monitor.add(down);
+
+  EXPECT_TRUE(monitor.waitReachable({up->getSerial()}, in(milliseconds(2000))).empty());
+  EXPECT_TRUE(monitor.isReachable(up->getSerial()));
+
+  const auto unreachable = monitor.waitReachable({up->getSerial(), down->getSerial()}, in(milliseconds(200)));
+  ASSERT_EQ(unreachable.size(), 1);
+  EXPECT_EQ(unreachable[0], down->getSerial());
+  EXPECT_FALSE(monitor.isReachable(down->getSerial()));
+  // Unreachable Secondaries are pinged again and again.
+  EXPECT_GT(down->pings.load(), 3);
+
+  // Unknown Secondaries are never reachable.
+  EXPECT_EQ(monitor.waitReachable({Uptane::EcuSerial("unknown")}, in(milliseconds(50))).size(), 1);
+}
+
+/* The wait ends as soon as a Secondary comes up. */
+TEST(SecondaryMonitor, ComesUp) {
+  SecondaryMonitor monitor(milliseconds(20), milliseconds(1000));
+  auto booting = std::make_shared<PingSecondary>("booting", false);
+  monitor.add(booting);
+
+  std::thread boot([&booting]() {
+    std::this_thread::sleep_for(milliseconds(200));
+    booting->setUp(true);
+  });
+  const auto start = std::chrono::steady_clock::now();
+  EXPECT_TRUE(monitor.waitReachable({booting->getSerial()}, in(milliseconds(5000))).empty());
+  EXPECT_LT(std::chrono::steady_clock::now() - start, milliseconds(2000));
+  boot.join();
+}
+
+/* A Secondary that goes down is noticed by the fresh ping of the wait. */
+TEST(SecondaryMonitor, GoesDown) {
+  SecondaryMonitor monitor(milliseconds(20), milliseconds(60000));
+  auto secondary = std::make_shared<PingSecondary>("secondary", true);
+  monitor.add(secondary);
+  ASSERT_TRUE(monitor.waitReachable({secondary->getSerial()}, in(milliseconds(2000))).empty());
+
+  std::this_thread::sleep_for(milliseconds(50));
+  secondary->setUp(false);
+  EXPECT_EQ(monitor.waitReachable({secondary->getSerial()}, in(milliseconds(200))).size(), 1);
+}
+
+/* Slow Secondaries don't hold up the others. */
+TEST(SecondaryMonitor, Concurrent) {
+  SecondaryMonitor monitor(milliseconds(20), milliseconds(1000));
+  std::vector<Uptane::EcuSerial> serials;
+  std::vector<std::shared_ptr<PingSecondary>> secondaries;
+  for (int i = 0; i < 10; ++i) {
+    secondaries.push_back(std::make_shared<PingSecondary>("slow" + std::to_string(i), true, milliseconds(300)));
+    serials.push_back(secondaries.back()->getSerial());
+    monitor.add(secondaries.back());
+  }
+  const auto start = std::chrono::steady_clock::now();
+  EXPECT_TRUE(monitor.waitReachable(serials, in(milliseconds(5000))).empty());
+  // Sequential pings would take at least 3 s.
+  EXPECT_LT(std::chrono::steady_clock::now() - start, milliseconds(2000));
+}
+
+/* Unreachable Secondaries are pinged less and less often while nobody waits for them. */
+TEST(SecondaryMonitor, Backoff) {
+  SecondaryMonitor monitor(milliseconds(20), milliseconds(1000), milliseconds(80));
+  auto down = std::make_shared<PingSecondary>("down", false);
+  monitor.add(down);
+
+  // Pings after 0, 20, 40, 80, 160, 240, ... ms instead of every 20 ms.
+  std::this_thread::sleep_for(milliseconds(500));
+  EXPECT_GE(down->pings.load(), 4);
+  EXPECT_LE(down->pings.load(), 12);
+
+  // A wait goes back to the short interval.
+  const int before = down->pings.load();
+  EXPECT_EQ(monitor.waitReachable({down->getSerial()}, in(milliseconds(200))).size(), 1);
+  EXPECT_GT(down->pings.load() - before, 5);
+}
+
+/* Secondaries that can't be pinged concurrently are only pinged during a wait. */
+TEST(SecondaryMonitor, NotThreadSafe) {
+  SecondaryMonitor monitor(milliseconds(20), milliseconds(20));
+  auto secondary = std::make_shared<PingSecondary>("secondary", true, milliseconds(0), false);
+  monitor.add(secondary);
+
+  std::this_thread::sleep_for(milliseconds(100));
+  EXPECT_EQ(secondary->pings.load(), 0);
+  EXPECT_TRUE(monitor.waitReachable({secondary->getSerial()}, in(milliseconds(2000))).empty());
+  const int pings = secondary->pings.load();
+  EXPECT_GE(pings, 1);
+  std::this_thread::sleep_for(milliseconds(100));
+  EXPECT_EQ(secondary->pings.load(), pings);
+}
+
+#ifndef __NO_MAIN__
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+#endif
@@ -3,8 +3,10 @@
 #include <fstream>
 
 #include "logging/logging.h"
+#include "package_manager/deltapatch.h"
 #include "storage/invstorage.h"
 #include "uptane/tuf.h"
+#include "utilities/memory_monitor.h"
 #include "utilities/utils.h"
 
 bool SecondaryProvider::getMetadata(Uptane::MetaBundle* meta_bundle, const Uptane::Target& target) const {
@@ -99,6 +101,22 @@ std::string SecondaryProvider::getTreehubCredentials() const {
   }
 }
 
-std::ifstream SecondaryProvider::getTargetFileHandle(const Uptane::Target& target) const {
+std::unique_ptr<std::istream> SecondaryProvider::getTargetFileHandle(const Uptane::Target& target) const {
   return package_manager_->openTargetFile(target);
 }
+
+std::unique_ptr<MappedFile> SecondaryProvider::mapTargetFile(const Uptane::Target& target) const {
+  return package_manager_->mapTargetFile(target);
+}
+
+bool SecondaryProvider::fitsInMemory(uint64_t bytes) const {
+  return MemoryMonitor(config_.uptane.memory_soft_limit_mb * 1024 * 1024).fits(bytes);
+}
+
+std::ifstream SecondaryProvider::getDeltaFileHandle(const DeltaTarget& delta) const {
+  auto file = package_manager_->checkDeltaFile(delta);
+  if (!file || file->first != delta.length()) {
+    return std::ifstream();
+  }
+  return package_manager_->openDeltaFile(delta);
+}
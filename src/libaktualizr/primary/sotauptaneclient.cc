@@ -3,6 +3,7 @@
 #include <fnmatch.h>
 #include <fstream>
 #include <memory>
+#include <set>
 #include <utility>
 
 #include "crypto/crypto.h"
@@ -11,6 +12,7 @@
 #include "logging/logging.h"
 #include "provisioner.h"
 #include "uptane/exceptions.h"
+#include "utilities/tracing.h"
 #include "utilities/utils.h"
 
 static void report_progress_cb(event::Channel *channel, const Uptane::Target &target, const std::string &description,
@@ -47,7 +49,8 @@ SotaUptaneClient::SotaUptaneClient(Config &config_in, std::shared_ptr<INvStorage
       uptane_fetcher(new Uptane::Fetcher(config, http)),
       events_channel(std::move(events_channel_in)),
       provisioner_(config.provision, storage, http, key_manager_, secondaries),
-      flow_control_(flow_control) {
+      flow_control_(flow_control),
+      memory_monitor_(config.uptane.memory_soft_limit_mb * 1024 * 1024) {
   report_queue = std_::make_unique<ReportQueue>(config, http, storage);
   secondary_provider_ = SecondaryProviderBuilder::Build(config, storage, package_manager_);
 }
@@ -62,6 +65,7 @@ void SotaUptaneClient::addSecondary(const std::shared_ptr<SecondaryInterface> &s
 
   secondaries.emplace(serial, sec);
   sec->init(secondary_provider_);
+  secondary_monitor_.add(sec);
   provisioner_.SecondariesWereChanged();
 }
 
@@ -104,6 +108,7 @@ std::vector<Uptane::Target> SotaUptaneClient::findForEcu(const std::vector<Uptan
 }
 
 data::InstallationResult SotaUptaneClient::PackageInstall(const Uptane::Target &target) {
+  TraceSpan span("uptane", "PackageInstall");
   LOG_INFO << "Installing package using " << package_manager_->name() << " package manager";
   try {
     return package_manager_->install(target);
@@ -143,26 +148,25 @@ void SotaUptaneClient::finalizeAfterReboot() {
     return;
   }
 
-  storage->saveEcuInstallationResult(primary_ecu_serial, install_res);
+  storage->batch([&](INvStorage &txn) {
+    txn.saveEcuInstallationResult(primary_ecu_serial, install_res);
 
-  if (install_res.success) {
-    storage->saveInstalledVersion(primary_ecu_serial.ToString(), *pending_target, InstalledVersionUpdateMode::kCurrent,
-                                  correlation_id);
+    // if finalize failed, unset pending flag so that the rest of the Uptane process can go forward again
+    txn.saveInstalledVersion(primary_ecu_serial.ToString(), *pending_target,
+                             install_res.success ? InstalledVersionUpdateMode::kCurrent
+                                                 : InstalledVersionUpdateMode::kNone,
+                             correlation_id);
 
-    report_queue->enqueue(std_::make_unique<EcuInstallationCompletedReport>(primary_ecu_serial, correlation_id, true));
-  } else {
-    // finalize failed, unset pending flag so that the rest of the Uptane process can go forward again
-    storage->saveInstalledVersion(primary_ecu_serial.ToString(), *pending_target, InstalledVersionUpdateMode::kNone,
-                                  correlation_id);
-    report_queue->enqueue(std_::make_unique<EcuInstallationCompletedReport>(primary_ecu_serial, correlation_id, false));
-  }
+    director_repo.dropTargets(txn);  // fix for OTA-2587, listen to backend again after end of install
 
-  director_repo.dropTargets(*storage);  // fix for OTA-2587, listen to backend again after end of install
+    data::InstallationResult ir;
+    std::string raw_report;
+    computeDeviceInstallationResult(&ir, &raw_report);
+    txn.storeDeviceInstallationResult(ir, raw_report, correlation_id);
+  });
 
-  data::InstallationResult ir;
-  std::string raw_report;
-  computeDeviceInstallationResult(&ir, &raw_report);
-  storage->storeDeviceInstallationResult(ir, raw_report, correlation_id);
+  report_queue->enqueue(
+      std_::make_unique<EcuInstallationCompletedReport>(primary_ecu_serial, correlation_id, install_res.success));
   putManifestSimple();
 }
 
@@ -302,6 +306,13 @@ void SotaUptaneClient::reportAktualizrConfiguration() {
 }
 
 Json::Value SotaUptaneClient::AssembleManifest() {
+  Json::Value manifest = collectManifest();
+  signPrimaryManifest(&manifest);
+  return manifest;
+}
+
+Json::Value SotaUptaneClient::collectManifest() {
+  TraceSpan span("uptane", "AssembleManifest");
   Json::Value manifest;  // signed top-level
   Uptane::EcuSerial primary_ecu_serial = primaryEcuSerial();
   manifest["primary_ecu_serial"] = primary_ecu_serial.ToString();
@@ -309,18 +320,10 @@ Json::Value SotaUptaneClient::AssembleManifest() {
   // first part: report current version/state of all ECUs
   Json::Value version_manifest;
 
-  Json::Value primary_manifest = uptane_manifest->assembleManifest(package_manager_->getCurrent());
-  std::vector<std::pair<Uptane::EcuSerial, int64_t>> ecu_cnt;
-  std::string report_counter;
-  if (!storage->loadEcuReportCounter(&ecu_cnt) || ecu_cnt.empty()) {
-    LOG_ERROR << "No ECU version report counter, please check the database!";
-    // TODO: consider not sending manifest at all in this case, or maybe retry
-  } else {
-    report_counter = std::to_string(ecu_cnt[0].second + 1);
-    storage->saveEcuReportCounter(ecu_cnt[0].first, ecu_cnt[0].second + 1);
-  }
-  version_manifest[primary_ecu_serial.ToString()] = uptane_manifest->sign(primary_manifest, report_counter);
+  // Signed later, by signPrimaryManifest()
+  version_manifest[primary_ecu_serial.ToString()] = uptane_manifest->assembleManifest(package_manager_->getCurrent());
 
+  std::vector<std::pair<Uptane::EcuSerial, std::string>> changed_ecu_manifests;
   for (auto it = secondaries.begin(); it != secondaries.end(); it++) {
     const Uptane::EcuSerial &ecu_serial = it->first;
     Uptane::Manifest secmanifest;
@@ -354,7 +357,12 @@ Json::Value SotaUptaneClient::AssembleManifest() {
     if (verified) {
       version_manifest[ecu_serial.ToString()] = secmanifest;
       if (!from_cache) {
-        storage->storeCachedEcuManifest(ecu_serial, Utils::jsonToCanonicalStr(secmanifest));
+        // Secondaries mostly report the same manifest as last time, no need
+        // to write it again.
+        std::string canonical = Utils::jsonToCanonicalStr(secmanifest);
+        if (canonical != cached_ecu_manifests_[ecu_serial]) {
+          changed_ecu_manifests.emplace_back(ecu_serial, std::move(canonical));
+        }
       }
     } else {
       // TODO(OTA-4305): send a corresponding event/report in this case
@@ -363,6 +371,16 @@ Json::Value SotaUptaneClient::AssembleManifest() {
     }
   }
   manifest["ecu_version_manifests"] = version_manifest;
+  if (!changed_ecu_manifests.empty()) {
+    storage->batch([&changed_ecu_manifests](INvStorage &txn) {
+      for (const auto &m : changed_ecu_manifests) {
+        txn.storeCachedEcuManifest(m.first, m.second);
+      }
+    });
+    for (auto &m : changed_ecu_manifests) {
+      cached_ecu_manifests_[m.first] = std::move(m.second);
+    }
+  }
 
   // second part: report installation results
   Json::Value installation_report;
@@ -403,6 +421,34 @@ Json::Value SotaUptaneClient::AssembleManifest() {
   return manifest;
 }
 
+void SotaUptaneClient::signPrimaryManifest(Json::Value *manifest) {
+  const std::string primary_ecu_serial = (*manifest)["primary_ecu_serial"].asString();
+  Json::Value &primary_manifest = (*manifest)["ecu_version_manifests"][primary_ecu_serial];
+
+  std::vector<std::pair<Uptane::EcuSerial, int64_t>> ecu_cnt;
+  std::string report_counter;
+  if (!storage->loadEcuReportCounter(&ecu_cnt) || ecu_cnt.empty()) {
+    LOG_ERROR << "No ECU version report counter, please check the database!";
+    // TODO: consider not sending manifest at all in this case, or maybe retry
+  } else {
+    report_counter = std::to_string(ecu_cnt[0].second + 1);
+    storage->saveEcuReportCounter(ecu_cnt[0].first, ecu_cnt[0].second + 1);
+  }
+  primary_manifest = uptane_manifest->sign(primary_manifest, report_counter);
+}
+
+std::string SotaUptaneClient::manifestFingerprint(const Json::Value &manifest) {
+  // Only what the ECUs report matters, not the signatures: these are not
+  // necessarily the same for the same content.
+  Json::Value content = manifest;
+  for (auto &ecu_manifest : content["ecu_version_manifests"]) {
+    if (ecu_manifest.isMember("signed")) {
+      ecu_manifest = ecu_manifest["signed"];
+    }
+  }
+  return Hash::generate(Hash::Type::kSha256, Utils::jsonToCanonicalStr(content)).HashString();
+}
+
 bool SotaUptaneClient::hasPendingUpdates() const { return storage->hasPendingInstall(); }
 
 void SotaUptaneClient::initialize() {
@@ -429,6 +475,7 @@ void SotaUptaneClient::requiresAlreadyProvisioned() {
 
 void SotaUptaneClient::updateDirectorMeta() {
   requiresProvision();
+  TraceSpan span("uptane", "updateDirectorMeta");
   try {
     director_repo.updateMeta(*storage, *uptane_fetcher, flow_control_);
   } catch (const std::exception &e) {
@@ -439,6 +486,7 @@ void SotaUptaneClient::updateDirectorMeta() {
 
 void SotaUptaneClient::updateImageMeta() {
   requiresProvision();
+  TraceSpan span("uptane", "updateImageMeta");
   try {
     image_repo.updateMeta(*storage, *uptane_fetcher, flow_control_);
   } catch (const std::exception &e) {
@@ -675,6 +723,7 @@ std::unique_ptr<Uptane::Target> SotaUptaneClient::findTargetInDelegationTree(con
 
 result::Download SotaUptaneClient::downloadImages(const std::vector<Uptane::Target> &targets) {
   requiresAlreadyProvisioned();
+  TraceSpan span("uptane", "downloadImages");
   // Uptane step 4 - download all the images and verify them against the metadata (for OSTree - pull without
   // deploying)
   std::lock_guard<std::mutex> guard(download_mutex);
@@ -738,6 +787,11 @@ void SotaUptaneClient::reportResume() {
 }
 
 std::pair<bool, Uptane::Target> SotaUptaneClient::downloadImage(const Uptane::Target &target) {
+  TraceSpan span("uptane", "downloadImage");
+  if (span) {
+    span.arg("target", target.filename());
+    span.arg("length", static_cast<int64_t>(target.length()));
+  }
   auto correlation_id = director_repo.getCorrelationId();
   // send an event for all ECUs that are touched by this target
   for (const auto &ecu : target.ecus()) {
@@ -754,6 +808,7 @@ std::pair<bool, Uptane::Target> SotaUptaneClient::downloadImage(const Uptane::Ta
     keys.loadKeys();
     auto prog_cb = [this](const Uptane::Target &t, const std::string &description, unsigned int progress) {
       report_progress_cb(events_channel.get(), t, description, progress);
+      checkMemory();
     };
 
     const Uptane::EcuSerial &primary_ecu_serial = primaryEcuSerial();
@@ -865,6 +920,7 @@ void SotaUptaneClient::sendDeviceData() {
 
 result::UpdateCheck SotaUptaneClient::fetchMeta() {
   requiresProvision();
+  TraceSpan span("uptane", "fetchMeta");
 
   result::UpdateCheck result;
 
@@ -889,6 +945,7 @@ result::UpdateCheck SotaUptaneClient::fetchMeta() {
     LOG_ERROR << "Error sending manifest!";
   }
   result = checkUpdates();
+  checkMemory();
   sendEvent<event::UpdateCheckComplete>(result);
 
   return result;
@@ -959,6 +1016,7 @@ result::UpdateCheck SotaUptaneClient::checkUpdates() {
 }
 
 result::UpdateStatus SotaUptaneClient::checkUpdatesOffline(const std::vector<Uptane::Target> &targets) {
+  TraceSpan span("uptane", "checkUpdatesOffline");
   if (hasPendingUpdates()) {
     // no need in update checking if there are some pending updates
     LOG_INFO << "An update is pending. Skipping stored metadata check until installation is complete.";
@@ -1008,6 +1066,7 @@ result::UpdateStatus SotaUptaneClient::checkUpdatesOffline(const std::vector<Upt
 
 result::Install SotaUptaneClient::uptaneInstall(const std::vector<Uptane::Target> &updates) {
   requiresAlreadyProvisioned();
+  TraceSpan span("uptane", "uptaneInstall");
   auto correlation_id = director_repo.getCorrelationId();
 
   // put most of the logic in a lambda so that we can take care of common
@@ -1039,16 +1098,19 @@ result::Install SotaUptaneClient::uptaneInstall(const std::vector<Uptane::Target
 
     Uptane::EcuSerial primary_ecu_serial = primaryEcuSerial();
     // Recheck the downloaded update hashes.
-    for (const auto &update : updates) {
-      if (update.IsForEcu(primary_ecu_serial) || !update.IsOstree()) {
-        // download binary images for any target, for both Primary and Secondary
-        // download an OSTree revision just for Primary, Secondary will do it by itself
-        // Primary cannot verify downloaded OSTree targets for Secondaries,
-        // Downloading of Secondary's OSTree repo revision to the Primary's can fail
-        // if they differ signficantly as OSTree has a certain cap/limit of the diff it pulls
-        if (package_manager_->verifyTarget(update) != TargetStatus::kGood) {
-          result.dev_report = {false, data::ResultCode::Numeric::kInternalError, ""};
-          return std::make_tuple(result, "Downloaded target is invalid");
+    {
+      TraceSpan verify_span("uptane", "verifyTargets");
+      for (const auto &update : updates) {
+        if (update.IsForEcu(primary_ecu_serial) || !update.IsOstree()) {
+          // download binary images for any target, for both Primary and Secondary
+          // download an OSTree revision just for Primary, Secondary will do it by itself
+          // Primary cannot verify downloaded OSTree targets for Secondaries,
+          // Downloading of Secondary's OSTree repo revision to the Primary's can fail
+          // if they differ signficantly as OSTree has a certain cap/limit of the diff it pulls
+          if (package_manager_->verifyTarget(update) != TargetStatus::kGood) {
+            result.dev_report = {false, data::ResultCode::Numeric::kInternalError, ""};
+            return std::make_tuple(result, "Downloaded target is invalid");
+          }
         }
       }
     }
@@ -1177,7 +1239,7 @@ void SotaUptaneClient::completeInstall() {
   }
 }
 
-bool SotaUptaneClient::putManifestSimple(const Json::Value &custom) {
+bool SotaUptaneClient::putManifestSimple(const Json::Value &custom, bool force) {
   // does not send event, so it can be used as a subset of other steps
   if (hasPendingUpdates()) {
     // Debug level here because info level is annoying if the update check
@@ -1186,11 +1248,25 @@ bool SotaUptaneClient::putManifestSimple(const Json::Value &custom) {
     return false;
   }
 
+  TraceSpan span("uptane", "putManifest");
   static bool connected = true;
-  auto manifest = AssembleManifest();
+  auto manifest = collectManifest();
   if (!custom.empty()) {
     manifest["custom"] = custom;
   }
+
+  // The server already knows everything in an unchanged manifest. Skip it,
+  // without using up a report counter, unless it is time for a heartbeat.
+  const std::string fingerprint = manifestFingerprint(manifest);
+  const auto now = std::chrono::steady_clock::now();
+  if (!force && config.uptane.manifest_heartbeat_sec > 0 && !manifest.isMember("installation_report") &&
+      fingerprint == last_manifest_fingerprint_ &&
+      now - last_manifest_sent_ < std::chrono::seconds(config.uptane.manifest_heartbeat_sec)) {
+    LOG_TRACE << "Not sending the manifest because it has not changed";
+    return true;
+  }
+
+  signPrimaryManifest(&manifest);
   auto signed_manifest = uptane_manifest->sign(manifest);
   HttpResponse response = http->put(config.uptane.director_server + "/manifest", signed_manifest);
   if (response.isOk()) {
@@ -1199,6 +1275,8 @@ bool SotaUptaneClient::putManifestSimple(const Json::Value &custom) {
     }
     connected = true;
     storage->clearInstallationResults();
+    last_manifest_fingerprint_ = fingerprint;
+    last_manifest_sent_ = now;
 
     return true;
   } else {
@@ -1212,26 +1290,26 @@ bool SotaUptaneClient::putManifestSimple(const Json::Value &custom) {
 bool SotaUptaneClient::putManifest(const Json::Value &custom) {
   requiresProvision();
 
-  bool success = putManifestSimple(custom);
+  bool success = putManifestSimple(custom, true);
   sendEvent<event::PutManifestComplete>(success);
   return success;
 }
 
 bool SotaUptaneClient::waitSecondariesReachable(const std::vector<Uptane::Target> &updates) {
-  std::map<Uptane::EcuSerial, SecondaryInterface *> targeted_secondaries;
+  TraceSpan span("uptane", "waitSecondariesReachable");
+  std::set<Uptane::EcuSerial> targeted_secondaries;
   const Uptane::EcuSerial &primary_ecu_serial = primaryEcuSerial();
   for (const auto &t : updates) {
     for (const auto &ecu : t.ecus()) {
       if (ecu.first == primary_ecu_serial) {
         continue;
       }
-      auto f = secondaries.find(ecu.first);
-      if (f == secondaries.end()) {
+      if (secondaries.find(ecu.first) == secondaries.end()) {
         LOG_ERROR << "Target " << t << " has an unknown ECU serial.";
         continue;
       }
 
-      targeted_secondaries[ecu.first] = f->second.get();
+      targeted_secondaries.insert(ecu.first);
     }
   }
 
@@ -1241,33 +1319,18 @@ bool SotaUptaneClient::waitSecondariesReachable(const std::vector<Uptane::Target
 
   LOG_INFO << "Waiting for Secondaries to connect to start installation...";
 
-  auto deadline = std::chrono::system_clock::now() + std::chrono::seconds(config.uptane.secondary_preinstall_wait_sec);
-  while (std::chrono::system_clock::now() <= deadline) {
-    if (targeted_secondaries.empty()) {
-      return true;
-    }
+  // The monitor pings the targeted Secondaries every second while this waits,
+  // so this returns as soon as the last of them answers.
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(config.uptane.secondary_preinstall_wait_sec);
+  const auto unreachable = secondary_monitor_.waitReachable(
+      std::vector<Uptane::EcuSerial>(targeted_secondaries.begin(), targeted_secondaries.end()), deadline);
 
-    for (auto sec_it = targeted_secondaries.begin(); sec_it != targeted_secondaries.end();) {
-      bool connected = false;
-      try {
-        connected = sec_it->second->ping();
-      } catch (const std::exception &ex) {
-        LOG_DEBUG << "Failed to ping Secondary with serial " << sec_it->first << ": " << ex.what();
-      }
-      if (connected) {
-        sec_it = targeted_secondaries.erase(sec_it);
-      } else {
-        sec_it++;
-      }
-    }
-    std::this_thread::sleep_for(std::chrono::seconds(1));
+  for (const auto &serial : unreachable) {
+    LOG_ERROR << "Secondary with serial " << serial << " failed to connect!";
   }
 
-  for (const auto &sec : targeted_secondaries) {
-    LOG_ERROR << "Secondary with serial " << sec.second->getSerial() << " failed to connect!";
-  }
-
-  return false;
+  return unreachable.empty();
 }
 
 void SotaUptaneClient::storeInstallationFailure(const data::InstallationResult &result) {
@@ -1285,15 +1348,15 @@ void SotaUptaneClient::storeInstallationFailure(const data::InstallationResult &
 
 /* If the Root has been rotated more than once, we need to provide the Secondary
  * with the incremental steps from what it has now. */
-data::InstallationResult SotaUptaneClient::rotateSecondaryRoot(Uptane::RepositoryType repo,
-                                                               SecondaryInterface &secondary) {
-  std::string latest_root;
-  if (!storage->loadLatestRoot(&latest_root, repo)) {
+data::InstallationResult SotaUptaneClient::rotateSecondaryRoot(RootChain &root_chain, SecondaryInterface &secondary) {
+  const Uptane::RepositoryType repo = root_chain.repo();
+  const bool director = repo == Uptane::RepositoryType::Director();
+  const int last_root_version = root_chain.latestVersion();
+  if (last_root_version < 0) {
     LOG_ERROR << "Error reading Root metadata";
     return data::InstallationResult(data::ResultCode::Numeric::kInternalError, "Error reading Root metadata");
   }
-  const int last_root_version = Uptane::extractVersionUntrusted(latest_root);
-  const int sec_root_version = secondary.getRootVersion((repo == Uptane::RepositoryType::Director()));
+  const int sec_root_version = secondary.getRootVersion(director);
   LOG_DEBUG << "Rotating " << repo << " from " << sec_root_version << " to " << (last_root_version - 1);
   if (sec_root_version < 0) {
     LOG_WARNING << "Secondary with serial " << secondary.getSerial() << " reported an invalid " << repo
@@ -1305,85 +1368,127 @@ data::InstallationResult SotaUptaneClient::rotateSecondaryRoot(Uptane::Repositor
 
   // Only send intermediate Roots that would otherwise be skipped. The latest
   // will be sent with the complete set of the latest metadata.
-  for (int version_to_send = sec_root_version + 1; version_to_send < last_root_version; version_to_send++) {
-    std::string root;
-    if (!storage->loadRoot(&root, repo, Uptane::Version(version_to_send))) {
-      LOG_WARNING << "Couldn't find Root metadata in the storage, trying remote repo";
-      try {
-        uptane_fetcher->fetchRole(&root, Uptane::kMaxRootSize, repo, Uptane::Role::Root(),
-                                  Uptane::Version(version_to_send), flow_control_);
-      } catch (const std::exception &e) {
-        LOG_ERROR << "Root metadata could not be fetched for Secondary with serial " << secondary.getSerial()
-                  << ", skipping to the next Secondary";
-        return {data::ResultCode::Numeric::kInternalError,
-                "Root metadata could not be fetched for Secondary with serial " + secondary.getSerial().ToString() +
-                    ", skipping to the next Secondary"};
+  int first_version = sec_root_version + 1;
+  const int last_version = last_root_version - 1;
+  if (first_version > last_version) {
+    return {data::ResultCode::Numeric::kOk, ""};
+  }
+
+  std::vector<std::string> roots;
+  try {
+    roots = root_chain.range(first_version, last_version);
+  } catch (const std::exception &e) {
+    LOG_ERROR << "Root metadata could not be fetched for Secondary with serial " << secondary.getSerial()
+              << ", skipping to the next Secondary";
+    return {data::ResultCode::Numeric::kInternalError,
+            "Root metadata could not be fetched for Secondary with serial " + secondary.getSerial().ToString() +
+                ", skipping to the next Secondary"};
+  }
+
+  try {
+    if (first_version == 1) {
+      // Old (pre 2024-07-XX) versions would assume that if sec_root_version
+      // is 0, either the Secondary doesn't have Root metadata or doesn't
+      // support the Root version request and skip sending any root metadata.
+      // Unfortunatately this cause TOR-3452 where an expired root metadata
+      // would cause updates to fail. Instead assume that '0' could mean 'I
+      // don't have any root versions yet'. If we send  version 1 and it is
+      // rejected, then assume we are in the case that the code originally was
+      // defending against: the secondary can't rotate root, and treat this
+      // as a success. The previous code would have returned success in this
+      // case anyway.
+      auto result = secondary.putRoot(roots.front(), director);
+      if (!result.isSuccess()) {
+        LOG_WARNING
+            << "Sending root.1.json to a secondary failed. Assuming it doesn't allow root rotation and continuing.";
+        return {data::ResultCode::Numeric::kOk, ""};
       }
+      roots.erase(roots.begin());
     }
-    try {
-      auto result = secondary.putRoot(root, repo == Uptane::RepositoryType::Director());
+    if (!roots.empty()) {
+      auto result = secondary.putRootChain(roots, director);
       if (!result.isSuccess()) {
-        // Old (pre 2024-07-XX) versions would assume that if sec_root_version
-        // is 0, either the Secondary doesn't have Root metadata or doesn't
-        // support the Root version request and skip sending any root metadata.
-        // Unfortunatately this cause TOR-3452 where an expired root metadata
-        // would cause updates to fail. Instead assume that '0' could mean 'I
-        // don't have any root versions yet'. If we send  version 1 and it is
-        // rejected, then assume we are in the case that the code originally was
-        // defending against: the secondary can't rotate root, and treat this
-        // as a success. The previous code would have returned success in this
-        // case anyway.
-        if (version_to_send == 1) {
-          LOG_WARNING
-              << "Sending root.1.json to a secondary failed. Assuming it doesn't allow root rotation and continuing.";
-          return {data::ResultCode::Numeric::kOk, ""};
-        }
         LOG_ERROR << "Sending Root metadata to Secondary with serial " << secondary.getSerial()
                   << " failed: " << result.result_code << " " << result.description;
         return result;
       }
-    } catch (const std::exception &ex) {
-      return {data::ResultCode::Numeric::kInternalError, ex.what()};
     }
+  } catch (const std::exception &ex) {
+    return {data::ResultCode::Numeric::kInternalError, ex.what()};
   }
   return {data::ResultCode::Numeric::kOk, ""};
 }
 
-// TODO: the function blocks until it updates all the Secondaries. Consider non-blocking operation.
+/* Rotate the Roots of and send the metadata to every Secondary concurrently.
+ * The Root metadata is loaded only once for all of them. The function still
+ * blocks until all the Secondaries have been processed. */
 void SotaUptaneClient::sendMetadataToEcus(const std::vector<Uptane::Target> &targets, data::InstallationResult *result,
                                           std::string *raw_installation_report) {
+  TraceSpan span("uptane", "sendMetadataToEcus");
   data::InstallationResult final_result{data::ResultCode::Numeric::kOk, ""};
   std::string result_code_err_str;
+
+  std::map<Uptane::EcuSerial, std::vector<Uptane::Target>> secondary_targets;
+  for (const auto &target : targets) {
+    for (const auto &ecu : target.ecus()) {
+      if (secondaries.find(ecu.first) != secondaries.end()) {
+        secondary_targets[ecu.first].push_back(target);
+      }
+    }
+  }
+
+  RootChain director_roots(Uptane::RepositoryType::Director(), *storage, *uptane_fetcher, flow_control_);
+  RootChain image_roots(Uptane::RepositoryType::Image(), *storage, *uptane_fetcher, flow_control_);
+
+  auto send_metadata = [this, &director_roots, &image_roots](SecondaryInterface &secondary,
+                                                             const std::vector<Uptane::Target> &sec_targets) {
+    /* Root rotation if necessary */
+    data::InstallationResult rotate_result = rotateSecondaryRoot(director_roots, secondary);
+    if (rotate_result.isSuccess()) {
+      rotate_result = rotateSecondaryRoot(image_roots, secondary);
+    }
+
+    std::vector<data::InstallationResult> results;
+    for (const auto &target : sec_targets) {
+      if (!rotate_result.isSuccess()) {
+        results.push_back(rotate_result);
+        continue;
+      }
+      try {
+        results.push_back(secondary.putMetadata(target));
+      } catch (const std::exception &ex) {
+        results.emplace_back(data::ResultCode::Numeric::kInternalError, ex.what());
+      }
+    }
+    return results;
+  };
+
+  std::map<Uptane::EcuSerial, std::future<std::vector<data::InstallationResult>>> futures;
+  for (const auto &sec_targets : secondary_targets) {
+    SecondaryInterface &sec = *secondaries[sec_targets.first];
+    futures.emplace(sec_targets.first,
+                    std::async(std::launch::async, send_metadata, std::ref(sec), std::cref(sec_targets.second)));
+  }
+
+  std::map<Uptane::EcuSerial, std::vector<data::InstallationResult>> results;
+  for (auto &f : futures) {
+    results.emplace(f.first, f.second.get());
+  }
+
+  // Report the failures in the same order as the targets list them.
+  std::map<Uptane::EcuSerial, size_t> next_result;
   for (const auto &target : targets) {
     for (const auto &ecu : target.ecus()) {
       const Uptane::EcuSerial ecu_serial = ecu.first;
       const Uptane::HardwareIdentifier hw_id = ecu.second;
-      auto sec = secondaries.find(ecu_serial);
-      if (sec == secondaries.end()) {
+      auto sec_results = results.find(ecu_serial);
+      if (sec_results == results.end()) {
         continue;
       }
 
-      data::InstallationResult local_result{data::ResultCode::Numeric::kOk, ""};
-      do {
-        /* Root rotation if necessary */
-        local_result = rotateSecondaryRoot(Uptane::RepositoryType::Director(), *(sec->second));
-        if (!local_result.isSuccess()) {
-          final_result = local_result;
-          break;
-        }
-        local_result = rotateSecondaryRoot(Uptane::RepositoryType::Image(), *(sec->second));
-        if (!local_result.isSuccess()) {
-          final_result = local_result;
-          break;
-        }
-        try {
-          local_result = sec->second->putMetadata(target);
-        } catch (const std::exception &ex) {
-          local_result = data::InstallationResult(data::ResultCode::Numeric::kInternalError, ex.what());
-        }
-      } while (false);
+      const data::InstallationResult &local_result = sec_results->second[next_result[ecu_serial]++];
       if (!local_result.isSuccess()) {
-        LOG_ERROR << "Sending metadata to " << sec->first << " failed: " << local_result.result_code << " "
+        LOG_ERROR << "Sending metadata to " << ecu_serial << " failed: " << local_result.result_code << " "
                   << local_result.description;
         const std::string ecu_code_str = hw_id.ToString() + ":" + local_result.result_code.ToString();
         result_code_err_str += (!result_code_err_str.empty() ? "|" : "") + ecu_code_str;
@@ -1439,6 +1544,7 @@ std::future<data::InstallationResult> SotaUptaneClient::sendFirmwareAsync(Second
 }
 
 std::vector<result::Install::EcuReport> SotaUptaneClient::sendImagesToEcus(const std::vector<Uptane::Target> &targets) {
+  TraceSpan span("uptane", "sendImagesToEcus");
   std::vector<result::Install::EcuReport> reports;
   std::vector<std::pair<result::Install::EcuReport, std::future<data::InstallationResult>>> firmwareFutures;
 
@@ -1465,20 +1571,39 @@ std::vector<result::Install::EcuReport> SotaUptaneClient::sendImagesToEcus(const
   }
 
   for (auto &f : firmwareFutures) {
-    data::InstallationResult fut_result = f.second.get();
-
-    if (fut_result.isSuccess() || fut_result.result_code == data::ResultCode::Numeric::kNeedCompletion) {
-      auto update_mode =
-          fut_result.isSuccess() ? InstalledVersionUpdateMode::kCurrent : InstalledVersionUpdateMode::kPending;
-      storage->saveInstalledVersion(f.first.serial.ToString(), f.first.update, update_mode,
-                                    director_repo.getCorrelationId());
+    f.first.install_res = f.second.get();
+    reports.push_back(f.first);
+    checkMemory();
+  }
+
+  // Record the results of all the Secondaries at once, rather than in two
+  // transactions for each of them.
+  storage->batch([&reports, this](INvStorage &txn) {
+    for (const auto &report : reports) {
+      const data::InstallationResult &res = report.install_res;
+      if (res.isSuccess() || res.result_code == data::ResultCode::Numeric::kNeedCompletion) {
+        auto update_mode =
+            res.isSuccess() ? InstalledVersionUpdateMode::kCurrent : InstalledVersionUpdateMode::kPending;
+        txn.saveInstalledVersion(report.serial.ToString(), report.update, update_mode,
+                                 director_repo.getCorrelationId());
+      }
+      txn.saveEcuInstallationResult(report.serial, res);
     }
+  });
+  return reports;
+}
 
-    f.first.install_res = fut_result;
-    storage->saveEcuInstallationResult(f.first.serial, f.first.install_res);
-    reports.push_back(f.first);
+void SotaUptaneClient::checkMemory() {
+  if (!memory_monitor_.enabled()) {
+    return;
+  }
+  const uint64_t rss = MemoryMonitor::residentBytes();
+  auto watermark = memory_monitor_.update(rss);
+  if (watermark) {
+    LOG_WARNING << "Resident memory has reached " << *watermark << "% of the soft limit: " << rss << " of "
+                << memory_monitor_.softLimit() << " bytes";
+    sendEvent<event::MemoryWatermark>(*watermark, rss, memory_monitor_.softLimit());
   }
-  return reports;
 }
 
 Uptane::LazyTargetsList SotaUptaneClient::allTargets() const {
@@ -1523,18 +1648,20 @@ void SotaUptaneClient::checkAndUpdatePendingSecondaries() {
       boost::optional<Uptane::Target> pending_version;
       Uptane::CorrelationId correlation_id;
       if (storage->loadInstalledVersions(pending_ecu.first.ToString(), nullptr, &pending_version, &correlation_id)) {
-        storage->saveEcuInstallationResult(pending_ecu.first,
-                                           data::InstallationResult(data::ResultCode::Numeric::kOk, ""));
-        storage->saveInstalledVersion(pending_ecu.first.ToString(), *pending_version,
-                                      InstalledVersionUpdateMode::kCurrent, correlation_id);
+        storage->batch([&](INvStorage &txn) {
+          txn.saveEcuInstallationResult(pending_ecu.first,
+                                        data::InstallationResult(data::ResultCode::Numeric::kOk, ""));
+          txn.saveInstalledVersion(pending_ecu.first.ToString(), *pending_version, InstalledVersionUpdateMode::kCurrent,
+                                   correlation_id);
+
+          data::InstallationResult ir;
+          std::string raw_report;
+          computeDeviceInstallationResult(&ir, &raw_report);
+          txn.storeDeviceInstallationResult(ir, raw_report, correlation_id);
+        });
 
         report_queue->enqueue(
             std_::make_unique<EcuInstallationCompletedReport>(pending_ecu.first, correlation_id, true));
-
-        data::InstallationResult ir;
-        std::string raw_report;
-        computeDeviceInstallationResult(&ir, &raw_report);
-        storage->storeDeviceInstallationResult(ir, raw_report, correlation_id);
       }
     } else {
       LOG_DEBUG << "The pending update for ECU " << pending_ecu.first << " has not been installed ("
@@ -1561,7 +1688,7 @@ boost::optional<Uptane::HardwareIdentifier> SotaUptaneClient::getEcuHwId(const U
   return boost::none;
 }
 
-std::ifstream SotaUptaneClient::openStoredTarget(const Uptane::Target &target) {
+std::unique_ptr<std::istream> SotaUptaneClient::openStoredTarget(const Uptane::Target &target) {
   auto status = package_manager_->verifyTarget(target);
   if (status == TargetStatus::kGood) {
     return package_manager_->openTargetFile(target);
@@ -1569,3 +1696,12 @@ std::ifstream SotaUptaneClient::openStoredTarget(const Uptane::Target &target) {
     throw std::runtime_error("Failed to open Target");
   }
 }
+
+std::unique_ptr<MappedFile> SotaUptaneClient::mapStoredTarget(const Uptane::Target &target) {
+  auto status = package_manager_->verifyTarget(target);
+  if (status == TargetStatus::kGood) {
+    return package_manager_->mapTargetFile(target);
+  } else {
+    throw std::runtime_error("Failed to map Target");
+  }
+}
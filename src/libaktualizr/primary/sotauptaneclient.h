@@ -1,6 +1,7 @@
 #ifndef SOTA_UPTANE_CLIENT_H_
 #define SOTA_UPTANE_CLIENT_H_
 
+#include <chrono>
 #include <map>
 #include <memory>
 #include <string>
@@ -21,6 +22,8 @@
 
 #include "bootloader/bootloader.h"
 #include "http/httpclient.h"
+#include "primary/root_chain.h"
+#include "primary/secondary_monitor.h"
 #include "primary/secondary_provider_builder.h"
 #include "provisioner.h"
 #include "reportqueue.h"
@@ -32,6 +35,7 @@
 #include "uptane/manifest.h"
 #include "uptane/tuf.h"
 #include "utilities/flow_control.h"
+#include "utilities/memory_monitor.h"
 
 class SotaUptaneClient {
  public:
@@ -84,11 +88,13 @@ class SotaUptaneClient {
   void campaignDecline(const std::string &campaign_id);
   void campaignPostpone(const std::string &campaign_id);
   bool hasPendingUpdates() const;
+  Uptane::ServerHints takeServerHints() const { return uptane_fetcher->takeServerHints(); }
   bool isInstallCompletionRequired();
   void completeInstall();
   std::vector<Uptane::Target> getStoredTargets() const { return package_manager_->getTargetFiles(); }
   void deleteStoredTarget(const Uptane::Target &target) { package_manager_->removeTargetFile(target); }
-  std::ifstream openStoredTarget(const Uptane::Target &target);
+  std::unique_ptr<std::istream> openStoredTarget(const Uptane::Target &target);
+  std::unique_ptr<MappedFile> mapStoredTarget(const Uptane::Target &target);
 
  private:
   FRIEND_TEST(Aktualizr, FullNoUpdates);
@@ -108,6 +114,7 @@ class SotaUptaneClient {
   FRIEND_TEST(Uptane, InstallFakeGood);
   FRIEND_TEST(Uptane, restoreVerify);
   FRIEND_TEST(Uptane, PutManifest);
+  FRIEND_TEST(Uptane, PutManifestHeartbeat);
   FRIEND_TEST(Uptane, offlineIteration);
   FRIEND_TEST(Uptane, IgnoreUnknownUpdate);
   FRIEND_TEST(Uptane, kRejectAllTest);
@@ -163,13 +170,19 @@ class SotaUptaneClient {
   void reportAktualizrConfiguration();
   bool waitSecondariesReachable(const std::vector<Uptane::Target> &updates);
   void storeInstallationFailure(const data::InstallationResult &result);
-  data::InstallationResult rotateSecondaryRoot(Uptane::RepositoryType repo, SecondaryInterface &secondary);
+  data::InstallationResult rotateSecondaryRoot(RootChain &root_chain, SecondaryInterface &secondary);
   void sendMetadataToEcus(const std::vector<Uptane::Target> &targets, data::InstallationResult *result,
                           std::string *raw_installation_report);
   std::future<data::InstallationResult> sendFirmwareAsync(SecondaryInterface &secondary, const Uptane::Target &target);
   std::vector<result::Install::EcuReport> sendImagesToEcus(const std::vector<Uptane::Target> &targets);
 
-  bool putManifestSimple(const Json::Value &custom = Json::nullValue);
+  // Unless forced, an unchanged manifest is only sent every uptane.manifest_heartbeat_sec.
+  bool putManifestSimple(const Json::Value &custom = Json::nullValue, bool force = false);
+  // The manifest, with the version manifest of the Primary not signed yet.
+  Json::Value collectManifest();
+  // Signs the version manifest of the Primary with the next report counter.
+  void signPrimaryManifest(Json::Value *manifest);
+  static std::string manifestFingerprint(const Json::Value &manifest);
   void getNewTargets(std::vector<Uptane::Target> *new_targets, unsigned int *ecus_count = nullptr);
   void updateDirectorMeta();
   void updateImageMeta();
@@ -185,6 +198,7 @@ class SotaUptaneClient {
   void checkAndUpdatePendingSecondaries();
   Uptane::EcuSerial primaryEcuSerial() { return provisioner_.PrimaryEcuSerial(); }
   boost::optional<Uptane::HardwareIdentifier> getEcuHwId(const Uptane::EcuSerial &serial);
+  void checkMemory();
 
   template <class T, class... Args>
   void sendEvent(Args &&...args) {
@@ -215,6 +229,13 @@ class SotaUptaneClient {
   Provisioner provisioner_;
   Json::Value custom_hardware_info_{Json::nullValue};
   const api::FlowControlToken *flow_control_;
+  MemoryMonitor memory_monitor_;
+  // What was last written with storeCachedEcuManifest()
+  std::map<Uptane::EcuSerial, std::string> cached_ecu_manifests_;
+  std::string last_manifest_fingerprint_;
+  std::chrono::steady_clock::time_point last_manifest_sent_;
+  // Last, so that its threads stop before anything else is torn down.
+  SecondaryMonitor secondary_monitor_;
 };
 
 #endif  // SOTA_UPTANE_CLIENT_H_
@@ -1,6 +1,7 @@
 #ifndef INVSTORAGE_H_
 #define INVSTORAGE_H_
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <utility>
@@ -49,6 +50,14 @@ class INvStorage {
   INvStorage& operator=(const INvStorage&) = delete;
   INvStorage& operator=(INvStorage&&) = delete;
   virtual StorageType type() = 0;
+
+  /**
+   * Groups the calls made by writes into one unit of work. SQLStorage commits
+   * them in a single transaction, and writes nothing if writes throws; other
+   * implementations just make the calls one after the other.
+   */
+  virtual void batch(const std::function<void(INvStorage&)>& writes) { writes(*this); }
+
   virtual void storePrimaryKeys(const std::string& public_key, const std::string& private_key) = 0;
   virtual bool loadPrimaryKeys(std::string* public_key, std::string* private_key) const = 0;
   virtual bool loadPrimaryPublic(std::string* public_key) const = 0;
@@ -143,6 +152,11 @@ class INvStorage {
   virtual bool loadDeviceDataHash(const std::string& data_type, std::string* hash) const = 0;
   virtual void clearDeviceData() = 0;
 
+  // Key that authenticates the entries of the TargetLedger. A key that is
+  // already stored is kept, so that concurrent callers agree on one.
+  virtual void storeTargetLedgerKey(const std::string& key) = 0;
+  virtual bool loadTargetLedgerKey(std::string* key) const = 0;
+
   // Downloaded files info API
   virtual void storeTargetFilename(const std::string& targetname, const std::string& filename) const = 0;
   virtual std::string getTargetFilename(const std::string& targetname) const = 0;
@@ -157,12 +157,27 @@ class SQLite3Guard {
   explicit SQLite3Guard(const boost::filesystem::path& path, bool readonly = false,
                         std::shared_ptr<std::mutex> mutex = nullptr)
       : SQLite3Guard(path.c_str(), readonly, std::move(mutex)) {}
-  SQLite3Guard(SQLite3Guard&& guard) noexcept : handle_(std::move(guard.handle_)), rc_(guard.rc_) {}
+  SQLite3Guard(SQLite3Guard&& guard) noexcept
+      : handle_(std::move(guard.handle_)),
+        rc_(guard.rc_),
+        m_(std::move(guard.m_)),
+        nested_(guard.nested_),
+        savepoint_open_(guard.savepoint_open_) {
+    guard.savepoint_open_ = false;
+  }
   ~SQLite3Guard() {
+    if (savepoint_open_) {
+      // Like closing a connection with a transaction in progress
+      exec("ROLLBACK TO SAVEPOINT nested; RELEASE SAVEPOINT nested;", nullptr, nullptr);
+    }
     if (m_) {
       m_->unlock();
     }
   }
+
+  // Shares a connection on which a transaction is already in progress, without
+  // locking or closing it. Transactions on it are nested in the outer one.
+  static SQLite3Guard nested(sqlite3* handle) { return SQLite3Guard(handle); }
   SQLite3Guard(const SQLite3Guard& guard) = delete;
   SQLite3Guard& operator=(const SQLite3Guard& guard) = delete;
   SQLite3Guard& operator=(SQLite3Guard&&) = delete;
@@ -192,31 +207,41 @@ class SQLite3Guard {
 
   void beginTransaction() {
     // Note: transaction cannot be nested and this will fail if another
-    // transaction was open on the same connection
-    if (exec("BEGIN TRANSACTION;", nullptr, nullptr) != SQLITE_OK) {
+    // transaction was open on the same connection, unless it was obtained with
+    // nested(): then it is a savepoint.
+    if (exec(nested_ ? "SAVEPOINT nested;" : "BEGIN TRANSACTION;", nullptr, nullptr) != SQLITE_OK) {
       LOG_ERROR << "Can't begin transaction: " << errmsg();
       throw SQLInternalException(std::string("Can't begin transaction: ") + errmsg());
     }
+    savepoint_open_ = nested_;
   }
 
   void commitTransaction() {
-    if (exec("COMMIT TRANSACTION;", nullptr, nullptr) != SQLITE_OK) {
+    if (exec(nested_ ? "RELEASE SAVEPOINT nested;" : "COMMIT TRANSACTION;", nullptr, nullptr) != SQLITE_OK) {
       LOG_ERROR << "Can't commit transaction: " << errmsg();
       throw SQLInternalException(std::string("Can't begin transaction: ") + errmsg());
     }
+    savepoint_open_ = false;
   }
 
   void rollbackTransaction() {
-    if (exec("ROLLBACK TRANSACTION;", nullptr, nullptr) != SQLITE_OK) {
+    if (exec(nested_ ? "ROLLBACK TO SAVEPOINT nested; RELEASE SAVEPOINT nested;" : "ROLLBACK TRANSACTION;", nullptr,
+             nullptr) != SQLITE_OK) {
       LOG_ERROR << "Can't rollback transaction: " << errmsg();
       throw SQLInternalException(std::string("Can't begin transaction: ") + errmsg());
     }
+    savepoint_open_ = false;
   }
 
  private:
+  explicit SQLite3Guard(sqlite3* handle)
+      : handle_(handle, [](sqlite3*) { return SQLITE_OK; }), rc_(SQLITE_OK), nested_(true) {}
+
   std::unique_ptr<sqlite3, int (*)(sqlite3*)> handle_;
   int rc_;
   std::shared_ptr<std::mutex> m_ = nullptr;
+  bool nested_{false};
+  bool savepoint_open_{false};
 };
 
 #endif  // SQL_UTILS_H_
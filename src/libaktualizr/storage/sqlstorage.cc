@@ -71,6 +71,10 @@ SQLStorage::SQLStorage(const StorageConfig& config, bool readonly)
   }
 }
 
+void SQLStorage::batch(const std::function<void(INvStorage&)>& writes) {
+  transaction([this, &writes]() { writes(*this); });
+}
+
 void SQLStorage::storePrimaryKeys(const std::string& public_key, const std::string& private_key) {
   SQLite3Guard db = dbConnection();
 
@@ -1681,6 +1685,43 @@ void SQLStorage::clearDeviceData() {
   }
 }
 
+void SQLStorage::storeTargetLedgerKey(const std::string& key) {
+  SQLite3Guard db = dbConnection();
+
+  auto statement = db.prepareStatement<SQLBlob>(
+      "INSERT OR IGNORE INTO target_ledger_key(unique_mark,key) VALUES (0,?);", SQLBlob(key));
+  if (statement.step() != SQLITE_DONE) {
+    LOG_ERROR << "Failed to store the Target ledger key: " << db.errmsg();
+    throw SQLException("Failed to store the Target ledger key: " + db.errmsg());
+  }
+}
+
+bool SQLStorage::loadTargetLedgerKey(std::string* key) const {
+  SQLite3Guard db = dbConnection();
+
+  auto statement = db.prepareStatement("SELECT key FROM target_ledger_key LIMIT 1;");
+
+  int result = statement.step();
+  if (result == SQLITE_DONE) {
+    LOG_TRACE << "Target ledger key not found in database";
+    return false;
+  } else if (result != SQLITE_ROW) {
+    LOG_ERROR << "Failed to get the Target ledger key: " << db.errmsg();
+    return false;
+  }
+
+  auto key_r = statement.get_result_col_blob(0);
+  if (key_r == boost::none) {
+    return false;
+  }
+
+  if (key != nullptr) {
+    *key = std::move(key_r.value());
+  }
+
+  return true;
+}
+
 void SQLStorage::storeTargetFilename(const std::string& targetname, const std::string& filename) const {
   SQLite3Guard db = dbConnection();
   auto statement = db.prepareStatement<std::string, std::string>(
@@ -24,6 +24,7 @@ class SQLStorage : public SQLStorageBase, public INvStorage {
   SQLStorage(SQLStorage&&) = delete;
   SQLStorage& operator=(const SQLStorage&) = delete;
   SQLStorage& operator=(SQLStorage&&) = delete;
+  void batch(const std::function<void(INvStorage&)>& writes) override;
   void storePrimaryKeys(const std::string& public_key, const std::string& private_key) override;
   bool loadPrimaryKeys(std::string* public_key, std::string* private_key) const override;
   bool loadPrimaryPublic(std::string* public_key) const override;
@@ -106,6 +107,9 @@ class SQLStorage : public SQLStorageBase, public INvStorage {
   bool loadDeviceDataHash(const std::string& data_type, std::string* hash) const override;
   void clearDeviceData() override;
 
+  void storeTargetLedgerKey(const std::string& key) override;
+  bool loadTargetLedgerKey(std::string* key) const override;
+
   void storeTargetFilename(const std::string& targetname, const std::string& filename) const override;
   std::string getTargetFilename(const std::string& targetname) const override;
   std::vector<std::string> getAllTargetNames() const override;
@@ -5,6 +5,7 @@
 #include <boost/filesystem.hpp>
 #include <fstream>
 
+#include "utilities/tracing.h"
 #include "utilities/utils.h"
 
 boost::filesystem::path SQLStorageBase::dbPath() const { return sqldb_path_; }
@@ -78,14 +79,59 @@ SQLStorageBase::SQLStorageBase(boost::filesystem::path sqldb_path, bool readonly
   }
 }
 
+// Called by SQLite when a statement has finished, with its run time in nanoseconds.
+static int traceStatement(unsigned int type, void* ctx, void* statement, void* nanoseconds) {
+  (void)type;
+  (void)ctx;
+  const auto duration = std::chrono::nanoseconds(*static_cast<sqlite3_int64*>(nanoseconds));
+  const auto end = Tracer::Clock::now();
+  Json::Value args;
+  const char* sql = sqlite3_sql(static_cast<sqlite3_stmt*>(statement));
+  if (sql != nullptr) {
+    args["sql"] = sql;
+  }
+  Tracer::complete("storage", "sql", end - std::chrono::duration_cast<Tracer::Clock::duration>(duration), duration,
+                   std::move(args));
+  return 0;
+}
+
 SQLite3Guard SQLStorageBase::dbConnection() const {
+  if (transaction_thread_.load() == std::this_thread::get_id()) {
+    return SQLite3Guard::nested(transaction_db_);
+  }
   SQLite3Guard db(dbPath(), readonly_, mutex_);
   if (db.get_rc() != SQLITE_OK) {
     throw SQLInternalException(std::string("Can't open database: ") + db.errmsg());
   }
+  if (Tracer::enabled()) {
+    sqlite3_trace_v2(db.get(), SQLITE_TRACE_PROFILE, traceStatement, nullptr);
+  }
   return db;
 }
 
+void SQLStorageBase::transaction(const std::function<void()>& fn) {
+  if (transaction_thread_.load() == std::this_thread::get_id()) {
+    fn();
+    return;
+  }
+
+  SQLite3Guard db = dbConnection();
+  db.beginTransaction();
+  transaction_db_ = db.get();
+  transaction_thread_ = std::this_thread::get_id();
+  try {
+    fn();
+  } catch (...) {
+    // Closing the connection rolls the transaction back.
+    transaction_thread_ = std::thread::id();
+    transaction_db_ = nullptr;
+    throw;
+  }
+  transaction_thread_ = std::thread::id();
+  transaction_db_ = nullptr;
+  db.commitTransaction();
+}
+
 std::string SQLStorageBase::getTableSchemaFromDb(const std::string& tablename) {
   SQLite3Guard db = dbConnection();
 
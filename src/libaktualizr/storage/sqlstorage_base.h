@@ -1,6 +1,10 @@
 #ifndef SQLSTORAGE_BASE_H_
 #define SQLSTORAGE_BASE_H_
 
+#include <atomic>
+#include <functional>
+#include <thread>
+
 #include <boost/filesystem/path.hpp>
 #include <boost/interprocess/sync/file_lock.hpp>
 #include <boost/interprocess/sync/scoped_lock.hpp>
@@ -56,6 +60,16 @@ class SQLStorageBase {
 
   SQLite3Guard dbConnection() const;
   bool dbInsertBackMigrations(SQLite3Guard &db, int version_latest);
+  /**
+   * Runs fn in a single transaction: the connections opened by this thread in
+   * the meantime share it, and other threads wait until it is committed.
+   * Nothing is written if fn throws.
+   */
+  void transaction(const std::function<void()> &fn);
+
+ private:
+  sqlite3 *transaction_db_{nullptr};
+  std::atomic<std::thread::id> transaction_thread_{};
 };
 
 #endif  // SQLSTORAGE_BASE_H_
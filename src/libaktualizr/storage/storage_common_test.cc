@@ -1,6 +1,9 @@
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <future>
 #include <memory>
+#include <stdexcept>
 #include <string>
 
 #include <boost/filesystem.hpp>
@@ -463,6 +466,54 @@ TEST(StorageCommon, LoadStoreInstallationResults) {
       "This call will return a negative value since the installation report was cleaned!"));
 }
 
+/*
+ * Writes grouped with batch() are committed together, or not at all. Other
+ * threads only get to see them once they are committed.
+ */
+TEST(StorageCommon, Batch) {
+  TemporaryDirectory temp_dir;
+  std::unique_ptr<INvStorage> storage = Storage(temp_dir.Path());
+
+  EcuSerials serials{{Uptane::EcuSerial("primary"), Uptane::HardwareIdentifier("primary_hw")},
+                     {Uptane::EcuSerial("secondary_1"), Uptane::HardwareIdentifier("secondary_hw")}};
+  storage->storeEcuSerials(serials);
+
+  std::vector<std::pair<Uptane::EcuSerial, data::InstallationResult>> res;
+  EXPECT_THROW(storage->batch([](INvStorage &txn) {
+    txn.saveEcuInstallationResult(Uptane::EcuSerial("primary"), data::InstallationResult());
+    throw std::runtime_error("aborted");
+  }),
+               std::runtime_error);
+  EXPECT_FALSE(storage->loadEcuInstallationResults(&res));
+
+  std::future<bool> other_thread;
+  storage->batch([&](INvStorage &txn) {
+    txn.saveEcuInstallationResult(Uptane::EcuSerial("primary"), data::InstallationResult());
+    txn.saveEcuInstallationResult(Uptane::EcuSerial("secondary_1"),
+                                  data::InstallationResult(data::ResultCode::Numeric::kGeneralError, ""));
+    EXPECT_TRUE(txn.loadEcuInstallationResults(&res));
+    EXPECT_EQ(res.size(), 2);
+
+    // A nested batch is part of the outer one.
+    txn.batch([](INvStorage &inner) {
+      inner.storeDeviceInstallationResult(data::InstallationResult(data::ResultCode::Numeric::kGeneralError, ""),
+                                          "raw", "corrid");
+    });
+
+    other_thread = std::async(std::launch::async, [&storage]() {
+      data::InstallationResult dev_res;
+      std::string report;
+      std::string correlation_id;
+      return storage->loadDeviceInstallationResult(&dev_res, &report, &correlation_id);
+    });
+    EXPECT_EQ(other_thread.wait_for(std::chrono::milliseconds(200)), std::future_status::timeout);
+  });
+  EXPECT_TRUE(other_thread.get());
+  res.clear();
+  EXPECT_TRUE(storage->loadEcuInstallationResults(&res));
+  EXPECT_EQ(res.size(), 2);
+}
+
 TEST(StorageCommon, DownloadedFilesInfo) {
   TemporaryDirectory temp_dir;
   std::unique_ptr<INvStorage> storage = Storage(temp_dir.Path());
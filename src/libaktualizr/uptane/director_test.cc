@@ -1,8 +1,19 @@
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <ctime>
+#include <thread>
+
+#include <boost/filesystem.hpp>
+
 #include "directorrepository.h"
+#include "imagerepository.h"
 #include "logging/logging.h"
+#include "storage/invstorage.h"
+#include "uptane/exceptions.h"
+#include "uptane/fetcher.h"
 #include "test_utils.h"
+#include "uptane_repo.h"
 #include "utilities/utils.h"
 
 boost::filesystem::path uptane_generator_path;
@@ -48,6 +59,111 @@ TEST(Director, EmptyTargets) {
   EXPECT_TRUE(director.latest_targets.targets.empty());
 }
 
+// Serves the metadata written by uptane-generator.
+class FileFetcher : public IMetadataFetcher {
+ public:
+  explicit FileFetcher(boost::filesystem::path meta_dir) : meta_dir_(std::move(meta_dir)) {}
+  void fetchRole(std::string* result, int64_t maxsize, RepositoryType repo, const Role& role, Version version,
+                 const api::FlowControlToken* flow_control) const override {
+    (void)maxsize;
+    (void)flow_control;
+    const boost::filesystem::path path =
+        meta_dir_ / "repo" / (repo == RepositoryType::Director() ? "director" : "repo") / version.RoleFileName(role);
+    if (!boost::filesystem::exists(path)) {
+      throw MetadataFetchFailure(repo.ToString(), role.ToString());
+    }
+    *result = Utils::readFile(path);
+  }
+
+ private:
+  boost::filesystem::path meta_dir_;
+};
+
+/*
+ * Targets metadata that is the same as in the previous update is not verified
+ * and compared with the stored copy again, but new metadata is.
+ */
+TEST(Director, UnchangedTargets) {
+  TemporaryDirectory temp_dir;
+  TemporaryDirectory meta_dir;
+  Process uptane_gen(uptane_generator_path.string());
+  uptane_gen.run({"generate", "--path", meta_dir.PathString()});
+  uptane_gen.run({"image", "--path", meta_dir.PathString(), "--filename", "tests/test_data/firmware.txt",
+                  "--targetname", "firmware.txt", "--hwid", "primary_hw"});
+  uptane_gen.run({"addtarget", "--path", meta_dir.PathString(), "--targetname", "firmware.txt", "--hwid", "primary_hw",
+                  "--serial", "CA:FE:A6:D2:84:9D"});
+  uptane_gen.run({"signtargets", "--path", meta_dir.PathString()});
+
+  StorageConfig config;
+  config.path = temp_dir.Path();
+  auto storage = INvStorage::newStorage(config);
+  FileFetcher fetcher(meta_dir.Path());
+  DirectorRepository director;
+  director.updateMeta(*storage, fetcher, nullptr);
+  ASSERT_EQ(director.getTargets().targets.size(), 1);
+
+  // A stored version newer than the one on the server would be a rollback
+  // attack, but the unchanged metadata doesn't need to be checked against it.
+  storage->storeNonRoot(R"({"signed": {"version": 100}})", RepositoryType::Director(), Role::Targets());
+  EXPECT_NO_THROW(director.updateMeta(*storage, fetcher, nullptr));
+  ASSERT_EQ(director.getTargets().targets.size(), 1);
+  EXPECT_EQ(director.getTargets().targets[0].filename(), "firmware.txt");
+
+  uptane_gen.run({"emptytargets", "--path", meta_dir.PathString()});
+  uptane_gen.run({"signtargets", "--path", meta_dir.PathString()});
+  EXPECT_THROW(director.updateMeta(*storage, fetcher, nullptr), SecurityException);
+
+  // Nothing is assumed to be verified after a failure.
+  EXPECT_THROW(director.updateMeta(*storage, fetcher, nullptr), SecurityException);
+}
+
+/*
+ * The Snapshot and Targets metadata verified along with an Image repo
+ * Timestamp are kept as long as the Timestamp is the same, but their
+ * expiration dates are still checked. A new Timestamp is verified in full.
+ */
+TEST(ImageRepo, UnchangedTimestamp) {
+  TemporaryDirectory temp_dir;
+  TemporaryDirectory meta_dir;
+  UptaneRepo uptane_repo(meta_dir.Path(), "", "");
+  uptane_repo.generateRepo();
+  uptane_repo.addImage("tests/test_data/firmware.txt", "firmware.txt", "primary_hw");
+
+  StorageConfig config;
+  config.path = temp_dir.Path();
+  auto storage = INvStorage::newStorage(config);
+  FileFetcher fetcher(meta_dir.Path());
+  ImageRepository image_repo;
+  image_repo.updateMeta(*storage, fetcher, nullptr);
+  const auto verified_targets = image_repo.getTargets();
+  ASSERT_EQ(verified_targets->targets.size(), 1);
+
+  // A stored version newer than the one on the server would be a rollback
+  // attack, but the unchanged metadata doesn't need to be checked against it.
+  const std::string timestamp_raw = Utils::readFile(meta_dir.Path() / "repo/repo/timestamp.json");
+  storage->storeNonRoot(R"({"signed": {"version": 100}})", RepositoryType::Image(), Role::Timestamp());
+  EXPECT_NO_THROW(image_repo.updateMeta(*storage, fetcher, nullptr));
+  EXPECT_EQ(image_repo.getTargets(), verified_targets);
+
+  uptane_repo.addImage("tests/test_data/firmware_name.txt", "firmware_name.txt", "primary_hw");
+  EXPECT_THROW(image_repo.updateMeta(*storage, fetcher, nullptr), SecurityException);
+
+  storage->storeNonRoot(timestamp_raw, RepositoryType::Image(), Role::Timestamp());
+  image_repo.updateMeta(*storage, fetcher, nullptr);
+  EXPECT_NE(image_repo.getTargets(), verified_targets);
+  EXPECT_EQ(image_repo.getTargets()->targets.size(), 2);
+
+  time_t expiration_time;
+  std::time(&expiration_time);
+  expiration_time += 2;
+  struct tm expiration_time_str {};
+  gmtime_r(&expiration_time, &expiration_time_str);
+  uptane_repo.refresh(RepositoryType::Image(), Role::Timestamp(), TimeStamp(expiration_time_str));
+  image_repo.updateMeta(*storage, fetcher, nullptr);
+  std::this_thread::sleep_for(std::chrono::seconds(3));
+  EXPECT_THROW(image_repo.updateMeta(*storage, fetcher, nullptr), ExpiredMetadata);
+}
+
 }  // namespace Uptane
 
 #ifndef __NO_MAIN__
@@ -12,6 +12,7 @@ void DirectorRepository::resetMeta() {
   resetRoot();
   targets = Targets();
   latest_targets = Targets();
+  verified_targets_raw_.clear();
 }
 
 void DirectorRepository::checkTargetsExpired() {
@@ -99,6 +100,11 @@ void DirectorRepository::updateMeta(INvStorage& storage, const IMetadataFetcher&
   // Uptane step 2 (download time) is not implemented yet.
   // Uptane step 3 (download metadata)
 
+  // Kept aside in case the Targets metadata turns out to be unchanged.
+  const std::string verified_targets_raw = std::move(verified_targets_raw_);
+  Targets verified_targets = std::move(targets);
+  Targets verified_latest_targets = std::move(latest_targets);
+
   // reset Director repo to initial state before starting Uptane iteration
   resetMeta();
 
@@ -114,6 +120,20 @@ void DirectorRepository::updateMeta(INvStorage& storage, const IMetadataFetcher&
 
     fetcher.fetchLatestRole(&director_targets, kMaxDirectorTargetsSize, RepositoryType::Director(), Role::Targets(),
                             flow_control);
+
+    // Fast path for the usual case of a device that is up to date: the same
+    // metadata, signed with keys of the same Root, has already been verified
+    // and stored. Only its expiration has to be checked again.
+    if (!verified_targets_raw.empty() && director_targets == verified_targets_raw &&
+        rootVersion() == verified_root_version_) {
+      LOG_DEBUG << "Director Targets metadata is unchanged.";
+      targets = std::move(verified_targets);
+      latest_targets = std::move(verified_latest_targets);
+      checkTargetsExpired();
+      verified_targets_raw_ = std::move(director_targets);
+      return;
+    }
+
     int remote_version = extractVersionUntrusted(director_targets);
 
     int local_version;
@@ -143,6 +163,9 @@ void DirectorRepository::updateMeta(INvStorage& storage, const IMetadataFetcher&
     checkTargetsExpired();
 
     targetsSanityCheck();
+
+    verified_targets_raw_ = std::move(director_targets);
+    verified_root_version_ = rootVersion();
   }
 }
 
@@ -47,6 +47,12 @@ class DirectorRepository : public RepositoryCommon {
    * kept until we've sent a manifest containing a terminating state.
    */
   Uptane::CorrelationId correlation_id_;
+
+  // The Targets metadata verified by the last successful updateMeta(). As
+  // long as the Director keeps sending it unchanged, and the Root is the
+  // same, there is no need to verify and process it again.
+  std::string verified_targets_raw_;
+  int verified_root_version_{-1};
 };
 
 }  // namespace Uptane
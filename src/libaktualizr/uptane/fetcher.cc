@@ -16,9 +16,24 @@ void Fetcher::fetchRole(std::string* result, int64_t maxsize, RepositoryType rep
     throw Uptane::LocallyAborted(repo);
   }
   if (!response.isOk()) {
+    if (response.retry_after_sec >= 0) {
+      std::lock_guard<std::mutex> lock(hints_mutex);
+      hints.retry_after_sec = response.retry_after_sec;
+    }
     throw Uptane::MetadataFetchFailure(repo.ToString(), role.ToString());
   }
+  if (role == Role::Timestamp() && response.max_age_sec >= 0) {
+    std::lock_guard<std::mutex> lock(hints_mutex);
+    hints.max_age_sec = response.max_age_sec;
+  }
   *result = response.body;
 }
 
+ServerHints Fetcher::takeServerHints() const {
+  std::lock_guard<std::mutex> lock(hints_mutex);
+  ServerHints taken = hints;
+  hints = ServerHints();
+  return taken;
+}
+
 }  // namespace Uptane
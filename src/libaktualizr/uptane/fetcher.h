@@ -1,6 +1,8 @@
 #ifndef UPTANE_FETCHER_H_
 #define UPTANE_FETCHER_H_
 
+#include <mutex>
+
 #include "http/httpinterface.h"
 #include "libaktualizr/config.h"
 #include "tuf.h"
@@ -14,6 +16,16 @@ constexpr int64_t kMaxTimestampSize = 64L * 1024;
 constexpr int64_t kMaxSnapshotSize = 64L * 1024;
 constexpr int64_t kMaxImageTargetsSize = 8L * 1024 * 1024;
 
+/**
+ * Polling hints of the server: how long the timestamp metadata stays fresh
+ * (the max-age of its Cache-Control header) and how long to wait after a
+ * failed fetch (Retry-After). Negative if the server did not send them.
+ */
+struct ServerHints {
+  int64_t max_age_sec{-1};
+  int64_t retry_after_sec{-1};
+};
+
 class IMetadataFetcher {
  public:
   IMetadataFetcher(const IMetadataFetcher&) = delete;
@@ -65,10 +77,15 @@ class Fetcher : public IMetadataFetcher {
 
   std::string getRepoServer() const { return repo_server; }
 
+  /** Hints received since the last call. */
+  ServerHints takeServerHints() const;
+
  private:
   std::shared_ptr<HttpInterface> http;
   std::string repo_server;
   std::string director_server;
+  mutable std::mutex hints_mutex;
+  mutable ServerHints hints;
 };
 
 }  // namespace Uptane
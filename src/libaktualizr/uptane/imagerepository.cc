@@ -13,6 +13,7 @@ void ImageRepository::resetMeta() {
   targets.reset();
   snapshot = Snapshot();
   timestamp = TimestampMeta();
+  verified_timestamp_raw_.clear();
 }
 
 void ImageRepository::verifyTimestamp(const std::string& timestamp_raw) {
@@ -216,15 +217,37 @@ void ImageRepository::checkTargetsExpired() {
 
 void ImageRepository::updateMeta(INvStorage& storage, const IMetadataFetcher& fetcher,
                                  const api::FlowControlToken* flow_control) {
+  // Kept aside in case the Timestamp metadata turns out to be unchanged.
+  const std::string verified_timestamp_raw = std::move(verified_timestamp_raw_);
+  std::shared_ptr<Uptane::Targets> verified_targets = std::move(targets);
+  Snapshot verified_snapshot = std::move(snapshot);
+  TimestampMeta verified_timestamp = std::move(timestamp);
+
   resetMeta();
 
   updateRoot(storage, fetcher, RepositoryType::Image());
 
+  std::string image_timestamp;
   // Update Image repo Timestamp metadata
   {
-    std::string image_timestamp;
-
     fetcher.fetchLatestRole(&image_timestamp, kMaxTimestampSize, RepositoryType::Image(), Role::Timestamp());
+
+    // Fast path: nothing has been published since the last update, so the
+    // Snapshot and Targets metadata don't have to be loaded and verified
+    // again. Only the expiration dates can have changed anything.
+    if (!verified_timestamp_raw.empty() && image_timestamp == verified_timestamp_raw &&
+        rootVersion() == verified_root_version_) {
+      LOG_DEBUG << "Image repo Timestamp metadata is unchanged.";
+      targets = std::move(verified_targets);
+      snapshot = std::move(verified_snapshot);
+      timestamp = std::move(verified_timestamp);
+      checkTimestampExpired();
+      checkSnapshotExpired();
+      checkTargetsExpired();
+      verified_timestamp_raw_ = std::move(image_timestamp);
+      return;
+    }
+
     int remote_version = extractVersionUntrusted(image_timestamp);
 
     int local_version;
@@ -307,6 +330,9 @@ void ImageRepository::updateMeta(INvStorage& storage, const IMetadataFetcher& fe
 
     checkTargetsExpired();
   }
+
+  verified_timestamp_raw_ = std::move(image_timestamp);
+  verified_root_version_ = rootVersion();
 }
 
 void ImageRepository::checkMetaOffline(INvStorage& storage) {
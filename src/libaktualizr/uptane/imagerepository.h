@@ -47,6 +47,12 @@ class ImageRepository : public RepositoryCommon {
   std::shared_ptr<Uptane::Targets> targets;
   Uptane::TimestampMeta timestamp;
   Uptane::Snapshot snapshot;
+
+  // The Timestamp metadata of the last successful updateMeta(). As long as
+  // the server sends it unchanged, and the Root is the same, the Snapshot and
+  // Targets metadata verified along with it are still current.
+  std::string verified_timestamp_raw_;
+  int verified_root_version_{-1};
 };
 
 }  // namespace Uptane
@@ -245,6 +245,65 @@ TEST(Uptane, PutManifest) {
             "test-package");
 }
 
+class HttpPutManifestCounter : public HttpFake {
+ public:
+  explicit HttpPutManifestCounter(const boost::filesystem::path &test_dir_in) : HttpFake(test_dir_in) {}
+  HttpResponse put(const std::string &url, const Json::Value &data) override {
+    ++manifest_count;
+    return HttpFake::put(url, data);
+  }
+
+  int manifest_count{0};
+};
+
+/*
+ * An unchanged manifest is only sent again after the heartbeat interval, and
+ * doesn't use up a report counter.
+ */
+TEST(Uptane, PutManifestHeartbeat) {
+  TemporaryDirectory temp_dir;
+  auto http = std::make_shared<HttpPutManifestCounter>(temp_dir.Path());
+  Config config = config_common();
+  config.storage.path = temp_dir.Path();
+  boost::filesystem::copy_file("tests/test_data/cred.zip", (temp_dir / "cred.zip").string());
+  config.provision.provision_path = temp_dir / "cred.zip";
+  config.provision.mode = ProvisionMode::kSharedCred;
+  config.uptane.director_server = http->tls_server + "/director";
+  config.uptane.repo_server = http->tls_server + "/repo";
+  config.uptane.manifest_heartbeat_sec = 3600;
+  config.provision.primary_ecu_serial = "testecuserial";
+  config.pacman.type = PACKAGE_MANAGER_NONE;
+  UptaneTestCommon::addDefaultSecondary(config, temp_dir, "secondary_ecu_serial", "secondary_hardware");
+
+  auto storage = INvStorage::newStorage(config.storage);
+  auto sota_client = std_::make_unique<UptaneTestCommon::TestUptaneClient>(config, storage, http);
+  EXPECT_NO_THROW(sota_client->initialize());
+  const auto report_counter = [&http]() {
+    return http->last_manifest["signed"]["ecu_version_manifests"]["testecuserial"]["signed"]["report_counter"]
+        .asString();
+  };
+
+  EXPECT_TRUE(sota_client->putManifestSimple());
+  EXPECT_EQ(http->manifest_count, 1);
+  const std::string first_counter = report_counter();
+
+  EXPECT_TRUE(sota_client->putManifestSimple());
+  EXPECT_EQ(http->manifest_count, 1);
+
+  // Changed
+  Json::Value custom;
+  custom["key"] = "value";
+  EXPECT_TRUE(sota_client->putManifestSimple(custom));
+  EXPECT_EQ(http->manifest_count, 2);
+  EXPECT_EQ(std::stoll(report_counter()), std::stoll(first_counter) + 1);
+  EXPECT_TRUE(sota_client->putManifestSimple(custom));
+  EXPECT_EQ(http->manifest_count, 2);
+
+  // Explicitly requested
+  EXPECT_TRUE(sota_client->putManifest(custom));
+  EXPECT_EQ(http->manifest_count, 3);
+}
+
 class HttpPutManifestFail : public HttpFake {
  public:
   HttpPutManifestFail(const boost::filesystem::path &test_dir_in, std::string flavor = "")
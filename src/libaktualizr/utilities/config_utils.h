@@ -89,6 +89,22 @@ inline void CopyFromConfig(BootedType& dest, const std::string& option_name, con
   }
 }
 
+template <>
+inline void CopyFromConfig(EventOverflow& dest, const std::string& option_name,
+                           const boost::property_tree::ptree& pt) {
+  boost::optional<std::string> value = pt.get_optional<std::string>(option_name);
+  if (value.is_initialized()) {
+    std::string overflow{StripQuotesFromStrings(value.get())};
+    if (overflow == "block") {
+      dest = EventOverflow::kBlock;
+    } else if (overflow == "drop_newest") {
+      dest = EventOverflow::kDropNewest;
+    } else {
+      dest = EventOverflow::kDropProgress;
+    }
+  }
+}
+
 template <>
 inline void CopyFromConfig(KeyType& dest, const std::string& option_name, const boost::property_tree::ptree& pt) {
   boost::optional<std::string> value = pt.get_optional<std::string>(option_name);
@@ -0,0 +1,131 @@
+#include "libaktualizr/mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "logging/logging.h"
+
+namespace {
+
+// Larger files are only mapped span by span, so that they don't take up most
+// of the address space on 32-bit devices.
+constexpr uint64_t kMaxWholeMapping = std::numeric_limits<size_t>::max() / 4;
+
+size_t pageAlignedSpan(size_t span_size) {
+  const auto page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  // Spans have to start at page boundaries for mmap() and madvise().
+  return std::max(page_size, span_size - span_size % page_size);
+}
+
+}  // namespace
+
+MappedFile::MappedFile(const boost::filesystem::path& path) {
+  fd_ = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd_ < 0) {
+    throw std::runtime_error("Can't open file " + path.string() + ": " + std::strerror(errno));
+  }
+  struct stat st {};
+  if (fstat(fd_, &st) != 0) {
+    const std::string err = std::strerror(errno);
+    close(fd_);
+    throw std::runtime_error("Can't stat file " + path.string() + ": " + err);
+  }
+  size_ = static_cast<uint64_t>(st.st_size);
+  if (size_ == 0) {
+    return;
+  }
+
+  // Doubles the readahead window of the file.
+  if (posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL) != 0) {
+    LOG_DEBUG << "posix_fadvise failed for " << path;
+  }
+  if (size_ > kMaxWholeMapping) {
+    LOG_DEBUG << "File " << path << " is mapped span by span";
+    return;
+  }
+  void* addr = mmap(nullptr, static_cast<size_t>(size_), PROT_READ, MAP_PRIVATE, fd_, 0);
+  if (addr == MAP_FAILED) {  // NOLINT(cppcoreguidelines-pro-type-cstyle-cast)
+    LOG_DEBUG << "Can't map file " << path << " as a whole, it is mapped span by span: " << std::strerror(errno);
+    return;
+  }
+  data_ = static_cast<uint8_t*>(addr);
+  if (madvise(data_, static_cast<size_t>(size_), MADV_SEQUENTIAL) != 0) {
+    LOG_DEBUG << "madvise failed for " << path;
+  }
+}
+
+MappedFile::~MappedFile() {
+  if (data_ != nullptr) {
+    munmap(data_, static_cast<size_t>(size_));
+  }
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+}
+
+void MappedFile::forEachSpan(const SpanCallback& cb, size_t span_size) const {
+  if (source_) {
+    source_(cb);
+    return;
+  }
+  span_size = pageAlignedSpan(span_size);
+  if (data_ == nullptr) {
+    forEachWindow(cb, span_size);
+    return;
+  }
+  for (uint64_t offset = 0; offset < size_; offset += span_size) {
+    const auto len = static_cast<size_t>(std::min<uint64_t>(span_size, size_ - offset));
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    uint8_t* span = data_ + offset;
+    if (offset + len < size_) {
+      const auto next_len = static_cast<size_t>(std::min<uint64_t>(span_size, size_ - offset - len));
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+      madvise(span + len, next_len, MADV_WILLNEED);
+    }
+    cb(span, len);
+    // The pages stay in the page cache, they are only dropped from this process.
+    madvise(span, len, MADV_DONTNEED);
+  }
+}
+
+/* Map one span at a time. If even that fails, read the spans into a buffer. */
+void MappedFile::forEachWindow(const SpanCallback& cb, size_t span_size) const {
+  std::vector<uint8_t> buf;
+  for (uint64_t offset = 0; offset < size_; offset += span_size) {
+    const auto len = static_cast<size_t>(std::min<uint64_t>(span_size, size_ - offset));
+    if (offset + len < size_) {
+      const auto next_len = static_cast<off_t>(std::min<uint64_t>(span_size, size_ - offset - len));
+      posix_fadvise(fd_, static_cast<off_t>(offset + len), next_len, POSIX_FADV_WILLNEED);
+    }
+    void* addr = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd_, static_cast<off_t>(offset));
+    if (addr != MAP_FAILED) {  // NOLINT(cppcoreguidelines-pro-type-cstyle-cast)
+      cb(static_cast<const uint8_t*>(addr), len);
+      munmap(addr, len);
+      continue;
+    }
+    buf.resize(len);
+    size_t done = 0;
+    while (done < len) {
+      const ssize_t r = pread(fd_, &buf[done], len - done, static_cast<off_t>(offset + done));
+      if (r < 0 && errno == EINTR) {
+        continue;
+      }
+      if (r <= 0) {
+        throw std::runtime_error(std::string("Can't read mapped file: ") +
+                                 (r < 0 ? std::strerror(errno) : "unexpected end of file"));
+      }
+      done += static_cast<size_t>(r);
+    }
+    cb(buf.data(), len);
+  }
+}
@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "libaktualizr/mapped_file.h"
+#include "utilities/utils.h"
+
+/* The mapped content matches the file and stays valid after the file is removed. */
+TEST(MappedFile, Content) {
+  TemporaryDirectory temp_dir;
+  const std::string content = "mapped file content";
+  Utils::writeFile(temp_dir / "file", content);
+
+  MappedFile mapped(temp_dir / "file");
+  boost::filesystem::remove(temp_dir / "file");
+  ASSERT_EQ(mapped.size(), content.size());
+  EXPECT_EQ(std::string(reinterpret_cast<const char*>(mapped.data()), mapped.size()), content);
+}
+
+/* Files are passed on in spans that add up to the whole file. */
+TEST(MappedFile, Spans) {
+  TemporaryDirectory temp_dir;
+  std::string content;
+  while (content.size() < 100000) {
+    content += Utils::randomUuid();
+  }
+  Utils::writeFile(temp_dir / "file", content);
+
+  MappedFile mapped(temp_dir / "file");
+  std::string out;
+  size_t spans = 0;
+  mapped.forEachSpan(
+      [&out, &spans](const uint8_t* data, size_t size) {
+        out.append(reinterpret_cast<const char*>(data), size);
+        ++spans;
+      },
+      8192);
+  EXPECT_EQ(out, content);
+  EXPECT_GT(spans, 10);
+  // The content can be read again after the spans have been released.
+  EXPECT_EQ(std::string(reinterpret_cast<const char*>(mapped.data()), mapped.size()), content);
+}
+
+/* Empty files map to nothing and missing files throw. */
+TEST(MappedFile, EmptyAndMissing) {
+  TemporaryDirectory temp_dir;
+  Utils::writeFile(temp_dir / "empty", std::string());
+  MappedFile mapped(temp_dir / "empty");
+  EXPECT_EQ(mapped.size(), 0);
+  EXPECT_EQ(mapped.data(), nullptr);
+  mapped.forEachSpan([](const uint8_t* data, size_t size) {
+    (void)data;
+    (void)size;
+    FAIL() << "Unexpected span";
+  });
+
+  EXPECT_THROW(MappedFile(temp_dir / "missing"), std::runtime_error);
+}
+
+#ifndef __NO_MAIN__
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+#endif
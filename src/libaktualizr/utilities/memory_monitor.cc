@@ -0,0 +1,53 @@
+#include "memory_monitor.h"
+
+#include <unistd.h>
+#include <fstream>
+
+constexpr std::array<unsigned int, 4> MemoryMonitor::kWatermarks;
+
+uint64_t MemoryMonitor::residentBytes() {
+  // The second field is the number of resident pages.
+  std::ifstream statm("/proc/self/statm");
+  uint64_t size = 0;
+  uint64_t resident = 0;
+  if (!(statm >> size >> resident)) {
+    return 0;
+  }
+  const long page_size = sysconf(_SC_PAGESIZE);  // NOLINT(google-runtime-int)
+  return page_size > 0 ? resident * static_cast<uint64_t>(page_size) : 0;
+}
+
+bool MemoryMonitor::fits(uint64_t bytes) const {
+  if (!enabled()) {
+    return true;
+  }
+  const uint64_t rss = residentBytes();
+  return rss <= soft_limit_ && bytes <= soft_limit_ - rss;
+}
+
+boost::optional<unsigned int> MemoryMonitor::update(uint64_t rss) {
+  if (!enabled()) {
+    return boost::none;
+  }
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (rss > peak_) {
+    peak_ = rss;
+  }
+  unsigned int level = 0;
+  for (const auto watermark : kWatermarks) {
+    if (rss >= soft_limit_ / 100 * watermark) {
+      level = watermark;
+    }
+  }
+  const bool crossed = level > level_;
+  level_ = level;
+  if (!crossed) {
+    return boost::none;
+  }
+  return level;
+}
+
+uint64_t MemoryMonitor::peak() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return peak_;
+}
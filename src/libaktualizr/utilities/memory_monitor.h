@@ -0,0 +1,47 @@
+#ifndef MEMORY_MONITOR_H_
+#define MEMORY_MONITOR_H_
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+
+#include <boost/optional.hpp>
+
+/**
+ * Tracks the resident memory of the process against a soft limit and reports
+ * when it crosses one of the watermarks, given in percent of the limit. The
+ * limit is not enforced: callers use fits() to refuse operations that would
+ * exceed it. A limit of 0 disables the monitor.
+ */
+class MemoryMonitor {
+ public:
+  static constexpr std::array<unsigned int, 4> kWatermarks{{50, 75, 90, 100}};
+
+  explicit MemoryMonitor(uint64_t soft_limit) : soft_limit_(soft_limit) {}
+
+  /** Resident set size of the process in bytes, or 0 if it can't be determined. */
+  static uint64_t residentBytes();
+
+  uint64_t softLimit() const { return soft_limit_; }
+  bool enabled() const { return soft_limit_ != 0; }
+  /** Whether `bytes` of additional memory can be used without exceeding the soft limit. */
+  bool fits(uint64_t bytes) const;
+
+  /** Sample the resident memory, see update(). */
+  boost::optional<unsigned int> check() { return update(residentBytes()); }
+  /**
+   * Returns the highest watermark that `rss` has crossed since the previous
+   * update, if any. A watermark is reported again only after the resident
+   * memory has dropped below it.
+   */
+  boost::optional<unsigned int> update(uint64_t rss);
+  uint64_t peak() const;
+
+ private:
+  uint64_t soft_limit_;
+  unsigned int level_{0};
+  uint64_t peak_{0};
+  mutable std::mutex mutex_;
+};
+
+#endif  // MEMORY_MONITOR_H_
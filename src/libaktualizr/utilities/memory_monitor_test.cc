@@ -0,0 +1,41 @@
+#include <gtest/gtest.h>
+
+#include <boost/optional/optional_io.hpp>
+
+#include "utilities/memory_monitor.h"
+
+TEST(MemoryMonitor, ResidentBytes) {
+  const uint64_t rss = MemoryMonitor::residentBytes();
+  EXPECT_GT(rss, 0);
+  EXPECT_TRUE(MemoryMonitor(rss * 4).fits(rss));
+  EXPECT_FALSE(MemoryMonitor(rss / 2).fits(0));
+}
+
+/* Each watermark is reported once when it is crossed upwards, and again after
+ * the resident memory dropped below it. */
+TEST(MemoryMonitor, Watermarks) {
+  MemoryMonitor monitor(1000);
+  EXPECT_FALSE(monitor.update(400));
+  EXPECT_EQ(monitor.update(600), 50U);
+  EXPECT_FALSE(monitor.update(700));
+  EXPECT_EQ(monitor.update(950), 90U);
+  EXPECT_FALSE(monitor.update(910));
+  EXPECT_EQ(monitor.update(1200), 100U);
+  EXPECT_FALSE(monitor.update(100));
+  EXPECT_EQ(monitor.update(800), 75U);
+  EXPECT_EQ(monitor.peak(), 1200U);
+}
+
+TEST(MemoryMonitor, Disabled) {
+  MemoryMonitor monitor(0);
+  EXPECT_FALSE(monitor.enabled());
+  EXPECT_FALSE(monitor.update(UINT64_MAX));
+  EXPECT_TRUE(monitor.fits(UINT64_MAX));
+}
+
+#ifndef __NO_MAIN__
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+#endif
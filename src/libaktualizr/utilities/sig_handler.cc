@@ -2,6 +2,7 @@
 #include "logging/logging.h"
 
 std::atomic_uint SigHandler::signal_marker_;   // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+std::atomic_uint SigHandler::wakeup_marker_;   // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
 std::mutex SigHandler::exit_m_;                // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
 std::condition_variable SigHandler::exit_cv_;  // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
 bool SigHandler::exit_flag_;                   // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
@@ -26,12 +27,12 @@ SigHandler::~SigHandler() {
   }
 }
 
-void SigHandler::start(const std::function<void()>& on_signal) {
+void SigHandler::start(const std::function<void()>& on_signal, const std::function<void()>& on_wakeup) {
   if (polling_thread_.get_id() != boost::thread::id()) {
     throw std::runtime_error("SigHandler can only be started once");
   }
 
-  polling_thread_ = boost::thread([on_signal]() {
+  polling_thread_ = boost::thread([on_signal, on_wakeup]() {
     std::unique_lock<std::mutex> l(exit_m_);
     while (true) {
       auto got_signal = signal_marker_.exchange(0);
@@ -41,6 +42,10 @@ void SigHandler::start(const std::function<void()>& on_signal) {
         return;
       }
 
+      if (wakeup_marker_.exchange(0) > 0 && on_wakeup) {
+        on_wakeup();
+      }
+
       if (exit_cv_.wait_for(l, std::chrono::seconds(1), [] { return exit_flag_; })) {
         break;
       }
@@ -50,9 +55,16 @@ void SigHandler::start(const std::function<void()>& on_signal) {
 
 void SigHandler::signal(int sig) { ::signal(sig, signal_handler); }
 
+void SigHandler::wakeupSignal(int sig) { ::signal(sig, wakeup_signal_handler); }
+
 void SigHandler::signal_handler(int sig) {
   (void)sig;
   unsigned int v = 0;
   // put true if currently set to false
   SigHandler::signal_marker_.compare_exchange_strong(v, 1);
 }
+
+void SigHandler::wakeup_signal_handler(int sig) {
+  (void)sig;
+  SigHandler::wakeup_marker_.store(1);
+}
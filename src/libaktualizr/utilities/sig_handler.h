@@ -20,9 +20,11 @@ class SigHandler {
   SigHandler& operator=(SigHandler&&) = delete;
 
   // set an handler for signals and start the handling thread
-  void start(const std::function<void()>& on_signal);
+  void start(const std::function<void()>& on_signal, const std::function<void()>& on_wakeup = nullptr);
   // add hook on signal `sig`
   static void signal(int sig);
+  // add hook on signal `sig` that calls `on_wakeup` and keeps the handling thread running
+  static void wakeupSignal(int sig);
 
   bool masked();
   void mask(int secs);  // send 0 to unmask
@@ -31,9 +33,11 @@ class SigHandler {
   SigHandler() = default;
   ~SigHandler();
   static void signal_handler(int sig);
+  static void wakeup_signal_handler(int sig);
 
   boost::thread polling_thread_;
   static std::atomic_uint signal_marker_;  // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+  static std::atomic_uint wakeup_marker_;  // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
 
   static std::mutex exit_m_;                // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
   static std::condition_variable exit_cv_;  // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
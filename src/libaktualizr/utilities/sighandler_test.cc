@@ -57,6 +57,21 @@ TEST(SigHandler, Catch) {
   }
 }
 
+/* A wakeup signal calls its handler and keeps the handling thread running. */
+TEST(SigHandler, Wakeup) {
+  std::atomic<int> wakeups{0};
+  SigHandler::get().start([]() {}, [&wakeups]() { ++wakeups; });
+  SigHandler::wakeupSignal(SIGUSR1);
+
+  for (int expected = 1; expected <= 2; ++expected) {
+    raise(SIGUSR1);
+    for (int i = 0; i < 100 && wakeups.load() < expected; ++i) {
+      boost::this_thread::sleep_for(boost::chrono::milliseconds(50));
+    }
+    EXPECT_EQ(wakeups.load(), expected);
+  }
+}
+
 #ifndef __NO_MAIN__
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
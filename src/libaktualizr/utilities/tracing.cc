@@ -0,0 +1,181 @@
+#include "tracing.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <utility>
+
+#include <boost/filesystem.hpp>
+
+#include "libaktualizr/config.h"
+#include "logging/logging.h"
+#include "utilities/utils.h"
+
+std::atomic<bool> Tracer::enabled_{false};
+
+namespace {
+
+struct SpanStats {
+  uint64_t count{0};
+  double sum{0.0};
+  double max{0.0};
+};
+
+struct TraceData {
+  std::mutex mutex;
+  boost::filesystem::path prometheus_path;
+  boost::filesystem::path chrome_trace_path;
+  uint64_t max_events{0};
+  std::map<std::pair<std::string, std::string>, SpanStats> spans;
+  std::map<std::string, uint64_t> counters;
+  std::deque<Json::Value> events;
+  uint64_t dropped{0};
+};
+
+TraceData &traceData() {
+  static TraceData trace_data;
+  return trace_data;
+}
+
+int64_t threadId() {
+  static std::atomic<int64_t> next{1};
+  thread_local const int64_t id = next++;
+  return id;
+}
+
+int64_t microseconds(Tracer::Clock::duration duration) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
+
+// Write to a temporary file first, so that readers never see a partial file.
+void writeAtomically(const boost::filesystem::path &path, const std::string &content) {
+  const boost::filesystem::path tmp = path.string() + ".tmp";
+  Utils::writeFile(tmp, content);
+  boost::filesystem::rename(tmp, path);
+}
+
+}  // namespace
+
+void Tracer::configure(const TracingConfig &config) {
+  TraceData &trace_data = traceData();
+  std::lock_guard<std::mutex> lock(trace_data.mutex);
+  trace_data.prometheus_path = config.prometheus_path;
+  trace_data.chrome_trace_path = config.chrome_trace_path;
+  trace_data.max_events = config.max_events;
+  enabled_ = config.enabled;
+}
+
+void Tracer::add(const char *name, uint64_t value) {
+  TraceData &trace_data = traceData();
+  std::lock_guard<std::mutex> lock(trace_data.mutex);
+  trace_data.counters[name] += value;
+}
+
+void Tracer::complete(const char *category, const char *name, Clock::time_point start, Clock::duration duration,
+                      Json::Value args) {
+  const double seconds = std::chrono::duration<double>(duration).count();
+  TraceData &trace_data = traceData();
+  std::lock_guard<std::mutex> lock(trace_data.mutex);
+  SpanStats &stats = trace_data.spans[{category, name}];
+  ++stats.count;
+  stats.sum += seconds;
+  stats.max = std::max(stats.max, seconds);
+
+  if (trace_data.max_events == 0) {
+    return;
+  }
+  if (trace_data.events.size() >= trace_data.max_events) {
+    // Keep the most recent events, which are the ones of interest after a slow update.
+    trace_data.events.pop_front();
+    ++trace_data.dropped;
+  }
+  Json::Value event;
+  event["name"] = name;
+  event["cat"] = category;
+  event["ph"] = "X";
+  event["ts"] = static_cast<Json::Int64>(microseconds(start.time_since_epoch()));
+  event["dur"] = static_cast<Json::Int64>(microseconds(duration));
+  event["pid"] = static_cast<Json::Int64>(getpid());
+  event["tid"] = static_cast<Json::Int64>(threadId());
+  if (!args.isNull()) {
+    event["args"] = std::move(args);
+  }
+  trace_data.events.push_back(std::move(event));
+}
+
+std::string Tracer::prometheus() {
+  TraceData &trace_data = traceData();
+  std::lock_guard<std::mutex> lock(trace_data.mutex);
+  std::ostringstream out;
+  out.precision(9);
+
+  out << "# HELP aktualizr_span_seconds Time spent in the phases of the update pipeline.\n";
+  out << "# TYPE aktualizr_span_seconds summary\n";
+  for (const auto &span : trace_data.spans) {
+    const std::string labels = "{category=\"" + span.first.first + "\",span=\"" + span.first.second + "\"}";
+    out << "aktualizr_span_seconds_sum" << labels << " " << span.second.sum << "\n";
+    out << "aktualizr_span_seconds_count" << labels << " " << span.second.count << "\n";
+  }
+  out << "# HELP aktualizr_span_max_seconds Longest time spent in a phase of the update pipeline.\n";
+  out << "# TYPE aktualizr_span_max_seconds gauge\n";
+  for (const auto &span : trace_data.spans) {
+    out << "aktualizr_span_max_seconds{category=\"" << span.first.first << "\",span=\"" << span.first.second
+        << "\"} " << span.second.max << "\n";
+  }
+  for (const auto &counter : trace_data.counters) {
+    out << "# TYPE aktualizr_" << counter.first << " counter\n";
+    out << "aktualizr_" << counter.first << " " << counter.second << "\n";
+  }
+  out << "# TYPE aktualizr_trace_events_dropped_total counter\n";
+  out << "aktualizr_trace_events_dropped_total " << trace_data.dropped << "\n";
+  return out.str();
+}
+
+Json::Value Tracer::chromeTrace() {
+  TraceData &trace_data = traceData();
+  std::lock_guard<std::mutex> lock(trace_data.mutex);
+  Json::Value trace;
+  trace["displayTimeUnit"] = "ms";
+  trace["traceEvents"] = Json::arrayValue;
+  for (const auto &event : trace_data.events) {
+    trace["traceEvents"].append(event);
+  }
+  return trace;
+}
+
+void Tracer::flush() {
+  if (!enabled()) {
+    return;
+  }
+  boost::filesystem::path prometheus_path;
+  boost::filesystem::path chrome_trace_path;
+  {
+    TraceData &trace_data = traceData();
+    std::lock_guard<std::mutex> lock(trace_data.mutex);
+    prometheus_path = trace_data.prometheus_path;
+    chrome_trace_path = trace_data.chrome_trace_path;
+  }
+  try {
+    if (!prometheus_path.empty()) {
+      writeAtomically(prometheus_path, prometheus());
+    }
+    if (!chrome_trace_path.empty()) {
+      writeAtomically(chrome_trace_path, Utils::jsonToCanonicalStr(chromeTrace()));
+    }
+  } catch (const std::exception &e) {
+    LOG_WARNING << "Could not write the trace: " << e.what();
+  }
+}
+
+void Tracer::reset() {
+  TraceData &trace_data = traceData();
+  std::lock_guard<std::mutex> lock(trace_data.mutex);
+  trace_data.spans.clear();
+  trace_data.counters.clear();
+  trace_data.events.clear();
+  trace_data.dropped = 0;
+}
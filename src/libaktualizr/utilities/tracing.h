@@ -0,0 +1,108 @@
+#ifndef TRACING_H_
+#define TRACING_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "json/json.h"
+
+struct TracingConfig;
+
+/**
+ * Collects the time spent in the phases of the update pipeline and counters
+ * such as the bytes transferred. The data is exported in the Prometheus text
+ * format (for the textfile collector of node_exporter) and as a Chrome trace,
+ * which chrome://tracing and Perfetto can display.
+ *
+ * Tracing is disabled by default. While disabled, a span or a counter costs
+ * a single atomic load and nothing is recorded. That doesn't cover the
+ * arguments computed at the call site, see TraceSpan.
+ */
+class Tracer {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  /** Enable or disable tracing. Enabling again keeps the data collected so far. */
+  static void configure(const TracingConfig& config);
+  static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+
+  /** Add to a counter, exported as aktualizr_<name>. */
+  static void count(const char* name, uint64_t value) {
+    if (enabled()) {
+      add(name, value);
+    }
+  }
+  /** Record a span that has finished, e.g. one measured by SQLite itself. */
+  static void complete(const char* category, const char* name, Clock::time_point start, Clock::duration duration,
+                       Json::Value args);
+
+  static std::string prometheus();
+  static Json::Value chromeTrace();
+  /** Write the data collected so far to the files of the configuration. */
+  static void flush();
+  /** Drop the data collected so far. */
+  static void reset();
+
+ private:
+  static void add(const char* name, uint64_t value);
+
+  static std::atomic<bool> enabled_;
+};
+
+/**
+ * Measures the scope it lives in. Arguments only show up in the Chrome trace.
+ * They are only stored while tracing is enabled, but they are computed at the
+ * call site either way, so check the span first unless they are constants:
+ *
+ *   TraceSpan span("http", "get");
+ *   if (span) { span.arg("url", url); }
+ */
+class TraceSpan {
+ public:
+  TraceSpan(const char* category, const char* name) : active_(Tracer::enabled()), category_(category), name_(name) {
+    if (active_) {
+      start_ = Tracer::Clock::now();
+    }
+  }
+  ~TraceSpan() {
+    if (active_) {
+      Tracer::complete(category_, name_, start_, Tracer::Clock::now() - start_,
+                       args_ ? std::move(*args_) : Json::Value());
+    }
+  }
+  TraceSpan(const TraceSpan&) = delete;
+  TraceSpan(TraceSpan&&) = delete;
+  TraceSpan& operator=(const TraceSpan&) = delete;
+  TraceSpan& operator=(TraceSpan&&) = delete;
+
+  explicit operator bool() const { return active_; }
+  void arg(const char* key, const std::string& value) {
+    if (active_) {
+      args()[key] = value;
+    }
+  }
+  void arg(const char* key, int64_t value) {
+    if (active_) {
+      args()[key] = static_cast<Json::Int64>(value);
+    }
+  }
+
+ private:
+  const bool active_;
+  const char* category_;
+  const char* name_;
+  Json::Value& args() {
+    if (!args_) {
+      args_.reset(new Json::Value());
+    }
+    return *args_;
+  }
+
+  Tracer::Clock::time_point start_;
+  std::unique_ptr<Json::Value> args_;  // only allocated once an argument is added
+};
+
+#endif  // TRACING_H_
@@ -0,0 +1,17 @@
+#include "libaktualizr/config.h"
+
+#include "utilities/config_utils.h"
+
+void TracingConfig::updateFromPropertyTree(const boost::property_tree::ptree& pt) {
+  CopyFromConfig(enabled, "enabled", pt);
+  CopyFromConfig(prometheus_path, "prometheus_path", pt);
+  CopyFromConfig(chrome_trace_path, "chrome_trace_path", pt);
+  CopyFromConfig(max_events, "max_events", pt);
+}
+
+void TracingConfig::writeToStream(std::ostream& out_stream) const {
+  writeOption(out_stream, enabled, "enabled");
+  writeOption(out_stream, prometheus_path, "prometheus_path");
+  writeOption(out_stream, chrome_trace_path, "chrome_trace_path");
+  writeOption(out_stream, max_events, "max_events");
+}
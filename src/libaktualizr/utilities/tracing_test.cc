@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <boost/filesystem.hpp>
+
+#include "libaktualizr/config.h"
+#include "utilities/tracing.h"
+#include "utilities/utils.h"
+
+static void enableTracing(uint64_t max_events = 100) {
+  TracingConfig config;
+  config.enabled = true;
+  config.max_events = max_events;
+  Tracer::configure(config);
+  Tracer::reset();
+}
+
+/* Nothing is recorded while tracing is disabled. */
+TEST(Tracing, Disabled) {
+  Tracer::configure(TracingConfig());
+  Tracer::reset();
+  {
+    TraceSpan span("test", "disabled");
+    EXPECT_FALSE(span);
+  }
+  Tracer::count("disabled_total", 1);
+  EXPECT_EQ(Tracer::chromeTrace()["traceEvents"].size(), 0);
+  EXPECT_EQ(Tracer::prometheus().find("disabled"), std::string::npos);
+}
+
+/* Spans are summed up per name, counters are added up. */
+TEST(Tracing, Prometheus) {
+  enableTracing();
+  for (int i = 0; i < 3; ++i) {
+    TraceSpan span("uptane", "fetchMeta");
+    EXPECT_TRUE(span);
+  }
+  Tracer::count("http_bytes_downloaded_total", 100);
+  Tracer::count("http_bytes_downloaded_total", 50);
+
+  const std::string text = Tracer::prometheus();
+  EXPECT_NE(text.find("aktualizr_span_seconds_count{category=\"uptane\",span=\"fetchMeta\"} 3\n"), std::string::npos);
+  EXPECT_NE(text.find("aktualizr_span_seconds_sum{category=\"uptane\",span=\"fetchMeta\"} "), std::string::npos);
+  EXPECT_NE(text.find("aktualizr_http_bytes_downloaded_total 150\n"), std::string::npos);
+}
+
+/* Each span is a complete event of the Chrome trace, with its arguments. */
+TEST(Tracing, ChromeTrace) {
+  enableTracing();
+  {
+    TraceSpan outer("uptane", "downloadImages");
+    TraceSpan inner("http", "download");
+    inner.arg("url", "https://example.com/targets/a.bin");
+    inner.arg("bytes", 1024);
+  }
+
+  const Json::Value events = Tracer::chromeTrace()["traceEvents"];
+  ASSERT_EQ(events.size(), 2);
+  // The inner span finishes first.
+  EXPECT_EQ(events[0]["name"].asString(), "download");
+  EXPECT_EQ(events[0]["cat"].asString(), "http");
+  EXPECT_EQ(events[0]["ph"].asString(), "X");
+  EXPECT_EQ(events[0]["args"]["bytes"].asInt64(), 1024);
+  EXPECT_EQ(events[1]["name"].asString(), "downloadImages");
+  EXPECT_FALSE(events[1].isMember("args"));
+  EXPECT_LE(events[1]["ts"].asInt64(), events[0]["ts"].asInt64());
+  EXPECT_GE(events[1]["dur"].asInt64(), events[0]["dur"].asInt64());
+}
+
+/* Only the most recent events are kept, the summary covers all of them. */
+TEST(Tracing, MaxEvents) {
+  enableTracing(2);
+  for (int i = 0; i < 5; ++i) {
+    TraceSpan span("storage", "sql");
+    span.arg("i", i);
+  }
+  const Json::Value events = Tracer::chromeTrace()["traceEvents"];
+  ASSERT_EQ(events.size(), 2);
+  EXPECT_EQ(events[1]["args"]["i"].asInt(), 4);
+  const std::string text = Tracer::prometheus();
+  EXPECT_NE(text.find("aktualizr_span_seconds_count{category=\"storage\",span=\"sql\"} 5\n"), std::string::npos);
+  EXPECT_NE(text.find("aktualizr_trace_events_dropped_total 3\n"), std::string::npos);
+}
+
+/* The data is written to the configured files. */
+TEST(Tracing, Flush) {
+  TemporaryDirectory temp_dir;
+  TracingConfig config;
+  config.enabled = true;
+  config.prometheus_path = temp_dir / "aktualizr.prom";
+  config.chrome_trace_path = temp_dir / "trace.json";
+  Tracer::configure(config);
+  Tracer::reset();
+  { TraceSpan span("uptane", "uptaneInstall"); }
+  Tracer::flush();
+
+  EXPECT_NE(Utils::readFile(temp_dir / "aktualizr.prom").find("uptaneInstall"), std::string::npos);
+  EXPECT_EQ(Utils::parseJSONFile(temp_dir / "trace.json")["traceEvents"][0]["name"].asString(), "uptaneInstall");
+  EXPECT_FALSE(boost::filesystem::exists(temp_dir / "trace.json.tmp"));
+}
+
+#ifndef __NO_MAIN__
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+#endif
@@ -53,6 +53,23 @@ std::ostream &operator<<(std::ostream &os, VerificationType vtype) {
   return os;
 }
 
+std::ostream &operator<<(std::ostream &os, const EventOverflow overflow) {
+  std::string overflow_str;
+  switch (overflow) {
+    case EventOverflow::kBlock:
+      overflow_str = "block";
+      break;
+    case EventOverflow::kDropNewest:
+      overflow_str = "drop_newest";
+      break;
+    default:
+      overflow_str = "drop_progress";
+      break;
+  }
+  os << '"' << overflow_str << '"';
+  return os;
+}
+
 std::string TimeToString(struct tm time) {
   std::array<char, 22> formatted{};
   strftime(formatted.data(), 22, "%Y-%m-%dT%H:%M:%SZ", &time);
@@ -941,6 +941,17 @@ std::string Socket::ToString() const {
   return Utils::ipDisplayName(saddr) + ":" + std::to_string(Utils::ipPort(saddr));
 }
 
+void Socket::setTimeout(std::chrono::milliseconds timeout) const {
+  struct timeval tv {};
+  tv.tv_sec = static_cast<time_t>(timeout.count() / 1000);
+  tv.tv_usec = static_cast<suseconds_t>((timeout.count() % 1000) * 1000);
+  // On Linux, the send timeout applies to connect() as well.
+  if (-1 == setsockopt(socket_fd_, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) ||
+      -1 == setsockopt(socket_fd_, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv))) {
+    throw std::system_error(errno, std::system_category(), "socket");
+  }
+}
+
 void Socket::bind(in_port_t port, bool reuse) const {
   sockaddr_in sa{};
   memset(&sa, 0, sizeof(sa));
@@ -2,6 +2,7 @@
 #define UTILS_H_
 
 #include <boost/filesystem/path.hpp>
+#include <chrono>
 #include <memory>
 #include <string>
 
@@ -118,6 +119,8 @@ class Socket {
 
   int &operator*() { return socket_fd_; }
   std::string ToString() const;
+  /** Give up on connecting, sending or receiving after `timeout`. Zero restores the system defaults. */
+  void setTimeout(std::chrono::milliseconds timeout) const;
 
  protected:
   void bind(in_port_t port, bool reuse = true) const;
@@ -0,0 +1,100 @@
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#include "aktualizr_secondary_config.h"
+#include "aktualizr_secondary_file.h"
+#include "logging/logging.h"
+#include "secondary_tcp_server.h"
+#include "utilities/utils.h"
+
+namespace bpo = boost::program_options;
+
+/*
+ * Serves a number of aktualizr-secondary instances over loopback TCP, one
+ * port each, for aktualizr-secondary-fleet. Once they are all listening, it
+ * writes "<serial> <port>" for each of them to the standard output, followed
+ * by "ready". It serves them until its standard input is closed.
+ */
+int main(int argc, char *argv[]) {
+  // The standard output carries the ports.
+  setenv("LOG_STDERR", "1", 1);
+  logger_init();
+
+  bpo::options_description description("aktualizr-secondary-fleet-server command line options");
+  // clang-format off
+  description.add_options()
+      ("help,h", "print usage")
+      ("loglevel", bpo::value<int>()->default_value(3), "set log level 0-5 (trace, debug, info, warning, error, fatal)")
+      ("count", bpo::value<size_t>()->required(), "number of Secondaries")
+      ("dir", bpo::value<boost::filesystem::path>()->required(), "directory for the storage of the Secondaries")
+      ("ecu-hardware-id", bpo::value<std::string>()->default_value("fleet-hw"), "hardware ID of the Secondaries")
+      ("ecu-serial-prefix", bpo::value<std::string>()->default_value("fleet-ecu-"), "serials are the prefix and an index");
+  // clang-format on
+
+  bpo::variables_map vm;
+  try {
+    bpo::store(bpo::parse_command_line(argc, argv, description), vm);
+    if (vm.count("help") != 0) {
+      std::cout << description << '\n';
+      return EXIT_SUCCESS;
+    }
+    bpo::notify(vm);
+  } catch (const bpo::error &ex) {
+    std::cerr << ex.what() << '\n' << description;
+    return EXIT_FAILURE;
+  }
+  logger_set_threshold(static_cast<boost::log::trivial::severity_level>(vm["loglevel"].as<int>()));
+
+  std::vector<std::shared_ptr<AktualizrSecondaryFile>> secondaries;
+  std::vector<std::unique_ptr<SecondaryTcpServer>> servers;
+  std::vector<std::thread> threads;
+  int ret = EXIT_SUCCESS;
+  try {
+    const auto count = vm["count"].as<size_t>();
+    const auto dir = vm["dir"].as<boost::filesystem::path>();
+    for (size_t i = 0; i < count; ++i) {
+      const std::string serial = vm["ecu-serial-prefix"].as<std::string>() + std::to_string(i);
+      AktualizrSecondaryConfig config;
+      config.pacman.type = PACKAGE_MANAGER_NONE;
+      config.storage.type = StorageType::kSqlite;
+      config.storage.path = dir / serial;
+      config.uptane.ecu_serial = serial;
+      config.uptane.ecu_hardware_id = vm["ecu-hardware-id"].as<std::string>();
+      config.uptane.key_type = KeyType::kED25519;
+      config.uptane.verification_type = VerificationType::kFull;
+
+      auto secondary = std::make_shared<AktualizrSecondaryFile>(config);
+      secondary->initialize();
+      secondaries.push_back(secondary);
+
+      servers.push_back(std_::make_unique<SecondaryTcpServer>(*secondary, "", 0));
+      SecondaryTcpServer *server = servers.back().get();
+      threads.emplace_back([server]() { server->run(); });
+      server->wait_until_running();
+      std::cout << serial << " " << server->port() << std::endl;
+    }
+    std::cout << "ready" << std::endl;
+
+    std::string line;
+    while (std::getline(std::cin, line)) {
+    }
+  } catch (const std::exception &exc) {
+    LOG_ERROR << "Error: " << exc.what();
+    ret = EXIT_FAILURE;
+  }
+
+  for (auto &server : servers) {
+    server->stop();
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  return ret;
+}
@@ -0,0 +1,234 @@
+#include <sys/resource.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#include "httpfake.h"
+#include "libaktualizr/aktualizr.h"
+#include "libaktualizr/config.h"
+#include "logging/logging.h"
+#include "secondary_fleet.h"
+#include "storage/invstorage.h"
+#include "uptane_repo.h"
+#include "utilities/memory_monitor.h"
+#include "utilities/utils.h"
+
+namespace bpo = boost::program_options;
+
+using Clock = std::chrono::steady_clock;
+
+// Gives access to the constructor that takes the storage and HTTP client.
+class FleetAktualizr : public Aktualizr {
+ public:
+  FleetAktualizr(const Config &config, const std::shared_ptr<INvStorage> &storage,
+                 const std::shared_ptr<HttpInterface> &http)
+      : Aktualizr(config, storage, http) {}
+};
+
+static double msSince(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+static double cpuMs(const struct timeval &tv) {
+  return static_cast<double>(tv.tv_sec) * 1000.0 + static_cast<double>(tv.tv_usec) / 1000.0;
+}
+
+bpo::variables_map parseOptions(int argc, char **argv) {
+  bpo::options_description description("aktualizr-secondary-fleet command line options");
+  // clang-format off
+  description.add_options()
+      ("help,h", "print usage")
+      ("loglevel", bpo::value<int>()->default_value(3), "set log level 0-5 (trace, debug, info, warning, error, fatal)")
+      ("secondaries,n", bpo::value<size_t>()->default_value(16), "number of Secondaries")
+      ("mode", bpo::value<std::string>()->default_value("in-process"), "in-process or tcp")
+      ("server", bpo::value<boost::filesystem::path>(), "aktualizr-secondary-fleet-server executable for tcp mode, by default the one next to this executable")
+      ("firmware-size", bpo::value<uint64_t>()->default_value(64 * 1024), "size of the firmware of every Secondary in bytes")
+      ("latency-ms", bpo::value<int64_t>()->default_value(0), "latency of each call to a Secondary")
+      ("bandwidth", bpo::value<uint64_t>()->default_value(0), "bandwidth of the link to each Secondary in bytes per second, 0 for unlimited")
+      ("failure-rate", bpo::value<double>()->default_value(0.0), "probability of a call to a Secondary failing")
+      ("seed", bpo::value<unsigned int>()->default_value(0), "seed of the failures")
+      ("manifests", bpo::value<unsigned int>()->default_value(10), "number of manifests to assemble and send")
+      ("dir", bpo::value<boost::filesystem::path>(), "working directory, a temporary one by default")
+      ("output,o", bpo::value<boost::filesystem::path>(), "write the report there instead of to the standard output");
+  // clang-format on
+
+  bpo::variables_map vm;
+  try {
+    bpo::store(bpo::parse_command_line(argc, argv, description), vm);
+    if (vm.count("help") != 0) {
+      std::cout << description << '\n';
+      exit(EXIT_SUCCESS);
+    }
+    bpo::notify(vm);
+  } catch (const bpo::error &ex) {
+    std::cerr << ex.what() << '\n' << description;
+    exit(EXIT_FAILURE);
+  }
+  return vm;
+}
+
+/*
+ * Benchmarks a Primary against a fleet of simulated Secondaries: how long it
+ * takes to assemble and send the device manifest, and to update every
+ * Secondary. The metadata and images are served by HttpFake, so the download
+ * time says little about a real server. Run it from the source directory, it
+ * uses the test credentials.
+ */
+int main(int argc, char **argv) {
+  logger_init();
+  const bpo::variables_map vm = parseOptions(argc, argv);
+  logger_set_threshold(static_cast<boost::log::trivial::severity_level>(vm["loglevel"].as<int>()));
+
+  TemporaryDirectory temp_dir("fleet");
+  const boost::filesystem::path dir = vm.count("dir") != 0 ? vm["dir"].as<boost::filesystem::path>() : temp_dir.Path();
+  Utils::createDirectories(dir, S_IRWXU);
+
+  FleetConfig fleet_config;
+  const std::string mode = vm["mode"].as<std::string>();
+  if (mode == "tcp") {
+    fleet_config.mode = FleetMode::kTcp;
+  } else if (mode != "in-process") {
+    std::cerr << "Unknown mode " << mode << "\n";
+    return EXIT_FAILURE;
+  }
+  fleet_config.size = vm["secondaries"].as<size_t>();
+  fleet_config.dir = dir / "secondaries";
+  if (vm.count("server") != 0) {
+    fleet_config.server = vm["server"].as<boost::filesystem::path>();
+  } else {
+    fleet_config.server =
+        boost::filesystem::read_symlink("/proc/self/exe").parent_path() / "aktualizr-secondary-fleet-server";
+  }
+  fleet_config.link.latency = std::chrono::milliseconds(vm["latency-ms"].as<int64_t>());
+  fleet_config.link.bandwidth = vm["bandwidth"].as<uint64_t>();
+  fleet_config.link.failure_rate = vm["failure-rate"].as<double>();
+  fleet_config.link.seed = vm["seed"].as<unsigned int>();
+
+  Json::Value report;
+  try {
+    SecondaryFleet fleet(fleet_config);
+
+    // One image per Secondary, so that the Primary has to fetch and send each of them.
+    const boost::filesystem::path meta_dir = dir / "meta";
+    UptaneRepo repo{meta_dir, "", "fleet"};
+    repo.generateRepo(KeyType::kED25519);
+    std::string firmware(vm["firmware-size"].as<uint64_t>(), '\0');
+    std::mt19937 rng(fleet_config.link.seed);
+    std::generate(firmware.begin(), firmware.end(), [&rng]() { return static_cast<char>(rng()); });
+    Utils::writeFile(dir / "firmware.bin", firmware);
+    std::vector<BinaryImage> images;
+    for (size_t i = 0; i < fleet_config.size; ++i) {
+      BinaryImage image;
+      image.image_path = dir / "firmware.bin";
+      image.targetname = "firmware-" + SecondaryFleet::serial(i) + ".bin";
+      image.hardware_id = fleet_config.hardware_id;
+      images.push_back(image);
+    }
+    repo.addImages(images);
+    for (size_t i = 0; i < fleet_config.size; ++i) {
+      repo.addTarget(images[i].targetname.string(), fleet_config.hardware_id, SecondaryFleet::serial(i));
+    }
+    repo.signTargets();
+
+    auto http = std::make_shared<HttpFake>(dir, "", meta_dir / "repo");
+    Config conf("tests/config/basic.toml");
+    conf.uptane.director_server = http->tls_server + "/director";
+    conf.uptane.repo_server = http->tls_server + "/repo";
+    conf.provision.server = http->tls_server;
+    conf.provision.primary_ecu_serial = "fleet-primary";
+    conf.provision.primary_ecu_hardware_id = "fleet-primary-hw";
+    conf.storage.path = dir / "primary";
+    conf.import.base_path = dir / "primary" / "import";
+    conf.pacman.images_path = dir / "primary" / "images";
+    conf.tls.server = http->tls_server;
+    conf.bootloader.reboot_sentinel_dir = dir / "primary";
+    auto storage = INvStorage::newStorage(conf.storage);
+
+    FleetAktualizr aktualizr(conf, storage, http);
+    for (const auto &secondary : fleet.secondaries()) {
+      aktualizr.AddSecondary(secondary);
+    }
+
+    struct rusage usage_before {};
+    getrusage(RUSAGE_SELF, &usage_before);
+
+    auto start = Clock::now();
+    aktualizr.Initialize();
+    report["initialize_ms"] = msSince(start);
+
+    const unsigned int manifests = vm["manifests"].as<unsigned int>();
+    double manifest_total = 0.0;
+    double manifest_max = 0.0;
+    for (unsigned int i = 0; i < manifests; ++i) {
+      start = Clock::now();
+      aktualizr.SendManifest().get();
+      const double ms = msSince(start);
+      manifest_total += ms;
+      manifest_max = std::max(manifest_max, ms);
+    }
+    report["manifest_ms"]["samples"] = manifests;
+    report["manifest_ms"]["mean"] = manifests != 0 ? manifest_total / manifests : 0.0;
+    report["manifest_ms"]["max"] = manifest_max;
+
+    const auto update_start = Clock::now();
+    start = update_start;
+    const result::UpdateCheck update_result = aktualizr.CheckUpdates().get();
+    report["update"]["check_ms"] = msSince(start);
+    report["update"]["targets"] = static_cast<Json::UInt64>(update_result.updates.size());
+    start = Clock::now();
+    const result::Download download_result = aktualizr.Download(update_result.updates).get();
+    report["update"]["download_ms"] = msSince(start);
+    start = Clock::now();
+    const result::Install install_result = aktualizr.Install(download_result.updates).get();
+    report["update"]["install_ms"] = msSince(start);
+    report["update"]["total_ms"] = msSince(update_start);
+
+    uint64_t installed = 0;
+    for (const auto &ecu_report : install_result.ecu_reports) {
+      if (ecu_report.install_res.isSuccess()) {
+        ++installed;
+      }
+    }
+    report["update"]["installed"] = static_cast<Json::UInt64>(installed);
+    report["update"]["failed"] = static_cast<Json::UInt64>(fleet_config.size - installed);
+
+    struct rusage usage_after {};
+    getrusage(RUSAGE_SELF, &usage_after);
+    report["primary"]["user_cpu_ms"] = cpuMs(usage_after.ru_utime) - cpuMs(usage_before.ru_utime);
+    report["primary"]["system_cpu_ms"] = cpuMs(usage_after.ru_stime) - cpuMs(usage_before.ru_stime);
+    report["primary"]["max_rss_kb"] = static_cast<Json::Int64>(usage_after.ru_maxrss);
+    report["primary"]["rss_bytes"] = static_cast<Json::UInt64>(MemoryMonitor::residentBytes());
+    // In-process Secondaries run on the Primary's CPU time and memory.
+    report["primary"]["includes_secondaries"] = fleet_config.mode == FleetMode::kInProcess;
+    report["link_failures"] = static_cast<Json::UInt64>(fleet.failures());
+  } catch (const std::exception &exc) {
+    LOG_ERROR << "Error: " << exc.what();
+    return EXIT_FAILURE;
+  }
+
+  report["secondaries"] = static_cast<Json::UInt64>(fleet_config.size);
+  report["mode"] = mode;
+  report["firmware_size"] = static_cast<Json::UInt64>(vm["firmware-size"].as<uint64_t>());
+  report["link"]["latency_ms"] = static_cast<Json::Int64>(fleet_config.link.latency.count());
+  report["link"]["bandwidth"] = static_cast<Json::UInt64>(fleet_config.link.bandwidth);
+  report["link"]["failure_rate"] = fleet_config.link.failure_rate;
+
+  if (vm.count("output") != 0) {
+    Utils::writeFile(vm["output"].as<boost::filesystem::path>(), report);
+  } else {
+    std::cout << report << std::endl;
+  }
+
+  // Without injected failures, every Secondary has to be updated.
+  const bool complete = report["update"]["failed"].asUInt64() == 0;
+  return complete || fleet_config.link.failure_rate > 0.0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,186 @@
+#include "secondary_fleet.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <sstream>
+
+#include <boost/filesystem.hpp>
+
+#include "crypto/crypto.h"
+#include "ipuptanesecondary.h"
+#include "logging/logging.h"
+#include "utilities/utils.h"
+#include "virtualsecondary.h"
+
+SecondaryFleet::SecondaryFleet(FleetConfig config) : config_(std::move(config)) {
+  Utils::createDirectories(config_.dir, S_IRWXU);
+  if (config_.mode == FleetMode::kTcp) {
+    try {
+      createTcp();
+    } catch (...) {
+      // The destructor doesn't run if the constructor throws.
+      secondaries_.clear();
+      stopServer(true);
+      throw;
+    }
+  } else {
+    createInProcess();
+  }
+}
+
+SecondaryFleet::~SecondaryFleet() {
+  secondaries_.clear();
+  stopServer(false);
+}
+
+void SecondaryFleet::stopServer(const bool force) {
+  if (server_pid_ <= 0) {
+    return;
+  }
+  // The server exits once its standard input is closed. If it failed to
+  // start up properly, it may never read from it.
+  close(server_stdin_);
+  if (force) {
+    kill(server_pid_, SIGTERM);
+  }
+  int status = 0;
+  waitpid(server_pid_, &status, 0);
+  server_pid_ = -1;
+  server_stdin_ = -1;
+}
+
+std::string SecondaryFleet::serial(size_t index) { return "fleet-ecu-" + std::to_string(index); }
+
+uint64_t SecondaryFleet::failures() const {
+  uint64_t failures = 0;
+  for (const auto& secondary : secondaries_) {
+    failures += secondary->failures();
+  }
+  return failures;
+}
+
+void SecondaryFleet::addSecondary(size_t index, SecondaryInterface::Ptr secondary) {
+  LinkConfig link = config_.link;
+  link.seed += static_cast<unsigned int>(index);
+  secondaries_.push_back(std::make_shared<SimulatedLink>(std::move(secondary), link));
+}
+
+void SecondaryFleet::createInProcess() {
+  // Generating an RSA key for every Secondary would dominate the setup time.
+  std::string public_key;
+  std::string private_key;
+  if (!Crypto::generateKeyPair(KeyType::kRSA2048, &public_key, &private_key)) {
+    throw std::runtime_error("Could not generate the keys of the Secondary fleet");
+  }
+
+  for (size_t i = 0; i < config_.size; ++i) {
+    const boost::filesystem::path sec_dir = config_.dir / serial(i);
+    Utils::createDirectories(sec_dir, S_IRWXU);
+
+    Primary::VirtualSecondaryConfig ecu_config;
+    ecu_config.partial_verifying = false;
+    ecu_config.full_client_dir = sec_dir;
+    ecu_config.ecu_serial = serial(i);
+    ecu_config.ecu_hardware_id = config_.hardware_id;
+    ecu_config.ecu_private_key = "sec.priv";
+    ecu_config.ecu_public_key = "sec.pub";
+    ecu_config.firmware_path = sec_dir / "firmware.bin";
+    ecu_config.target_name_path = sec_dir / "firmware_name.txt";
+    ecu_config.metadata_path = sec_dir / "secondary_metadata";
+    Utils::writeFile(sec_dir / ecu_config.ecu_private_key, private_key);
+    Utils::writeFile(sec_dir / ecu_config.ecu_public_key, public_key);
+
+    addSecondary(i, std::make_shared<Primary::VirtualSecondary>(ecu_config));
+  }
+}
+
+void SecondaryFleet::createTcp() {
+  int to_server[2];
+  int from_server[2];
+  if (pipe2(to_server, O_CLOEXEC) != 0) {
+    throw std::runtime_error(std::string("Could not create a pipe: ") + std::strerror(errno));
+  }
+  if (pipe2(from_server, O_CLOEXEC) != 0) {
+    close(to_server[0]);
+    close(to_server[1]);
+    throw std::runtime_error(std::string("Could not create a pipe: ") + std::strerror(errno));
+  }
+
+  const std::string server = config_.server.string();
+  const std::string count = std::to_string(config_.size);
+  const std::string dir = config_.dir.string();
+  const std::string loglevel = std::to_string(loggerGetSeverity());
+  std::vector<const char*> argv{server.c_str(),
+                                "--count",
+                                count.c_str(),
+                                "--dir",
+                                dir.c_str(),
+                                "--ecu-hardware-id",
+                                config_.hardware_id.c_str(),
+                                "--loglevel",
+                                loglevel.c_str(),
+                                nullptr};
+
+  server_pid_ = fork();
+  if (server_pid_ == 0) {
+    dup2(to_server[0], STDIN_FILENO);
+    dup2(from_server[1], STDOUT_FILENO);
+    execv(argv[0], const_cast<char* const*>(argv.data()));
+    _exit(127);
+  }
+  close(to_server[0]);
+  close(from_server[1]);
+  server_stdin_ = to_server[1];
+  if (server_pid_ < 0) {
+    close(from_server[0]);
+    throw std::runtime_error(std::string("Could not start the Secondary fleet server: ") + std::strerror(errno));
+  }
+
+  // The server reports "<serial> <port>" for every Secondary it is serving,
+  // then "ready".
+  std::map<std::string, in_port_t> ports;
+  FILE* reports = fdopen(from_server[0], "r");
+  if (reports == nullptr) {
+    close(from_server[0]);
+    throw std::runtime_error(std::string("Could not read from the Secondary fleet server: ") + std::strerror(errno));
+  }
+  char* line = nullptr;
+  size_t line_size = 0;
+  while (getline(&line, &line_size, reports) > 0) {
+    std::istringstream fields(line);
+    std::string serial_in;
+    in_port_t port = 0;
+    if (!(fields >> serial_in)) {
+      continue;
+    }
+    if (serial_in == "ready") {
+      break;
+    }
+    if (fields >> port) {
+      ports[serial_in] = port;
+    }
+  }
+  free(line);
+  fclose(reports);
+
+  for (size_t i = 0; i < config_.size; ++i) {
+    auto it = ports.find(serial(i));
+    if (it == ports.end()) {
+      throw std::runtime_error("The Secondary fleet server did not start Secondary " + serial(i));
+    }
+    auto secondary = Uptane::IpUptaneSecondary::connectAndCreate("127.0.0.1", it->second, VerificationType::kFull);
+    if (secondary == nullptr) {
+      throw std::runtime_error("Could not connect to Secondary " + serial(i) + " on port " +
+                               std::to_string(it->second));
+    }
+    addSecondary(i, secondary);
+  }
+}
@@ -0,0 +1,67 @@
+#ifndef SECONDARY_FLEET_SECONDARY_FLEET_H_
+#define SECONDARY_FLEET_SECONDARY_FLEET_H_
+
+#include <sys/types.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem/path.hpp>
+
+#include "simulated_link.h"
+
+enum class FleetMode {
+  // VirtualSecondaries in the process of the Primary.
+  kInProcess,
+  // aktualizr-secondary instances behind loopback TCP, hosted by a separate
+  // aktualizr-secondary-fleet-server process.
+  kTcp,
+};
+
+struct FleetConfig {
+  FleetMode mode{FleetMode::kInProcess};
+  size_t size{1};
+  std::string hardware_id{"fleet-hw"};
+  // Where the Secondaries keep their keys, metadata and firmware.
+  boost::filesystem::path dir;
+  // The aktualizr-secondary-fleet-server executable, for FleetMode::kTcp.
+  boost::filesystem::path server;
+  // Every Secondary gets a link of its own, seeded with `link.seed` plus its index.
+  LinkConfig link;
+};
+
+/**
+ * A fleet of simulated Secondaries to run a Primary against. In TCP mode the
+ * Secondaries run the real aktualizr-secondary stack in a server process of
+ * their own, which keeps their CPU time and memory apart from the Primary's.
+ */
+class SecondaryFleet {
+ public:
+  explicit SecondaryFleet(FleetConfig config);
+  ~SecondaryFleet();
+  SecondaryFleet(const SecondaryFleet&) = delete;
+  SecondaryFleet(SecondaryFleet&&) = delete;
+  SecondaryFleet& operator=(const SecondaryFleet&) = delete;
+  SecondaryFleet& operator=(SecondaryFleet&&) = delete;
+
+  static std::string serial(size_t index);
+
+  const std::vector<std::shared_ptr<SimulatedLink>>& secondaries() const { return secondaries_; }
+  /** Number of calls that the links have made to fail. */
+  uint64_t failures() const;
+
+ private:
+  void createInProcess();
+  void createTcp();
+  /** Stop the server of the tcp mode, if it is running. */
+  void stopServer(bool force);
+  void addSecondary(size_t index, SecondaryInterface::Ptr secondary);
+
+  const FleetConfig config_;
+  std::vector<std::shared_ptr<SimulatedLink>> secondaries_;
+  pid_t server_pid_{-1};
+  int server_stdin_{-1};
+};
+
+#endif  // SECONDARY_FLEET_SECONDARY_FLEET_H_
@@ -0,0 +1,91 @@
+#include "simulated_link.h"
+
+#include <thread>
+
+SimulatedLink::SimulatedLink(SecondaryInterface::Ptr secondary, LinkConfig config)
+    : secondary_(std::move(secondary)), config_(config), rng_(config.seed) {}
+
+std::chrono::microseconds SimulatedLink::transferTime(uint64_t bytes) const {
+  std::chrono::microseconds time = config_.latency;
+  if (config_.bandwidth != 0) {
+    time += std::chrono::microseconds(bytes * 1000000 / config_.bandwidth);
+  }
+  return time;
+}
+
+bool SimulatedLink::transfer(uint64_t bytes) const {
+  std::this_thread::sleep_for(transferTime(bytes));
+  if (config_.failure_rate <= 0.0) {
+    return true;
+  }
+  bool fail;
+  {
+    std::lock_guard<std::mutex> lock(rng_mutex_);
+    fail = std::uniform_real_distribution<double>(0.0, 1.0)(rng_) < config_.failure_rate;
+  }
+  if (fail) {
+    ++failures_;
+  }
+  return !fail;
+}
+
+data::InstallationResult SimulatedLink::linkFailure() {
+  return data::InstallationResult(data::ResultCode::Numeric::kInternalError, "Simulated link failure");
+}
+
+Uptane::Manifest SimulatedLink::getManifest() const {
+  if (!transfer(0)) {
+    return Json::Value();
+  }
+  return secondary_->getManifest();
+}
+
+data::InstallationResult SimulatedLink::putMetadata(const Uptane::Target& target) {
+  if (!transfer(0)) {
+    return linkFailure();
+  }
+  return secondary_->putMetadata(target);
+}
+
+bool SimulatedLink::ping() const { return transfer(0) && secondary_->ping(); }
+
+int32_t SimulatedLink::getRootVersion(bool director) const {
+  if (!transfer(0)) {
+    return -1;
+  }
+  return secondary_->getRootVersion(director);
+}
+
+data::InstallationResult SimulatedLink::putRoot(const std::string& root, bool director) {
+  if (!transfer(root.size())) {
+    return linkFailure();
+  }
+  return secondary_->putRoot(root, director);
+}
+
+data::InstallationResult SimulatedLink::putRootChain(const std::vector<std::string>& roots, bool director) {
+  uint64_t bytes = 0;
+  for (const auto& root : roots) {
+    bytes += root.size();
+  }
+  if (!transfer(bytes)) {
+    return linkFailure();
+  }
+  return secondary_->putRootChain(roots, director);
+}
+
+data::InstallationResult SimulatedLink::sendFirmware(const Uptane::Target& target,
+                                                     const api::FlowControlToken* flow_control) {
+  if (!transfer(target.length())) {
+    return linkFailure();
+  }
+  return secondary_->sendFirmware(target, flow_control);
+}
+
+data::InstallationResult SimulatedLink::install(const Uptane::Target& target,
+                                                const api::FlowControlToken* flow_control) {
+  if (!transfer(0)) {
+    return linkFailure();
+  }
+  return secondary_->install(target, flow_control);
+}
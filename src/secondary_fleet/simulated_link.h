@@ -0,0 +1,70 @@
+#ifndef SECONDARY_FLEET_SIMULATED_LINK_H_
+#define SECONDARY_FLEET_SIMULATED_LINK_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "libaktualizr/secondaryinterface.h"
+
+struct LinkConfig {
+  // Added to every call that goes over the link.
+  std::chrono::milliseconds latency{0};
+  // Bytes per second for firmware transfers, 0 for an unlimited link.
+  uint64_t bandwidth{0};
+  // Probability of a call failing, between 0 and 1.
+  double failure_rate{0.0};
+  unsigned int seed{0};
+};
+
+/**
+ * Puts a simulated link between the Primary and a Secondary: every call that
+ * would go over the wire is delayed by the latency of the link, firmware
+ * transfers by the time the link needs for the image, and calls fail at
+ * random at the configured rate. Failures look like the ones of an
+ * unreachable IP Secondary.
+ */
+class SimulatedLink : public SecondaryInterface {
+ public:
+  SimulatedLink(SecondaryInterface::Ptr secondary, LinkConfig config);
+
+  void init(std::shared_ptr<SecondaryProvider> secondary_provider_in) override {
+    secondary_->init(std::move(secondary_provider_in));
+  }
+  std::string Type() const override { return secondary_->Type(); }
+  Uptane::EcuSerial getSerial() const override { return secondary_->getSerial(); }
+  Uptane::HardwareIdentifier getHwId() const override { return secondary_->getHwId(); }
+  PublicKey getPublicKey() const override { return secondary_->getPublicKey(); }
+
+  Uptane::Manifest getManifest() const override;
+  data::InstallationResult putMetadata(const Uptane::Target& target) override;
+  bool ping() const override;
+  int32_t getRootVersion(bool director) const override;
+  data::InstallationResult putRoot(const std::string& root, bool director) override;
+  data::InstallationResult putRootChain(const std::vector<std::string>& roots, bool director) override;
+  data::InstallationResult sendFirmware(const Uptane::Target& target,
+                                        const api::FlowControlToken* flow_control) override;
+  data::InstallationResult install(const Uptane::Target& target, const api::FlowControlToken* flow_control) override;
+
+  /** Number of calls that have been made to fail. */
+  uint64_t failures() const { return failures_.load(); }
+  /** Time it takes the link to transfer `bytes`, latency included. */
+  std::chrono::microseconds transferTime(uint64_t bytes) const;
+
+ private:
+  // Waits for the link, returns false if the call is to fail.
+  bool transfer(uint64_t bytes) const;
+  static data::InstallationResult linkFailure();
+
+  SecondaryInterface::Ptr secondary_;
+  const LinkConfig config_;
+  mutable std::mutex rng_mutex_;
+  mutable std::mt19937 rng_;
+  mutable std::atomic<uint64_t> failures_{0};
+};
+
+#endif  // SECONDARY_FLEET_SIMULATED_LINK_H_
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "simulated_link.h"
+
+using std::chrono::milliseconds;
+
+class CountingSecondary : public SecondaryInterface {
+ public:
+  void init(std::shared_ptr<SecondaryProvider> secondary_provider_in) override { (void)secondary_provider_in; }
+  std::string Type() const override { return "counting"; }
+  Uptane::EcuSerial getSerial() const override { return Uptane::EcuSerial("counting"); }
+  Uptane::HardwareIdentifier getHwId() const override { return Uptane::HardwareIdentifier("counting-hw"); }
+  PublicKey getPublicKey() const override { return PublicKey("", KeyType::kUnknown); }
+  Uptane::Manifest getManifest() const override {
+    ++calls;
+    Json::Value manifest;
+    manifest["signed"]["ecu_serial"] = "counting";
+    return manifest;
+  }
+  data::InstallationResult putMetadata(const Uptane::Target& target) override {
+    (void)target;
+    return ok();
+  }
+  bool ping() const override {
+    ++calls;
+    return true;
+  }
+  int32_t getRootVersion(bool director) const override {
+    (void)director;
+    return 1;
+  }
+  data::InstallationResult putRoot(const std::string& root, bool director) override {
+    (void)root;
+    (void)director;
+    return ok();
+  }
+  data::InstallationResult sendFirmware(const Uptane::Target& target,
+                                        const api::FlowControlToken* flow_control) override {
+    (void)target;
+    (void)flow_control;
+    return ok();
+  }
+  data::InstallationResult install(const Uptane::Target& target, const api::FlowControlToken* flow_control) override {
+    (void)target;
+    (void)flow_control;
+    return ok();
+  }
+
+  mutable int calls{0};
+
+ private:
+  data::InstallationResult ok() const {
+    ++calls;
+    return data::InstallationResult(data::ResultCode::Numeric::kOk, "");
+  }
+};
+
+/* Every call is delayed by the latency, transfers by the bandwidth as well. */
+TEST(SimulatedLink, LatencyAndBandwidth) {
+  LinkConfig config;
+  config.latency = milliseconds(50);
+  config.bandwidth = 1000;
+  auto secondary = std::make_shared<CountingSecondary>();
+  SimulatedLink link(secondary, config);
+
+  EXPECT_EQ(link.transferTime(0), milliseconds(50));
+  EXPECT_EQ(link.transferTime(500), milliseconds(550));
+
+  const auto start = std::chrono::steady_clock::now();
+  EXPECT_TRUE(link.ping());
+  EXPECT_GE(std::chrono::steady_clock::now() - start, milliseconds(50));
+  EXPECT_EQ(secondary->calls, 1);
+  // Local calls don't go over the link.
+  EXPECT_EQ(link.getSerial(), secondary->getSerial());
+}
+
+/* Failing calls don't reach the Secondary. */
+TEST(SimulatedLink, Failures) {
+  LinkConfig config;
+  config.failure_rate = 1.0;
+  auto secondary = std::make_shared<CountingSecondary>();
+  SimulatedLink link(secondary, config);
+
+  EXPECT_FALSE(link.ping());
+  EXPECT_TRUE(link.getManifest().isNull());
+  EXPECT_EQ(link.getRootVersion(true), -1);
+  EXPECT_FALSE(link.putRoot("root", true).isSuccess());
+  EXPECT_EQ(secondary->calls, 0);
+  EXPECT_EQ(link.failures(), 4);
+
+  config.failure_rate = 0.0;
+  SimulatedLink reliable(secondary, config);
+  EXPECT_TRUE(reliable.ping());
+  EXPECT_FALSE(reliable.getManifest().isNull());
+  EXPECT_EQ(reliable.failures(), 0);
+}
+
+/* The failures depend only on the seed. */
+TEST(SimulatedLink, Reproducible) {
+  LinkConfig config;
+  config.failure_rate = 0.5;
+  config.seed = 42;
+  SimulatedLink link1(std::make_shared<CountingSecondary>(), config);
+  SimulatedLink link2(std::make_shared<CountingSecondary>(), config);
+
+  std::vector<bool> results1;
+  std::vector<bool> results2;
+  for (int i = 0; i < 100; ++i) {
+    results1.push_back(link1.ping());
+    results2.push_back(link2.ping());
+  }
+  EXPECT_EQ(results1, results2);
+  EXPECT_GT(link1.failures(), 10);
+  EXPECT_LT(link1.failures(), 90);
+}
+
+#ifndef __NO_MAIN__
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+#endif
@@ -24,7 +24,7 @@ static size_t writeString(void *contents, size_t size, size_t nmemb, void *userp
 }
 
 int CheckRefValid(TreehubServer &treehub, const std::string &ref, RunMode mode, int max_curl_requests,
-                  const boost::filesystem::path &tree_dir) {
+                  const boost::filesystem::path &tree_dir, PresenceCache *presence_cache) {
   // Check if the ref is present on treehub. The traditional use case is that it
   // should be a commit object, but we allow walking the tree given any OSTree
   // ref.
@@ -68,7 +68,7 @@ int CheckRefValid(TreehubServer &treehub, const std::string &ref, RunMode mode,
     OSTreeHash hash = OSTreeHash::Parse(ref);
     OSTreeObject::ptr input_object = dest_repo.GetObject(hash, type);
 
-    RequestPool request_pool(treehub, max_curl_requests, mode, false);
+    RequestPool request_pool(treehub, max_curl_requests, mode, false, presence_cache);
 
     // Add input object to the queue.
     request_pool.AddQuery(input_object);
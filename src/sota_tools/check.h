@@ -6,12 +6,15 @@
 #include "garage_common.h"
 #include "ostree_ref.h"
 #include "ostree_repo.h"
+#include "presence_cache.h"
 #include "server_credentials.h"
 
 /**
  * Check if the ref is present on the server and in targets.json
+ * \param presence_cache Objects known to be on the server, only used with
+ *                       RunMode::kWalkTree. May be null.
  */
 int CheckRefValid(TreehubServer& treehub, const std::string& ref, RunMode mode, int max_curl_requests,
-                  const boost::filesystem::path& tree_dir = "");
+                  const boost::filesystem::path& tree_dir = "", PresenceCache* presence_cache = nullptr);
 
 #endif
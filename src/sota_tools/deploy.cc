@@ -24,7 +24,8 @@ bool CheckPoolState(const OSTreeObject::ptr &root_object, const RequestPool &req
 }
 
 bool UploadToTreehub(const OSTreeRepo::ptr &src_repo, TreehubServer &push_server, const OSTreeHash &ostree_commit,
-                     const RunMode mode, const int max_curl_requests, const bool fsck_on_upload) {
+                     const RunMode mode, const int max_curl_requests, const bool fsck_on_upload,
+                     PresenceCache *presence_cache, PushJournal *journal, const uintmax_t bundle_size) {
   assert(max_curl_requests > 0);
 
   OSTreeObject::ptr root_object;
@@ -35,7 +36,7 @@ bool UploadToTreehub(const OSTreeRepo::ptr &src_repo, TreehubServer &push_server
     return false;
   }
 
-  RequestPool request_pool(push_server, max_curl_requests, mode, fsck_on_upload);
+  RequestPool request_pool(push_server, max_curl_requests, mode, fsck_on_upload, presence_cache, journal, bundle_size);
 
   // Add commit object to the queue.
   request_pool.AddQuery(root_object);
@@ -50,8 +51,17 @@ bool UploadToTreehub(const OSTreeRepo::ptr &src_repo, TreehubServer &push_server
 
   if (root_object->is_on_server() == PresenceOnServer::kObjectPresent) {
     if (mode == RunMode::kDefault || mode == RunMode::kPushTree) {
-      LOG_INFO << "Upload to Treehub complete after " << request_pool.head_requests_made() << " HEAD requests and "
-               << request_pool.put_requests_made() << " PUT requests.";
+      LOG_INFO << "Upload to Treehub complete after " << request_pool.head_requests_made() << " HEAD requests, "
+               << request_pool.batch_requests_made() << " batched presence queries, "
+               << request_pool.put_requests_made() << " PUT requests and " << request_pool.bundle_requests_made()
+               << " bundle uploads.";
+      if (presence_cache != nullptr) {
+        LOG_INFO << request_pool.cache_hits() << " objects were known to be present from the presence cache.";
+      }
+      if (journal != nullptr) {
+        LOG_INFO << request_pool.journal_hits() << " objects were confirmed by an earlier attempt of this push.";
+        journal->Finish();
+      }
       LOG_INFO << "Total size of uploaded objects: " << request_pool.total_object_size() << " bytes.";
     } else {
       LOG_INFO << "Dry run. No objects uploaded.";
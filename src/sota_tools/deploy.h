@@ -6,6 +6,8 @@
 #include "garage_common.h"
 #include "ostree_ref.h"
 #include "ostree_repo.h"
+#include "presence_cache.h"
+#include "push_journal.h"
 #include "server_credentials.h"
 
 /*
@@ -26,9 +28,18 @@ bool CheckPoolState(const OSTreeObject::ptr& root_object, const RequestPool& req
  * \param mode
  * \param max_curl_requests
  * \param fsck_on_upload Validate objects on disk before uploading them
+ * \param presence_cache Objects known to be on push_server, which are neither
+ *                       checked nor uploaded. May be null.
+ * \param journal Journal of this push, used to resume it where an earlier
+ *                attempt stopped. Finished when the upload is complete. May
+ *                be null.
+ * \param bundle_size Upload missing objects in bundles of about this many
+ *                    bytes, rather than one by one. 0 disables bundles.
  */
 bool UploadToTreehub(const OSTreeRepo::ptr& src_repo, TreehubServer& push_server, const OSTreeHash& ostree_commit,
-                     RunMode mode, int max_curl_requests, bool fsck_on_upload);
+                     RunMode mode, int max_curl_requests, bool fsck_on_upload,
+                     PresenceCache* presence_cache = nullptr, PushJournal* journal = nullptr,
+                     uintmax_t bundle_size = 0);
 
 /**
  * Use the garage-sign tool and the Image repo targets.json keys in credentials.zip
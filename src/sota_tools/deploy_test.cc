@@ -9,6 +9,7 @@
 #include "ostree_dir_repo.h"
 #include "ostree_http_repo.h"
 #include "ostree_ref.h"
+#include "request_pool.h"
 #include "test_utils.h"
 
 std::string port = "2443";
@@ -43,6 +44,76 @@ TEST(deploy, UploadToTreehub) {
   EXPECT_EQ(result, 0) << "Diff between the source repo refs and the destination repos refs is nonzero.";
 }
 
+/* Check the presence of the pushed objects with batched queries instead of a HEAD
+ * request per object. */
+TEST(deploy, BatchPresenceQuery) {
+  OSTreeRepo::ptr src_repo = std::make_shared<OSTreeDirRepo>("tests/sota_tools/repo");
+  boost::filesystem::path filepath = (temp_dir.Path() / "auth.json").string();
+  boost::filesystem::path cert_path = "tests/fake_http_server/server.crt";
+  TreehubServer push_server;
+  EXPECT_EQ(authenticate(cert_path.string(), ServerCredentials(filepath), push_server), EXIT_SUCCESS);
+
+  OSTreeObject::ptr root_object =
+      src_repo->GetObject(src_repo->GetRef("master").GetHash(), OstreeObjectType::OSTREE_OBJECT_TYPE_COMMIT);
+  RequestPool request_pool(push_server, 2, RunMode::kWalkTree, false);
+  request_pool.AddQuery(root_object);
+  do {
+    request_pool.Loop();
+  } while (!request_pool.is_idle() && !request_pool.is_stopped());
+
+  EXPECT_EQ(root_object->is_on_server(), PresenceOnServer::kObjectPresent);
+  // The commit and the only file are checked on their own, the dirtree and
+  // dirmeta below the commit in one batch.
+  EXPECT_EQ(request_pool.head_requests_made(), 2);
+  EXPECT_EQ(request_pool.batch_requests_made(), 1);
+}
+
+/* Upload the objects missing on a new server in bundles, or one by one if the
+ * server doesn't support bundles. */
+static void UploadInBundles(bool server_supports_bundles) {
+  TemporaryDirectory server_dir;
+  const std::string server_port = TestUtils::getFreePort();
+  std::vector<std::string> server_args{"-p", server_port, "-d", server_dir.PathString(), "--tls"};
+  if (!server_supports_bundles) {
+    server_args.emplace_back("--no-bundle");
+  }
+  boost::process::child server_process("tests/sota_tools/treehub_server.py", boost::process::args(server_args));
+  TestUtils::waitForServer("https://localhost:" + server_port + "/");
+
+  TemporaryFile auth_file("auth.json");
+  Json::Value auth;
+  auth["ostree"]["server"] = std::string("https://localhost:") + server_port;
+  Utils::writeFile(auth_file.Path(), auth);
+  TreehubServer push_server;
+  EXPECT_EQ(authenticate("tests/fake_http_server/server.crt", ServerCredentials(auth_file.Path()), push_server),
+            EXIT_SUCCESS);
+
+  OSTreeRepo::ptr src_repo = std::make_shared<OSTreeDirRepo>("tests/sota_tools/repo");
+  OSTreeObject::ptr root_object =
+      src_repo->GetObject(src_repo->GetRef("master").GetHash(), OstreeObjectType::OSTREE_OBJECT_TYPE_COMMIT);
+  RequestPool request_pool(push_server, 2, RunMode::kDefault, true, nullptr, nullptr, 1024 * 1024);
+  request_pool.AddQuery(root_object);
+  do {
+    request_pool.Loop();
+  } while (root_object->is_on_server() != PresenceOnServer::kObjectPresent && !request_pool.is_stopped());
+
+  EXPECT_EQ(root_object->is_on_server(), PresenceOnServer::kObjectPresent);
+  const std::string diff = "diff -r " + (server_dir.Path() / "objects/").string() + " tests/sota_tools/repo/objects/";
+  int result = system(diff.c_str());
+  EXPECT_EQ(result, 0) << "Diff between the source repo objects and the destination repo objects is nonzero.";
+  if (server_supports_bundles) {
+    EXPECT_GT(request_pool.bundle_requests_made(), 0);
+    EXPECT_EQ(request_pool.put_requests_made(), 0);
+  } else {
+    EXPECT_EQ(request_pool.bundle_requests_made(), 1);
+    EXPECT_EQ(request_pool.put_requests_made(), 4);
+  }
+}
+
+TEST(deploy, BundleUpload) { UploadInBundles(true); }
+
+TEST(deploy, BundleFallback) { UploadInBundles(false); }
+
 #ifndef __NO_MAIN__
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
@@ -1,3 +1,4 @@
+#include <memory>
 #include <string>
 
 #include <curl/curl.h>
@@ -12,6 +13,7 @@
 #include "logging/logging.h"
 #include "ostree_http_repo.h"
 #include "ostree_object.h"
+#include "presence_cache.h"
 #include "request_pool.h"
 #include "treehub_server.h"
 #include "utilities/utils.h"
@@ -25,6 +27,9 @@ int main(int argc, char **argv) {
   boost::filesystem::path credentials_path;
   std::string cacerts;
   int max_curl_requests;
+  boost::filesystem::path presence_cache_dir;
+  int64_t presence_cache_ttl;
+  unsigned int verify_cache;
   RunMode mode = RunMode::kDefault;
   boost::filesystem::path tree_dir;
   po::options_description desc("garage-check command line options");
@@ -40,7 +45,10 @@ int main(int argc, char **argv) {
     ("cacert", po::value<std::string>(&cacerts), "override path to CA root certificates, in the same format as curl --cacert")
     ("jobs", po::value<int>(&max_curl_requests)->default_value(30), "maximum number of parallel requests (only relevant with --walk-tree)")
     ("walk-tree,w", "walk entire tree and check presence of all objects")
-    ("tree-dir,t", po::value<boost::filesystem::path>(&tree_dir), "directory to which to write the tree (only used with --walk-tree)");
+    ("tree-dir,t", po::value<boost::filesystem::path>(&tree_dir), "directory to which to write the tree (only used with --walk-tree)")
+    ("presence-cache", po::value<boost::filesystem::path>(&presence_cache_dir), "directory in which to remember the objects found on the server, to skip checking them again on later runs (only used with --walk-tree)")
+    ("presence-cache-ttl", po::value<int64_t>(&presence_cache_ttl)->default_value(168), "hours after which objects in the presence cache are checked again")
+    ("verify-cache", po::value<unsigned int>(&verify_cache)->default_value(0)->implicit_value(10), "check this percentage of the objects found in the presence cache with the server anyway (10 if not given)");
   // clang-format on
 
   po::variables_map vm;
@@ -89,13 +97,23 @@ int main(int argc, char **argv) {
       return EXIT_FAILURE;
     }
 
+    if (verify_cache > 100) {
+      LOG_FATAL << "--verify-cache must be a percentage";
+      return EXIT_FAILURE;
+    }
+
     TreehubServer treehub;
     if (authenticate(cacerts, ServerCredentials(credentials_path), treehub) != EXIT_SUCCESS) {
       LOG_FATAL << "Authentication failed";
       return EXIT_FAILURE;
     }
 
-    if (CheckRefValid(treehub, ref, mode, max_curl_requests, tree_dir) != EXIT_SUCCESS) {
+    std::unique_ptr<PresenceCache> presence_cache;
+    if (!presence_cache_dir.empty()) {
+      presence_cache = std_::make_unique<PresenceCache>(presence_cache_dir, treehub.root_url(),
+                                                        std::chrono::hours(presence_cache_ttl), verify_cache);
+    }
+    if (CheckRefValid(treehub, ref, mode, max_curl_requests, tree_dir, presence_cache.get()) != EXIT_SUCCESS) {
       LOG_FATAL << "Check if the ref is present on the server or in targets.json failed";
       return EXIT_FAILURE;
     }
@@ -110,13 +110,12 @@ int main(int argc, char **argv) {
     return EXIT_FAILURE;
   }
 
-  OSTreeRepo::ptr src_repo = std::make_shared<OSTreeHttpRepo>(&fetch_server);
+  OSTreeRepo::ptr src_repo = std::make_shared<OSTreeHttpRepo>(&fetch_server, "", max_curl_requests);
   try {
     OSTreeHash commit(OSTreeHash::Parse(ostree_commit));
     bool fsck = vm.count("disable-integrity-checks") == 0;
-    // Since the fetches happen on a single thread in OSTreeHttpRepo, there
-    // isn't much reason to upload in parallel, but why hold the system back if
-    // the fetching is faster than the uploading?
+    // OSTreeHttpRepo fetches the children of each directory in parallel, as
+    // soon as the directory turns out to be missing on the push server.
     if (!UploadToTreehub(src_repo, push_server, commit, mode, max_curl_requests, fsck)) {
       LOG_FATAL << "Upload to treehub failed";
       return EXIT_FAILURE;
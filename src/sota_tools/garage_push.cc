@@ -1,3 +1,4 @@
+#include <memory>
 #include <string>
 
 #include <boost/filesystem.hpp>
@@ -10,6 +11,8 @@
 #include "logging/logging.h"
 #include "ostree_dir_repo.h"
 #include "ostree_repo.h"
+#include "presence_cache.h"
+#include "push_journal.h"
 #include "utilities/xml2json.h"
 
 namespace po = boost::program_options;
@@ -23,6 +26,11 @@ int main(int argc, char **argv) {
   std::string cacerts;
   boost::filesystem::path manifest_path;
   int max_curl_requests;
+  boost::filesystem::path presence_cache_dir;
+  int64_t presence_cache_ttl;
+  unsigned int verify_cache;
+  boost::filesystem::path journal_dir;
+  uintmax_t bundle_size_mb;
   RunMode mode = RunMode::kDefault;
   po::options_description desc("garage-push command line options");
   // clang-format off
@@ -40,7 +48,12 @@ int main(int argc, char **argv) {
     ("jobs", po::value<int>(&max_curl_requests)->default_value(30), "maximum number of parallel requests")
     ("dry-run,n", "check arguments and authenticate but don't upload")
     ("walk-tree,w", "walk entire tree and upload all missing objects")
-    ("disable-integrity-checks", "Don't validate the checksums of objects before uploading them");
+    ("disable-integrity-checks", "Don't validate the checksums of objects before uploading them")
+    ("presence-cache", po::value<boost::filesystem::path>(&presence_cache_dir), "directory in which to remember the objects found on the server, to skip checking them again on later runs")
+    ("presence-cache-ttl", po::value<int64_t>(&presence_cache_ttl)->default_value(168), "hours after which objects in the presence cache are checked again")
+    ("verify-cache", po::value<unsigned int>(&verify_cache)->default_value(0)->implicit_value(10), "check this percentage of the objects found in the presence cache with the server anyway (10 if not given)")
+    ("journal", po::value<boost::filesystem::path>(&journal_dir), "directory in which to record the progress of the push, so that an interrupted push resumes where it stopped")
+    ("bundle-size", po::value<uintmax_t>(&bundle_size_mb)->default_value(0)->implicit_value(64), "upload missing objects in bundles of about this many MiB instead of one by one, if the server supports it (64 if not given)");
   // clang-format on
 
   po::variables_map vm;
@@ -108,6 +121,11 @@ int main(int argc, char **argv) {
     return EXIT_FAILURE;
   }
 
+  if (verify_cache > 100) {
+    LOG_FATAL << "--verify-cache must be a percentage";
+    return EXIT_FAILURE;
+  }
+
   OSTreeRepo::ptr src_repo = std::make_shared<OSTreeDirRepo>(repo_path);
   if (!src_repo->LooksValid()) {
     LOG_FATAL << "The OSTree src repository does not appear to contain a valid OSTree repository";
@@ -137,7 +155,17 @@ int main(int argc, char **argv) {
       return EXIT_FAILURE;
     }
     bool fsck = vm.count("disable-integrity-checks") == 0;
-    if (!UploadToTreehub(src_repo, push_server, *commit, mode, max_curl_requests, fsck)) {
+    std::unique_ptr<PresenceCache> presence_cache;
+    if (!presence_cache_dir.empty()) {
+      presence_cache = std_::make_unique<PresenceCache>(presence_cache_dir, push_server.root_url(),
+                                                        std::chrono::hours(presence_cache_ttl), verify_cache);
+    }
+    std::unique_ptr<PushJournal> journal;
+    if (!journal_dir.empty()) {
+      journal = std_::make_unique<PushJournal>(journal_dir, push_server.root_url(), *commit);
+    }
+    if (!UploadToTreehub(src_repo, push_server, *commit, mode, max_curl_requests, fsck, presence_cache.get(),
+                         journal.get(), bundle_size_mb * 1024 * 1024)) {
       LOG_FATAL << "Upload to treehub failed";
       return EXIT_FAILURE;
     }
@@ -0,0 +1,104 @@
+#include "object_bundle.h"
+
+#include <archive.h>
+#include <archive_entry.h>
+#include <sys/stat.h>
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <boost/algorithm/string/case_conv.hpp>
+#include <boost/filesystem.hpp>
+
+#include "crypto/crypto.h"
+#include "ostree_repo.h"
+
+namespace {
+struct ArchiveOutput {
+  FILE* file;
+  MultiPartSHA256Hasher hasher;
+  uintmax_t written;
+};
+
+// Hash the archive on its way to the disk, rather than reading it again
+// afterwards.
+ssize_t WriteArchive(struct archive* a, void* client_data, const void* buffer, size_t length) {
+  auto* out = static_cast<ArchiveOutput*>(client_data);
+  if (fwrite(buffer, 1, length, out->file) != length) {
+    archive_set_error(a, errno, "unable to write bundle: %s", std::strerror(errno));
+    return -1;
+  }
+  out->hasher.update(static_cast<const unsigned char*>(buffer), length);
+  out->written += length;
+  return static_cast<ssize_t>(length);
+}
+}  // namespace
+
+ObjectBundle::~ObjectBundle() {
+  if (file_ != nullptr) {
+    fclose(file_);
+  }
+}
+
+void ObjectBundle::Add(const OSTreeObject::ptr& object) {
+  objects_.push_back(object);
+  size_ += object->GetSize();
+}
+
+void ObjectBundle::Write() {
+  ArchiveOutput out{fopen(archive_.Path().c_str(), "wb"), {}, 0};
+  if (out.file == nullptr) {
+    throw std::runtime_error("Could not create bundle " + archive_.PathString() + ": " + std::strerror(errno));
+  }
+  StructGuardInt<FILE> file_guard(out.file, fclose);
+
+  StructGuardInt<struct archive> a(archive_write_new(), archive_write_free);
+  if (a == nullptr) {
+    throw std::runtime_error("Could not initialize archive object");
+  }
+  archive_write_set_format_ustar(a.get());
+  if (archive_write_open(a.get(), &out, nullptr, WriteArchive, nullptr) != ARCHIVE_OK) {
+    throw std::runtime_error(std::string("Could not open bundle: ") + archive_error_string(a.get()));
+  }
+
+  StructGuard<struct archive_entry> entry(archive_entry_new(), archive_entry_free);
+  std::array<char, 65536> buffer{};
+  for (const auto& object : objects_) {
+    const boost::filesystem::path path = object->PathOnDisk();
+    std::ifstream in(path.string(), std::ios::binary);
+    if (!in) {
+      throw std::runtime_error("Could not open " + path.string());
+    }
+    archive_entry_clear(entry.get());
+    archive_entry_set_pathname(entry.get(), OSTreeRepo::GetPathForHash(object->hash(), object->type()).c_str());
+    archive_entry_set_filetype(entry.get(), AE_IFREG);
+    archive_entry_set_perm(entry.get(), S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    archive_entry_set_size(entry.get(), static_cast<int64_t>(boost::filesystem::file_size(path)));
+    if (archive_write_header(a.get(), entry.get()) != ARCHIVE_OK) {
+      throw std::runtime_error(std::string("Could not add object to bundle: ") + archive_error_string(a.get()));
+    }
+    while (in.read(buffer.data(), buffer.size()) || in.gcount() > 0) {
+      if (archive_write_data(a.get(), buffer.data(), static_cast<size_t>(in.gcount())) < 0) {
+        throw std::runtime_error(std::string("Could not add object to bundle: ") + archive_error_string(a.get()));
+      }
+    }
+  }
+  if (archive_write_close(a.get()) != ARCHIVE_OK) {
+    throw std::runtime_error(std::string("Could not write bundle: ") + archive_error_string(a.get()));
+  }
+  if (fflush(out.file) != 0) {
+    throw std::runtime_error("Could not write bundle " + archive_.PathString() + ": " + std::strerror(errno));
+  }
+
+  archive_size_ = out.written;
+  sha256_ = boost::algorithm::to_lower_copy(out.hasher.getHexDigest());
+  file_ = fopen(archive_.Path().c_str(), "rb");
+  if (file_ == nullptr) {
+    throw std::runtime_error("Could not open bundle " + archive_.PathString() + ": " + std::strerror(errno));
+  }
+}
+
+// vim: set tabstop=2 shiftwidth=2 expandtab:
@@ -0,0 +1,50 @@
+#ifndef SOTA_CLIENT_TOOLS_OBJECT_BUNDLE_H_
+#define SOTA_CLIENT_TOOLS_OBJECT_BUNDLE_H_
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "ostree_object.h"
+#include "utilities/utils.h"
+
+/**
+ * A tar archive of objects, so that many small objects can be uploaded in a
+ * single request instead of one request each. Every object is stored under
+ * its path relative to objects/, in the order in which it was added.
+ *
+ * The archive is written to a temporary file and streamed to the server from
+ * there. Its SHA256 is sent along, so that the server can check that the
+ * bundle arrived intact before storing any of its objects.
+ */
+class ObjectBundle {
+ public:
+  ObjectBundle() = default;
+  ~ObjectBundle();
+  ObjectBundle(const ObjectBundle&) = delete;
+  ObjectBundle(ObjectBundle&&) = delete;
+  ObjectBundle& operator=(const ObjectBundle&) = delete;
+  ObjectBundle& operator=(ObjectBundle&&) = delete;
+
+  void Add(const OSTreeObject::ptr& object);
+  const std::vector<OSTreeObject::ptr>& objects() const { return objects_; }
+  /** Total size of the objects in the bundle. */
+  uintmax_t size() const { return size_; }
+
+  /** Write the archive. Afterwards file() is open for reading it. */
+  void Write();
+  FILE* file() const { return file_; }
+  uintmax_t archive_size() const { return archive_size_; }
+  const std::string& sha256() const { return sha256_; }
+
+ private:
+  std::vector<OSTreeObject::ptr> objects_;
+  uintmax_t size_{0};
+  TemporaryFile archive_{"bundle"};
+  FILE* file_{nullptr};
+  uintmax_t archive_size_{0};
+  std::string sha256_;
+};
+
+// vim: set tabstop=2 shiftwidth=2 expandtab:
+#endif  // SOTA_CLIENT_TOOLS_OBJECT_BUNDLE_H_
@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+
+#include <archive.h>
+#include <archive_entry.h>
+
+#include <array>
+#include <map>
+#include <string>
+
+#include <boost/algorithm/string/case_conv.hpp>
+
+#include "crypto/crypto.h"
+#include "object_bundle.h"
+#include "ostree_dir_repo.h"
+#include "utilities/utils.h"
+
+/* The bundle holds the objects under their path in the repo, and its SHA256 matches. */
+TEST(ObjectBundle, Write) {
+  OSTreeDirRepo repo("tests/sota_tools/repo");
+  ObjectBundle bundle;
+  bundle.Add(repo.GetObject(OSTreeHash::Parse("a1f4f81612ce959883f58e83789f6c7d97b0b55b801b2a09955235f40b0f2dfb"),
+                            OstreeObjectType::OSTREE_OBJECT_TYPE_FILE));
+  bundle.Add(repo.GetObject(OSTreeHash::Parse("2a28dac42b76c2015ee3c41cc4183bb8b5c790fd21fa5cfa0802c6e11fd0edbe"),
+                            OstreeObjectType::OSTREE_OBJECT_TYPE_DIR_META));
+  EXPECT_EQ(bundle.objects().size(), 2);
+  EXPECT_EQ(bundle.size(), bundle.objects()[0]->GetSize() + bundle.objects()[1]->GetSize());
+
+  bundle.Write();
+  ASSERT_NE(bundle.file(), nullptr);
+  std::string contents;
+  std::array<char, 4096> buffer{};
+  size_t n;
+  while ((n = fread(buffer.data(), 1, buffer.size(), bundle.file())) > 0) {
+    contents.append(buffer.data(), n);
+  }
+  EXPECT_EQ(contents.size(), bundle.archive_size());
+  EXPECT_EQ(bundle.sha256(), boost::algorithm::to_lower_copy(Crypto::sha256digestHex(contents)));
+
+  std::map<std::string, std::string> members;
+  StructGuardInt<struct archive> a(archive_read_new(), archive_read_free);
+  archive_read_support_format_all(a.get());
+  ASSERT_EQ(archive_read_open_memory(a.get(), contents.data(), contents.size()), ARCHIVE_OK);
+  struct archive_entry *entry;
+  while (archive_read_next_header(a.get(), &entry) == ARCHIVE_OK) {
+    std::string data(static_cast<size_t>(archive_entry_size(entry)), '\0');
+    EXPECT_EQ(archive_read_data(a.get(), &data[0], data.size()), static_cast<ssize_t>(data.size()));
+    members[archive_entry_pathname(entry)] = data;
+  }
+  EXPECT_EQ(members.size(), 2);
+  for (const auto &object : bundle.objects()) {
+    const std::string path = OSTreeRepo::GetPathForHash(object->hash(), object->type()).string();
+    EXPECT_EQ(members[path], Utils::readFile(object->PathOnDisk())) << path;
+  }
+}
+
+#ifndef __NO_MAIN__
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+#endif
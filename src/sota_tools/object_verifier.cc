@@ -0,0 +1,123 @@
+#include "object_verifier.h"
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "logging/logging.h"
+
+ObjectVerifier::ObjectVerifier(const unsigned int threads)
+    : max_in_flight_(2 * static_cast<size_t>(std::max(threads, 1U))) {
+  event_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (event_fd_ < 0) {
+    throw std::runtime_error(std::string("eventfd failed with error: ") + std::strerror(errno));
+  }
+  for (unsigned int i = 0; i < std::max(threads, 1U); ++i) {
+    workers_.emplace_back([this] { Run(); });
+  }
+}
+
+ObjectVerifier::~ObjectVerifier() {
+  {
+    std::lock_guard<std::mutex> lock(m_);
+    stop_ = true;
+    work_.clear();
+  }
+  cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+  close(event_fd_);
+}
+
+void ObjectVerifier::Add(const OSTreeObject::ptr& object) {
+  waiting_.push_back(object);
+  Feed();
+}
+
+void ObjectVerifier::Feed() {
+  while (in_flight_.size() < max_in_flight_ && !waiting_.empty()) {
+    OSTreeObject::ptr object = waiting_.front();
+    waiting_.pop_front();
+    in_flight_.emplace(object.get(), object);
+    {
+      std::lock_guard<std::mutex> lock(m_);
+      work_.push_back(object.get());
+    }
+    cv_.notify_one();
+  }
+}
+
+std::vector<std::pair<OSTreeObject::ptr, bool>> ObjectVerifier::Collect() {
+  uint64_t count;
+  if (read(event_fd_, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+    LOG_WARNING << "Reading the verifier's eventfd failed: " << std::strerror(errno);
+  }
+
+  std::vector<std::pair<const OSTreeObject*, bool>> done;
+  {
+    std::lock_guard<std::mutex> lock(m_);
+    done.swap(done_);
+  }
+  std::vector<std::pair<OSTreeObject::ptr, bool>> results;
+  for (const auto& result : done) {
+    // The same object can be added more than once, e.g. when it is shared in
+    // the ObjectTable. Every copy has its own entry and yields its own result.
+    auto it = in_flight_.find(result.first);
+    assert(it != in_flight_.end());
+    results.emplace_back(it->second, result.second);
+    in_flight_.erase(it);
+  }
+  Feed();
+  return results;
+}
+
+void ObjectVerifier::Clear() {
+  waiting_.clear();
+  std::lock_guard<std::mutex> lock(m_);
+  if (work_.empty()) {
+    return;
+  }
+  // Objects that no worker has picked up yet count as failed, the caller is
+  // not interested in them anymore anyway.
+  for (const OSTreeObject* object : work_) {
+    done_.emplace_back(object, false);
+  }
+  work_.clear();
+  const uint64_t one = 1;
+  if (write(event_fd_, &one, sizeof(one)) < 0) {
+    LOG_WARNING << "Writing the verifier's eventfd failed: " << std::strerror(errno);
+  }
+}
+
+void ObjectVerifier::Run() {
+  for (;;) {
+    const OSTreeObject* object;
+    {
+      std::unique_lock<std::mutex> lock(m_);
+      cv_.wait(lock, [this] { return stop_ || !work_.empty(); });
+      if (stop_) {
+        return;
+      }
+      object = work_.front();
+      work_.pop_front();
+    }
+    const bool ok = object->Fsck();
+    {
+      std::lock_guard<std::mutex> lock(m_);
+      done_.emplace_back(object, ok);
+    }
+    const uint64_t one = 1;
+    if (write(event_fd_, &one, sizeof(one)) < 0) {
+      LOG_WARNING << "Writing the verifier's eventfd failed: " << std::strerror(errno);
+    }
+  }
+}
+
+// vim: set tabstop=2 shiftwidth=2 expandtab:
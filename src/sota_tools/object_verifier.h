@@ -0,0 +1,62 @@
+#ifndef SOTA_CLIENT_TOOLS_OBJECT_VERIFIER_H_
+#define SOTA_CLIENT_TOOLS_OBJECT_VERIFIER_H_
+
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "ostree_object.h"
+
+/**
+ * Verifies objects with OSTreeObject::Fsck() on a pool of worker threads, so
+ * that hashing large objects doesn't hold up the network I/O of the
+ * RequestPool.
+ *
+ * Only the thread that created the verifier may call its methods. The
+ * reference counts of OSTreeObject are not thread-safe, so the workers only
+ * see plain pointers and the verifier holds on to the objects meanwhile. At
+ * most a few objects per worker are handed out at a time, the others wait in
+ * line.
+ */
+class ObjectVerifier {
+ public:
+  explicit ObjectVerifier(unsigned int threads);
+  ~ObjectVerifier();
+  ObjectVerifier(const ObjectVerifier&) = delete;
+  ObjectVerifier(ObjectVerifier&&) = delete;
+  ObjectVerifier& operator=(const ObjectVerifier&) = delete;
+  ObjectVerifier& operator=(ObjectVerifier&&) = delete;
+
+  void Add(const OSTreeObject::ptr& object);
+  /** Take the objects verified so far, with the result of their check. */
+  std::vector<std::pair<OSTreeObject::ptr, bool>> Collect();
+  /** Drop the objects that are waiting. Objects being checked are still returned by Collect(). */
+  void Clear();
+  bool is_idle() const { return waiting_.empty() && in_flight_.empty(); }
+  /** Becomes readable when there are results to collect. */
+  int fd() const { return event_fd_; }
+
+ private:
+  void Feed();
+  void Run();
+
+  const size_t max_in_flight_;
+  int event_fd_;
+  std::list<OSTreeObject::ptr> waiting_;
+  std::multimap<const OSTreeObject*, OSTreeObject::ptr> in_flight_;
+
+  std::mutex m_;
+  std::condition_variable cv_;
+  std::deque<const OSTreeObject*> work_;                   // guarded by m_
+  std::vector<std::pair<const OSTreeObject*, bool>> done_;  // guarded by m_
+  bool stop_{false};                                        // guarded by m_
+  std::vector<std::thread> workers_;
+};
+
+// vim: set tabstop=2 shiftwidth=2 expandtab:
+#endif  // SOTA_CLIENT_TOOLS_OBJECT_VERIFIER_H_
@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include <poll.h>
+
+#include "object_verifier.h"
+#include "ostree_dir_repo.h"
+
+/* Objects are checked on the worker threads and come back with the result of their check. */
+TEST(ObjectVerifier, Verify) {
+  OSTreeDirRepo repo("tests/sota_tools/corrupt-repo");
+  auto good_object =
+      repo.GetObject(OSTreeHash::Parse("2ee758031340b51db1c0229bddd8f64bca4b131728d2bfb20c0c8671b1259a38"),
+                     OstreeObjectType::OSTREE_OBJECT_TYPE_FILE);
+  auto corrupt_object =
+      repo.GetObject(OSTreeHash::Parse("4145b1a9bade30efb28ff921f7a555ff82ba7d3b7b83b968084436167912fa83"),
+                     OstreeObjectType::OSTREE_OBJECT_TYPE_FILE);
+
+  ObjectVerifier verifier(1);
+  verifier.Add(good_object);
+  verifier.Add(corrupt_object);
+  verifier.Add(good_object);
+  EXPECT_FALSE(verifier.is_idle());
+
+  std::map<OSTreeObject::ptr, std::vector<bool>> results;
+  while (!verifier.is_idle()) {
+    struct pollfd pfd {};
+    pfd.fd = verifier.fd();
+    pfd.events = POLLIN;
+    ASSERT_EQ(poll(&pfd, 1, 10000), 1);
+    for (const auto& result : verifier.Collect()) {
+      results[result.first].push_back(result.second);
+    }
+  }
+  EXPECT_EQ(results[good_object], std::vector<bool>({true, true}));
+  EXPECT_EQ(results[corrupt_object], std::vector<bool>({false}));
+}
+
+/* An object that is added several times yields one result per time. */
+TEST(ObjectVerifier, Duplicates) {
+  OSTreeDirRepo repo("tests/sota_tools/corrupt-repo");
+  auto object = repo.GetObject(OSTreeHash::Parse("2ee758031340b51db1c0229bddd8f64bca4b131728d2bfb20c0c8671b1259a38"),
+                               OstreeObjectType::OSTREE_OBJECT_TYPE_FILE);
+
+  ObjectVerifier verifier(2);
+  for (int i = 0; i < 10; ++i) {
+    verifier.Add(object);
+  }
+
+  size_t returned = 0;
+  while (!verifier.is_idle()) {
+    struct pollfd pfd {};
+    pfd.fd = verifier.fd();
+    pfd.events = POLLIN;
+    ASSERT_EQ(poll(&pfd, 1, 10000), 1);
+    for (const auto& result : verifier.Collect()) {
+      EXPECT_EQ(result.first, object);
+      EXPECT_TRUE(result.second);
+      ++returned;
+    }
+  }
+  EXPECT_EQ(returned, 10);
+}
+
+/* Objects that are waiting are dropped by Clear(). */
+TEST(ObjectVerifier, Clear) {
+  OSTreeDirRepo repo("tests/sota_tools/corrupt-repo");
+  auto object = repo.GetObject(OSTreeHash::Parse("2ee758031340b51db1c0229bddd8f64bca4b131728d2bfb20c0c8671b1259a38"),
+                               OstreeObjectType::OSTREE_OBJECT_TYPE_FILE);
+
+  ObjectVerifier verifier(1);
+  for (int i = 0; i < 10; ++i) {
+    verifier.Add(object);
+  }
+  verifier.Clear();
+
+  size_t returned = 0;
+  while (!verifier.is_idle()) {
+    struct pollfd pfd {};
+    pfd.fd = verifier.fd();
+    pfd.events = POLLIN;
+    ASSERT_EQ(poll(&pfd, 1, 10000), 1);
+    returned += verifier.Collect().size();
+  }
+  // Only the objects that had been handed to the worker are returned.
+  EXPECT_LE(returned, 2);
+}
+
+#ifndef __NO_MAIN__
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+#endif
+
+// vim: set tabstop=2 shiftwidth=2 expandtab:
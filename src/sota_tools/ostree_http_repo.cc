@@ -1,6 +1,8 @@
 #include "ostree_http_repo.h"
 
 #include <fcntl.h>
+#include <map>
+#include <memory>
 #include <string>
 
 #include <boost/filesystem.hpp>
@@ -33,12 +35,102 @@ bool OSTreeHttpRepo::LooksValid() const {
 
 OSTreeRef OSTreeHttpRepo::GetRef(const std::string &refname) const { return OSTreeRef(*server_, refname); }
 
+void OSTreeHttpRepo::Prefetch(const std::vector<std::pair<OSTreeHash, OstreeObjectType>> &objects) const {
+  struct Transfer {
+    boost::filesystem::path path;
+    boost::filesystem::path part_path;
+    int fd{-1};
+    CURL *handle{nullptr};
+  };
+  std::map<CURL *, std::unique_ptr<Transfer>> transfers;
+
+  auto next = objects.cbegin();
+  while (next != objects.cend() || !transfers.empty()) {
+    // Keep max_fetches_ downloads going
+    for (; next != objects.cend() && transfers.size() < static_cast<size_t>(max_fetches_); ++next) {
+      boost::filesystem::path path("objects");
+      path /= GetPathForHash(next->first, next->second);
+      if (ObjectTable.count(next->first) != 0 || prefetched_.count(path) != 0) {
+        continue;
+      }
+      auto transfer = std_::make_unique<Transfer>();
+      transfer->path = path;
+      // Partial downloads must not be taken for objects
+      transfer->part_path = root_ / path;
+      transfer->part_path += ".part";
+      boost::filesystem::create_directories(transfer->part_path.parent_path());
+      transfer->fd =
+          open(transfer->part_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IWUSR | S_IRUSR | S_IRGRP | S_IROTH);
+      if (transfer->fd == -1) {
+        LOG_ERROR << "Failed to open file: " << transfer->part_path;
+        continue;
+      }
+      transfer->handle = curl_easy_init();
+      curlEasySetoptWrapper(transfer->handle, CURLOPT_VERBOSE, get_curlopt_verbose());
+      curlEasySetoptWrapper(transfer->handle, CURLOPT_WRITEFUNCTION, &OSTreeHttpRepo::curl_handle_write);
+      curlEasySetoptWrapper(transfer->handle, CURLOPT_WRITEDATA, &transfer->fd);
+      curlEasySetoptWrapper(transfer->handle, CURLOPT_FAILONERROR, true);
+      server_->InjectIntoCurl(path.string(), transfer->handle);
+      curl_multi_add_handle(multi_, transfer->handle);
+      transfers[transfer->handle] = std::move(transfer);
+    }
+
+    int running = 0;
+    if (curl_multi_perform(multi_, &running) != CURLM_OK) {
+      LOG_ERROR << "curl_multi_perform failed";
+      break;
+    }
+    int msgs_in_queue;
+    do {
+      CURLMsg *msg = curl_multi_info_read(multi_, &msgs_in_queue);
+      if (msg == nullptr || msg->msg != CURLMSG_DONE) {
+        continue;
+      }
+      auto it = transfers.find(msg->easy_handle);
+      assert(it != transfers.end());
+      std::unique_ptr<Transfer> done = std::move(it->second);
+      transfers.erase(it);
+      const CURLcode result = msg->data.result;
+      close(done->fd);
+      if (result == CURLE_OK) {
+        boost::filesystem::rename(done->part_path, root_ / done->path);
+        prefetched_.insert(done->path);
+        LOG_TRACE << "Prefetched OSTree object " << done->path;
+      } else {
+        // GetObject() will try again and report the error
+        LOG_DEBUG << "Prefetching " << done->path << " failed: " << curl_easy_strerror(result);
+        boost::filesystem::remove(done->part_path);
+      }
+      curl_multi_remove_handle(multi_, done->handle);
+      curl_easy_cleanup(done->handle);
+    } while (msgs_in_queue > 0);
+
+    if (!transfers.empty() && curl_multi_wait(multi_, nullptr, 0, 1000, nullptr) != CURLM_OK) {
+      LOG_ERROR << "curl_multi_wait failed";
+      break;
+    }
+  }
+
+  // Only left over after an error
+  for (auto &transfer : transfers) {
+    close(transfer.second->fd);
+    boost::filesystem::remove(transfer.second->part_path);
+    curl_multi_remove_handle(multi_, transfer.first);
+    curl_easy_cleanup(transfer.first);
+  }
+}
+
 bool OSTreeHttpRepo::FetchObject(const boost::filesystem::path &path) const {
+  // A prefetched object is only used once, so that it is downloaded again if
+  // GetObject() retries because the file is broken.
+  if (prefetched_.erase(path) != 0 && boost::filesystem::exists(root_ / path)) {
+    return true;
+  }
   CURLcode err = CURLE_OK;
   server_->InjectIntoCurl(path.string(), easy_handle_.get());
   boost::filesystem::create_directories((root_ / path).parent_path());
   std::string filename = (root_ / path).string();
-  int fp = open(filename.c_str(), O_WRONLY | O_CREAT, S_IWUSR | S_IRUSR | S_IRGRP | S_IROTH);
+  int fp = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IWUSR | S_IRUSR | S_IRGRP | S_IROTH);
   if (fp == -1) {
     LOG_ERROR << "Failed to open file: " << filename;
     return false;
@@ -1,6 +1,11 @@
 #ifndef SOTA_CLIENT_TOOLS_OSTREE_HTTP_REPO_H_
 #define SOTA_CLIENT_TOOLS_OSTREE_HTTP_REPO_H_
 
+#include <algorithm>
+#include <set>
+#include <utility>
+#include <vector>
+
 #include <boost/filesystem/path.hpp>
 
 #include "logging/logging.h"
@@ -11,19 +16,30 @@
 
 class OSTreeHttpRepo : public OSTreeRepo {
  public:
-  explicit OSTreeHttpRepo(TreehubServer* server, boost::filesystem::path root_in = "")
-      : server_(server), root_(std::move(root_in)) {
+  /**
+   * \param max_fetches The number of objects that Prefetch() downloads at the
+   *                    same time.
+   */
+  explicit OSTreeHttpRepo(TreehubServer* server, boost::filesystem::path root_in = "", int max_fetches = 8)
+      : server_(server), root_(std::move(root_in)), max_fetches_(std::max(max_fetches, 1)) {
     if (root_.empty()) {
       root_ = root_tmp_.Path();
     }
     curlEasySetoptWrapper(easy_handle_.get(), CURLOPT_VERBOSE, get_curlopt_verbose());
     curlEasySetoptWrapper(easy_handle_.get(), CURLOPT_WRITEFUNCTION, &OSTreeHttpRepo::curl_handle_write);
     curlEasySetoptWrapper(easy_handle_.get(), CURLOPT_FAILONERROR, true);
+    multi_ = curl_multi_init();
   }
+  ~OSTreeHttpRepo() override { curl_multi_cleanup(multi_); }
+  OSTreeHttpRepo(const OSTreeHttpRepo&) = delete;
+  OSTreeHttpRepo(OSTreeHttpRepo&&) = delete;
+  OSTreeHttpRepo& operator=(const OSTreeHttpRepo&) = delete;
+  OSTreeHttpRepo& operator=(OSTreeHttpRepo&&) = delete;
 
   bool LooksValid() const override;
   OSTreeRef GetRef(const std::string& refname) const override;
   boost::filesystem::path root() const override { return root_; }
+  void Prefetch(const std::vector<std::pair<OSTreeHash, OstreeObjectType>>& objects) const override;
 
  private:
   bool FetchObject(const boost::filesystem::path& path) const override;
@@ -33,6 +49,11 @@ class OSTreeHttpRepo : public OSTreeRepo {
   boost::filesystem::path root_;
   const TemporaryDirectory root_tmp_;
   mutable CurlEasyWrapper easy_handle_;
+  const int max_fetches_;
+  // Used by Prefetch(), keeps the connections to the server between calls
+  mutable CURLM* multi_;
+  // Objects that have been downloaded by Prefetch() and not used yet
+  mutable std::set<boost::filesystem::path> prefetched_;
 };
 
 // vim: set tabstop=2 shiftwidth=2 expandtab:
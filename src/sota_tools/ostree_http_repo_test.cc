@@ -52,6 +52,40 @@ TEST(http_repo, GetObject) {
   EXPECT_EQ(s.str(), std::string("44/6a0ef11b7cc167f3b603e585c7eeeeb675faa412d5ec73f62988eb0b6c5488.dirmeta"));
 }
 
+/* Prefetch OSTree objects in parallel, skipping the ones that are missing. */
+TEST(http_repo, Prefetch) {
+  TreehubServer server;
+  server.root_url("http://localhost:" + port);
+  auto src_repo = std::make_shared<OSTreeHttpRepo>(&server);
+  const auto commit = OSTreeHash::Parse("b9ac1e45f9227df8ee191b6e51e09417bd36c6ebbeff999431e3073ac50f0563");
+  const auto missing = OSTreeHash::Parse("0028dac42b76c2015ee3c41cc4183bb8b5c790fd21fa5cfa0802c6e11fd0edbe");
+  src_repo->Prefetch({{commit, OstreeObjectType::OSTREE_OBJECT_TYPE_COMMIT},
+                      {missing, OstreeObjectType::OSTREE_OBJECT_TYPE_DIR_META}});
+
+  const auto commit_path = src_repo->root() / "objects" / OSTreeRepo::GetPathForHash(commit, OSTREE_OBJECT_TYPE_COMMIT);
+  EXPECT_TRUE(boost::filesystem::exists(commit_path));
+  EXPECT_FALSE(boost::filesystem::exists(src_repo->root() / "objects" / missing.string().substr(0, 2)));
+  // The commit is parsed from the prefetched copy.
+  auto object = src_repo->GetObject(commit, OstreeObjectType::OSTREE_OBJECT_TYPE_COMMIT);
+  EXPECT_EQ(object->GetSize(), boost::filesystem::file_size(commit_path));
+}
+
+/* Download a prefetched object again if its file has gone missing. */
+TEST(http_repo, PrefetchRemoved) {
+  TreehubServer server;
+  server.root_url("http://localhost:" + port);
+  auto src_repo = std::make_shared<OSTreeHttpRepo>(&server);
+  const auto commit = OSTreeHash::Parse("b9ac1e45f9227df8ee191b6e51e09417bd36c6ebbeff999431e3073ac50f0563");
+  src_repo->Prefetch({{commit, OstreeObjectType::OSTREE_OBJECT_TYPE_COMMIT}});
+
+  const auto commit_path = src_repo->root() / "objects" / OSTreeRepo::GetPathForHash(commit, OSTREE_OBJECT_TYPE_COMMIT);
+  ASSERT_TRUE(boost::filesystem::exists(commit_path));
+  boost::filesystem::remove(commit_path);
+  auto object = src_repo->GetObject(commit, OstreeObjectType::OSTREE_OBJECT_TYPE_COMMIT);
+  EXPECT_TRUE(boost::filesystem::exists(commit_path));
+  EXPECT_EQ(object->GetSize(), boost::filesystem::file_size(commit_path));
+}
+
 /* Abort if OSTree object is not found after retry. */
 TEST(http_repo, GetWrongObject) {
   TreehubServer server;
@@ -7,9 +7,11 @@
 #include <cassert>
 #include <cstring>
 #include <iostream>
+#include <vector>
 
 #include "logging/logging.h"
 #include "ostree_repo.h"
+#include "presence_cache.h"
 #include "request_pool.h"
 #include "utilities/utils.h"
 
@@ -100,6 +102,8 @@ void OSTreeObject::PopulateChildren() {
                               reinterpret_cast<GDestroyNotify>(g_mapped_file_unref), mfile);
   g_variant_ref_sink(contents);
 
+  // Collect the children first, so that the repo can fetch them all at once.
+  std::vector<std::pair<OSTreeHash, OstreeObjectType>> children;
   if (is_commit) {
     // * - ay - Root tree contents
     GVariant *content_csum_variant = nullptr;
@@ -108,14 +112,14 @@ void OSTreeObject::PopulateChildren() {
     gsize n_elts;
     const auto *csum = static_cast<const uint8_t *>(g_variant_get_fixed_array(content_csum_variant, &n_elts, 1));
     assert(n_elts == 32);
-    AppendChild(repo_.GetObject(csum, OstreeObjectType::OSTREE_OBJECT_TYPE_DIR_TREE));
+    children.emplace_back(OSTreeHash(csum), OstreeObjectType::OSTREE_OBJECT_TYPE_DIR_TREE);
 
     // * - ay - Root tree metadata
     GVariant *meta_csum_variant = nullptr;
     g_variant_get_child(contents, 7, "@ay", &meta_csum_variant);
     csum = static_cast<const uint8_t *>(g_variant_get_fixed_array(meta_csum_variant, &n_elts, 1));
     assert(n_elts == 32);
-    AppendChild(repo_.GetObject(csum, OstreeObjectType::OSTREE_OBJECT_TYPE_DIR_META));
+    children.emplace_back(OSTreeHash(csum), OstreeObjectType::OSTREE_OBJECT_TYPE_DIR_META);
 
     g_variant_unref(meta_csum_variant);
     g_variant_unref(content_csum_variant);
@@ -138,7 +142,7 @@ void OSTreeObject::PopulateChildren() {
       gsize n_elts;
       const auto *csum = static_cast<const uint8_t *>(g_variant_get_fixed_array(csum_variant, &n_elts, 1));
       assert(n_elts == 32);
-      AppendChild(repo_.GetObject(csum, OstreeObjectType::OSTREE_OBJECT_TYPE_FILE));
+      children.emplace_back(OSTreeHash(csum), OstreeObjectType::OSTREE_OBJECT_TYPE_FILE);
 
       g_variant_unref(csum_variant);
     }
@@ -153,12 +157,12 @@ void OSTreeObject::PopulateChildren() {
       // First the .dirtree:
       const auto *csum = static_cast<const uint8_t *>(g_variant_get_fixed_array(content_csum_variant, &n_elts, 1));
       assert(n_elts == 32);
-      AppendChild(repo_.GetObject(csum, OstreeObjectType::OSTREE_OBJECT_TYPE_DIR_TREE));
+      children.emplace_back(OSTreeHash(csum), OstreeObjectType::OSTREE_OBJECT_TYPE_DIR_TREE);
 
       // Then the .dirmeta:
       csum = static_cast<const uint8_t *>(g_variant_get_fixed_array(meta_csum_variant, &n_elts, 1));
       assert(n_elts == 32);
-      AppendChild(repo_.GetObject(csum, OstreeObjectType::OSTREE_OBJECT_TYPE_DIR_META));
+      children.emplace_back(OSTreeHash(csum), OstreeObjectType::OSTREE_OBJECT_TYPE_DIR_META);
 
       g_variant_unref(meta_csum_variant);
       g_variant_unref(content_csum_variant);
@@ -168,6 +172,11 @@ void OSTreeObject::PopulateChildren() {
     g_variant_unref(files_variant);
   }
   g_variant_unref(contents);
+
+  repo_.Prefetch(children);
+  for (const auto &child : children) {
+    AppendChild(repo_.GetObject(child.first, child.second));
+  }
 }
 
 void OSTreeObject::QueryChildren(RequestPool &pool) {
@@ -193,13 +202,14 @@ boost::filesystem::path OSTreeObject::PathOnDisk() const {
 
 uintmax_t OSTreeObject::GetSize() const { return boost::filesystem::file_size(PathOnDisk()); }
 
-void OSTreeObject::MakeTestRequest(const TreehubServer &push_target, CURLM *curl_multi_handle) {
+void OSTreeObject::MakeTestRequest(const TreehubServer &push_target, CURLM *curl_multi_handle, CURL *handle) {
   assert(!curl_handle_);
-  curl_handle_ = curl_easy_init();
+  curl_handle_ = handle != nullptr ? handle : curl_easy_init();
   if (curl_handle_ == nullptr) {
     throw std::runtime_error("Could not initialize curl handle");
   }
   curlEasySetoptWrapper(curl_handle_, CURLOPT_VERBOSE, get_curlopt_verbose());
+  setHttpVersion(curl_handle_);
   current_operation_ = CurrentOp::kOstreeObjectPresenceCheck;
 
   push_target.InjectIntoCurl(Url(), curl_handle_);
@@ -219,7 +229,7 @@ void OSTreeObject::MakeTestRequest(const TreehubServer &push_target, CURLM *curl
   request_start_time_ = std::chrono::steady_clock::now();
 }
 
-void OSTreeObject::Upload(TreehubServer &push_target, CURLM *curl_multi_handle, const RunMode mode) {
+void OSTreeObject::Upload(TreehubServer &push_target, CURLM *curl_multi_handle, const RunMode mode, CURL *handle) {
   if (mode == RunMode::kDefault || mode == RunMode::kPushTree) {
     LOG_INFO << "Uploading " << *this;
   } else {
@@ -229,11 +239,12 @@ void OSTreeObject::Upload(TreehubServer &push_target, CURLM *curl_multi_handle,
   }
   assert(!curl_handle_);
 
-  curl_handle_ = curl_easy_init();
+  curl_handle_ = handle != nullptr ? handle : curl_easy_init();
   if (curl_handle_ == nullptr) {
     throw std::runtime_error("Could not initialize curl handle");
   }
   curlEasySetoptWrapper(curl_handle_, CURLOPT_VERBOSE, get_curlopt_verbose());
+  setHttpVersion(curl_handle_);
   current_operation_ = CurrentOp::kOstreeObjectUploading;
   push_target.SetContentType("Content-Type: application/octet-stream");
   push_target.InjectIntoCurl(Url(), curl_handle_);
@@ -315,19 +326,8 @@ void OSTreeObject::CurlDone(CURLM *curl_multi_handle, RequestPool &pool) {
     // NOLINTNEXTLINE(bugprone-branch-clone)
     if (url == nullptr || strstr(url, OSTreeRepo::GetPathForHash(hash_, type_).c_str()) == nullptr) {
       PresenceError(pool, rescode);
-    } else if (rescode == 200) {
-      LOG_INFO << "Already present: " << *this;
-      is_on_server_ = PresenceOnServer::kObjectPresent;
-      last_operation_result_ = ServerResponse::kOk;
-      if (pool.run_mode() == RunMode::kWalkTree || pool.run_mode() == RunMode::kPushTree) {
-        CheckChildren(pool, rescode);
-      } else {
-        NotifyParents(pool);
-      }
-    } else if (rescode == 404) {
-      is_on_server_ = PresenceOnServer::kObjectMissing;
-      last_operation_result_ = ServerResponse::kOk;
-      CheckChildren(pool, rescode);
+    } else if (rescode == 200 || rescode == 404) {
+      PresenceChecked(pool, rescode == 200);
     } else {
       PresenceError(pool, rescode);
     }
@@ -340,14 +340,10 @@ void OSTreeObject::CurlDone(CURLM *curl_multi_handle, RequestPool &pool) {
       UploadError(pool, rescode);
     } else if (rescode == 204) {
       LOG_TRACE << "OSTree upload successful";
-      is_on_server_ = PresenceOnServer::kObjectPresent;
-      last_operation_result_ = ServerResponse::kOk;
-      NotifyParents(pool);
+      UploadConfirmed(pool);
     } else if (rescode == 409) {
       LOG_DEBUG << "OSTree upload reported a 409 Conflict, possibly due to concurrent uploads";
-      is_on_server_ = PresenceOnServer::kObjectPresent;
-      last_operation_result_ = ServerResponse::kOk;
-      NotifyParents(pool);
+      UploadConfirmed(pool);
     } else {
       UploadError(pool, rescode);
     }
@@ -357,10 +353,48 @@ void OSTreeObject::CurlDone(CURLM *curl_multi_handle, RequestPool &pool) {
     assert(0);
   }
   curl_multi_remove_handle(curl_multi_handle, curl_handle_);
-  curl_easy_cleanup(curl_handle_);
+  pool.ReleaseHandle(curl_handle_);
   curl_handle_ = nullptr;
 }
 
+void OSTreeObject::UploadConfirmed(RequestPool &pool) {
+  is_on_server_ = PresenceOnServer::kObjectPresent;
+  last_operation_result_ = ServerResponse::kOk;
+  pool.RecordPresent(hash_, type_);
+  NotifyParents(pool);
+}
+
+void OSTreeObject::PresenceChecked(RequestPool &pool, const bool present) {
+  PresenceCache *cache = pool.presence_cache();
+  if (present) {
+    LOG_INFO << "Already present: " << *this;
+    pool.RecordPresent(hash_, type_);
+    PresenceConfirmed(pool);
+  } else if (cache != nullptr && cache->Contains(hash_, type_)) {
+    // Objects we already uploaded can't be trusted to be there either.
+    LOG_ERROR << "Object " << *this << " is in the presence cache, but missing on the server. Clearing the cache "
+              << cache->path() << ", please try again.";
+    is_on_server_ = PresenceOnServer::kObjectMissing;
+    last_operation_result_ = ServerResponse::kOk;
+    cache->Clear();
+    pool.Abort();
+  } else {
+    is_on_server_ = PresenceOnServer::kObjectMissing;
+    last_operation_result_ = ServerResponse::kOk;
+    CheckChildren(pool, 404);
+  }
+}
+
+void OSTreeObject::PresenceConfirmed(RequestPool &pool) {
+  is_on_server_ = PresenceOnServer::kObjectPresent;
+  last_operation_result_ = ServerResponse::kOk;
+  if (pool.run_mode() == RunMode::kWalkTree || pool.run_mode() == RunMode::kPushTree) {
+    CheckChildren(pool, 200);
+  } else {
+    NotifyParents(pool);
+  }
+}
+
 size_t OSTreeObject::curl_handle_write(void *buffer, size_t size, size_t nmemb, void *userp) {
   auto *that = static_cast<OSTreeObject *>(userp);
   that->http_response_.write(static_cast<const char *>(buffer), static_cast<std::streamsize>(size * nmemb));
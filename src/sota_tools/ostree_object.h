@@ -51,17 +51,37 @@ class OSTreeObject {
   void NotifyParents(RequestPool& pool);
 
   /* Send a HEAD request to the destination server to check if this object is
-   * present there. */
-  void MakeTestRequest(const TreehubServer& push_target, CURLM* curl_multi_handle);
+   * present there. The request is made on `handle` if given, or on a new curl
+   * handle otherwise. */
+  void MakeTestRequest(const TreehubServer& push_target, CURLM* curl_multi_handle, CURL* handle = nullptr);
 
   /* Upload this object to the destination server. */
-  void Upload(TreehubServer& push_target, CURLM* curl_multi_handle, RunMode mode);
+  void Upload(TreehubServer& push_target, CURLM* curl_multi_handle, RunMode mode, CURL* handle = nullptr);
 
-  /* Process a completed curl transaction (presence check or upload). */
+  /* Process a completed curl transaction (presence check or upload). The curl
+   * handle is given back to the pool. */
   void CurlDone(CURLM* curl_multi_handle, RequestPool& pool);
 
+  /* Process the result of a presence check, made either for this object alone
+   * or for a batch of objects. */
+  void PresenceChecked(RequestPool& pool, bool present);
+
+  /* This object is known to be on the server, either from a presence check or
+   * from the presence cache. Walk its children or notify its parents. */
+  void PresenceConfirmed(RequestPool& pool);
+
+  /* This object has been uploaded, either on its own or in a bundle. Notify
+   * its parents. */
+  void UploadConfirmed(RequestPool& pool);
+
   uintmax_t GetSize() const;
 
+  /** Full path on disk to this object */
+  boost::filesystem::path PathOnDisk() const;
+
+  const OSTreeHash& hash() const { return hash_; }
+  OstreeObjectType type() const { return type_; }
+
   PresenceOnServer is_on_server() const { return is_on_server_; }
   CurrentOp operation() const { return current_operation_; }
   bool children_ready() const { return children_.empty(); }
@@ -106,9 +126,6 @@ class OSTreeObject {
 
   static size_t curl_handle_write(void* buffer, size_t size, size_t nmemb, void* userp);
 
-  /** Full path on disk to this object */
-  boost::filesystem::path PathOnDisk() const;
-
   FRIEND_TEST(OstreeObject, Request);
   FRIEND_TEST(OstreeObject, UploadDryRun);
   FRIEND_TEST(OstreeObject, UploadFail);
@@ -3,6 +3,8 @@
 
 #include <map>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <boost/filesystem/path.hpp>
 
@@ -37,6 +39,13 @@ class OSTreeRepo {
 
   static boost::filesystem::path GetPathForHash(OSTreeHash hash, OstreeObjectType type);
 
+  /**
+   * Hint that the given objects are about to be requested with GetObject(),
+   * so that a remote repository can fetch them in parallel. Failures are
+   * ignored here, GetObject() retries and reports them.
+   */
+  virtual void Prefetch(const std::vector<std::pair<OSTreeHash, OstreeObjectType>>& objects) const { (void)objects; }
+
  protected:
   /**
    * Look for an object with a given path, downloading it if necessary and
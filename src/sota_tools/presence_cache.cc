@@ -0,0 +1,102 @@
+#include "presence_cache.h"
+
+#include <fstream>
+#include <sstream>
+
+#include <boost/filesystem.hpp>
+
+#include "crypto/crypto.h"
+#include "logging/logging.h"
+#include "ostree_repo.h"
+#include "utilities/utils.h"
+
+static int64_t now() {
+  return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+PresenceCache::PresenceCache(const boost::filesystem::path& directory, const std::string& server_url,
+                             std::chrono::seconds ttl, const unsigned int verify_percent)
+    : path_(directory / Crypto::sha256digestHex(server_url)),
+      ttl_(ttl),
+      verify_percent_(verify_percent),
+      rng_(std::random_device{}()) {
+  std::ifstream in(path_.string());
+  std::string line;
+  while (std::getline(in, line)) {
+    std::istringstream fields(line);
+    std::string object;
+    int64_t seen;
+    if (!(fields >> object >> seen)) {
+      LOG_WARNING << "Ignoring malformed line in presence cache " << path_ << ": " << line;
+      dirty_ = true;
+      continue;
+    }
+    if (IsFresh(seen)) {
+      objects_[object] = seen;
+    } else {
+      dirty_ = true;
+    }
+  }
+  LOG_INFO << "Presence cache for " << server_url << " knows about " << objects_.size() << " objects";
+}
+
+PresenceCache::~PresenceCache() {
+  try {
+    Save();
+  } catch (const std::exception& e) {
+    LOG_ERROR << "Could not save presence cache " << path_ << ": " << e.what();
+  }
+}
+
+std::string PresenceCache::Key(const OSTreeHash& hash, const OstreeObjectType type) {
+  return OSTreeRepo::GetPathForHash(hash, type).string();
+}
+
+bool PresenceCache::IsFresh(const int64_t seen) const { return now() - seen < ttl_.count(); }
+
+bool PresenceCache::IsPresent(const OSTreeHash& hash, const OstreeObjectType type) {
+  if (!Contains(hash, type)) {
+    return false;
+  }
+  if (verify_percent_ > 0 && std::uniform_int_distribution<unsigned int>(0, 99)(rng_) < verify_percent_) {
+    LOG_DEBUG << "Verifying cached object " << Key(hash, type);
+    return false;
+  }
+  return true;
+}
+
+bool PresenceCache::Contains(const OSTreeHash& hash, const OstreeObjectType type) const {
+  auto it = objects_.find(Key(hash, type));
+  return it != objects_.end() && IsFresh(it->second);
+}
+
+void PresenceCache::Add(const OSTreeHash& hash, const OstreeObjectType type) {
+  objects_[Key(hash, type)] = now();
+  dirty_ = true;
+}
+
+void PresenceCache::Clear() {
+  objects_.clear();
+  dirty_ = true;
+}
+
+void PresenceCache::Save() {
+  if (!dirty_) {
+    return;
+  }
+  std::ostringstream out;
+  for (const auto& object : objects_) {
+    if (IsFresh(object.second)) {
+      out << object.first << ' ' << object.second << '\n';
+    }
+  }
+  // Write to a temporary file first so that a crash can't leave a truncated
+  // cache behind.
+  boost::filesystem::path tmp_path(path_);
+  tmp_path += ".tmp";
+  Utils::writeFile(tmp_path, out.str());
+  boost::filesystem::rename(tmp_path, path_);
+  dirty_ = false;
+}
+
+// vim: set tabstop=2 shiftwidth=2 expandtab:
@@ -0,0 +1,71 @@
+#ifndef SOTA_CLIENT_TOOLS_PRESENCE_CACHE_H_
+#define SOTA_CLIENT_TOOLS_PRESENCE_CACHE_H_
+
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+#include <boost/filesystem/path.hpp>
+
+#include "garage_common.h"
+#include "ostree_hash.h"
+
+/**
+ * Remembers which objects have been found on a Treehub server, so that later
+ * runs don't have to send a HEAD request for each of them again.
+ *
+ * Each server has a file of its own in the cache directory, named after the
+ * hash of the server's URL. Every line of the file holds the path of an object
+ * and the time at which the object was last seen on the server. Objects that
+ * haven't been seen for longer than the TTL are checked again.
+ */
+class PresenceCache {
+ public:
+  /**
+   * \param directory Where the cache files are kept.
+   * \param server_url URL of the Treehub server.
+   * \param ttl How long objects are trusted to remain on the server.
+   * \param verify_percent Percentage of the objects found in the cache that
+   *                       are checked with the server anyway.
+   */
+  PresenceCache(const boost::filesystem::path& directory, const std::string& server_url, std::chrono::seconds ttl,
+                unsigned int verify_percent = 0);
+  ~PresenceCache();
+  PresenceCache(const PresenceCache&) = delete;
+  PresenceCache(PresenceCache&&) = delete;
+  PresenceCache& operator=(const PresenceCache&) = delete;
+  PresenceCache& operator=(PresenceCache&&) = delete;
+
+  /**
+   * Whether the object can be taken to be on the server without asking. This
+   * is false for objects picked for verification.
+   */
+  bool IsPresent(const OSTreeHash& hash, OstreeObjectType type);
+  /** Whether the object is in the cache, regardless of verification. */
+  bool Contains(const OSTreeHash& hash, OstreeObjectType type) const;
+  /** Record that the object has been seen on the server. */
+  void Add(const OSTreeHash& hash, OstreeObjectType type);
+  /** Forget all objects, e.g. because the server turned out to have lost some. */
+  void Clear();
+  /** Write the cache to disk. Done by the destructor as well. */
+  void Save();
+
+  size_t size() const { return objects_.size(); }
+  const boost::filesystem::path& path() const { return path_; }
+
+ private:
+  static std::string Key(const OSTreeHash& hash, OstreeObjectType type);
+  bool IsFresh(int64_t seen) const;
+
+  boost::filesystem::path path_;
+  std::chrono::seconds ttl_;
+  unsigned int verify_percent_;
+  std::unordered_map<std::string, int64_t> objects_;  // object path -> last seen, in seconds since the epoch
+  bool dirty_{false};
+  std::mt19937 rng_;
+};
+
+// vim: set tabstop=2 shiftwidth=2 expandtab:
+#endif  // SOTA_CLIENT_TOOLS_PRESENCE_CACHE_H_
@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+
+#include "presence_cache.h"
+#include "utilities/utils.h"
+
+static const std::string server = "https://treehub.example.com/api/v3";
+
+static OSTreeHash hash(char c) { return OSTreeHash::Parse(std::string(64, c)); }
+
+/* Objects added to the cache are known on later runs, for the same server only. */
+TEST(PresenceCache, Persist) {
+  TemporaryDirectory temp_dir;
+  {
+    PresenceCache cache(temp_dir.Path(), server, std::chrono::hours(1));
+    EXPECT_FALSE(cache.IsPresent(hash('a'), OSTREE_OBJECT_TYPE_COMMIT));
+    cache.Add(hash('a'), OSTREE_OBJECT_TYPE_COMMIT);
+    EXPECT_TRUE(cache.IsPresent(hash('a'), OSTREE_OBJECT_TYPE_COMMIT));
+  }
+  PresenceCache cache(temp_dir.Path(), server, std::chrono::hours(1));
+  EXPECT_EQ(cache.size(), 1);
+  EXPECT_TRUE(cache.IsPresent(hash('a'), OSTREE_OBJECT_TYPE_COMMIT));
+  EXPECT_FALSE(cache.IsPresent(hash('a'), OSTREE_OBJECT_TYPE_DIR_TREE));
+  EXPECT_FALSE(cache.IsPresent(hash('b'), OSTREE_OBJECT_TYPE_COMMIT));
+
+  PresenceCache other(temp_dir.Path(), server + "/other", std::chrono::hours(1));
+  EXPECT_EQ(other.size(), 0);
+}
+
+/* Objects seen longer ago than the TTL, or in malformed lines, are ignored. */
+TEST(PresenceCache, Expiry) {
+  TemporaryDirectory temp_dir;
+  {
+    PresenceCache cache(temp_dir.Path(), server, std::chrono::hours(1));
+    cache.Add(hash('a'), OSTREE_OBJECT_TYPE_DIR_META);
+  }
+  PresenceCache probe(temp_dir.Path(), server, std::chrono::hours(1));
+  Utils::writeFile(probe.path(), Utils::readFile(probe.path()) + "bb/" + std::string(62, 'b') +
+                                     ".dirmeta 1000\ngarbage\n");
+
+  PresenceCache cache(temp_dir.Path(), server, std::chrono::hours(1));
+  EXPECT_EQ(cache.size(), 1);
+  EXPECT_TRUE(cache.IsPresent(hash('a'), OSTREE_OBJECT_TYPE_DIR_META));
+  EXPECT_FALSE(cache.IsPresent(hash('b'), OSTREE_OBJECT_TYPE_DIR_META));
+}
+
+/* Objects picked for verification are reported as unknown, but are still in the cache. */
+TEST(PresenceCache, Verify) {
+  TemporaryDirectory temp_dir;
+  PresenceCache cache(temp_dir.Path(), server, std::chrono::hours(1), 100);
+  cache.Add(hash('a'), OSTREE_OBJECT_TYPE_FILE);
+  EXPECT_FALSE(cache.IsPresent(hash('a'), OSTREE_OBJECT_TYPE_FILE));
+  EXPECT_TRUE(cache.Contains(hash('a'), OSTREE_OBJECT_TYPE_FILE));
+
+  cache.Clear();
+  EXPECT_FALSE(cache.Contains(hash('a'), OSTREE_OBJECT_TYPE_FILE));
+}
+
+#ifndef __NO_MAIN__
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+#endif
@@ -0,0 +1,59 @@
+#include "push_journal.h"
+
+#include <boost/filesystem.hpp>
+
+#include "crypto/crypto.h"
+#include "logging/logging.h"
+#include "ostree_repo.h"
+
+PushJournal::PushJournal(const boost::filesystem::path& directory, const std::string& server_url,
+                         const OSTreeHash& commit)
+    : path_(directory / Crypto::sha256digestHex(server_url + " " + commit.string())) {
+  {
+    std::ifstream in(path_.string());
+    std::string line;
+    while (std::getline(in, line)) {
+      if (!line.empty()) {
+        objects_.insert(line);
+      }
+    }
+  }
+  if (!objects_.empty()) {
+    LOG_INFO << "Resuming the push of " << commit << " with " << objects_.size()
+             << " objects known to be on the server from " << path_;
+  }
+
+  boost::filesystem::create_directories(directory);
+  out_.open(path_.string(), std::ios::app);
+  if (!out_) {
+    throw std::runtime_error("Could not open push journal " + path_.string());
+  }
+}
+
+std::string PushJournal::Key(const OSTreeHash& hash, const OstreeObjectType type) {
+  return OSTreeRepo::GetPathForHash(hash, type).string();
+}
+
+bool PushJournal::Contains(const OSTreeHash& hash, const OstreeObjectType type) const {
+  return objects_.count(Key(hash, type)) != 0;
+}
+
+void PushJournal::Record(const OSTreeHash& hash, const OstreeObjectType type) {
+  auto key = Key(hash, type);
+  if (objects_.insert(key).second) {
+    // Flushed right away, the journal has to survive the process being killed.
+    out_ << key << std::endl;
+  }
+}
+
+void PushJournal::Finish() {
+  out_.close();
+  boost::system::error_code ec;
+  boost::filesystem::remove(path_, ec);
+  if (ec) {
+    LOG_WARNING << "Could not remove push journal " << path_ << ": " << ec.message();
+  }
+  objects_.clear();
+}
+
+// vim: set tabstop=2 shiftwidth=2 expandtab:
@@ -0,0 +1,48 @@
+#ifndef SOTA_CLIENT_TOOLS_PUSH_JOURNAL_H_
+#define SOTA_CLIENT_TOOLS_PUSH_JOURNAL_H_
+
+#include <fstream>
+#include <string>
+#include <unordered_set>
+
+#include <boost/filesystem/path.hpp>
+
+#include "garage_common.h"
+#include "ostree_hash.h"
+
+/**
+ * Records the objects of a push that are known to be on the server, so that
+ * a push that failed halfway can be resumed where it stopped instead of
+ * walking the whole tree again.
+ *
+ * There is one journal per commit and server, in a file named after the hash
+ * of both. Objects are appended to it as soon as they are confirmed, and the
+ * file is removed once the push is complete.
+ */
+class PushJournal {
+ public:
+  PushJournal(const boost::filesystem::path& directory, const std::string& server_url, const OSTreeHash& commit);
+  PushJournal(const PushJournal&) = delete;
+  PushJournal(PushJournal&&) = delete;
+  PushJournal& operator=(const PushJournal&) = delete;
+  PushJournal& operator=(PushJournal&&) = delete;
+  ~PushJournal() = default;
+
+  bool Contains(const OSTreeHash& hash, OstreeObjectType type) const;
+  void Record(const OSTreeHash& hash, OstreeObjectType type);
+  /** The push is complete, remove the journal. */
+  void Finish();
+
+  size_t size() const { return objects_.size(); }
+  const boost::filesystem::path& path() const { return path_; }
+
+ private:
+  static std::string Key(const OSTreeHash& hash, OstreeObjectType type);
+
+  boost::filesystem::path path_;
+  std::unordered_set<std::string> objects_;
+  std::ofstream out_;
+};
+
+// vim: set tabstop=2 shiftwidth=2 expandtab:
+#endif  // SOTA_CLIENT_TOOLS_PUSH_JOURNAL_H_
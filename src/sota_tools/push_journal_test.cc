@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <boost/filesystem.hpp>
+
+#include "push_journal.h"
+#include "utilities/utils.h"
+
+static const std::string server = "https://treehub.example.com/api/v3";
+
+static OSTreeHash hash(char c) { return OSTreeHash::Parse(std::string(64, c)); }
+
+/* Recorded objects are known to later attempts of the same push only. */
+TEST(PushJournal, Resume) {
+  TemporaryDirectory temp_dir;
+  {
+    PushJournal journal(temp_dir.Path(), server, hash('c'));
+    EXPECT_FALSE(journal.Contains(hash('a'), OSTREE_OBJECT_TYPE_FILE));
+    journal.Record(hash('a'), OSTREE_OBJECT_TYPE_FILE);
+    journal.Record(hash('a'), OSTREE_OBJECT_TYPE_FILE);
+    EXPECT_TRUE(journal.Contains(hash('a'), OSTREE_OBJECT_TYPE_FILE));
+  }
+  PushJournal journal(temp_dir.Path(), server, hash('c'));
+  EXPECT_EQ(journal.size(), 1);
+  EXPECT_TRUE(journal.Contains(hash('a'), OSTREE_OBJECT_TYPE_FILE));
+  EXPECT_FALSE(journal.Contains(hash('a'), OSTREE_OBJECT_TYPE_DIR_TREE));
+
+  PushJournal other_commit(temp_dir.Path(), server, hash('d'));
+  EXPECT_EQ(other_commit.size(), 0);
+  PushJournal other_server(temp_dir.Path(), server + "/other", hash('c'));
+  EXPECT_EQ(other_server.size(), 0);
+}
+
+/* Objects are written to disk as soon as they are recorded. */
+TEST(PushJournal, Incremental) {
+  TemporaryDirectory temp_dir;
+  PushJournal journal(temp_dir.Path(), server, hash('c'));
+  journal.Record(hash('a'), OSTREE_OBJECT_TYPE_DIR_META);
+  journal.Record(hash('b'), OSTREE_OBJECT_TYPE_DIR_TREE);
+
+  PushJournal reader(temp_dir.Path(), server, hash('c'));
+  EXPECT_EQ(reader.size(), 2);
+  EXPECT_TRUE(reader.Contains(hash('b'), OSTREE_OBJECT_TYPE_DIR_TREE));
+}
+
+/* A finished push leaves no journal behind. */
+TEST(PushJournal, Finish) {
+  TemporaryDirectory temp_dir;
+  PushJournal journal(temp_dir.Path(), server, hash('c'));
+  journal.Record(hash('a'), OSTREE_OBJECT_TYPE_COMMIT);
+  journal.Finish();
+  EXPECT_FALSE(boost::filesystem::exists(journal.path()));
+
+  PushJournal next(temp_dir.Path(), server, hash('c'));
+  EXPECT_EQ(next.size(), 0);
+}
+
+#ifndef __NO_MAIN__
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+#endif
@@ -9,23 +9,59 @@ const RateController::clock::duration RateController::kMaxSleepTime = std::chron
 
 const RateController::clock::duration RateController::kInitialSleepTime = std::chrono::seconds(1);
 
-RateController::RateController(const int concurrency_cap) : concurrency_cap_(concurrency_cap) { CheckInvariants(); }
+const RateController::clock::duration RateController::kBaseLatencyWindow = std::chrono::seconds(60);
+
+static int64_t milliseconds(const RateController::clock::duration d) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(d).count();
+}
+
+static double seconds(const RateController::clock::duration d) {
+  return std::chrono::duration_cast<std::chrono::duration<double>>(d).count();
+}
+
+RateController::RateController(const int concurrency_cap)
+    : concurrency_cap_(concurrency_cap), epoch_(clock::now()) {
+  CheckInvariants();
+}
 
 void RateController::RequestCompleted(const clock::time_point start_time, const clock::time_point end_time,
-                                      const bool succeeded) {
+                                      const bool succeeded, const bool sample_latency) {
+  LOG_TRACE << "Request trace: " << milliseconds(start_time - epoch_) << ' ' << milliseconds(end_time - epoch_) << ' '
+            << static_cast<int>(succeeded) << ' ' << static_cast<int>(sample_latency);
+
+  if (succeeded) {
+    round_completed_++;
+    if (sample_latency) {
+      const clock::duration latency = end_time - start_time;
+      // Only requests sent since the last change tell about its effect.
+      if (start_time >= last_concurrency_update_) {
+        round_latency_ += latency;
+        round_samples_++;
+      }
+      if (latency <= base_latency_ || end_time - base_latency_time_ > kBaseLatencyWindow) {
+        base_latency_ = latency;
+        base_latency_time_ = end_time;
+      }
+    }
+  }
+
   if (last_concurrency_update_ < start_time) {
     const int prev_concurrency = max_concurrency_;
-    last_concurrency_update_ = end_time;
     if (succeeded) {
-      max_concurrency_ = std::min(max_concurrency_ + 1, concurrency_cap_);
       sleep_time_ = clock::duration(0);
+      EndRound(end_time);
     } else {
+      startup_ = false;
       if (max_concurrency_ >= 2) {
         max_concurrency_ = max_concurrency_ / 2;
       } else {
         sleep_time_ = std::max(sleep_time_ * 2, kInitialSleepTime);
       }
     }
+    last_concurrency_update_ = end_time;
+    round_latency_ = clock::duration(0);
+    round_samples_ = 0;
+    round_completed_ = 0;
     if (prev_concurrency != max_concurrency_) {
       LOG_DEBUG << "Concurrency limit is now: " << max_concurrency_;
     }
@@ -33,6 +69,47 @@ void RateController::RequestCompleted(const clock::time_point start_time, const
   CheckInvariants();
 }
 
+void RateController::EndRound(const clock::time_point end_time) {
+  // Vegas' estimate of the requests queued at the server: the difference
+  // between the throughput expected at the base latency and the actual one,
+  // times the base latency. Vegas takes the shortest latency of the round,
+  // but requests that happen to find a free worker make that too optimistic.
+  double queued = 0.0;
+  if (round_samples_ > 0) {
+    const double latency = seconds(round_latency_) / round_samples_;
+    queued = std::max(0.0, max_concurrency_ * (1.0 - seconds(base_latency_) / latency));
+  }
+
+  if (startup_) {
+    if (queued > kMaxQueued) {
+      // Overshot, drain the queue that has built up.
+      startup_ = false;
+      max_concurrency_ -= static_cast<int>(queued);
+    } else {
+      if (last_concurrency_update_ != clock::time_point()) {
+        const double throughput = round_completed_ / seconds(end_time - last_concurrency_update_);
+        if (throughput > best_throughput_ * kStartupGrowth) {
+          best_throughput_ = throughput;
+          startup_stale_rounds_ = 0;
+        } else if (++startup_stale_rounds_ >= kStartupRounds) {
+          startup_ = false;
+        }
+      }
+      if (startup_) {
+        max_concurrency_ *= 2;
+      }
+    }
+    if (!startup_) {
+      LOG_DEBUG << "Leaving startup with a base latency of " << milliseconds(base_latency_) << " ms";
+    }
+  } else if (queued < kMinQueued) {
+    max_concurrency_++;
+  } else if (queued > kMaxQueued) {
+    max_concurrency_--;
+  }
+  max_concurrency_ = std::max(1, std::min(max_concurrency_, concurrency_cap_));
+}
+
 int RateController::MaxConcurrency() const {
   CheckInvariants();
   return max_concurrency_;
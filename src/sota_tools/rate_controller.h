@@ -10,8 +10,16 @@
  *    MaxConcurrency - The current estimate of the number of parallel requests that can be opened
  *    Sleep() - The number of seconds to sleep before sending the next request. 0.0 if MaxConcurrency is > 1
  *    Failed() - A boolean indicating that the server is broken, and to report an error up to the user.
- * The congestion control is loosely based on the original TCP AIMD scheme. Better performance might be available by
- * Stealing ideas from the later TCP conjection control algorithms
+ *
+ * The congestion control follows TCP Vegas, with a startup phase borrowed from BBR. Time is divided in rounds of
+ * one round-trip time. During startup the concurrency doubles every round for as long as the throughput keeps
+ * growing. After that, the average latency in a round is compared with the shortest latency seen overall to
+ * estimate how many requests wait in a queue at the server. The concurrency grows by one while that queue is
+ * short and shrinks by one when it gets longer, which backs off before the server is overloaded to the point of
+ * returning errors. Errors still halve the concurrency, as in the original AIMD scheme.
+ *
+ * Each completed request is logged at trace level, prefixed with "Request trace: ". These lines can be replayed
+ * against the controller in rate_controller_test.
  */
 class RateController {
  public:
@@ -23,7 +31,14 @@ class RateController {
   RateController operator=(const RateController&) = delete;
   RateController operator=(RateController&&) = delete;
 
-  void RequestCompleted(clock::time_point start_time, clock::time_point end_time, bool succeeded);
+  /**
+   * \param sample_latency Whether the duration of the request tells about the
+   *                       latency of the server. Should be false for requests
+   *                       whose duration mostly depends on their size, like
+   *                       uploads.
+   */
+  void RequestCompleted(clock::time_point start_time, clock::time_point end_time, bool succeeded,
+                        bool sample_latency = true);
 
   int MaxConcurrency() const;
 
@@ -44,7 +59,30 @@ class RateController {
    */
   static const clock::duration kInitialSleepTime;
 
+  /**
+   * The shortest latency is forgotten after this long, in case the server or
+   * the route to it has become slower for good.
+   */
+  static const clock::duration kBaseLatencyWindow;
+
+  /**
+   * Bounds on the estimated number of queued requests, between which the
+   * concurrency is left alone.
+   */
+  static constexpr double kMinQueued = 1.0;
+  static constexpr double kMaxQueued = 3.0;
+
+  /**
+   * Startup ends once the throughput has grown by less than this factor for
+   * kStartupRounds rounds.
+   */
+  static constexpr double kStartupGrowth = 1.25;
+  static constexpr int kStartupRounds = 3;
+
+  void EndRound(clock::time_point end_time);
+
   const int concurrency_cap_;
+  const clock::time_point epoch_;
   /**
    * After making a change to the system, we wait a full round-trip time to
    * see any effects of the change. This is the last time that an change was
@@ -55,6 +93,16 @@ class RateController {
   int max_concurrency_{1};
   clock::duration sleep_time_{0};
 
+  bool startup_{true};
+  int startup_stale_rounds_{0};
+  double best_throughput_{0.0};  // requests per second
+
+  clock::duration base_latency_{clock::duration::max()};
+  clock::time_point base_latency_time_;
+  clock::duration round_latency_{0};  // total latency of the requests sent in the current round
+  int round_samples_{0};
+  int round_completed_{0};
+
   void CheckInvariants() const;
 };
 
@@ -1,5 +1,13 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <queue>
+#include <sstream>
+#include <string>
+#include <vector>
+
 #include "rate_controller.h"
 
 /* Initial rate controller status is good. */
@@ -48,6 +56,111 @@ TEST(control, good_results_improve_concurrency) {
   EXPECT_GT(dut.MaxConcurrency(), initial_concurrency);
 }
 
+/*
+ * Simulated server with a fixed number of workers, which serve requests in
+ * the order they arrive. Requests beyond that wait in a queue, and the server
+ * fails requests once the queue gets too long.
+ */
+class SimulatedServer {
+ public:
+  SimulatedServer(size_t workers, RateController::clock::duration service_time, int max_queued)
+      : free_at_(workers), service_time_(service_time), max_queued_(max_queued) {}
+
+  // Returns when a request sent at the given time completes, and whether it succeeds
+  std::pair<RateController::clock::time_point, bool> Send(RateController::clock::time_point now, int in_flight) {
+    if (in_flight >= static_cast<int>(free_at_.size()) + max_queued_) {
+      return {now + service_time_, false};
+    }
+    auto worker = std::min_element(free_at_.begin(), free_at_.end());
+    *worker = std::max(*worker, now) + service_time_;
+    return {*worker, true};
+  }
+  int workers() const { return static_cast<int>(free_at_.size()); }
+
+ private:
+  std::vector<RateController::clock::time_point> free_at_;
+  RateController::clock::duration service_time_;
+  int max_queued_;
+};
+
+/* Runs a client that keeps as many requests going as the controller allows. Returns the number of failed requests. */
+static int Simulate(RateController &dut, SimulatedServer &server, int requests) {
+  using Completion = std::pair<RateController::clock::time_point, std::pair<RateController::clock::time_point, bool>>;
+  std::priority_queue<Completion, std::vector<Completion>, std::greater<Completion>> in_flight;
+  RateController::clock::time_point now = RateController::clock::now();
+  int failures = 0;
+  int sent = 0;
+  while (sent < requests || !in_flight.empty()) {
+    while (sent < requests && static_cast<int>(in_flight.size()) < dut.MaxConcurrency()) {
+      auto result = server.Send(now, static_cast<int>(in_flight.size()));
+      in_flight.push({result.first, {now, result.second}});
+      sent++;
+    }
+    Completion done = in_flight.top();
+    in_flight.pop();
+    now = done.first;
+    dut.RequestCompleted(done.second.first, now, done.second.second);
+    if (!done.second.second) {
+      failures++;
+    }
+    EXPECT_FALSE(dut.ServerHasFailed());
+    now += dut.GetSleepTime();
+  }
+  return failures;
+}
+
+/* Rate controller settles just above the capacity of the server, without overloading it. */
+TEST(control, backs_off_on_rising_latency) {
+  RateController dut;
+  SimulatedServer server(8, std::chrono::milliseconds(100), 16);
+  EXPECT_EQ(Simulate(dut, server, 2000), 0);
+  EXPECT_GE(dut.MaxConcurrency(), server.workers());
+  EXPECT_LE(dut.MaxConcurrency(), server.workers() + 4);
+}
+
+/* Rate controller uses all the capacity of a fast server. */
+TEST(control, fills_fast_server) {
+  RateController dut(20);
+  SimulatedServer server(100, std::chrono::milliseconds(50), 100);
+  EXPECT_EQ(Simulate(dut, server, 2000), 0);
+  EXPECT_EQ(dut.MaxConcurrency(), 20);
+}
+
+/*
+ * Replay a synthetic trace, generated rather than recorded from a real server,
+ * against the rate controller. The server's latency rises well before it
+ * starts failing requests, and the controller should have backed off by then.
+ */
+TEST(control, trace_replay) {
+  std::ifstream trace("tests/sota_tools/rate_controller_synthetic_trace.txt");
+  ASSERT_TRUE(trace.good());
+  RateController dut;
+  const RateController::clock::time_point epoch = RateController::clock::now();
+  int peak = 0;
+  int before_failure = 0;
+  std::string line;
+  while (std::getline(trace, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::istringstream fields(line);
+    int64_t start_ms;
+    int64_t end_ms;
+    bool succeeded;
+    bool sample_latency;
+    ASSERT_TRUE(static_cast<bool>(fields >> start_ms >> end_ms >> succeeded >> sample_latency)) << line;
+    if (!succeeded && before_failure == 0) {
+      before_failure = dut.MaxConcurrency();
+    }
+    dut.RequestCompleted(epoch + std::chrono::milliseconds(start_ms), epoch + std::chrono::milliseconds(end_ms),
+                         succeeded, sample_latency);
+    peak = std::max(peak, dut.MaxConcurrency());
+    EXPECT_FALSE(dut.ServerHasFailed());
+  }
+  EXPECT_GT(before_failure, 0);
+  EXPECT_LT(before_failure, peak / 2);
+}
+
 #ifndef __NO_MAIN__
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
@@ -1,22 +1,57 @@
 #include "request_pool.h"
 
+#include <sys/epoll.h>
+#include <unistd.h>
+
 #include <algorithm>  // min
+#include <array>
+#include <cerrno>
 #include <chrono>
+#include <cstring>
 #include <exception>
 #include <thread>
 
 #include "logging/logging.h"
+#include "ostree_repo.h"
+
+void setHttpVersion(CURL* curl_handle) {
+  curlEasySetoptWrapper(curl_handle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+  curlEasySetoptWrapper(curl_handle, CURLOPT_PIPEWAIT, 1L);
+}
 
-RequestPool::RequestPool(TreehubServer& server, const int max_curl_requests, const RunMode mode, bool fsck_on_upload)
+RequestPool::RequestPool(TreehubServer& server, const int max_curl_requests, const RunMode mode, bool fsck_on_upload,
+                         PresenceCache* presence_cache, PushJournal* journal, uintmax_t bundle_size)
     : rate_controller_(max_curl_requests),
       running_requests_(0),
+      bundle_size_(bundle_size),
       server_(server),
       mode_(mode),
       fsck_on_upload_(fsck_on_upload),
+      presence_cache_(presence_cache),
+      journal_(journal),
       stopped_(false) {
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  if (epoll_fd_ < 0) {
+    throw std::runtime_error(std::string("epoll_create1 failed with error: ") + std::strerror(errno));
+  }
   curl_global_init(CURL_GLOBAL_DEFAULT);
   multi_ = curl_multi_init();
   curl_multi_setopt(multi_, CURLMOPT_PIPELINING, CURLPIPE_HTTP1 | CURLPIPE_MULTIPLEX);
+  curl_multi_setopt(multi_, CURLMOPT_SOCKETFUNCTION, SocketCallback);
+  curl_multi_setopt(multi_, CURLMOPT_SOCKETDATA, this);
+  curl_multi_setopt(multi_, CURLMOPT_TIMERFUNCTION, TimerCallback);
+  curl_multi_setopt(multi_, CURLMOPT_TIMERDATA, this);
+
+  if (fsck_on_upload_) {
+    // Hashing is CPU bound, so use all cores for it.
+    verifier_ = std_::make_unique<ObjectVerifier>(std::thread::hardware_concurrency());
+    struct epoll_event ev {};
+    ev.events = EPOLLIN;
+    ev.data.fd = verifier_->fd();
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, verifier_->fd(), &ev) != 0) {
+      throw std::runtime_error(std::string("epoll_ctl failed with error: ") + std::strerror(errno));
+    }
+  }
 }
 
 RequestPool::~RequestPool() {
@@ -29,8 +64,20 @@ RequestPool::~RequestPool() {
     }
     LOG_INFO << "...done";
 
+    for (auto& batch : batches_) {
+      curl_multi_remove_handle(multi_, batch.first);
+      curl_easy_cleanup(batch.first);
+    }
+    for (auto& bundle : bundles_) {
+      curl_multi_remove_handle(multi_, bundle.first);
+      curl_easy_cleanup(bundle.first);
+    }
+    for (CURL* handle : idle_handles_) {
+      curl_easy_cleanup(handle);
+    }
     curl_multi_cleanup(multi_);
     curl_global_cleanup();
+    close(epoll_fd_);
   } catch (std::exception& ex) {
     LOG_ERROR << "Exception in RequestPool dtor: " << ex.what();
   } catch (...) {
@@ -38,6 +85,65 @@ RequestPool::~RequestPool() {
   }
 }
 
+CURL* RequestPool::AcquireHandle() {
+  if (idle_handles_.empty()) {
+    CURL* handle = curl_easy_init();
+    if (handle == nullptr) {
+      throw std::runtime_error("Could not initialize curl handle");
+    }
+    return handle;
+  }
+  CURL* handle = idle_handles_.back();
+  idle_handles_.pop_back();
+  return handle;
+}
+
+void RequestPool::ReleaseHandle(CURL* handle) {
+  // Drops the options of the last request, but keeps the connection and the
+  // caches.
+  curl_easy_reset(handle);
+  idle_handles_.push_back(handle);
+}
+
+int RequestPool::SocketCallback(CURL* easy, curl_socket_t s, int what, void* userp, void* socketp) {
+  (void)easy;
+  (void)socketp;
+  auto* pool = static_cast<RequestPool*>(userp);
+  if (what == CURL_POLL_REMOVE) {
+    // The socket may have been closed already, in which case epoll has
+    // forgotten about it by itself.
+    epoll_ctl(pool->epoll_fd_, EPOLL_CTL_DEL, s, nullptr);
+    pool->watched_sockets_--;
+    return 0;
+  }
+  struct epoll_event ev {};
+  if ((what & CURL_POLL_IN) != 0) {
+    ev.events |= EPOLLIN;
+  }
+  if ((what & CURL_POLL_OUT) != 0) {
+    ev.events |= EPOLLOUT;
+  }
+  ev.data.fd = s;
+  if (epoll_ctl(pool->epoll_fd_, EPOLL_CTL_MOD, s, &ev) != 0) {
+    if (errno != ENOENT || epoll_ctl(pool->epoll_fd_, EPOLL_CTL_ADD, s, &ev) != 0) {
+      LOG_ERROR << "epoll_ctl failed with error: " << std::strerror(errno);
+      return -1;
+    }
+    pool->watched_sockets_++;
+  }
+  return 0;
+}
+
+int RequestPool::TimerCallback(CURLM* multi, long timeout_ms, void* userp) {  // NOLINT(google-runtime-int)
+  (void)multi;
+  auto* pool = static_cast<RequestPool*>(userp);
+  pool->timer_set_ = timeout_ms >= 0;
+  if (pool->timer_set_) {
+    pool->timer_deadline_ = RateController::clock::now() + std::chrono::milliseconds(timeout_ms);
+  }
+  return 0;
+}
+
 void RequestPool::AddQuery(const OSTreeObject::ptr& request) {
   request->LaunchNotify();
   if (!stopped_) {
@@ -48,7 +154,242 @@ void RequestPool::AddQuery(const OSTreeObject::ptr& request) {
 void RequestPool::AddUpload(const OSTreeObject::ptr& request) {
   request->LaunchNotify();
   if (!stopped_) {
-    upload_queue_.push_back(request);
+    // Check object's integrity before uploading them, but after we know they
+    // are not present on the server
+    if (verifier_) {
+      verifier_->Add(request);
+    } else {
+      upload_queue_.push_back(request);
+    }
+  }
+}
+
+void RequestPool::CollectVerified() {
+  for (const auto& result : verifier_->Collect()) {
+    if (stopped_) {
+      continue;
+    }
+    if (result.second) {
+      upload_queue_.push_back(result.first);
+    } else {
+      LOG_ERROR << "Local object " << result.first << " is corrupt. Aborting upload.";
+      Abort();
+    }
+  }
+}
+
+bool RequestPool::UseBatchQuery() const {
+  // A single query is sent on its own, it might as well be a HEAD request.
+  // While it is unknown whether the server supports batches, only one batch
+  // is sent to find out.
+  switch (batch_support_) {
+    case BatchSupport::kSupported:
+      return query_queue_.size() > 1;
+    case BatchSupport::kUnknown:
+      return query_queue_.size() > 1 && batches_.empty();
+    case BatchSupport::kUnsupported:
+    default:
+      return false;
+  }
+}
+
+bool RequestPool::KnownPresent(const OSTreeObject::ptr& object) {
+  if (journal_ != nullptr && journal_->Contains(object->hash(), object->type())) {
+    LOG_DEBUG << "Confirmed earlier in this push: " << object;
+    journal_hits_++;
+  } else if (presence_cache_ != nullptr && presence_cache_->IsPresent(object->hash(), object->type())) {
+    LOG_DEBUG << "Known to be present: " << object;
+    cache_hits_++;
+  } else {
+    return false;
+  }
+  object->PresenceConfirmed(*this);
+  return true;
+}
+
+void RequestPool::RecordPresent(const OSTreeHash& hash, const OstreeObjectType type) {
+  if (presence_cache_ != nullptr) {
+    presence_cache_->Add(hash, type);
+  }
+  if (journal_ != nullptr) {
+    journal_->Record(hash, type);
+  }
+}
+
+bool RequestPool::LaunchBatchQuery() {
+  auto batch = std_::make_unique<PresenceBatch>();
+  std::vector<std::string> object_paths;
+  while (!query_queue_.empty() && batch->objects.size() < kMaxBatchSize) {
+    OSTreeObject::ptr cur = query_queue_.front();
+    query_queue_.pop_front();
+    if (KnownPresent(cur)) {
+      continue;
+    }
+    object_paths.push_back(OSTreeRepo::GetPathForHash(cur->hash(), cur->type()).string());
+    batch->objects.push_back(cur);
+  }
+  if (batch->objects.empty()) {
+    return false;
+  }
+
+  LOG_DEBUG << "Querying presence of " << batch->objects.size() << " objects";
+  batch->handle = AcquireHandle();
+  curlEasySetoptWrapper(batch->handle, CURLOPT_VERBOSE, get_curlopt_verbose());
+  setHttpVersion(batch->handle);
+  batch->headers = server_.InjectPresenceQuery(object_paths, batch->handle);
+  curlEasySetoptWrapper(batch->handle, CURLOPT_USERAGENT, Utils::getUserAgent());
+  curlEasySetoptWrapper(batch->handle, CURLOPT_WRITEFUNCTION, &RequestPool::BatchReplyWrite);
+  curlEasySetoptWrapper(batch->handle, CURLOPT_WRITEDATA, &batch->reply);
+  const CURLMcode err = curl_multi_add_handle(multi_, batch->handle);
+  if (err != 0) {
+    LOG_ERROR << "curl_multi_add_handle error:" << curl_multi_strerror(err);
+  }
+  batch->start_time = RateController::clock::now();
+  batches_[batch->handle] = std::move(batch);
+  batch_requests_made_++;
+  return true;
+}
+
+bool RequestPool::BatchQueryDone(PresenceBatch& batch) {
+  long rescode = 0;  // NOLINT(google-runtime-int)
+  curl_easy_getinfo(batch.handle, CURLINFO_RESPONSE_CODE, &rescode);
+  std::vector<bool> present;
+  if (rescode == 200 && TreehubServer::ParsePresenceReply(batch.reply, batch.objects.size(), &present)) {
+    batch_support_ = BatchSupport::kSupported;
+    for (size_t i = 0; i < batch.objects.size(); ++i) {
+      batch.objects[i]->PresenceChecked(*this, present[i]);
+    }
+    return true;
+  }
+
+  bool server_ok = false;
+  if (batch_support_ == BatchSupport::kUnknown) {
+    LOG_INFO << "Server doesn't support batched presence queries (" << rescode << "), checking objects one by one";
+    batch_support_ = BatchSupport::kUnsupported;
+    server_ok = true;
+  } else {
+    LOG_WARNING << "Batched presence query reported an error code: " << rescode << " retrying...";
+  }
+  if (!stopped_) {
+    query_queue_.insert(query_queue_.end(), batch.objects.begin(), batch.objects.end());
+  }
+  return server_ok;
+}
+
+size_t RequestPool::BatchReplyWrite(void* buffer, size_t size, size_t nmemb, void* userp) {
+  static_cast<std::string*>(userp)->append(static_cast<const char*>(buffer), size * nmemb);
+  return size * nmemb;
+}
+
+bool RequestPool::UseBundles() const {
+  return bundle_size_ > 0 && (mode_ == RunMode::kDefault || mode_ == RunMode::kPushTree) &&
+         bundle_support_ != BatchSupport::kUnsupported;
+}
+
+void RequestPool::BundleUploads() {
+  // While it is unknown whether the server supports bundles, only one bundle
+  // is sent to find out.
+  auto can_launch = [this]() {
+    return running_requests_ < rate_controller_.MaxConcurrency() &&
+           (bundle_support_ == BatchSupport::kSupported || bundles_.empty());
+  };
+  while (!upload_queue_.empty()) {
+    if (!pending_bundle_) {
+      pending_bundle_ = std_::make_unique<ObjectBundle>();
+    }
+    if (pending_bundle_->size() >= bundle_size_) {
+      if (!can_launch()) {
+        // The rest waits in the upload queue.
+        return;
+      }
+      LaunchBundleUpload();
+      if (!UseBundles()) {
+        return;
+      }
+      continue;
+    }
+    pending_bundle_->Add(upload_queue_.front());
+    upload_queue_.pop_front();
+  }
+  // Parents are only queued for upload once their children are on the
+  // server, so nothing can be added to the bundle before the requests that
+  // are running complete.
+  const bool stalled = query_queue_.empty() && running_requests_ == 0 && (!verifier_ || verifier_->is_idle());
+  if (pending_bundle_ && can_launch() && (stalled || pending_bundle_->size() >= bundle_size_)) {
+    LaunchBundleUpload();
+  }
+}
+
+void RequestPool::LaunchBundleUpload() {
+  std::unique_ptr<ObjectBundle> bundle = std::move(pending_bundle_);
+  try {
+    bundle->Write();
+  } catch (const std::exception& e) {
+    LOG_WARNING << "Could not write bundle, uploading objects one by one: " << e.what();
+    bundle_support_ = BatchSupport::kUnsupported;
+    UnbundleUploads(*bundle);
+    return;
+  }
+
+  LOG_INFO << "Uploading a bundle of " << bundle->objects().size() << " objects, " << bundle->archive_size()
+           << " bytes";
+  auto upload = std_::make_unique<BundleUpload>();
+  upload->handle = AcquireHandle();
+  curlEasySetoptWrapper(upload->handle, CURLOPT_VERBOSE, get_curlopt_verbose());
+  setHttpVersion(upload->handle);
+  upload->headers = server_.InjectBundleUpload(bundle->sha256(), upload->handle);
+  curlEasySetoptWrapper(upload->handle, CURLOPT_USERAGENT, Utils::getUserAgent());
+  curlEasySetoptWrapper(upload->handle, CURLOPT_WRITEFUNCTION, &RequestPool::BatchReplyWrite);
+  curlEasySetoptWrapper(upload->handle, CURLOPT_WRITEDATA, &upload->reply);
+  curlEasySetoptWrapper(upload->handle, CURLOPT_READDATA, bundle->file());
+  curlEasySetoptWrapper(upload->handle, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(bundle->archive_size()));
+  curlEasySetoptWrapper(upload->handle, CURLOPT_POST, 1);
+  const CURLMcode err = curl_multi_add_handle(multi_, upload->handle);
+  if (err != 0) {
+    LOG_ERROR << "curl_multi_add_handle error:" << curl_multi_strerror(err);
+  }
+  upload->start_time = RateController::clock::now();
+  total_object_size_ += bundle->size();
+  upload->bundle = std::move(bundle);
+  bundles_[upload->handle] = std::move(upload);
+  bundle_requests_made_++;
+  running_requests_++;
+}
+
+bool RequestPool::BundleUploadDone(BundleUpload& upload) {
+  long rescode = 0;  // NOLINT(google-runtime-int)
+  curl_easy_getinfo(upload.handle, CURLINFO_RESPONSE_CODE, &rescode);
+  if (rescode == 204) {
+    bundle_support_ = BatchSupport::kSupported;
+    for (const auto& object : upload.bundle->objects()) {
+      object->UploadConfirmed(*this);
+    }
+    return true;
+  }
+
+  // Retrying bundles could keep a push going for a long time before it fails,
+  // objects one by one are a safer bet.
+  bool server_ok = false;
+  if (bundle_support_ == BatchSupport::kUnknown) {
+    LOG_INFO << "Server doesn't support bundles (" << rescode << "), uploading objects one by one";
+    server_ok = true;
+  } else {
+    LOG_WARNING << "Bundle upload reported an error code: " << rescode << ", uploading objects one by one";
+    LOG_DEBUG << upload.reply;
+  }
+  bundle_support_ = BatchSupport::kUnsupported;
+  total_object_size_ -= upload.bundle->size();
+  UnbundleUploads(*upload.bundle);
+  if (pending_bundle_) {
+    UnbundleUploads(*pending_bundle_);
+    pending_bundle_.reset();
+  }
+  return server_ok;
+}
+
+void RequestPool::UnbundleUploads(const ObjectBundle& bundle) {
+  if (!stopped_) {
+    upload_queue_.insert(upload_queue_.end(), bundle.objects().begin(), bundle.objects().end());
   }
 }
 
@@ -57,20 +398,18 @@ void RequestPool::LoopLaunch() {
     OSTreeObject::ptr cur;
 
     // Queries first, uploads second
-    if (query_queue_.empty()) {
+    if (query_queue_.empty() && UseBundles()) {
+      BundleUploads();
+      break;
+    } else if (query_queue_.empty()) {
       // Uploads
       cur = upload_queue_.front();
       upload_queue_.pop_front();
-      // Check object's integrity before uploading them, but after we know they
-      // are not present on the server
-      if (fsck_on_upload_) {
-        if (!cur->Fsck()) {
-          LOG_ERROR << "Local object " << cur << " is corrupt. Aborting upload.";
-          Abort();
-          continue;
-        }
+      if (mode_ == RunMode::kDefault || mode_ == RunMode::kPushTree) {
+        cur->Upload(server_, multi_, mode_, AcquireHandle());
+      } else {
+        cur->Upload(server_, multi_, mode_);
       }
-      cur->Upload(server_, multi_, mode_);
       put_requests_made_++;
       total_object_size_ += cur->GetSize();
       if (mode_ == RunMode::kDryRun || mode_ == RunMode::kWalkTree) {
@@ -78,74 +417,84 @@ void RequestPool::LoopLaunch() {
         // acknowledge that the object has been uploaded.
         cur->NotifyParents(*this);
       }
+    } else if (UseBatchQuery()) {
+      if (!LaunchBatchQuery()) {
+        continue;
+      }
     } else {
       // Queries
       cur = query_queue_.front();
       query_queue_.pop_front();
-      cur->MakeTestRequest(server_, multi_);
+      if (KnownPresent(cur)) {
+        continue;
+      }
+      cur->MakeTestRequest(server_, multi_, AcquireHandle());
       head_requests_made_++;
     }
 
     running_requests_++;
   }
+  if (pending_bundle_) {
+    BundleUploads();
+  }
 }
 
 void RequestPool::LoopListen() {
-  // For more information about the timeout logic, read these:
-  // https://curl.haxx.se/libcurl/c/curl_multi_timeout.html
-  // https://curl.haxx.se/libcurl/c/curl_multi_fdset.html
+  // curl tells through SocketCallback() and TimerCallback() which sockets to
+  // watch and when it wants to be called regardless, see
+  // https://curl.se/libcurl/c/curl_multi_socket_action.html
+  // Unlike select(), epoll has no limit on the number of sockets or on the
+  // numbers of the file descriptors, and only reports the sockets with events.
   CURLMcode mc;
-  // Poll for IO
-  fd_set fdread;
-  fd_set fdwrite;
-  fd_set fdexcept;
-  int maxfd = 0;
-  FD_ZERO(&fdread);    // NOLINT(readability-isolate-declaration)
-  FD_ZERO(&fdwrite);   // NOLINT(readability-isolate-declaration)
-  FD_ZERO(&fdexcept);  // NOLINT(readability-isolate-declaration)
-  long timeoutms = 0;  // NOLINT(google-runtime-int)
-  mc = curl_multi_timeout(multi_, &timeoutms);
-  if (mc != CURLM_OK) {
-    throw std::runtime_error("curl_multi_timeout failed with error");
-  }
-  // If timeoutms is 0, "it means you should proceed immediately without waiting
-  // for anything".
-  if (timeoutms != 0) {
-    mc = curl_multi_fdset(multi_, &fdread, &fdwrite, &fdexcept, &maxfd);
-    if (mc != CURLM_OK) {
-      throw std::runtime_error("curl_multi_fdset failed with error");
+  // "You must not wait too long (more than a few seconds perhaps)".
+  int wait_ms = 3000;
+  if (!timer_set_ && watched_sockets_ == 0 && (!verifier_ || verifier_->is_idle())) {
+    // Nothing to wait for, e.g. in dry run mode.
+    wait_ms = 0;
+  } else if (timer_set_) {
+    const auto remaining =
+        std::chrono::duration_cast<std::chrono::milliseconds>(timer_deadline_ - RateController::clock::now()).count();
+    wait_ms = static_cast<int>(std::max<decltype(remaining)>(0, std::min<decltype(remaining)>(wait_ms, remaining)));
+  }
+  static constexpr int kMaxEvents = 64;
+  std::array<struct epoll_event, kMaxEvents> events{};
+  int nfds = epoll_wait(epoll_fd_, events.data(), kMaxEvents, wait_ms);
+  if (nfds < 0) {
+    if (errno != EINTR) {
+      throw std::runtime_error(std::string("epoll_wait failed with error: ") + std::strerror(errno));
     }
+    nfds = 0;
+  }
 
-    struct timeval timeout {};
-    if (maxfd != -1) {
-      // "Wait for activities no longer than the set timeout."
-      if (timeoutms == -1) {
-        // "You must not wait too long (more than a few seconds perhaps)".
-        timeout.tv_sec = 3;
-        timeout.tv_usec = 0;
-      } else {
-        timeout.tv_sec = timeoutms / 1000;
-        timeout.tv_usec = 1000 * (timeoutms % 1000);
-      }
-      if (select(maxfd + 1, &fdread, &fdwrite, &fdexcept, &timeout) < 0) {
-        throw std::runtime_error(std::string("select failed with error: ") + std::strerror(errno));
-      }
-    } else if (timeoutms > 0) {
-      // If maxfd == -1, then wait the lesser of timeoutms and 100 ms.
-      long nofd_timeoutms = std::min(timeoutms, static_cast<long>(100));  // NOLINT(google-runtime-int)
-      LOG_DEBUG << "Waiting " << nofd_timeoutms << " ms for curl";
-      timeout.tv_sec = 0;
-      timeout.tv_usec = 1000 * (nofd_timeoutms % 1000);
-      if (select(0, nullptr, nullptr, nullptr, &timeout) < 0) {
-        throw std::runtime_error(std::string("select failed with error: ") + std::strerror(errno));
-      }
+  // Ask curl to handle IO on the sockets that are ready
+  for (int i = 0; i < nfds; ++i) {
+    if (verifier_ && events.at(static_cast<size_t>(i)).data.fd == verifier_->fd()) {
+      CollectVerified();
+      continue;
+    }
+    const uint32_t ev = events.at(static_cast<size_t>(i)).events;
+    int flags = 0;
+    if ((ev & EPOLLIN) != 0U) {
+      flags |= CURL_CSELECT_IN;
+    }
+    if ((ev & EPOLLOUT) != 0U) {
+      flags |= CURL_CSELECT_OUT;
+    }
+    if ((ev & (EPOLLERR | EPOLLHUP)) != 0U) {
+      flags |= CURL_CSELECT_ERR;
+    }
+    mc = curl_multi_socket_action(multi_, events.at(static_cast<size_t>(i)).data.fd, flags, &running_requests_);
+    if (mc != CURLM_OK) {
+      throw std::runtime_error("curl_multi_socket_action failed with error");
     }
   }
-
-  // Ask curl to handle IO
-  mc = curl_multi_perform(multi_, &running_requests_);
-  if (mc != CURLM_OK) {
-    throw std::runtime_error("curl_multi failed with error");
+  // ...and on its timeout, which also starts requests that have just been added
+  if (nfds == 0 || (timer_set_ && RateController::clock::now() >= timer_deadline_)) {
+    timer_set_ = false;
+    mc = curl_multi_socket_action(multi_, CURL_SOCKET_TIMEOUT, 0, &running_requests_);
+    if (mc != CURLM_OK) {
+      throw std::runtime_error("curl_multi_socket_action failed with error");
+    }
   }
   assert(running_requests_ >= 0);
 
@@ -154,12 +503,39 @@ void RequestPool::LoopListen() {
   do {
     CURLMsg* msg = curl_multi_info_read(multi_, &msgs_in_queue);
     if ((msg != nullptr) && msg->msg == CURLMSG_DONE) {
-      OSTreeObject::ptr completed_object = ostree_object_from_curl(msg->easy_handle);
-      completed_object->CurlDone(multi_, *this);
-      auto start_time = completed_object->RequestStartTime();
+      RateController::clock::time_point start_time;
+      bool server_responded_ok;
+      bool sample_latency = true;
+      auto batch = batches_.find(msg->easy_handle);
+      auto bundle = bundles_.find(msg->easy_handle);
+      if (batch != batches_.end()) {
+        std::unique_ptr<PresenceBatch> done = std::move(batch->second);
+        batches_.erase(batch);
+        curl_multi_remove_handle(multi_, done->handle);
+        start_time = done->start_time;
+        // The server looks up every object in the batch, so the duration
+        // depends on the size of the batch more than on the server's latency.
+        sample_latency = false;
+        server_responded_ok = BatchQueryDone(*done);
+        ReleaseHandle(done->handle);
+      } else if (bundle != bundles_.end()) {
+        std::unique_ptr<BundleUpload> done = std::move(bundle->second);
+        bundles_.erase(bundle);
+        curl_multi_remove_handle(multi_, done->handle);
+        start_time = done->start_time;
+        sample_latency = false;
+        server_responded_ok = BundleUploadDone(*done);
+        ReleaseHandle(done->handle);
+      } else {
+        OSTreeObject::ptr completed_object = ostree_object_from_curl(msg->easy_handle);
+        // The duration of uploads depends on the size of the object more than on the server's latency.
+        sample_latency = completed_object->operation() == CurrentOp::kOstreeObjectPresenceCheck;
+        completed_object->CurlDone(multi_, *this);
+        start_time = completed_object->RequestStartTime();
+        server_responded_ok = completed_object->LastOperationResult() == ServerResponse::kOk;
+      }
       auto end_time = RateController::clock::now();
-      bool server_responded_ok = completed_object->LastOperationResult() == ServerResponse::kOk;
-      rate_controller_.RequestCompleted(start_time, end_time, server_responded_ok);
+      rate_controller_.RequestCompleted(start_time, end_time, server_responded_ok, sample_latency);
 
       if (rate_controller_.ServerHasFailed()) {
         Abort();
@@ -2,16 +2,31 @@
 #define SOTA_CLIENT_TOOLS_REQUEST_POOL_H_
 
 #include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
 
 #include <curl/curl.h>
 
 #include "garage_common.h"
+#include "object_bundle.h"
+#include "object_verifier.h"
 #include "ostree_object.h"
+#include "presence_cache.h"
+#include "push_journal.h"
 #include "rate_controller.h"
 
+/**
+ * Multiplex requests over a single HTTP/2 connection where the server
+ * supports it, rather than opening a connection per concurrent request.
+ */
+void setHttpVersion(CURL* curl_handle);
+
 class RequestPool {
  public:
-  RequestPool(TreehubServer& server, int max_curl_requests, RunMode mode, bool fsck_on_upload);
+  RequestPool(TreehubServer& server, int max_curl_requests, RunMode mode, bool fsck_on_upload,
+              PresenceCache* presence_cache = nullptr, PushJournal* journal = nullptr, uintmax_t bundle_size = 0);
   ~RequestPool();
   // Non-Copyable, Non-Movable
   RequestPool(const RequestPool&) = delete;
@@ -25,10 +40,20 @@ class RequestPool {
     stopped_ = true;
     query_queue_.clear();
     upload_queue_.clear();
+    pending_bundle_.reset();
+    if (verifier_) {
+      verifier_->Clear();
+    }
   };
-  bool is_idle() const { return query_queue_.empty() && upload_queue_.empty() && running_requests_ == 0; }
+  bool is_idle() const {
+    return query_queue_.empty() && upload_queue_.empty() && running_requests_ == 0 &&
+           (!verifier_ || verifier_->is_idle()) && !pending_bundle_;
+  }
   bool is_stopped() const { return stopped_; }
   RunMode run_mode() const { return mode_; }
+  PresenceCache* presence_cache() const { return presence_cache_; }
+  /** Record in the presence cache and push journal that an object is on the server. */
+  void RecordPresent(const OSTreeHash& hash, OstreeObjectType type);
 
   /**
    * One iteration of request-listen loop, launches multiple requests, then
@@ -41,23 +66,123 @@ class RequestPool {
    */
   int put_requests_made() const { return put_requests_made_; }
   int head_requests_made() const { return head_requests_made_; }
+  /** The number of batched presence queries, each covering many objects. */
+  int batch_requests_made() const { return batch_requests_made_; }
+  /** The number of bundles uploaded, each holding many objects. */
+  int bundle_requests_made() const { return bundle_requests_made_; }
+  /** The number of presence checks answered by the presence cache. */
+  int cache_hits() const { return cache_hits_; }
+  /** The number of presence checks skipped because the push journal had the object. */
+  int journal_hits() const { return journal_hits_; }
   uintmax_t total_object_size() const { return total_object_size_; }
 
+  /**
+   * Curl handles are kept after their request completes and reused for the
+   * next one, so that connections, DNS lookups and TLS sessions are reused as
+   * well.
+   */
+  CURL* AcquireHandle();
+  void ReleaseHandle(CURL* handle);
+
  private:
+  // Whether the server supports batched presence queries, or bundles
+  enum class BatchSupport { kUnknown, kSupported, kUnsupported };
+
+  /* A presence query for several objects at once. */
+  struct PresenceBatch {
+    PresenceBatch() = default;
+    ~PresenceBatch() { curl_slist_free_all(headers); }
+    PresenceBatch(const PresenceBatch&) = delete;
+    PresenceBatch(PresenceBatch&&) = delete;
+    PresenceBatch& operator=(const PresenceBatch&) = delete;
+    PresenceBatch& operator=(PresenceBatch&&) = delete;
+
+    CURL* handle{nullptr};
+    struct curl_slist* headers{nullptr};
+    std::vector<OSTreeObject::ptr> objects;
+    std::string reply;
+    RateController::clock::time_point start_time;
+  };
+  static constexpr size_t kMaxBatchSize = 1000;
+
+  /* Confirm the object without asking the server if the push journal or the
+   * presence cache has it. */
+  bool KnownPresent(const OSTreeObject::ptr& object);
+  bool UseBatchQuery() const;
+  /* Launch a batched presence query for the objects at the front of the query
+   * queue. Returns false if no request was needed. */
+  bool LaunchBatchQuery();
+  /* Process a completed batched presence query. Returns false if the server
+   * failed to answer it. */
+  bool BatchQueryDone(PresenceBatch& batch);
+  static size_t BatchReplyWrite(void* buffer, size_t size, size_t nmemb, void* userp);
+
+  /* An upload of a bundle of objects. */
+  struct BundleUpload {
+    BundleUpload() = default;
+    ~BundleUpload() { curl_slist_free_all(headers); }
+    BundleUpload(const BundleUpload&) = delete;
+    BundleUpload(BundleUpload&&) = delete;
+    BundleUpload& operator=(const BundleUpload&) = delete;
+    BundleUpload& operator=(BundleUpload&&) = delete;
+
+    CURL* handle{nullptr};
+    struct curl_slist* headers{nullptr};
+    std::unique_ptr<ObjectBundle> bundle;
+    std::string reply;
+    RateController::clock::time_point start_time;
+  };
+
+  bool UseBundles() const;
+  /* Move the upload queue into the pending bundle, and upload the bundle once
+   * it is large enough or nothing else can be added to it. */
+  void BundleUploads();
+  void LaunchBundleUpload();
+  /* Process a completed bundle upload. Returns false if the server failed to
+   * store the bundle. */
+  bool BundleUploadDone(BundleUpload& upload);
+  /* Upload the objects of a bundle one by one instead. */
+  void UnbundleUploads(const ObjectBundle& bundle);
+
   void LoopLaunch();  // launches multiple requests from the queues
   void LoopListen();  // listens to the result of launched requests
+  void CollectVerified();  // queues the uploads of the objects checked by verifier_
+
+  // Callbacks through which curl tells which sockets and timeout to wait for.
+  static int SocketCallback(CURL* easy, curl_socket_t s, int what, void* userp, void* socketp);
+  static int TimerCallback(CURLM* multi, long timeout_ms, void* userp);  // NOLINT(google-runtime-int)
 
   RateController rate_controller_;
   int running_requests_;
   int head_requests_made_{0};
   int put_requests_made_{0};
+  int cache_hits_{0};
+  int journal_hits_{0};
+  int batch_requests_made_{0};
+  BatchSupport batch_support_{BatchSupport::kUnknown};
+  std::map<CURL*, std::unique_ptr<PresenceBatch>> batches_;
+  // Objects are uploaded in bundles of about this many bytes, or one by one if 0
+  uintmax_t bundle_size_;
+  BatchSupport bundle_support_{BatchSupport::kUnknown};
+  int bundle_requests_made_{0};
+  std::unique_ptr<ObjectBundle> pending_bundle_;
+  std::map<CURL*, std::unique_ptr<BundleUpload>> bundles_;
+  // Checks objects before their upload if fsck_on_upload_ is set
+  std::unique_ptr<ObjectVerifier> verifier_;
   uintmax_t total_object_size_{0};
   TreehubServer& server_;
   CURLM* multi_;
+  int epoll_fd_;
+  int watched_sockets_{0};
+  bool timer_set_{false};
+  RateController::clock::time_point timer_deadline_;
+  std::vector<CURL*> idle_handles_;
   std::list<OSTreeObject::ptr> query_queue_;
   std::list<OSTreeObject::ptr> upload_queue_;
   RunMode mode_;
   bool fsck_on_upload_;
+  PresenceCache* presence_cache_;
+  PushJournal* journal_;
   bool stopped_;
 };
 // vim: set tabstop=2 shiftwidth=2 expandtab:
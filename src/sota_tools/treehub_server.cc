@@ -86,6 +86,48 @@ void TreehubServer::InjectIntoCurl(const string& url_suffix, CURL* curl_handle,
   }
 }
 
+// The content type in content_type_header_ is shared by the object uploads
+// running at the same time, so requests with a body of another type get a
+// list of their own.
+struct curl_slist* TreehubServer::InjectOwnHeaders(const std::string& content_type, CURL* curl_handle) const {
+  struct curl_slist* headers = nullptr;
+  if (!auth_header_contents_.empty()) {
+    headers = curl_slist_append(headers, auth_header_contents_.c_str());
+  }
+  headers = curl_slist_append(headers, force_header_contents_.c_str());
+  headers = curl_slist_append(headers, ("Content-Type: " + content_type).c_str());
+  curlEasySetoptWrapper(curl_handle, CURLOPT_HTTPHEADER, headers);
+  return headers;
+}
+
+struct curl_slist* TreehubServer::InjectPresenceQuery(const std::vector<std::string>& object_paths,
+                                                      CURL* curl_handle) const {
+  InjectIntoCurl("object-presence", curl_handle);
+  std::string body;
+  for (const auto& path : object_paths) {
+    body += path + "\n";
+  }
+  curlEasySetoptWrapper(curl_handle, CURLOPT_POSTFIELDSIZE, body.size());
+  curlEasySetoptWrapper(curl_handle, CURLOPT_COPYPOSTFIELDS, body.c_str());
+  return InjectOwnHeaders("text/plain", curl_handle);
+}
+
+bool TreehubServer::ParsePresenceReply(const std::string& reply, const size_t count, std::vector<bool>* present) {
+  if (reply.size() != (count + 7) / 8) {
+    return false;
+  }
+  present->resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    (*present)[i] = ((static_cast<unsigned char>(reply[i / 8]) >> (i % 8)) & 1U) != 0;
+  }
+  return true;
+}
+
+struct curl_slist* TreehubServer::InjectBundleUpload(const std::string& sha256, CURL* curl_handle) const {
+  InjectIntoCurl("object-bundle?sha256=" + sha256, curl_handle);
+  return InjectOwnHeaders("application/x-tar", curl_handle);
+}
+
 // Set the url of the treehub server, this should be something like
 // "https://treehub-staging.atsgarage.com/api/v2/"
 // The trailing slash is optional, and will be appended if required
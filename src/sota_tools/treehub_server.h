@@ -2,6 +2,7 @@
 #define SOTA_CLIENT_TOOLS_TREEHUB_SERVER_H_
 
 #include <string>
+#include <vector>
 
 #include <curl/curl.h>
 
@@ -18,12 +19,41 @@ class TreehubServer {
 
   void InjectIntoCurl(const std::string &url_suffix, CURL *curl_handle, bool tufrepo = false) const;
 
+  /**
+   * Set up a request that asks the server which of the given objects it has,
+   * instead of sending a HEAD request for each of them. The objects are given
+   * as paths relative to objects/, one per line. A server that supports this
+   * replies with a bitmap, see ParsePresenceReply(). Others reply with an
+   * error.
+   * @return the headers of the request, which belong to it alone. Free them
+   * with curl_slist_free_all() once the request has completed.
+   */
+  struct curl_slist *InjectPresenceQuery(const std::vector<std::string> &object_paths, CURL *curl_handle) const;
+  /**
+   * Decode the reply to a presence query for `count` objects. Bit i of the
+   * reply, counting from the least significant bit of the first byte, is set
+   * if object i is present.
+   * @return false if the reply doesn't have the expected size
+   */
+  static bool ParsePresenceReply(const std::string &reply, size_t count, std::vector<bool> *present);
+  /**
+   * Set up the upload of a bundle of objects, see ObjectBundle. The body of
+   * the request is left to the caller. The server checks the bundle against
+   * `sha256` and replies with 204 once it has stored all the objects in it.
+   * Servers without support for bundles reply with an error.
+   * @return the headers of the request, which belong to it alone. Free them
+   * with curl_slist_free_all() once the request has completed.
+   */
+  struct curl_slist *InjectBundleUpload(const std::string &sha256, CURL *curl_handle) const;
+
   void ca_certs(const std::string &cacerts) { ca_certs_ = cacerts; }
   void root_url(const std::string &_root_url);
   void repo_url(const std::string &_repo_url);
   std::string root_url() { return root_url_; };
 
  private:
+  struct curl_slist *InjectOwnHeaders(const std::string &content_type, CURL *curl_handle) const;
+
   std::string ca_certs_;
   std::string root_url_;
   std::string repo_url_;
@@ -61,6 +61,17 @@ TEST(treehub_server, basic_auth) {
   }
 }
 
+/* Replies to presence queries are decoded bit by bit and rejected if their size is wrong. */
+TEST(treehub_server, presence_reply) {
+  std::vector<bool> present;
+  EXPECT_TRUE(TreehubServer::ParsePresenceReply(std::string("\x05\x01", 2), 9, &present));
+  const std::vector<bool> expected{true, false, true, false, false, false, false, false, true};
+  EXPECT_EQ(present, expected);
+
+  EXPECT_FALSE(TreehubServer::ParsePresenceReply(std::string("\x05", 1), 9, &present));
+  EXPECT_FALSE(TreehubServer::ParsePresenceReply(std::string(3, '\0'), 9, &present));
+}
+
 #ifndef __NO_MAIN__
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
@@ -1,20 +1,89 @@
 #include "image_repo.h"
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+#include <boost/algorithm/string/case_conv.hpp>
 #include <boost/filesystem.hpp>
 
 #include "crypto/crypto.h"
 #include "utilities/utils.h"
 
+namespace {
+
+// Copy the image to the repo and hash it on the way, so that it is read only
+// once and never held in memory as a whole.
+uint64_t copyAndHash(const boost::filesystem::path &source, const boost::filesystem::path &destination,
+                     MultiPartHasher &sha256, MultiPartHasher &sha512) {
+  std::ifstream in(source.string(), std::ios::binary);
+  if (!in) {
+    throw std::runtime_error("Unable to open " + source.string());
+  }
+  // The image may already be in place.
+  const bool copy = !boost::filesystem::exists(destination) || !boost::filesystem::equivalent(source, destination);
+  std::ofstream out;
+  if (copy) {
+    out.open(destination.string(), std::ios::binary | std::ios::trunc);
+    if (!out) {
+      throw std::runtime_error("Unable to create " + destination.string());
+    }
+  }
+
+  std::vector<char> buf(1 << 20);
+  uint64_t length = 0;
+  while (in) {
+    in.read(buf.data(), static_cast<std::streamsize>(buf.size()));
+    const auto n = in.gcount();
+    if (n <= 0) {
+      break;
+    }
+    const auto *data = reinterpret_cast<const unsigned char *>(buf.data());
+    sha256.update(data, static_cast<uint64_t>(n));
+    sha512.update(data, static_cast<uint64_t>(n));
+    if (copy && !out.write(buf.data(), n)) {
+      throw std::runtime_error("Unable to write " + destination.string());
+    }
+    length += static_cast<uint64_t>(n);
+  }
+  if (in.bad()) {
+    throw std::runtime_error("Unable to read " + source.string());
+  }
+  if (copy) {
+    out.close();
+    if (!out) {
+      throw std::runtime_error("Unable to write " + destination.string());
+    }
+  }
+  return length;
+}
+
+void setHardwareId(Json::Value &target, const std::string &hardware_id) {
+  // TODO: support multiple hardware IDs.
+  target["custom"]["hardwareIds"][0] = hardware_id;
+}
+
+}  // namespace
+
 void ImageRepo::addImage(const std::string &name, Json::Value &target, const std::string &hardware_id,
                          const Delegation &delegation) {
+  setHardwareId(target, hardware_id);
+  addImages({{name, target}}, delegation);
+}
+
+void ImageRepo::addImages(const std::vector<std::pair<std::string, Json::Value>> &targets_to_add,
+                          const Delegation &delegation) {
   boost::filesystem::path repo_dir(path_ / ImageRepo::dir);
 
   boost::filesystem::path targets_path =
       delegation ? ((repo_dir / "delegations") / delegation.name).string() + ".json" : repo_dir / "targets.json";
   Json::Value targets = Utils::parseJSONFile(targets_path)["signed"];
-  // TODO: support multiple hardware IDs.
-  target["custom"]["hardwareIds"][0] = hardware_id;
-  targets["targets"][name] = target;
+  for (const auto &target : targets_to_add) {
+    targets["targets"][target.first] = target.second;
+  }
   targets["version"] = (targets["version"].asUInt()) + 1;
 
   auto role = delegation ? Uptane::Role(delegation.name, true) : Uptane::Role::Targets();
@@ -23,34 +92,85 @@ void ImageRepo::addImage(const std::string &name, Json::Value &target, const std
   updateRepo();
 }
 
-void ImageRepo::addBinaryImage(const boost::filesystem::path &image_path, const boost::filesystem::path &targetname,
-                               const std::string &hardware_id, const std::string &url, const int32_t custom_version,
-                               const Delegation &delegation, const Json::Value &custom) {
-  boost::filesystem::path repo_dir(path_ / ImageRepo::dir);
-  boost::filesystem::path targets_path = repo_dir / "targets";
+Json::Value ImageRepo::binaryTarget(const BinaryImage &image) const {
+  boost::filesystem::path targets_path = path_ / ImageRepo::dir / "targets";
 
-  auto targetname_dir = targetname.parent_path();
-  boost::filesystem::create_directories(targets_path / targetname_dir);
-  boost::filesystem::copy_file(image_path, targets_path / targetname_dir / targetname.filename(),
-                               boost::filesystem::copy_option::overwrite_if_exists);
+  // Several workers may create the same directory at once.
+  const auto targetname_dir = targets_path / image.targetname.parent_path();
+  boost::system::error_code ec;
+  boost::filesystem::create_directories(targetname_dir, ec);
+  if (ec && !boost::filesystem::is_directory(targetname_dir)) {
+    throw std::runtime_error("Unable to create " + targetname_dir.string() + ": " + ec.message());
+  }
 
-  std::string image = Utils::readFile(image_path);
+  MultiPartSHA256Hasher sha256;
+  MultiPartSHA512Hasher sha512;
+  const uint64_t length = copyAndHash(image.image_path, targetname_dir / image.targetname.filename(), sha256, sha512);
 
   Json::Value target;
-  target["length"] = Json::UInt64(image.size());
-  target["hashes"]["sha256"] = Crypto::sha256digestHex(image);
-  target["hashes"]["sha512"] = Crypto::sha512digestHex(image);
-  target["custom"] = custom;
+  target["length"] = Json::UInt64(length);
+  target["hashes"]["sha256"] = boost::algorithm::to_lower_copy(sha256.getHexDigest());
+  target["hashes"]["sha512"] = boost::algorithm::to_lower_copy(sha512.getHexDigest());
+  target["custom"] = image.custom;
   if (!target["custom"].isMember("targetFormat")) {
     target["custom"]["targetFormat"] = "BINARY";
   }
-  if (!url.empty()) {
-    target["custom"]["uri"] = url;
+  if (!image.url.empty()) {
+    target["custom"]["uri"] = image.url;
   }
-  if (custom_version != 0) {
-    target["custom"]["version"] = custom_version;
+  if (image.custom_version != 0) {
+    target["custom"]["version"] = image.custom_version;
+  }
+  setHardwareId(target, image.hardware_id);
+  return target;
+}
+
+void ImageRepo::addBinaryImage(const boost::filesystem::path &image_path, const boost::filesystem::path &targetname,
+                               const std::string &hardware_id, const std::string &url, const int32_t custom_version,
+                               const Delegation &delegation, const Json::Value &custom) {
+  addBinaryImages({BinaryImage{image_path, targetname, hardware_id, url, custom_version, custom}}, delegation, 1);
+}
+
+void ImageRepo::addBinaryImages(const std::vector<BinaryImage> &images, const Delegation &delegation,
+                                unsigned int jobs) {
+  if (jobs == 0) {
+    jobs = std::max(std::thread::hardware_concurrency(), 1U);
+  }
+  jobs = std::min(jobs, static_cast<unsigned int>(std::max<size_t>(images.size(), 1)));
+
+  std::vector<std::pair<std::string, Json::Value>> targets(images.size());
+  std::atomic<size_t> next{0};
+  std::mutex error_mutex;
+  std::exception_ptr error;
+  auto worker = [&]() {
+    for (size_t i = next++; i < images.size(); i = next++) {
+      try {
+        targets[i] = {images[i].targetname.string(), binaryTarget(images[i])};
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error) {
+          error = std::current_exception();
+        }
+        next = images.size();
+      }
+    }
+  };
+
+  if (jobs == 1) {
+    worker();
+  } else {
+    std::vector<std::thread> workers;
+    for (unsigned int i = 0; i < jobs; ++i) {
+      workers.emplace_back(worker);
+    }
+    for (auto &w : workers) {
+      w.join();
+    }
+  }
+  if (error) {
+    std::rethrow_exception(error);
   }
-  addImage(targetname.string(), target, hardware_id, delegation);
+  addImages(targets, delegation);
 }
 
 void ImageRepo::addCustomImage(const std::string &name, const Hash &hash, const uint64_t length,
@@ -1,8 +1,20 @@
 #ifndef IMAGE_REPO_H_
 #define IMAGE_REPO_H_
 
+#include <vector>
+
 #include "repo.h"
 
+/** An image file to be added to the Image repo, see ImageRepo::addBinaryImages(). */
+struct BinaryImage {
+  boost::filesystem::path image_path;
+  boost::filesystem::path targetname;
+  std::string hardware_id;
+  std::string url;
+  int32_t custom_version{0};
+  Json::Value custom;
+};
+
 class ImageRepo : public Repo {
  public:
   ImageRepo(boost::filesystem::path path, const std::string &expires, std::string correlation_id)
@@ -10,6 +22,12 @@ class ImageRepo : public Repo {
   void addBinaryImage(const boost::filesystem::path &image_path, const boost::filesystem::path &targetname,
                       const std::string &hardware_id, const std::string &url = "", int32_t custom_version = 0,
                       const Delegation &delegation = {}, const Json::Value &custom = {});
+  /**
+   * Add many images at once. The images are hashed concurrently on up to
+   * `jobs` threads (all cores if 0) and the metadata is signed only once.
+   */
+  void addBinaryImages(const std::vector<BinaryImage> &images, const Delegation &delegation = {},
+                       unsigned int jobs = 0);
   void addCustomImage(const std::string &name, const Hash &hash, uint64_t length, const std::string &hardware_id,
                       const std::string &url = "", int32_t custom_version = 0, const Delegation &delegation = {},
                       const Json::Value &custom = {});
@@ -25,6 +43,8 @@ class ImageRepo : public Repo {
  private:
   void addImage(const std::string &name, Json::Value &target, const std::string &hardware_id,
                 const Delegation &delegation = {});
+  void addImages(const std::vector<std::pair<std::string, Json::Value>> &targets, const Delegation &delegation);
+  Json::Value binaryTarget(const BinaryImage &image) const;
   void removeDelegationRecursive(const Uptane::Role &name, const Uptane::Role &parent_name);
 };
 
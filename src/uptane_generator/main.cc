@@ -4,7 +4,9 @@
 #include <istream>
 #include <iterator>
 #include <ostream>
+#include <sstream>
 #include <string>
+#include <vector>
 
 #include "logging/logging.h"
 #include "uptane_repo.h"
@@ -21,6 +23,22 @@ KeyType parseKeyType(const po::variables_map &vm) {
   return key_type;
 }
 
+Json::Value parseCustom(const po::variables_map &vm) {
+  Json::Value custom;
+  if (vm.count("targetcustom") > 0 && vm.count("targetformat") > 0) {
+    std::cerr << "--targetcustom and --targetformat cannot be used together";
+    exit(EXIT_FAILURE);
+  }
+  if (vm.count("targetcustom") > 0) {
+    std::ifstream custom_file(vm["targetcustom"].as<boost::filesystem::path>().c_str());
+    custom_file >> custom;
+  } else if (vm.count("targetformat") > 0) {
+    custom = Json::Value();
+    custom["targetFormat"] = vm["targetformat"].as<std::string>();
+  }
+  return custom;
+}
+
 void check_info_options(const po::options_description &description, const po::variables_map &vm) {
   if (vm.count("help") != 0 || (vm.count("command") == 0 && vm.count("version") == 0)) {
     std::cout << description << '\n';
@@ -42,6 +60,7 @@ int main(int argc, char **argv) {
                                           "adddelegation: \tadd a delegated role to the Image repo metadata\n"
                                           "revokedelegation: \tremove delegated role from the Image repo metadata and all signed targets of this role\n"
                                           "image: \tadd a target to the Image repo metadata\n"
+                                          "images: \tadd all the targets listed in --imagelist to the Image repo metadata\n"
                                           "addtarget: \tprepare Director Targets metadata for a given device\n"
                                           "signtargets: \tsign the staged Director Targets metadata\n"
                                           "emptytargets: \tclear the staged Director Targets metadata\n"
@@ -52,6 +71,8 @@ int main(int argc, char **argv) {
                                           "rotate: \trotate a Root metadata key")
     ("path", po::value<boost::filesystem::path>(), "path to the repository")
     ("filename", po::value<boost::filesystem::path>(), "path to the image")
+    ("imagelist", po::value<boost::filesystem::path>(), "file listing the images for 'images' command, one '<filename> [<targetname>]' per line")
+    ("jobs", po::value<unsigned int>()->default_value(0), "number of images hashed at once by 'images' command (0 for one per core)")
     ("hwid", po::value<std::string>(), "target hardware identifier")
     ("targetformat", po::value<std::string>(), "format of target for 'image' command")
     ("targetcustom", po::value<boost::filesystem::path>(), "path to custom JSON for 'image' command")
@@ -138,18 +159,7 @@ int main(int argc, char **argv) {
         if (vm.count("customversion") != 0) {
           custom_version = vm["customversion"].as<int32_t>();
         }
-        Json::Value custom;
-        if (vm.count("targetcustom") > 0 && vm.count("targetformat") > 0) {
-          std::cerr << "--targetcustom and --targetformat cannot be used together";
-          exit(EXIT_FAILURE);
-        }
-        if (vm.count("targetcustom") > 0) {
-          std::ifstream custom_file(vm["targetcustom"].as<boost::filesystem::path>().c_str());
-          custom_file >> custom;
-        } else if (vm.count("targetformat") > 0) {
-          custom = Json::Value();
-          custom["targetFormat"] = vm["targetformat"].as<std::string>();
-        }
+        Json::Value custom = parseCustom(vm);
         if (vm.count("filename") > 0) {
           repo.addImage(vm["filename"].as<boost::filesystem::path>(), targetname, hwid, url, custom_version, delegation,
                         custom);
@@ -170,6 +180,52 @@ int main(int argc, char **argv) {
                               delegation, custom);
           std::cout << "Added a custom image target " << targetname.string() << std::endl;
         }
+      } else if (command == "images") {
+        if (vm.count("imagelist") == 0 || vm.count("hwid") == 0) {
+          std::cerr << "images command requires --imagelist and --hwid\n";
+          exit(EXIT_FAILURE);
+        }
+        BinaryImage common;
+        common.hardware_id = vm["hwid"].as<std::string>();
+        if (vm.count("url") != 0) {
+          common.url = vm["url"].as<std::string>();
+        }
+        if (vm.count("customversion") != 0) {
+          common.custom_version = vm["customversion"].as<int32_t>();
+        }
+        common.custom = parseCustom(vm);
+
+        Delegation delegation;
+        if (vm.count("dname") != 0) {
+          delegation = Delegation(repo_dir, dname);
+        }
+
+        std::vector<BinaryImage> images;
+        std::ifstream list(vm["imagelist"].as<boost::filesystem::path>().string());
+        if (!list) {
+          std::cerr << "Unable to open " << vm["imagelist"].as<boost::filesystem::path>() << "\n";
+          exit(EXIT_FAILURE);
+        }
+        std::string line;
+        while (std::getline(list, line)) {
+          std::istringstream fields(line);
+          std::string filename;
+          std::string targetname;
+          if (!(fields >> filename) || filename[0] == '#') {
+            continue;
+          }
+          fields >> targetname;
+          BinaryImage image(common);
+          image.image_path = filename;
+          image.targetname = targetname.empty() ? filename : targetname;
+          if (delegation && !delegation.isMatched(image.targetname)) {
+            std::cerr << "Image path " << image.targetname << " doesn't match delegation!\n";
+            exit(EXIT_FAILURE);
+          }
+          images.push_back(std::move(image));
+        }
+        repo.addImages(images, delegation, vm["jobs"].as<unsigned int>());
+        std::cout << "Added " << images.size() << " targets to the Image repo metadata" << std::endl;
       } else if (command == "addtarget") {
         if (vm.count("targetname") == 0 || vm.count("hwid") == 0 || vm.count("serial") == 0) {
           std::cerr << "addtarget command requires --targetname, --hwid, and --serial\n";
@@ -223,6 +223,49 @@ TEST(uptane_generator, image_custom_version) {
   check_repo(temp_dir);
 }
 
+/*
+ * Add several images to the Image repo at once.
+ */
+TEST(uptane_generator, add_images) {
+  TemporaryDirectory temp_dir;
+  UptaneRepo repo(temp_dir.Path(), "", "");
+  repo.generateRepo(key_type);
+  const Json::Value old_snapshot = Utils::parseJSONFile(temp_dir.Path() / ImageRepo::dir / "snapshot.json");
+
+  std::vector<BinaryImage> images;
+  for (int i = 0; i < 5; ++i) {
+    BinaryImage image;
+    image.image_path = temp_dir / ("image" + std::to_string(i));
+    image.targetname = "dir/image" + std::to_string(i);
+    image.hardware_id = "test-hw";
+    image.custom_version = i;
+    // Big enough to take more than one read.
+    Utils::writeFile(image.image_path, std::string(static_cast<size_t>(i) * 700000, static_cast<char>('a' + i)));
+    images.push_back(image);
+  }
+  repo.addImages(images, {}, 3);
+
+  Json::Value image_targets = Utils::parseJSONFile(temp_dir.Path() / ImageRepo::dir / "targets.json");
+  EXPECT_EQ(image_targets["signed"]["targets"].size(), images.size());
+  // Signed once for the whole batch.
+  EXPECT_EQ(image_targets["signed"]["version"].asUInt(), 2);
+  const Json::Value snapshot = Utils::parseJSONFile(temp_dir.Path() / ImageRepo::dir / "snapshot.json");
+  EXPECT_EQ(snapshot["signed"]["version"].asUInt(), old_snapshot["signed"]["version"].asUInt() + 1);
+  for (const auto &image : images) {
+    const std::string content = Utils::readFile(image.image_path);
+    const Json::Value target = image_targets["signed"]["targets"][image.targetname.string()];
+    EXPECT_EQ(target["length"].asUInt64(), content.size());
+    EXPECT_EQ(target["hashes"]["sha256"].asString(), Crypto::sha256digestHex(content));
+    EXPECT_EQ(target["hashes"]["sha512"].asString(), Crypto::sha512digestHex(content));
+    EXPECT_EQ(target["custom"]["hardwareIds"][0], "test-hw");
+    EXPECT_EQ(target["custom"]["targetFormat"], "BINARY");
+    EXPECT_EQ(Utils::readFile(temp_dir.Path() / ImageRepo::dir / "targets" / image.targetname), content);
+  }
+  EXPECT_FALSE(image_targets["signed"]["targets"]["dir/image0"]["custom"].isMember("version"));
+  EXPECT_EQ(image_targets["signed"]["targets"]["dir/image4"]["custom"]["version"], 4);
+  check_repo(temp_dir);
+}
+
 /*
  * Add simple delegation.
  * Add image with delegation.
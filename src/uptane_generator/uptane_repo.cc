@@ -34,6 +34,10 @@ void UptaneRepo::addImage(const boost::filesystem::path &image_path, const boost
                           const Delegation &delegation, const Json::Value &custom) {
   image_repo_.addBinaryImage(image_path, targetname, hardware_id, url, custom_version, delegation, custom);
 }
+void UptaneRepo::addImages(const std::vector<BinaryImage> &images, const Delegation &delegation,
+                           const unsigned int jobs) {
+  image_repo_.addBinaryImages(images, delegation, jobs);
+}
 void UptaneRepo::addCustomImage(const std::string &name, const Hash &hash, uint64_t length,
                                 const std::string &hardware_id, const std::string &url, const int32_t custom_version,
                                 const Delegation &delegation, const Json::Value &custom) {
@@ -3,7 +3,11 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <array>
+#include <fstream>
+
 #include <boost/algorithm/hex.hpp>
+#include <boost/algorithm/string/case_conv.hpp>
 #include <boost/filesystem.hpp>
 
 #include "crypto/crypto.h"
@@ -17,7 +21,8 @@
 
 namespace Primary {
 
-ManagedSecondary::ManagedSecondary(Primary::ManagedSecondaryConfig sconfig_in) : sconfig(std::move(sconfig_in)) {
+ManagedSecondary::ManagedSecondary(Primary::ManagedSecondaryConfig sconfig_in)
+    : sconfig(std::move(sconfig_in)), manifest_cache_(std_::make_unique<ManifestCache>()) {
   struct stat stat_buf {};
   if (!boost::filesystem::is_directory(sconfig.metadata_path)) {
     Utils::createDirectories(sconfig.metadata_path, S_IRWXU);
@@ -177,10 +182,11 @@ data::InstallationResult ManagedSecondary::install(const Uptane::Target &target,
   }
 
   // TODO: check that the target is actually valid.
-  auto str = secondary_provider_->getTargetFileHandle(target);
+  auto image = secondary_provider_->mapTargetFile(target);
   std::ofstream out_file(sconfig.firmware_path.string(), std::ios::binary);
-  out_file << str.rdbuf();
-  str.close();
+  image->forEachSpan([&out_file](const uint8_t* data, size_t size) {
+    out_file.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+  });
   out_file.close();
 
   Utils::writeFile(sconfig.target_name_path, target.filename());
@@ -199,9 +205,15 @@ Uptane::Manifest ManagedSecondary::getManifest() const {
   // and signing functionality in one place
   manifest["attacks_detected"] = detected_attack;
 
+  const std::string canonical = Utils::jsonToCanonicalStr(manifest);
+  std::lock_guard<std::mutex> lock(manifest_cache_->mutex);
+  if (canonical == manifest_cache_->canonical) {
+    return manifest_cache_->manifest;
+  }
+
   Json::Value signed_ecu_version;
 
-  std::string b64sig = Utils::toBase64(Crypto::RSAPSSSign(nullptr, private_key, Utils::jsonToCanonicalStr(manifest)));
+  std::string b64sig = Utils::toBase64(Crypto::RSAPSSSign(nullptr, private_key, canonical));
   Json::Value signature;
   signature["method"] = "rsassa-pss";
   signature["sig"] = b64sig;
@@ -211,21 +223,50 @@ Uptane::Manifest ManagedSecondary::getManifest() const {
   signed_ecu_version["signatures"] = Json::Value(Json::arrayValue);
   signed_ecu_version["signatures"].append(signature);
 
+  manifest_cache_->canonical = canonical;
+  manifest_cache_->manifest = signed_ecu_version;
   return signed_ecu_version;
 }
 
 bool ManagedSecondary::getFirmwareInfo(Uptane::InstalledImageInfo &firmware_info) const {
-  std::string content;
-
-  if (!boost::filesystem::exists(sconfig.target_name_path) || !boost::filesystem::exists(sconfig.firmware_path)) {
+  struct stat st {};
+  if (!boost::filesystem::exists(sconfig.target_name_path) || stat(sconfig.firmware_path.c_str(), &st) != 0) {
     firmware_info.name = std::string("noimage");
-    content = "";
-  } else {
-    firmware_info.name = Utils::readFile(sconfig.target_name_path.string());
-    content = Utils::readFile(sconfig.firmware_path.string());
+    firmware_info.hash = Uptane::ManifestIssuer::generateVersionHashStr("");
+    firmware_info.len = 0;
+    return true;
+  }
+
+  const std::string name = Utils::readFile(sconfig.target_name_path.string());
+  // The firmware is only hashed again once it has been replaced or modified.
+  const std::string stamp = name + "|" + std::to_string(st.st_ino) + "|" + std::to_string(st.st_size) + "|" +
+                            std::to_string(st.st_mtim.tv_sec) + "." + std::to_string(st.st_mtim.tv_nsec) + "|" +
+                            std::to_string(st.st_ctim.tv_sec) + "." + std::to_string(st.st_ctim.tv_nsec);
+  std::lock_guard<std::mutex> lock(manifest_cache_->mutex);
+  if (stamp != manifest_cache_->firmware_stamp) {
+    std::ifstream in(sconfig.firmware_path.string(), std::ios::binary);
+    if (!in) {
+      LOG_ERROR << "Could not open the firmware of Secondary " << getSerial() << ": " << sconfig.firmware_path;
+      return false;
+    }
+    MultiPartSHA256Hasher hasher;
+    std::array<char, 64 * 1024> buf{};
+    uint64_t len = 0;
+    while (in) {
+      in.read(buf.data(), buf.size());
+      const auto got = in.gcount();
+      hasher.update(reinterpret_cast<const unsigned char *>(buf.data()), static_cast<uint64_t>(got));
+      len += static_cast<uint64_t>(got);
+    }
+    if (in.bad()) {
+      LOG_ERROR << "Could not read the firmware of Secondary " << getSerial() << " from " << sconfig.firmware_path;
+      return false;
+    }
+    manifest_cache_->firmware_info =
+        Uptane::InstalledImageInfo(name, len, boost::algorithm::to_lower_copy(hasher.getHexDigest()));
+    manifest_cache_->firmware_stamp = stamp;
   }
-  firmware_info.hash = Uptane::ManifestIssuer::generateVersionHashStr(content);
-  firmware_info.len = content.size();
+  firmware_info = manifest_cache_->firmware_info;
 
   return true;
 }
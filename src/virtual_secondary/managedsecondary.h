@@ -2,6 +2,7 @@
 #define PRIMARY_MANAGEDSECONDARY_H_
 
 #include <future>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -86,6 +87,16 @@ class ManagedSecondary : public SecondaryInterface {
   std::string detected_attack;
 
  private:
+  // What getFirmwareInfo() and getManifest() computed last, so that repeated
+  // manifests of an unchanged ECU cost neither a rehash nor a signature.
+  struct ManifestCache {
+    std::mutex mutex;
+    std::string firmware_stamp;
+    Uptane::InstalledImageInfo firmware_info;
+    std::string canonical;
+    Uptane::Manifest manifest;
+  };
+
   void storeKeys(const std::string& pub_key, const std::string& priv_key);
 
   int did_store_keys{0};  // For testing
@@ -95,6 +106,7 @@ class ManagedSecondary : public SecondaryInterface {
   std::string private_key;
   StorageConfig storage_config_;
   std::shared_ptr<INvStorage> storage_;
+  std::unique_ptr<ManifestCache> manifest_cache_;
 };
 
 }  // namespace Primary
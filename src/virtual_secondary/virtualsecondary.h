@@ -31,6 +31,7 @@ class VirtualSecondary : public ManagedSecondary {
   data::InstallationResult install(const Uptane::Target& target, const api::FlowControlToken* flow_control) override;
 
   bool ping() const override { return true; }
+  bool isPingThreadSafe() const override { return true; }
 };
 
 }  // namespace Primary
@@ -0,0 +1,104 @@
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <string>
+#include <thread>
+
+#include "asn1/asn1_message.h"
+#include "benchmark.h"
+#include "utilities/dequeue_buffer.h"
+
+namespace {
+
+Asn1Message::Ptr uploadDataRequest(const std::string &data) {
+  Asn1Message::Ptr req(Asn1Message::Empty());
+  req->present(AKIpUptaneMes_PR_uploadDataReq);
+  auto m = req->uploadDataReq();
+  OCTET_STRING_fromBuf(&m->data, data.data(), static_cast<int>(data.size()));
+  return req;
+}
+
+Asn1Message::Ptr decode(const std::string &encoded) {
+  AKIpUptaneMes_t *m = nullptr;
+  asn_codec_ctx_s context{};
+  const asn_dec_rval_t res =
+      ber_decode(&context, &asn_DEF_AKIpUptaneMes, reinterpret_cast<void **>(&m), encoded.data(), encoded.size());
+  Asn1Message::Ptr msg = Asn1Message::FromRaw(&m);
+  if (res.code != RC_OK) {
+    msg->present(AKIpUptaneMes_PR_NOTHING);
+  }
+  return msg;
+}
+
+/* Answers every uploadDataReq on the socket like a Secondary, until the socket is closed. */
+void respond(int fd) {
+  DequeueBuffer buffer;
+  for (;;) {
+    AKIpUptaneMes_t *m = nullptr;
+    asn_codec_ctx_s context{};
+    asn_dec_rval_t res{};
+    ssize_t received;
+    do {
+      res.code = RC_FAIL;
+      received = recv(fd, buffer.Tail(), buffer.TailSpace(), 0);
+      if (received <= 0) {
+        break;
+      }
+      buffer.HaveEnqueued(static_cast<size_t>(received));
+      res = ber_decode(&context, &asn_DEF_AKIpUptaneMes, reinterpret_cast<void **>(&m), buffer.Head(), buffer.Size());
+      buffer.Consume(res.consumed);
+    } while (res.code == RC_WMORE);
+    Asn1Message::Ptr msg = Asn1Message::FromRaw(&m);
+    if (res.code != RC_OK) {
+      return;
+    }
+
+    Asn1Message::Ptr resp(Asn1Message::Empty());
+    auto r = resp->present(AKIpUptaneMes_PR_uploadDataResp).uploadDataResp();
+    r->result = AKInstallationResultCode_ok;
+    SetString(&r->description, "");
+    der_encode(&asn_DEF_AKIpUptaneMes, &resp->msg_, Asn1SocketWriteCallback, &fd);
+  }
+}
+
+}  // namespace
+
+/* Encode and decode a chunk of firmware, as sent to IP Secondaries. */
+void Asn1EncodeDecode(BenchmarkState &state) {
+  const std::string data(static_cast<size_t>(state.arg()), 'x');
+  const Asn1Message::Ptr req = uploadDataRequest(data);
+  std::string encoded;
+  while (state.keepRunning()) {
+    encoded.clear();
+    der_encode(&asn_DEF_AKIpUptaneMes, &req->msg_, Asn1StringAppendCallback, &encoded);
+    if (decode(encoded)->present() != AKIpUptaneMes_PR_uploadDataReq) {
+      state.skipWithError("Decoding failed");
+    }
+  }
+  state.setBytesProcessed(state.iterations() * data.size());
+}
+AKTUALIZR_BENCHMARK(Asn1EncodeDecode)->arg(1024)->arg(1024 * 1024);
+
+/* A full request and response with a Secondary over a local socket. */
+void Asn1RoundTrip(BenchmarkState &state) {
+  int fds[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+    state.skipWithError("socketpair() failed");
+    return;
+  }
+  std::thread responder(respond, fds[1]);
+
+  const Asn1Message::Ptr req = uploadDataRequest(std::string(static_cast<size_t>(state.arg()), 'x'));
+  while (state.keepRunning()) {
+    if (Asn1Rpc(req, fds[0])->present() != AKIpUptaneMes_PR_uploadDataResp) {
+      state.skipWithError("No response");
+    }
+  }
+  state.setBytesProcessed(state.iterations() * static_cast<uint64_t>(state.arg()));
+
+  shutdown(fds[0], SHUT_RDWR);
+  responder.join();
+  close(fds[0]);
+  close(fds[1]);
+}
+AKTUALIZR_BENCHMARK(Asn1RoundTrip)->arg(1024)->arg(1024 * 1024);
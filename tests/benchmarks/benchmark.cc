@@ -0,0 +1,149 @@
+#include "benchmark.h"
+
+#include <time.h>
+#include <unistd.h>
+
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <regex>
+
+#include "libaktualizr/types.h"
+#include "utilities/aktualizr_version.h"
+#include "utilities/utils.h"
+
+static std::chrono::duration<double> processCpuTime() {
+  struct timespec ts {};
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+}
+
+BenchmarkState::BenchmarkState(int64_t arg, std::chrono::duration<double> min_time)
+    : arg_(arg), min_time_(min_time) {}
+
+void BenchmarkState::start() {
+  running_ = true;
+  real_start_ = std::chrono::steady_clock::now();
+  cpu_start_ = processCpuTime();
+}
+
+void BenchmarkState::stop() {
+  running_ = false;
+  real_time_ += std::chrono::steady_clock::now() - real_start_;
+  cpu_time_ += processCpuTime() - cpu_start_;
+}
+
+bool BenchmarkState::keepRunning() {
+  if (!error_.empty()) {
+    if (running_) {
+      stop();
+    }
+    return false;
+  }
+  if (!started_) {
+    started_ = true;
+    start();
+    return true;
+  }
+  ++iterations_;
+  if (!running_) {
+    // Paused at the end of the iteration.
+    resumeTiming();
+  }
+  const auto measured = real_time_ + (std::chrono::steady_clock::now() - real_start_);
+  if (measured >= min_time_) {
+    stop();
+    return false;
+  }
+  return true;
+}
+
+void BenchmarkState::pauseTiming() {
+  if (running_) {
+    stop();
+  }
+}
+
+void BenchmarkState::resumeTiming() {
+  if (!running_) {
+    start();
+  }
+}
+
+static std::vector<std::unique_ptr<Benchmark>>& registry() {
+  static std::vector<std::unique_ptr<Benchmark>> benchmarks;
+  return benchmarks;
+}
+
+Benchmark* registerBenchmark(const std::string& name, Benchmark::Function function) {
+  registry().push_back(std_::make_unique<Benchmark>(name, std::move(function)));
+  return registry().back().get();
+}
+
+Json::Value runBenchmarks(const std::string& filter, std::chrono::duration<double> min_time) {
+  Json::Value result;
+  char host_name[256] = {};
+  gethostname(host_name, sizeof(host_name) - 1);
+  result["context"]["host_name"] = host_name;
+  result["context"]["num_cpus"] = static_cast<Json::Int64>(sysconf(_SC_NPROCESSORS_ONLN));
+  result["context"]["aktualizr_version"] = aktualizr_version();
+  result["context"]["date"] = TimeStamp::Now().ToString();
+  result["benchmarks"] = Json::Value(Json::arrayValue);
+
+  const std::regex filter_re(filter);
+  for (const auto& benchmark : registry()) {
+    std::vector<int64_t> args = benchmark->args();
+    if (args.empty()) {
+      args.push_back(0);
+    }
+    for (const auto arg : args) {
+      const std::string name = benchmark->name() + (benchmark->args().empty() ? "" : "/" + std::to_string(arg));
+      if (!std::regex_search(name, filter_re)) {
+        continue;
+      }
+
+      BenchmarkState state(arg, min_time);
+      try {
+        benchmark->run(state);
+      } catch (const std::exception& e) {
+        state.skipWithError(e.what());
+      }
+
+      Json::Value run;
+      run["name"] = name;
+      run["run_name"] = name;
+      run["run_type"] = "iteration";
+      run["iterations"] = static_cast<Json::UInt64>(state.iterations());
+      run["time_unit"] = "ns";
+      if (!state.error().empty() || state.iterations() == 0) {
+        run["error_occurred"] = true;
+        run["error_message"] = state.error().empty() ? "No iterations" : state.error();
+        std::cout << std::left << std::setw(40) << name << " ERROR: " << run["error_message"].asString() << std::endl;
+        result["benchmarks"].append(run);
+        continue;
+      }
+
+      const double iterations = static_cast<double>(state.iterations());
+      const double real_ns = state.realTime().count() * 1e9 / iterations;
+      const double cpu_ns = state.cpuTime().count() * 1e9 / iterations;
+      run["real_time"] = real_ns;
+      run["cpu_time"] = cpu_ns;
+      std::cout << std::left << std::setw(40) << name << std::right << std::setw(16) << std::fixed
+                << std::setprecision(0) << real_ns << " ns " << std::setw(16) << cpu_ns << " ns cpu "
+                << std::setw(10) << state.iterations();
+      if (state.bytesProcessed() != 0) {
+        const double rate = static_cast<double>(state.bytesProcessed()) / state.realTime().count();
+        run["bytes_per_second"] = rate;
+        std::cout << "  " << std::setprecision(1) << rate / (1024 * 1024) << " MiB/s";
+      }
+      if (state.itemsProcessed() != 0) {
+        const double rate = static_cast<double>(state.itemsProcessed()) / state.realTime().count();
+        run["items_per_second"] = rate;
+        std::cout << "  " << std::setprecision(0) << rate << " items/s";
+      }
+      std::cout << std::endl;
+      result["benchmarks"].append(run);
+    }
+  }
+  return result;
+}
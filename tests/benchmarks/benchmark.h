@@ -0,0 +1,99 @@
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "json/json.h"
+
+/**
+ * Timing state of one benchmark run. The benchmark does its setup, then runs
+ * the code to measure in `while (state.keepRunning()) { ... }`. The loop runs
+ * until it has measured for at least the minimum time, and at least once.
+ */
+class BenchmarkState {
+ public:
+  BenchmarkState(int64_t arg, std::chrono::duration<double> min_time);
+
+  bool keepRunning();
+  /** The argument the benchmark was registered with, 0 if none. */
+  int64_t arg() const { return arg_; }
+
+  /** Exclude per-iteration setup from the measurement. */
+  void pauseTiming();
+  void resumeTiming();
+
+  /** Work done by all the iterations together, reported per second. */
+  void setBytesProcessed(uint64_t bytes) { bytes_ = bytes; }
+  void setItemsProcessed(uint64_t items) { items_ = items; }
+  void skipWithError(const std::string& error) { error_ = error; }
+
+  uint64_t iterations() const { return iterations_; }
+  std::chrono::duration<double> realTime() const { return real_time_; }
+  std::chrono::duration<double> cpuTime() const { return cpu_time_; }
+  uint64_t bytesProcessed() const { return bytes_; }
+  uint64_t itemsProcessed() const { return items_; }
+  const std::string& error() const { return error_; }
+
+ private:
+  void start();
+  void stop();
+
+  const int64_t arg_;
+  const std::chrono::duration<double> min_time_;
+  uint64_t iterations_{0};
+  bool started_{false};
+  bool running_{false};
+  std::chrono::steady_clock::time_point real_start_;
+  std::chrono::duration<double> cpu_start_{0};
+  std::chrono::duration<double> real_time_{0};
+  std::chrono::duration<double> cpu_time_{0};
+  uint64_t bytes_{0};
+  uint64_t items_{0};
+  std::string error_;
+};
+
+class Benchmark {
+ public:
+  using Function = std::function<void(BenchmarkState&)>;
+
+  Benchmark(std::string name, Function function) : name_(std::move(name)), function_(std::move(function)) {}
+
+  /** Run the benchmark once for each argument added. */
+  Benchmark* arg(int64_t value) {
+    args_.push_back(value);
+    return this;
+  }
+
+  const std::string& name() const { return name_; }
+  const std::vector<int64_t>& args() const { return args_; }
+  void run(BenchmarkState& state) const { function_(state); }
+
+ private:
+  std::string name_;
+  Function function_;
+  std::vector<int64_t> args_;
+};
+
+/** Register a benchmark, see AKTUALIZR_BENCHMARK. */
+Benchmark* registerBenchmark(const std::string& name, Benchmark::Function function);
+
+/**
+ * Run the registered benchmarks whose name matches `filter`. The result is in
+ * the JSON format of Google Benchmark, so that the usual tools can compare
+ * runs.
+ */
+Json::Value runBenchmarks(const std::string& filter, std::chrono::duration<double> min_time);
+
+#define AKTUALIZR_BENCHMARK_CONCAT2(a, b) a##b
+#define AKTUALIZR_BENCHMARK_CONCAT(a, b) AKTUALIZR_BENCHMARK_CONCAT2(a, b)
+
+/** Use like: AKTUALIZR_BENCHMARK(Function)->arg(1000)->arg(10000); */
+#define AKTUALIZR_BENCHMARK(function)                                                                    \
+  static Benchmark* AKTUALIZR_BENCHMARK_CONCAT(benchmark_, AKTUALIZR_BENCHMARK_CONCAT(function, __LINE__)) \
+      __attribute__((unused)) = registerBenchmark(#function, function)
+
+#endif  // BENCHMARK_H_
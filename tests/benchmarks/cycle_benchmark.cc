@@ -0,0 +1,97 @@
+#include <memory>
+#include <string>
+
+#include <boost/process.hpp>
+
+#include "benchmark.h"
+#include "libaktualizr/aktualizr.h"
+#include "libaktualizr/config.h"
+#include "test_utils.h"
+#include "uptane_repo.h"
+#include "utilities/utils.h"
+
+namespace {
+
+const std::string primary_serial = "CA:FE:A6:D2:84:9D";
+const std::string primary_hw = "primary_hw";
+
+/* The fake server with a repo that has an update for the Primary. */
+class UptaneServer {
+ public:
+  UptaneServer() : port_(TestUtils::getFreePort()), url_("http://127.0.0.1:" + port_) {
+    UptaneRepo repo{temp_dir_.Path(), "", ""};
+    repo.generateRepo(KeyType::kED25519);
+    Utils::writeFile(temp_dir_ / "firmware.bin", std::string(1024 * 1024, 'f'));
+    repo.addImage(temp_dir_ / "firmware.bin", "firmware.bin", primary_hw);
+    repo.addTarget("firmware.bin", primary_hw, primary_serial);
+    repo.signTargets();
+
+    server_process_ = boost::process::child("tests/fake_http_server/fake_test_server.py", port_, "-m",
+                                            temp_dir_.PathString());
+    TestUtils::waitForServer(url_ + "/");
+  }
+
+  Config config(const boost::filesystem::path &storage_dir) const {
+    Config conf;
+    conf.pacman.type = PACKAGE_MANAGER_NONE;
+    conf.provision.device_id = "device_id";
+    conf.provision.ecu_registration_endpoint = url_ + "/director/ecus";
+    conf.tls.server = url_;
+    conf.uptane.director_server = url_ + "/director";
+    conf.uptane.repo_server = url_ + "/repo";
+    conf.uptane.key_type = KeyType::kED25519;
+    conf.provision.server = url_;
+    conf.provision.provision_path = "tests/test_data/cred.zip";
+    conf.provision.primary_ecu_serial = primary_serial;
+    conf.provision.primary_ecu_hardware_id = primary_hw;
+    conf.storage.path = storage_dir;
+    conf.pacman.images_path = storage_dir / "images";
+    conf.bootloader.reboot_sentinel_dir = storage_dir;
+    conf.postUpdateValues();
+    return conf;
+  }
+
+ private:
+  TemporaryDirectory temp_dir_;
+  std::string port_;
+  std::string url_;
+  boost::process::child server_process_;
+};
+
+const UptaneServer &server() {
+  static UptaneServer server;
+  return server;
+}
+
+}  // namespace
+
+/* A full update of the Primary: check, download, install and send the manifest. */
+void UptaneCycleUpdate(BenchmarkState &state) {
+  std::unique_ptr<TemporaryDirectory> storage_dir;
+  std::unique_ptr<Aktualizr> aktualizr;
+  while (state.keepRunning()) {
+    state.pauseTiming();
+    aktualizr.reset();
+    storage_dir = std_::make_unique<TemporaryDirectory>();
+    aktualizr = std_::make_unique<Aktualizr>(server().config(storage_dir->Path()));
+    aktualizr->Initialize();
+    state.resumeTiming();
+
+    aktualizr->UptaneCycle();
+  }
+  state.setItemsProcessed(state.iterations());
+}
+AKTUALIZR_BENCHMARK(UptaneCycleUpdate);
+
+/* A cycle with nothing to update, as the Primary runs at every poll. */
+void UptaneCycleIdle(BenchmarkState &state) {
+  TemporaryDirectory storage_dir;
+  Aktualizr aktualizr(server().config(storage_dir.Path()));
+  aktualizr.Initialize();
+  aktualizr.UptaneCycle();
+  while (state.keepRunning()) {
+    aktualizr.UptaneCycle();
+  }
+  state.setItemsProcessed(state.iterations());
+}
+AKTUALIZR_BENCHMARK(UptaneCycleIdle);
@@ -0,0 +1,46 @@
+#include <string>
+
+#include <boost/process.hpp>
+
+#include "benchmark.h"
+#include "crypto/crypto.h"
+#include "http/httpclient.h"
+#include "test_utils.h"
+
+namespace {
+
+struct Download {
+  MultiPartSHA256Hasher hasher;
+  uint64_t received{0};
+};
+
+size_t writeCallback(char *contents, size_t size, size_t nmemb, void *userp) {
+  auto *download = static_cast<Download *>(userp);
+  download->hasher.update(reinterpret_cast<const unsigned char *>(contents), size * nmemb);
+  download->received += size * nmemb;
+  return size * nmemb;
+}
+
+}  // namespace
+
+/* Download and hash a 100 MiB image from the fake server, as the Primary fetches binary Targets. */
+void DownloadImage(BenchmarkState &state) {
+  const std::string port = TestUtils::getFreePort();
+  const std::string server = "http://127.0.0.1:" + port;
+  boost::process::child server_process("tests/fake_http_server/fake_test_server.py", port);
+  TestUtils::waitForServer(server + "/");
+
+  HttpClient http;
+  uint64_t received = 0;
+  while (state.keepRunning()) {
+    Download download;
+    const HttpResponse response = http.download(server + "/large_file", writeCallback, nullptr, &download, 0);
+    if (!response.isOk()) {
+      state.skipWithError("Download failed: " + response.getStatusStr());
+    }
+    download.hasher.getHexDigest();
+    received += download.received;
+  }
+  state.setBytesProcessed(received);
+}
+AKTUALIZR_BENCHMARK(DownloadImage);
@@ -0,0 +1,32 @@
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+#include "crypto/crypto.h"
+
+namespace {
+
+/* Hash 16 MiB per iteration in parts of the given size, as images are hashed while downloaded. */
+void hashImage(BenchmarkState &state, Hash::Type type) {
+  constexpr uint64_t image_size = 16 * 1024 * 1024;
+  const auto part_size = static_cast<uint64_t>(state.arg());
+  const std::vector<unsigned char> part(part_size, 0x5a);
+  auto hasher = MultiPartHasher::create(type);
+  std::string digest;
+  while (state.keepRunning()) {
+    hasher->reset();
+    for (uint64_t hashed = 0; hashed < image_size; hashed += part_size) {
+      hasher->update(part.data(), part_size);
+    }
+    digest = hasher->getHexDigest();
+  }
+  state.setBytesProcessed(state.iterations() * image_size);
+}
+
+}  // namespace
+
+void HashSha256(BenchmarkState &state) { hashImage(state, Hash::Type::kSha256); }
+AKTUALIZR_BENCHMARK(HashSha256)->arg(4096)->arg(65536);
+
+void HashSha512(BenchmarkState &state) { hashImage(state, Hash::Type::kSha512); }
+AKTUALIZR_BENCHMARK(HashSha512)->arg(4096)->arg(65536);
@@ -0,0 +1,62 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#include "benchmark.h"
+#include "logging/logging.h"
+#include "utilities/utils.h"
+
+namespace bpo = boost::program_options;
+
+bpo::variables_map parseOptions(int argc, char **argv) {
+  bpo::options_description description("aktualizr-benchmarks command line options");
+  // clang-format off
+  description.add_options()
+      ("help,h", "print usage")
+      ("loglevel", bpo::value<int>()->default_value(3), "set log level 0-5 (trace, debug, info, warning, error, fatal)")
+      ("filter", bpo::value<std::string>()->default_value("."), "run only the benchmarks whose name matches this regular expression")
+      ("min-time", bpo::value<double>()->default_value(0.5), "minimum time to measure each benchmark for in seconds, 0 to run each once")
+      ("output,o", bpo::value<boost::filesystem::path>(), "write the results there in the JSON format of Google Benchmark");
+  // clang-format on
+
+  bpo::variables_map vm;
+  try {
+    bpo::store(bpo::parse_command_line(argc, argv, description), vm);
+    if (vm.count("help") != 0) {
+      std::cout << description << '\n';
+      exit(EXIT_SUCCESS);
+    }
+    bpo::notify(vm);
+  } catch (const bpo::error &ex) {
+    std::cerr << ex.what() << '\n' << description;
+    exit(EXIT_FAILURE);
+  }
+  return vm;
+}
+
+/*
+ * Runs the benchmarks of libaktualizr's hot paths. Run it from the source
+ * directory, some benchmarks use the test credentials and the fake server.
+ * Compare two result files with scripts/compare_benchmarks.py.
+ */
+int main(int argc, char **argv) {
+  logger_init();
+  const bpo::variables_map vm = parseOptions(argc, argv);
+  logger_set_threshold(static_cast<boost::log::trivial::severity_level>(vm["loglevel"].as<int>()));
+
+  const Json::Value results =
+      runBenchmarks(vm["filter"].as<std::string>(), std::chrono::duration<double>(vm["min-time"].as<double>()));
+  if (vm.count("output") != 0) {
+    Utils::writeFile(vm["output"].as<boost::filesystem::path>(), results);
+  }
+
+  for (const auto &run : results["benchmarks"]) {
+    if (run["error_occurred"].asBool()) {
+      return EXIT_FAILURE;
+    }
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,82 @@
+#include <memory>
+#include <string>
+
+#include "benchmark.h"
+#include "crypto/crypto.h"
+#include "storage/sqlstorage.h"
+#include "utilities/utils.h"
+
+namespace {
+
+std::unique_ptr<INvStorage> storage(const boost::filesystem::path &dir) {
+  StorageConfig config;
+  config.type = StorageType::kSqlite;
+  config.path = dir;
+  return std::unique_ptr<INvStorage>(new SQLStorage(config, false));
+}
+
+Uptane::Target target(const std::string &name) {
+  const std::vector<Hash> hashes{Hash{Hash::Type::kSha256, Crypto::sha256digestHex(name)}};
+  const Uptane::EcuMap ecus{{Uptane::EcuSerial("primary"), Uptane::HardwareIdentifier("primary-hw")}};
+  return Uptane::Target{name, ecus, hashes, 1024};
+}
+
+}  // namespace
+
+/* Store and load back Targets metadata, as done on every update check. */
+void StorageMetadata(BenchmarkState &state) {
+  TemporaryDirectory temp_dir;
+  auto db = storage(temp_dir.Path());
+  Json::Value targets;
+  targets["signed"]["_type"] = "Targets";
+  for (int64_t i = 0; i < state.arg(); ++i) {
+    const std::string name = "target-" + std::to_string(i);
+    targets["signed"]["targets"][name]["length"] = 1024;
+    targets["signed"]["targets"][name]["hashes"]["sha256"] = Crypto::sha256digestHex(name);
+  }
+  const std::string metadata = Utils::jsonToCanonicalStr(targets);
+
+  std::string loaded;
+  while (state.keepRunning()) {
+    db->storeNonRoot(metadata, Uptane::RepositoryType::Image(), Uptane::Role::Targets());
+    db->loadNonRoot(&loaded, Uptane::RepositoryType::Image(), Uptane::Role::Targets());
+  }
+  state.setBytesProcessed(state.iterations() * metadata.size() * 2);
+}
+AKTUALIZR_BENCHMARK(StorageMetadata)->arg(100)->arg(10000);
+
+/* Load the installed versions of an ECU with a given length of installation history. */
+void StorageInstalledVersions(BenchmarkState &state) {
+  TemporaryDirectory temp_dir;
+  auto db = storage(temp_dir.Path());
+  db->storeEcuSerials({{Uptane::EcuSerial("primary"), Uptane::HardwareIdentifier("primary-hw")}});
+  for (int64_t i = 0; i < state.arg(); ++i) {
+    db->saveInstalledVersion("primary", target("update-" + std::to_string(i)), InstalledVersionUpdateMode::kCurrent,
+                             "");
+  }
+
+  boost::optional<Uptane::Target> current;
+  boost::optional<Uptane::Target> pending;
+  while (state.keepRunning()) {
+    if (!db->loadInstalledVersions("primary", &current, &pending)) {
+      state.skipWithError("Could not load the installed versions");
+    }
+  }
+  state.setItemsProcessed(state.iterations());
+}
+AKTUALIZR_BENCHMARK(StorageInstalledVersions)->arg(1)->arg(1000);
+
+/* Record an installation, as done for each ECU at the end of an update. */
+void StorageSaveInstalledVersion(BenchmarkState &state) {
+  TemporaryDirectory temp_dir;
+  auto db = storage(temp_dir.Path());
+  db->storeEcuSerials({{Uptane::EcuSerial("primary"), Uptane::HardwareIdentifier("primary-hw")}});
+  const Uptane::Target update = target("update");
+
+  while (state.keepRunning()) {
+    db->saveInstalledVersion("primary", update, InstalledVersionUpdateMode::kPending, "");
+    db->saveInstalledVersion("primary", update, InstalledVersionUpdateMode::kCurrent, "");
+  }
+  state.setItemsProcessed(state.iterations());
+}
+AKTUALIZR_BENCHMARK(StorageSaveInstalledVersion);
@@ -0,0 +1,77 @@
+#include <map>
+#include <memory>
+#include <string>
+
+#include "benchmark.h"
+#include "crypto/crypto.h"
+#include "image_repo.h"
+#include "uptane/tuf.h"
+#include "utilities/utils.h"
+
+namespace {
+
+/* Signed Image repo Targets metadata with a given number of Targets. */
+struct TargetsFixture {
+  explicit TargetsFixture(int64_t count) : repo(temp_dir.Path(), "", "") {
+    repo.generateRepo(KeyType::kED25519);
+    root = std::make_shared<Uptane::Root>(Uptane::RepositoryType::Image(),
+                                          Utils::parseJSONFile(temp_dir.Path() / ImageRepo::dir / "root.json"));
+
+    Json::Value targets = Utils::parseJSONFile(temp_dir.Path() / ImageRepo::dir / "targets.json")["signed"];
+    for (int64_t i = 0; i < count; ++i) {
+      const std::string name = "target-" + std::to_string(i);
+      Json::Value target;
+      target["length"] = Json::UInt64(1024);
+      target["hashes"]["sha256"] = Crypto::sha256digestHex(name);
+      target["custom"]["hardwareIds"][0] = "benchmark-hw";
+      target["custom"]["targetFormat"] = "BINARY";
+      targets["targets"][name] = target;
+    }
+    targets["version"] = targets["version"].asUInt() + 1;
+    metadata = Utils::jsonToCanonicalStr(repo.signTuf(Uptane::Role::Targets(), targets));
+  }
+
+  TemporaryDirectory temp_dir;
+  ImageRepo repo;
+  std::shared_ptr<Uptane::Root> root;
+  std::string metadata;
+};
+
+const TargetsFixture &fixture(int64_t count) {
+  // Signing large metadata takes longer than parsing it, keep it for the other benchmarks.
+  static std::map<int64_t, std::unique_ptr<TargetsFixture>> fixtures;
+  auto &entry = fixtures[count];
+  if (entry == nullptr) {
+    entry = std_::make_unique<TargetsFixture>(count);
+  }
+  return *entry;
+}
+
+}  // namespace
+
+/* Parse Targets metadata without checking the signature. */
+void TargetsParse(BenchmarkState &state) {
+  const TargetsFixture &targets = fixture(state.arg());
+  size_t parsed = 0;
+  while (state.keepRunning()) {
+    const Uptane::Targets meta(Utils::parseJSON(targets.metadata));
+    parsed += meta.targets.size();
+  }
+  state.setItemsProcessed(parsed);
+  state.setBytesProcessed(state.iterations() * targets.metadata.size());
+}
+AKTUALIZR_BENCHMARK(TargetsParse)->arg(1000)->arg(10000)->arg(100000);
+
+/* Parse Targets metadata and verify its signature, as the Primary does on every check. */
+void TargetsVerify(BenchmarkState &state) {
+  const TargetsFixture &targets = fixture(state.arg());
+  size_t parsed = 0;
+  while (state.keepRunning()) {
+    const Uptane::Targets meta(Uptane::RepositoryType::Image(), Uptane::Role::Targets(),
+                               Utils::parseJSON(targets.metadata), targets.root);
+    parsed += meta.targets.size();
+  }
+  state.setItemsProcessed(parsed);
+  state.setBytesProcessed(state.iterations() * targets.metadata.size());
+}
+AKTUALIZR_BENCHMARK(TargetsVerify)->arg(1000)->arg(10000)->arg(100000);
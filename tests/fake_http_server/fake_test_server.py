@@ -118,6 +118,12 @@ class Handler(SimpleHTTPRequestHandler):
                 sleep(1)
         elif self.path == '/campaigner/campaigns':
             self.serve_meta("/campaigns.json")
+        elif self.path == '/polling_hints':
+            self.send_response(429)
+            self.send_header('Cache-Control', 'public, max-age=120')
+            self.send_header('Retry-After', '30')
+            self.end_headers()
+            self.wfile.write(b'{}')
         elif self.path == '/user_agent':
             user_agent = self.headers.get('user-agent')
             self.send_response(200)
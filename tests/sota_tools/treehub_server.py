@@ -2,17 +2,20 @@
 
 import argparse
 import cgi
+import io
 import os
 import signal
 import ssl
 import subprocess
 import sys
+import tarfile
 import time
 import hashlib
 from contextlib import ExitStack
 from http.server import BaseHTTPRequestHandler, HTTPServer
 from random import seed, randrange
 from pathlib import Path
+from urllib.parse import urlparse, parse_qs
 from tempfile import TemporaryDirectory
 
 
@@ -53,6 +56,12 @@ class TreehubServerHandler(BaseHTTPRequestHandler):
             self.end_headers()
 
     def do_POST(self):
+        if self.path == '/object-presence':
+            self.check_presence()
+            return
+        if self.path.startswith('/object-bundle'):
+            self.store_bundle()
+            return
         ctype, pdict = cgi.parse_header(self.headers['Content-Type'])
         print("Upload type: {}".format(ctype))
         if ctype == 'multipart/form-data':
@@ -93,6 +102,59 @@ class TreehubServerHandler(BaseHTTPRequestHandler):
         self.send_response_only(400)
         self.end_headers()
 
+    def check_presence(self):
+        # Batched presence query: one object path per line, answered with a
+        # bitmap in which bit i is set if object i is present.
+        if self.drop_check():
+            print("Dropping presence query")
+            return
+        if args.no_batch:
+            self.send_response_only(404)
+            self.end_headers()
+            return
+        length = int(self.headers['content-length'])
+        paths = self.rfile.read(length).decode().splitlines()
+        print("Processing presence query for %d objects" % len(paths))
+        reply = bytearray((len(paths) + 7) // 8)
+        for i, path in enumerate(paths):
+            if os.path.exists(os.path.join(repo_path, 'objects', path)):
+                reply[i // 8] |= 1 << (i % 8)
+        self.send_response_only(200)
+        self.send_header('Content-Length', str(len(reply)))
+        self.end_headers()
+        self.wfile.write(reply)
+
+    def store_bundle(self):
+        # Tar archive of objects, named by their path relative to objects/.
+        # The SHA256 of the archive is given in the query string.
+        if self.drop_check():
+            print("Dropping bundle upload")
+            return
+        length = int(self.headers['content-length'])
+        body = self.rfile.read(length)
+        if args.no_bundle:
+            self.send_response_only(404)
+            self.end_headers()
+            return
+        expected = parse_qs(urlparse(self.path).query).get('sha256', [''])[0]
+        if hashlib.sha256(body).hexdigest() != expected.lower():
+            print("Bundle does not match its SHA256")
+            self.send_response_only(400)
+            self.end_headers()
+            return
+        objects_path = os.path.join(repo_path, 'objects')
+        with tarfile.open(fileobj=io.BytesIO(body)) as bundle:
+            members = bundle.getmembers()
+            for member in members:
+                if not member.isfile() or member.name.startswith('/') or '..' in member.name.split('/'):
+                    self.send_response_only(400)
+                    self.end_headers()
+                    return
+            print("Storing bundle of %d objects" % len(members))
+            bundle.extractall(objects_path, members)
+        self.send_response_only(204)
+        self.end_headers()
+
     def drop_check(self):
         self.__class__.made_requests += 1
         if args.fail and args.fail > 0:
@@ -167,6 +229,10 @@ if __name__ == "__main__":
                         help='sleep for n.n seconds for every GET request')
     parser.add_argument('-t', '--tls', action='store_true',
                         help='require TLS from clients')
+    parser.add_argument('--no-batch', action='store_true',
+                        help='reject batched presence queries')
+    parser.add_argument('--no-bundle', action='store_true',
+                        help='reject bundles of objects')
     args = parser.parse_args()
 
     signal.signal(signal.SIGTERM, sig_handler)